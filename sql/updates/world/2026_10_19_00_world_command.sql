@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='instance cleanup';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('instance cleanup',3,'Syntax: .instance cleanup\r\n\r\nRemove unbound instances and references to deleted instances in the background. Instances in use are skipped, renumbering only happens at server startup.');
@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug movementtiers';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug movementtiers',3,'Syntax: .debug movementtiers\r\n\r\nShow how many movement packets and bytes were sent and how many were suppressed by the distance tiers on your current map.');
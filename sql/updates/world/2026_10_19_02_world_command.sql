@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug lookupbench';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug lookupbench',3,'Syntax: .debug lookupbench [#lookups]\r\n\r\nLook up creatures by GUID from as many threads as MapUpdate.Threads, #lookups per thread (default 1000000, at most 50000000), once lock free and once through the container lock, and show the time of both runs. The world update is blocked while it runs.');
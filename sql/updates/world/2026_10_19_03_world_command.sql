@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug dormant';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug dormant',3,'Syntax: .debug dormant\r\n\r\nShow how many creatures and gameobjects in the updated cells of your current map were updated and how many were skipped as dormant by the last map update, and whether the selected creature is dormant.');
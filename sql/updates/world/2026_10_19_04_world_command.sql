@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug randbench';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug randbench',3,'Syntax: .debug randbench [#numbers]\r\n\r\nDraw #numbers random numbers (default 10000000, at most 500000000) through the old per call MTRand lookup, through urand() and through the configured engine directly, and show the time of each run. The world update is blocked while it runs.');
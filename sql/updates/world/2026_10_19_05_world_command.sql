@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug spellbench';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug spellbench',3,'Syntax: .debug spellbench [#events]\r\n\r\nReplay a synthetic raid combat log of #events spell hits (default 2000000, at most 20000000) and run the per hit spell checks once through SpellEntry and the DBC/SpellMgr lookups and once through the packed SpellInfo, and show the time of both runs. The world update is blocked while it runs.');
@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug gridload';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug gridload',3,'Syntax: .debug gridload\r\n\r\nShow the grid loading stages of your current map: terrain tiles loaded, cells loaded at once around entering players, cells loaded later under GridLoad.TickBudget, cells loaded early because something looked at them, with object counts and times, and the cells still pending.');
@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug lootstats';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug lootstats',3,'Syntax: .debug lootstats\r\n\r\nShow how many creature corpses became lootable since startup, how many of their loots were generated by a loot request and how many corpses disappeared without anybody opening them.');
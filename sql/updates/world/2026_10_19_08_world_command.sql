@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug pathbench';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug pathbench',3,'Syntax: .debug pathbench [#count [#radius]]\r\n\r\nPlan paths between #count (default 1000, at most 100000) random point pairs within #radius (default 100) yards of you on the walk maps of your current map: how many need a way around obstacles, can be walked straight, lie outside the loaded walk maps or find no path, and the paths per second with every pair searched and with as many of the pairs as the path cache holds answered by it.');
@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug objectpools';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug objectpools',3,'Syntax: .debug objectpools [reset]\r\n\r\nShow the pools of released creatures, gameobjects, update fields, AIs and movement generators kept for reuse: blocks in use and kept free, allocations and allocations per second since the last reset, the share of them served from a pool instead of the heap, and the memory per creature. With reset, restart the allocation counters.');
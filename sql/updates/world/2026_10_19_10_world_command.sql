@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug profiler';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug profiler',3,'Syntax: .debug profiler [on|off|reset|dump [$file]]\r\n\r\nWithout argument, show the 50th, 95th and 99th percentile, the maximum and the total time of every profiled phase of the world and map updates over what the profile buffers hold, and the five maps with the most update time. on and off switch the profiler, reset clears the buffers and dump writes them to $file, a plain file name (default tickprofile.json), in the logs directory in Chrome trace format, for chrome://tracing or Perfetto.');
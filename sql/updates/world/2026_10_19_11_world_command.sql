@@ -0,0 +1,2 @@
+DELETE FROM `command` WHERE `name`='debug losbench';
+INSERT INTO `command`(`name`,`security`,`help`) VALUES ('debug losbench',3,'Syntax: .debug losbench [#count [#radius]]\r\n\r\nTrace #count (default 10000, at most 1000000) random line of sight segments and height points within #radius (default 50) yards of you on your current map, first one query at a time and then as one batch: the rays and points per second of both ways, how many segments are visible and heights found, and how many results of the batch differ from the single queries.');
@@ -251,6 +251,7 @@ extern int main(int argc, char **argv)
     //StopDB();
 
     sLog->outString("Halting process...");
+    sLog->Flush();
     return 0;
 }
 
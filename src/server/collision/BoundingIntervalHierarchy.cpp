@@ -20,7 +20,7 @@
 
 #include "BoundingIntervalHierarchy.h"
 
-void BIH::buildHierarchy(std::vector<uint32> &tempTree, buildData &dat, BuildStats &stats)
+void BIH::buildHierarchy(std::vector<uint32> &tempTree, buildData &dat, BuildStats &stats, BIHBuildMethod method)
 {
     // create space for the first node
     tempTree.push_back(3 << 30); // dummy leaf
@@ -31,7 +31,10 @@ void BIH::buildHierarchy(std::vector<uint32> &tempTree, buildData &dat, BuildSta
     AABound gridBox = { bounds.low(), bounds.high() };
     AABound nodeBox = gridBox;
     // seed subdivide function
-    subdivide(0, dat.numPrims - 1, tempTree, dat, gridBox, nodeBox, 0, 1, stats);
+    if (method == BIH_BUILD_SAH)
+        subdivideSAH(0, dat.numPrims - 1, tempTree, dat, nodeBox, 0, 1, stats);
+    else
+        subdivide(0, dat.numPrims - 1, tempTree, dat, gridBox, nodeBox, 0, 1, stats);
 }
 
 void BIH::subdivide(int left, int right, std::vector<uint32> &tempTree, buildData &dat, AABound &gridBox, AABound &nodeBox, int nodeIndex, int depth, BuildStats &stats)
@@ -240,6 +243,235 @@ void BIH::subdivide(int left, int right, std::vector<uint32> &tempTree, buildDat
         stats.updateLeaf(depth + 1, 0);
 }
 
+void BIH::subdivideSAH(int left, int right, std::vector<uint32> &tempTree, buildData &dat, AABound nodeBox, int nodeIndex, int depth, BuildStats &stats)
+{
+    int count = right - left + 1;
+    if (count <= dat.maxPrims || depth >= MAX_STACK_SIZE)
+    {
+        stats.updateLeaf(depth, count);
+        createNode(tempTree, nodeIndex, left, right);
+        return;
+    }
+
+    // bounds of the primitives and of their centers
+    AABound primBox = { Vector3(G3D::inf(), G3D::inf(), G3D::inf()), Vector3(-G3D::inf(), -G3D::inf(), -G3D::inf()) };
+    AABound centerBox = primBox;
+    for (int i = left; i <= right; ++i)
+    {
+        AABox const& b = dat.primBound[dat.indices[i]];
+        primBox.lo = primBox.lo.min(b.low());
+        primBox.hi = primBox.hi.max(b.high());
+        centerBox.lo = centerBox.lo.min(b.center());
+        centerBox.hi = centerBox.hi.max(b.center());
+    }
+
+    // cut off empty space on the axis where it is largest, as the midpoint builder does
+    int cutAxis = -1;
+    float cutRatio = 1.0f / 1.3f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (primBox.lo[axis] <= nodeBox.lo[axis] || primBox.hi[axis] >= nodeBox.hi[axis])
+            continue;
+        float ratio = (primBox.hi[axis] - primBox.lo[axis]) / (nodeBox.hi[axis] - nodeBox.lo[axis]);
+        if (ratio < cutRatio)
+        {
+            cutRatio = ratio;
+            cutAxis = axis;
+        }
+    }
+    if (cutAxis != -1)
+    {
+        stats.updateBVH2();
+        int nextIndex = tempTree.size();
+        // allocate child
+        tempTree.insert(tempTree.end(), 3, 0);
+        // write bvh2 clip node
+        stats.updateInner();
+        tempTree[nodeIndex + 0] = (cutAxis << 30) | (1 << 29) | nextIndex;
+        tempTree[nodeIndex + 1] = floatToRawIntBits(primBox.lo[cutAxis]);
+        tempTree[nodeIndex + 2] = floatToRawIntBits(primBox.hi[cutAxis]);
+        nodeBox.lo[cutAxis] = primBox.lo[cutAxis];
+        nodeBox.hi[cutAxis] = primBox.hi[cutAxis];
+        subdivideSAH(left, right, tempTree, dat, nodeBox, nextIndex, depth + 1, stats);
+        return;
+    }
+
+    // evaluate the bin borders of every axis
+    float parentArea = surfaceArea(primBox);
+    float bestCost = G3D::inf();
+    int bestAxis = -1;
+    int bestBin = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float extent = centerBox.hi[axis] - centerBox.lo[axis];
+        if (!(extent > 0.0f) || !(parentArea > 0.0f))
+            continue;
+
+        AABound binBox[BIH_SAH_BINS];
+        int binCount[BIH_SAH_BINS];
+        for (int b = 0; b < BIH_SAH_BINS; ++b)
+        {
+            binBox[b].lo = Vector3(G3D::inf(), G3D::inf(), G3D::inf());
+            binBox[b].hi = Vector3(-G3D::inf(), -G3D::inf(), -G3D::inf());
+            binCount[b] = 0;
+        }
+
+        float scale = BIH_SAH_BINS / extent;
+        for (int i = left; i <= right; ++i)
+        {
+            AABox const& pb = dat.primBound[dat.indices[i]];
+            int b = std::min(int((pb.center()[axis] - centerBox.lo[axis]) * scale), BIH_SAH_BINS - 1);
+            binBox[b].lo = binBox[b].lo.min(pb.low());
+            binBox[b].hi = binBox[b].hi.max(pb.high());
+            ++binCount[b];
+        }
+
+        // area and count right of each border, then sweep from the left
+        float rightArea[BIH_SAH_BINS];
+        int rightCount[BIH_SAH_BINS];
+        AABound acc = binBox[BIH_SAH_BINS - 1];
+        int accCount = binCount[BIH_SAH_BINS - 1];
+        for (int b = BIH_SAH_BINS - 1; b > 0; --b)
+        {
+            if (b < BIH_SAH_BINS - 1)
+            {
+                acc.lo = acc.lo.min(binBox[b].lo);
+                acc.hi = acc.hi.max(binBox[b].hi);
+                accCount += binCount[b];
+            }
+            rightArea[b] = surfaceArea(acc);
+            rightCount[b] = accCount;
+        }
+
+        acc = binBox[0];
+        accCount = 0;
+        for (int b = 1; b < BIH_SAH_BINS; ++b)
+        {
+            if (b > 1)
+            {
+                acc.lo = acc.lo.min(binBox[b - 1].lo);
+                acc.hi = acc.hi.max(binBox[b - 1].hi);
+            }
+            accCount += binCount[b - 1];
+            if (!accCount || !rightCount[b])
+                continue;
+
+            float cost = BIH_SAH_TRAVERSAL_COST + BIH_SAH_INTERSECT_COST *
+                (surfaceArea(acc) * accCount + rightArea[b] * rightCount[b]) / parentArea;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    int maxLeafSize = std::max(dat.maxPrims, BIH_SAH_MAX_LEAF_SIZE);
+    if (count <= maxLeafSize && (bestAxis == -1 || bestCost >= BIH_SAH_INTERSECT_COST * count))
+    {
+        stats.updateLeaf(depth, count);
+        createNode(tempTree, nodeIndex, left, right);
+        return;
+    }
+
+    // partition L/R subsets
+    int axis = bestAxis;
+    int mid = left;
+    if (axis != -1)
+    {
+        float scale = BIH_SAH_BINS / (centerBox.hi[axis] - centerBox.lo[axis]);
+        for (int i = left; i <= right; ++i)
+        {
+            float c = dat.primBound[dat.indices[i]].center()[axis];
+            if (std::min(int((c - centerBox.lo[axis]) * scale), BIH_SAH_BINS - 1) < bestBin)
+                std::swap(dat.indices[i], dat.indices[mid++]);
+        }
+    }
+    else
+    {
+        // too many primitives sharing one center, split them in half
+        axis = (primBox.hi - primBox.lo).primaryAxis();
+        mid = left + count / 2;
+    }
+
+    float clipL = -G3D::inf();
+    float clipR = G3D::inf();
+    for (int i = left; i < mid; ++i)
+        clipL = std::max(clipL, dat.primBound[dat.indices[i]].high()[axis]);
+    for (int i = mid; i <= right; ++i)
+        clipR = std::min(clipR, dat.primBound[dat.indices[i]].low()[axis]);
+
+    // both children are never empty here
+    int nextIndex = tempTree.size();
+    tempTree.insert(tempTree.end(), 6, 0);
+    stats.updateInner();
+    tempTree[nodeIndex + 0] = (axis << 30) | nextIndex;
+    tempTree[nodeIndex + 1] = floatToRawIntBits(clipL);
+    tempTree[nodeIndex + 2] = floatToRawIntBits(clipR);
+
+    AABound nodeBoxL(nodeBox), nodeBoxR(nodeBox);
+    nodeBoxL.hi[axis] = clipL;
+    nodeBoxR.lo[axis] = clipR;
+    subdivideSAH(left, mid - 1, tempTree, dat, nodeBoxL, nextIndex, depth + 1, stats);
+    subdivideSAH(mid, right, tempTree, dat, nodeBoxR, nextIndex + 3, depth + 1, stats);
+}
+
+float BIH::surfaceArea(AABound const& box)
+{
+    Vector3 d = box.hi - box.lo;
+    if (d.x < 0.0f || d.y < 0.0f || d.z < 0.0f)
+        return 0.0f;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+// Expected cost of a random ray hitting the root box: every node costs its
+// traversal or primitive tests times the chance of the ray entering it
+float BIH::traversalCost(std::vector<uint32> const& tree, AABox const& bounds)
+{
+    AABound box = { bounds.low(), bounds.high() };
+    float rootArea = surfaceArea(box);
+    if (tree.empty() || !(rootArea > 0.0f))
+        return 0.0f;
+    return nodeCost(tree, 0, box) / rootArea;
+}
+
+float BIH::nodeCost(std::vector<uint32> const& tree, uint32 node, AABound const& box)
+{
+    uint32 tn = tree[node];
+    uint32 axis = (tn & (3 << 30)) >> 30;
+    bool BVH2 = tn & (1 << 29);
+    uint32 offset = tn & ~(7 << 29);
+    float area = surfaceArea(box);
+
+    if (!BVH2 && axis == 3)
+        return BIH_SAH_INTERSECT_COST * tree[node + 1] * area;
+
+    float clipL = intBitsToFloat(tree[node + 1]);
+    float clipR = intBitsToFloat(tree[node + 2]);
+    float cost = BIH_SAH_TRAVERSAL_COST * area;
+
+    if (BVH2)
+    {
+        AABound child(box);
+        child.lo[axis] = std::max(box.lo[axis], clipL);
+        child.hi[axis] = std::min(box.hi[axis], clipR);
+        if (child.lo[axis] <= child.hi[axis])
+            cost += nodeCost(tree, offset, child);
+        return cost;
+    }
+
+    // a side with an infinite clip plane has no node
+    AABound boxL(box), boxR(box);
+    boxL.hi[axis] = std::min(box.hi[axis], clipL);
+    boxR.lo[axis] = std::max(box.lo[axis], clipR);
+    if (boxL.hi[axis] >= box.lo[axis])
+        cost += nodeCost(tree, offset, boxL);
+    if (boxR.lo[axis] <= box.hi[axis])
+        cost += nodeCost(tree, offset + 3, boxR);
+    return cost;
+}
+
 bool BIH::writeToFile(FILE *wf) const
 {
     uint32 treeSize = tree.size();
@@ -34,6 +34,14 @@
 #include <cmath>
 
 #define MAX_STACK_SIZE 64
+// rays traced together by intersectRays, one bit per ray in the active masks
+#define BIH_PACKET_SIZE 8
+
+// surface area heuristic builder
+#define BIH_SAH_BINS            16
+#define BIH_SAH_MAX_LEAF_SIZE   8
+#define BIH_SAH_TRAVERSAL_COST  1.0f
+#define BIH_SAH_INTERSECT_COST  1.5f
 
 #ifdef _MSC_VER
     #define isnan(x) _isnan(x)
@@ -72,6 +80,30 @@ struct AABound
     Vector3 lo, hi;
 };
 
+enum BIHBuildMethod
+{
+    BIH_BUILD_MIDPOINT  = 0,                                // split the longest axis of the remaining space in half
+    BIH_BUILD_SAH       = 1,                                // binned surface area heuristic, cheaper trees but slower to build
+};
+
+// Expected cost of tracing a ray through the trees built with either method,
+// in node traversals and primitive tests weighted by the surface area heuristic
+struct BIHCostStats
+{
+    BIHCostStats() : trees(0), midpoint(0.0), sah(0.0) {}
+
+    void add(BIHCostStats const& other)
+    {
+        trees += other.trees;
+        midpoint += other.midpoint;
+        sah += other.sah;
+    }
+
+    uint32 trees;
+    double midpoint;
+    double sah;
+};
+
 /* Bounding Interval Hierarchy Class.
    Building and Ray-Intersection functions based on BIH from
    Sunflow, a Java Raytracer, released under MIT/X11 License
@@ -83,8 +115,10 @@ class BIH
 {
     public:
         BIH() {};
+        // costStats: also build the same input with the other method and add the cost of both trees
         template< class T, class BoundsFunc >
-        void build(const std::vector<T> &primitives, BoundsFunc &getBounds, uint32 leafSize = 3, bool printStats=false)
+        void build(const std::vector<T> &primitives, BoundsFunc &getBounds, uint32 leafSize = 3, bool printStats=false,
+            BIHBuildMethod method = BIH_BUILD_MIDPOINT, BIHCostStats* costStats = NULL)
         {
             if (primitives.size() == 0)
                 return;
@@ -103,19 +137,39 @@ class BIH
             }
             std::vector<uint32> tempTree;
             BuildStats stats;
-            buildHierarchy(tempTree, dat, stats);
+            buildHierarchy(tempTree, dat, stats, method);
             if (printStats)
+            {
                 stats.printStats();
+                printf("  * SAH cost:       %.2f\n", traversalCost(tempTree, bounds));
+            }
 
             objects.resize(dat.numPrims);
             for (uint32 i = 0; i < dat.numPrims; ++i)
                 objects[i] = dat.indices[i];
             //nObjects = dat.numPrims;
-            tree = tempTree;
+            tree.swap(tempTree);
+
+            if (costStats)
+            {
+                // the builders only reorder the indices, any start order gives the same tree
+                BIHBuildMethod other = method == BIH_BUILD_SAH ? BIH_BUILD_MIDPOINT : BIH_BUILD_SAH;
+                BuildStats otherStats;
+                std::vector<uint32> otherTree;
+                buildHierarchy(otherTree, dat, otherStats, other);
+
+                float cost = traversalCost(tree, bounds);
+                float otherCost = traversalCost(otherTree, bounds);
+                ++costStats->trees;
+                costStats->midpoint += method == BIH_BUILD_MIDPOINT ? cost : otherCost;
+                costStats->sah += method == BIH_BUILD_SAH ? cost : otherCost;
+            }
+
             delete[] dat.primBound;
             delete[] dat.indices;
         }
         uint32 primCount() { return objects.size(); }
+        float traversalCost() const { return traversalCost(tree, bounds); }
 
         template<typename RayCallback>
         void intersectRay(const Ray &r, RayCallback& intersectCallback, float &maxDist, bool stopAtFirst=false) const
@@ -150,6 +204,169 @@ class BIH
             intervalMin = std::max(intervalMin, 0.f);
             intervalMax = std::min(intervalMax, maxDist);
 
+            traverseRay(r, intersectCallback, maxDist, stopAtFirst, 0, intervalMin, intervalMax);
+        }
+
+        /* Trace a batch of rays, each with its own maxDist.
+           Rays with the same direction signs are traversed together in packets of
+           BIH_PACKET_SIZE: a node is fetched and decoded once for the whole packet and
+           the per-ray slab tests run over plain arrays the compiler can vectorize.
+           The callback is called as intersectCallback(rayIndex, rays[rayIndex], entry, maxDist[rayIndex], stopAtFirst). */
+        template<typename RayCallback>
+        void intersectRays(const Ray* rays, float* maxDist, uint32 count, RayCallback& intersectCallback, bool stopAtFirst=false) const
+        {
+            if (tree.empty())
+                return;
+
+            uint32 packets[8][BIH_PACKET_SIZE];
+            uint32 packetSize[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+            for (uint32 i = 0; i < count; ++i)
+            {
+                const Vector3& dir = rays[i].direction();
+                uint32 octant = (floatToRawIntBits(dir.x) >> 31) | ((floatToRawIntBits(dir.y) >> 31) << 1) | ((floatToRawIntBits(dir.z) >> 31) << 2);
+                packets[octant][packetSize[octant]++] = i;
+                if (packetSize[octant] == BIH_PACKET_SIZE)
+                {
+                    intersectPacket(rays, maxDist, packets[octant], BIH_PACKET_SIZE, intersectCallback, stopAtFirst);
+                    packetSize[octant] = 0;
+                }
+            }
+
+            for (uint32 octant = 0; octant < 8; ++octant)
+                if (packetSize[octant])
+                    intersectPacket(rays, maxDist, packets[octant], packetSize[octant], intersectCallback, stopAtFirst);
+        }
+
+        template<typename IsectCallback>
+        void intersectPoint(const Vector3 &p, IsectCallback& intersectCallback) const
+        {
+            if (!bounds.contains(p))
+                return;
+
+            StackNode stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (true) {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    bool BVH2 = tn & (1 << 29);
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            // "normal" interior node
+                            float tl = intBitsToFloat(tree[node + 1]);
+                            float tr = intBitsToFloat(tree[node + 2]);
+                            // point is between clip zones
+                            if (tl < p[axis] && tr > p[axis])
+                                break;
+                            int right = offset + 3;
+                            node = right;
+                            // point is in right node only
+                            if (tl < p[axis]) {
+                                continue;
+                            }
+                            node = offset; // left
+                            // point is in left node only
+                            if (tr > p[axis]) {
+                                continue;
+                            }
+                            // point is in both nodes
+                            // push back right node
+                            stack[stackPos].node = right;
+                            stackPos++;
+                            continue;
+                        }
+                        else
+                        {
+                            // leaf - test some objects
+                            int n = tree[node + 1];
+                            while (n > 0) {
+                                intersectCallback(p, objects[offset]); // !!!
+                                --n;
+                                ++offset;
+                            }
+                            break;
+                        }
+                    }
+                    else // BVH2 node (empty space cut off left and right)
+                    {
+                        if (axis>2)
+                            return; // should not happen
+                        float tl = intBitsToFloat(tree[node + 1]);
+                        float tr = intBitsToFloat(tree[node + 2]);
+                        node = offset;
+                        if (tl > p[axis] || tr < p[axis])
+                            break;
+                        continue;
+                    }
+                } // traversal loop
+
+                // stack is empty?
+                if (stackPos == 0)
+                    return;
+                // move back up the stack
+                stackPos--;
+                node = stack[stackPos].node;
+            }
+        }
+
+        bool writeToFile(FILE *wf) const;
+        bool readFromFile(FILE *rf);
+
+    protected:
+        std::vector<uint32> tree;
+        std::vector<uint32> objects;
+        AABox bounds;
+
+        struct buildData
+        {
+            uint32 *indices;
+            AABox *primBound;
+            uint32 numPrims;
+            int maxPrims;
+        };
+        struct StackNode
+        {
+            uint32 node;
+            float tnear;
+            float tfar;
+        };
+        struct PacketStackNode
+        {
+            uint32 node;
+            uint32 mask;
+            float tnear[BIH_PACKET_SIZE];
+            float tfar[BIH_PACKET_SIZE];
+        };
+
+        // forwards the single ray callback of traverseRay to a batch callback
+        template<typename RayCallback>
+        struct PacketRayCallback
+        {
+            PacketRayCallback(RayCallback& _callback, uint32 _index) : callback(_callback), index(_index) {}
+            bool operator()(const Ray& r, uint32 entry, float& maxDist, bool stopAtFirst)
+            {
+                return callback(index, r, entry, maxDist, stopAtFirst);
+            }
+            RayCallback& callback;
+            uint32 index;
+        };
+
+        // single ray traversal from node, returns true when it stopped at the first hit
+        template<typename RayCallback>
+        bool traverseRay(const Ray &r, RayCallback& intersectCallback, float &maxDist, bool stopAtFirst, int node, float intervalMin, float intervalMax) const
+        {
+            Vector3 org = r.origin();
+            Vector3 dir = r.direction();
+            Vector3 invDir;
+            for (int i = 0; i < 3; ++i)
+                invDir[i] = 1.f / dir[i];
+
             uint32 offsetFront[3];
             uint32 offsetBack[3];
             uint32 offsetFront3[3];
@@ -170,7 +387,6 @@ class BIH
 
             StackNode stack[MAX_STACK_SIZE];
             int stackPos = 0;
-            int node = 0;
 
             while (true) {
                 while (true)
@@ -218,7 +434,7 @@ class BIH
                             int n = tree[node + 1];
                             while (n > 0) {
                                 bool hit = intersectCallback(r, objects[offset], maxDist, stopAtFirst);
-                                if (stopAtFirst && hit) return;
+                                if (stopAtFirst && hit) return true;
                                 --n;
                                 ++offset;
                             }
@@ -228,7 +444,7 @@ class BIH
                     else
                     {
                         if (axis>2)
-                            return; // should not happen
+                            return false; // should not happen
                         float tf = (intBitsToFloat(tree[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
                         float tb = (intBitsToFloat(tree[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
                         node = offset;
@@ -243,7 +459,7 @@ class BIH
                 {
                     // stack is empty?
                     if (stackPos == 0)
-                        return;
+                        return false;
                     // move back up the stack
                     stackPos--;
                     intervalMin = stack[stackPos].tnear;
@@ -256,19 +472,88 @@ class BIH
             }
         }
 
-        template<typename IsectCallback>
-        void intersectPoint(const Vector3 &p, IsectCallback& intersectCallback) const
+        // all rays of a packet must share the direction signs, the child order is taken from the first one
+        template<typename RayCallback>
+        void intersectPacket(const Ray* rays, float* maxDist, const uint32* index, uint32 size, RayCallback& intersectCallback, bool stopAtFirst) const
         {
-            if (!bounds.contains(p))
+            float org[3][BIH_PACKET_SIZE];
+            float invDir[3][BIH_PACKET_SIZE];
+            float intervalMin[BIH_PACKET_SIZE];
+            float intervalMax[BIH_PACKET_SIZE];
+            uint32 mask = 0;                                // rays still inside the current node
+            uint32 done = 0;                                // rays that stopped at their first hit
+
+            for (uint32 k = 0; k < size; ++k)
+            {
+                const Ray& r = rays[index[k]];
+                float tMin = -1.f;
+                float tMax = -1.f;
+                bool miss = false;
+                for (int i = 0; i < 3; ++i)
+                {
+                    org[i][k] = r.origin()[i];
+                    invDir[i][k] = 1.f / r.direction()[i];
+                    if (r.direction()[i] != 0.f)
+                    {
+                        float t1 = (bounds.low()[i]  - org[i][k]) * invDir[i][k];
+                        float t2 = (bounds.high()[i] - org[i][k]) * invDir[i][k];
+                        if (t1 > t2)
+                            std::swap(t1, t2);
+                        if (t1 > tMin)
+                            tMin = t1;
+                        if (t2 < tMax || tMax < 0.f)
+                            tMax = t2;
+                        if (tMax <= 0 || tMin >= maxDist[index[k]])
+                            miss = true;
+                    }
+                }
+
+                if (miss || tMin > tMax)
+                {
+                    intervalMin[k] = intervalMax[k] = 0.f;
+                    continue;
+                }
+                intervalMin[k] = std::max(tMin, 0.f);
+                intervalMax[k] = std::min(tMax, maxDist[index[k]]);
+                mask |= 1 << k;
+            }
+
+            if (!mask)
                 return;
 
-            StackNode stack[MAX_STACK_SIZE];
+            uint32 offsetFront[3];
+            uint32 offsetBack[3];
+            uint32 offsetFront3[3];
+            uint32 offsetBack3[3];
+            const Vector3& dir = rays[index[0]].direction();
+            for (int i = 0; i < 3; ++i)
+            {
+                offsetFront[i] = floatToRawIntBits(dir[i]) >> 31;
+                offsetBack[i] = offsetFront[i] ^ 1;
+                offsetFront3[i] = offsetFront[i] * 3;
+                offsetBack3[i] = offsetBack[i] * 3;
+                ++offsetFront[i];
+                ++offsetBack[i];
+            }
+
+            PacketStackNode stack[MAX_STACK_SIZE];
             int stackPos = 0;
             int node = 0;
 
             while (true) {
                 while (true)
                 {
+                    // a single ray left, follow it without the packet bookkeeping
+                    if (!(mask & (mask - 1)))
+                    {
+                        uint32 k = 0;
+                        while (!(mask & (1 << k)))
+                            ++k;
+                        PacketRayCallback<RayCallback> single(intersectCallback, index[k]);
+                        if (traverseRay(rays[index[k]], single, maxDist[index[k]], stopAtFirst, node, intervalMin[k], intervalMax[k]))
+                            done |= mask;
+                        break;
+                    }
                     uint32 tn = tree[node];
                     uint32 axis = (tn & (3 << 30)) >> 30;
                     bool BVH2 = tn & (1 << 29);
@@ -277,85 +562,123 @@ class BIH
                     {
                         if (axis < 3)
                         {
-                            // "normal" interior node
-                            float tl = intBitsToFloat(tree[node + 1]);
-                            float tr = intBitsToFloat(tree[node + 2]);
-                            // point is between clip zones
-                            if (tl < p[axis] && tr > p[axis])
+                            float clipFront = intBitsToFloat(tree[node + offsetFront[axis]]);
+                            float clipBack = intBitsToFloat(tree[node + offsetBack[axis]]);
+                            float nearMax[BIH_PACKET_SIZE];
+                            float farMin[BIH_PACKET_SIZE];
+                            uint32 nearMask = 0;
+                            uint32 farMask = 0;
+                            for (uint32 k = 0; k < size; ++k)
+                            {
+                                float tf = (clipFront - org[axis][k]) * invDir[axis][k];
+                                float tb = (clipBack - org[axis][k]) * invDir[axis][k];
+                                // negated like the single ray tests so NaN (clip plane on an axis parallel ray) enters both children
+                                nearMask |= uint32(!(tf < intervalMin[k])) << k;
+                                farMask |= uint32(!(tb > intervalMax[k])) << k;
+                                nearMax[k] = (tf <= intervalMax[k]) ? tf : intervalMax[k];
+                                farMin[k] = (tb >= intervalMin[k]) ? tb : intervalMin[k];
+                            }
+                            nearMask &= mask;
+                            farMask &= mask;
+                            // all rays pass between clip zones
+                            if (!nearMask && !farMask)
                                 break;
-                            int right = offset + 3;
-                            node = right;
-                            // point is in right node only
-                            if (tl < p[axis]) {
+                            int back = offset + offsetBack3[axis];
+                            if (!nearMask)
+                            {
+                                for (uint32 k = 0; k < size; ++k)
+                                    intervalMin[k] = farMin[k];
+                                mask = farMask;
+                                node = back;
                                 continue;
                             }
-                            node = offset; // left
-                            // point is in left node only
-                            if (tr > p[axis]) {
-                                continue;
+                            if (farMask)
+                            {
+                                // some rays also pass through the far node, push it back with their intervals
+                                stack[stackPos].node = back;
+                                stack[stackPos].mask = farMask;
+                                for (uint32 k = 0; k < size; ++k)
+                                {
+                                    stack[stackPos].tnear[k] = farMin[k];
+                                    stack[stackPos].tfar[k] = intervalMax[k];
+                                }
+                                stackPos++;
                             }
-                            // point is in both nodes
-                            // push back right node
-                            stack[stackPos].node = right;
-                            stackPos++;
+                            for (uint32 k = 0; k < size; ++k)
+                                intervalMax[k] = nearMax[k];
+                            mask = nearMask;
+                            node = offset + offsetFront3[axis];
                             continue;
                         }
                         else
                         {
-                            // leaf - test some objects
+                            // leaf - test the objects against every ray still in it
                             int n = tree[node + 1];
                             while (n > 0) {
-                                intersectCallback(p, objects[offset]); // !!!
+                                for (uint32 k = 0; k < size; ++k)
+                                {
+                                    if (!(mask & (1 << k)))
+                                        continue;
+                                    uint32 i = index[k];
+                                    if (intersectCallback(i, rays[i], objects[offset], maxDist[i], stopAtFirst) && stopAtFirst)
+                                    {
+                                        mask &= ~(1 << k);
+                                        done |= 1 << k;
+                                    }
+                                }
+                                if (!mask)
+                                    break;
                                 --n;
                                 ++offset;
                             }
                             break;
                         }
                     }
-                    else // BVH2 node (empty space cut off left and right)
+                    else
                     {
                         if (axis>2)
                             return; // should not happen
-                        float tl = intBitsToFloat(tree[node + 1]);
-                        float tr = intBitsToFloat(tree[node + 2]);
+                        float clipFront = intBitsToFloat(tree[node + offsetFront[axis]]);
+                        float clipBack = intBitsToFloat(tree[node + offsetBack[axis]]);
+                        uint32 inside = 0;
+                        for (uint32 k = 0; k < size; ++k)
+                        {
+                            float tf = (clipFront - org[axis][k]) * invDir[axis][k];
+                            float tb = (clipBack - org[axis][k]) * invDir[axis][k];
+                            intervalMin[k] = (tf >= intervalMin[k]) ? tf : intervalMin[k];
+                            intervalMax[k] = (tb <= intervalMax[k]) ? tb : intervalMax[k];
+                            inside |= uint32(!(intervalMin[k] > intervalMax[k])) << k;
+                        }
+                        mask &= inside;
                         node = offset;
-                        if (tl > p[axis] || tr < p[axis])
+                        if (!mask)
                             break;
                         continue;
                     }
                 } // traversal loop
-
-                // stack is empty?
-                if (stackPos == 0)
-                    return;
-                // move back up the stack
-                stackPos--;
-                node = stack[stackPos].node;
+                do
+                {
+                    if (stackPos == 0)
+                        return;
+                    stackPos--;
+                    PacketStackNode const& entry = stack[stackPos];
+                    mask = entry.mask & ~done;
+                    for (uint32 k = 0; k < size; ++k)
+                    {
+                        // maxDist shrinks with every hit, drop the rays that ended before this node
+                        if ((mask & (1 << k)) && maxDist[index[k]] < entry.tnear[k])
+                            mask &= ~(1 << k);
+                        intervalMin[k] = entry.tnear[k];
+                        intervalMax[k] = entry.tfar[k];
+                    }
+                    if (!mask)
+                        continue;
+                    node = entry.node;
+                    break;
+                } while (true);
             }
         }
 
-        bool writeToFile(FILE *wf) const;
-        bool readFromFile(FILE *rf);
-
-    protected:
-        std::vector<uint32> tree;
-        std::vector<uint32> objects;
-        AABox bounds;
-
-        struct buildData
-        {
-            uint32 *indices;
-            AABox *primBound;
-            uint32 numPrims;
-            int maxPrims;
-        };
-        struct StackNode
-        {
-            uint32 node;
-            float tnear;
-            float tfar;
-        };
-
         class BuildStats
         {
             private:
@@ -385,7 +708,7 @@ class BIH
             void printStats();
         };
 
-        void buildHierarchy(std::vector<uint32> &tempTree, buildData &dat, BuildStats &stats);
+        void buildHierarchy(std::vector<uint32> &tempTree, buildData &dat, BuildStats &stats, BIHBuildMethod method);
 
         void createNode(std::vector<uint32> &tempTree, int nodeIndex, uint32 left, uint32 right) {
             // write leaf node
@@ -394,6 +717,11 @@ class BIH
         }
 
         void subdivide(int left, int right, std::vector<uint32> &tempTree, buildData &dat, AABound &gridBox, AABound &nodeBox, int nodeIndex, int depth, BuildStats &stats);
+        void subdivideSAH(int left, int right, std::vector<uint32> &tempTree, buildData &dat, AABound nodeBox, int nodeIndex, int depth, BuildStats &stats);
+
+        static float surfaceArea(AABound const& box);
+        static float traversalCost(std::vector<uint32> const& tree, AABox const& bounds);
+        static float nodeCost(std::vector<uint32> const& tree, uint32 node, AABound const& box);
 };
 
 #endif // _BIH_H
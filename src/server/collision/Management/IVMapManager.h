@@ -38,6 +38,22 @@ namespace VMAP
     #define VMAP_INVALID_HEIGHT       -100000.0f            // for check
     #define VMAP_INVALID_HEIGHT_VALUE -200000.0f            // real assigned value in unknown height case
 
+    // one segment of a batched line of sight query
+    struct LineOfSightQuery
+    {
+        float x1, y1, z1;
+        float x2, y2, z2;
+        bool result;                                        // out
+    };
+
+    // one point of a batched height query
+    struct HeightQuery
+    {
+        float x, y, z;
+        float maxSearchDist;
+        float height;                                       // out, VMAP_INVALID_HEIGHT_VALUE if nothing was found
+    };
+
     class IVMapManager
     {
         private:
@@ -59,6 +75,11 @@ namespace VMAP
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /*
+            same as isInLineOfSight / getHeight for many queries on one map, the rays are traced in packets
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count) = 0;
+            virtual void getHeight(unsigned int pMapId, HeightQuery* queries, uint32 count) = 0;
+            /*
             test if we hit an object. return true if we hit one. rx, ry, rz will hold the hit position or the dest position, if no intersection was found
             return a position, that is pReduceDist closer to the origin
             */
@@ -201,6 +201,58 @@ namespace VMAP
         return height;
     }
 
+    void VMapManager2::isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            queries[i].result = true;
+
+        if (!isLineOfSightCalcEnabled() || !count)
+            return;
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        std::vector<Vector3> pos1(count);
+        std::vector<Vector3> pos2(count);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            pos1[i] = convertPositionToInternalRep(queries[i].x1, queries[i].y1, queries[i].z1);
+            pos2[i] = convertPositionToInternalRep(queries[i].x2, queries[i].y2, queries[i].z2);
+        }
+
+        bool* results = new bool[count];
+        instanceTree->second->isInLineOfSight(&pos1[0], &pos2[0], results, count);
+        for (uint32 i = 0; i < count; ++i)
+            queries[i].result = results[i];
+        delete[] results;
+    }
+
+    void VMapManager2::getHeight(unsigned int pMapId, HeightQuery* queries, uint32 count)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            queries[i].height = VMAP_INVALID_HEIGHT_VALUE;  //no height
+
+        if (!isHeightCalcEnabled() || !count)
+            return;
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        std::vector<Vector3> pos(count);
+        std::vector<float> maxSearchDist(count);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            pos[i] = convertPositionToInternalRep(queries[i].x, queries[i].y, queries[i].z);
+            maxSearchDist[i] = queries[i].maxSearchDist;
+        }
+
+        std::vector<float> heights(count);
+        instanceTree->second->getHeights(&pos[0], &maxSearchDist[0], &heights[0], count);
+        for (uint32 i = 0; i < count; ++i)
+            if (heights[i] < G3D::inf())
+                queries[i].height = heights[i];
+    }
+
     bool VMapManager2::getAreaInfo(unsigned int pMapId, float x, float y, float &z, uint32 &flags, int32 &adtId, int32 &rootId, int32 &groupId) const
     {
         bool result=false;
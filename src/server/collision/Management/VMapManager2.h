@@ -87,6 +87,8 @@ namespace VMAP
             // fill the hit pos and return true, if an object was hit
             bool getObjectHitPos(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float pModifyDist);
             float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist);
+            void isInLineOfSight(unsigned int pMapId, LineOfSightQuery* queries, uint32 count);
+            void getHeight(unsigned int pMapId, HeightQuery* queries, uint32 count);
 
             bool processCommand(char * /*pCommand*/) { return false; }      // for debug and extensions
 
@@ -49,6 +49,22 @@ namespace VMAP
             bool hit;
     };
 
+    class MapRayPacketCallback
+    {
+        public:
+            MapRayPacketCallback(ModelInstance *val, bool *hits): prims(val), hits(hits) {}
+            bool operator()(uint32 rayIndex, const G3D::Ray& ray, uint32 entry, float& distance, bool pStopAtFirstHit=true)
+            {
+                bool result = prims[entry].intersectRay(ray, distance, pStopAtFirstHit);
+                if (result)
+                    hits[rayIndex] = true;
+                return result;
+            }
+        protected:
+            ModelInstance *prims;
+            bool *hits;
+    };
+
     class AreaInfoCallback
     {
         public:
@@ -146,6 +162,18 @@ namespace VMAP
         return intersectionCallBack.didHit();
     }
 
+    void StaticMapTree::getIntersectionTimes(const G3D::Ray* pRays, float* pMaxDist, bool* pHits, uint32 count, bool pStopAtFirstHit) const
+    {
+        std::vector<float> distance(pMaxDist, pMaxDist + count);
+        for (uint32 i = 0; i < count; ++i)
+            pHits[i] = false;
+        MapRayPacketCallback intersectionCallBack(iTreeValues, pHits);
+        iTree.intersectRays(pRays, &distance[0], count, intersectionCallBack, pStopAtFirstHit);
+        for (uint32 i = 0; i < count; ++i)
+            if (pHits[i])
+                pMaxDist[i] = distance[i];
+    }
+
     bool StaticMapTree::isInLineOfSight(const Vector3& pos1, const Vector3& pos2) const
     {
         float maxDist = (pos2 - pos1).magnitude();
@@ -162,6 +190,39 @@ namespace VMAP
         return true;
     }
 
+    void StaticMapTree::isInLineOfSight(const Vector3* pos1, const Vector3* pos2, bool* results, uint32 count) const
+    {
+        std::vector<G3D::Ray> rays;
+        std::vector<float> maxDist;
+        std::vector<uint32> queryIndex;
+        rays.reserve(count);
+        maxDist.reserve(count);
+        queryIndex.reserve(count);
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            results[i] = true;
+            float dist = (pos2[i] - pos1[i]).magnitude();
+            ASSERT(dist < std::numeric_limits<float>::max());
+            // prevent NaN values which can cause BIH intersection to enter infinite loop
+            if (dist < 1e-10f)
+                continue;
+            rays.push_back(G3D::Ray::fromOriginAndDirection(pos1[i], (pos2[i] - pos1[i])/dist));
+            maxDist.push_back(dist);
+            queryIndex.push_back(i);
+        }
+
+        if (rays.empty())
+            return;
+
+        bool* hits = new bool[rays.size()];
+        getIntersectionTimes(&rays[0], &maxDist[0], hits, rays.size(), true);
+        for (uint32 i = 0; i < rays.size(); ++i)
+            if (hits[i])
+                results[queryIndex[i]] = false;
+        delete[] hits;
+    }
+
     /*
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
     Return the hit pos or the original dest pos
@@ -222,6 +283,24 @@ namespace VMAP
         return(height);
     }
 
+    void StaticMapTree::getHeights(const Vector3* pPos, const float* maxSearchDist, float* heights, uint32 count) const
+    {
+        if (!count)
+            return;
+
+        std::vector<G3D::Ray> rays;
+        rays.reserve(count);
+        for (uint32 i = 0; i < count; ++i)
+            rays.push_back(G3D::Ray(pPos[i], Vector3(0, 0, -1)));
+
+        std::vector<float> maxDist(maxSearchDist, maxSearchDist + count);
+        bool* hits = new bool[count];
+        getIntersectionTimes(&rays[0], &maxDist[0], hits, count, false);
+        for (uint32 i = 0; i < count; ++i)
+            heights[i] = hits[i] ? pPos[i].z - maxDist[i] : G3D::inf();
+        delete[] hits;
+    }
+
     bool StaticMapTree::CanLoadMap(const std::string &vmapPath, uint32 mapID, uint32 tileX, uint32 tileY)
     {
         std::string basePath = vmapPath;
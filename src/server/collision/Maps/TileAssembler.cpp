@@ -28,6 +28,8 @@
 #include <iomanip>
 #include <sstream>
 #include <iomanip>
+#include <ace/Task.h>
+#include <ace/Guard_T.h>
 
 using G3D::Vector3;
 using G3D::AABox;
@@ -58,6 +60,9 @@ namespace VMAP
     {
         iCurrentUniqueNameId = 0;
         iFilterMethod = NULL;
+        iThreads = 1;
+        iBuildMethod = BIH_BUILD_MIDPOINT;
+        iCompareBuilders = false;
         iSrcDir = pSrcDirName;
         iDestDir = pDestDirName;
         //mkdir(iDestDir);
@@ -69,132 +74,230 @@ namespace VMAP
         //delete iCoordModelMapping;
     }
 
+    // Hands out the jobs of one stage to the worker threads, one index at a time
+    class AssemblerTask : public ACE_Task_Base
+    {
+        public:
+            AssemblerTask(TileAssembler& assembler, TileAssembler::Job job, uint32 count)
+                : iAssembler(assembler), iJob(job), iCount(count), iNext(0), iFailed(false) {}
+
+            int svc()
+            {
+                BIHCostStats costStats;
+                uint32 index;
+                while (next(index))
+                {
+                    if (!(iAssembler.*iJob)(index, iAssembler.iCompareBuilders ? &costStats : NULL))
+                        iFailed = true;
+                }
+
+                ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iLock, 0);
+                iCostStats.add(costStats);
+                return 0;
+            }
+
+            bool failed() const { return iFailed; }
+            BIHCostStats const& getCostStats() const { return iCostStats; }
+
+        private:
+            bool next(uint32& index)
+            {
+                ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iLock, false);
+                // stop handing out work after the first error, as the sequential export did
+                if (iFailed || iNext >= iCount)
+                    return false;
+                index = iNext++;
+                return true;
+            }
+
+            TileAssembler& iAssembler;
+            TileAssembler::Job iJob;
+            uint32 iCount;
+            uint32 iNext;
+            volatile bool iFailed;
+            ACE_Thread_Mutex iLock;
+            BIHCostStats iCostStats;
+    };
+
     bool TileAssembler::convertWorld2()
     {
-        std::set<std::string> spawnedModelFiles;
         bool success = readMapSpawns();
         if (!success)
             return false;
 
         // export Map data
-        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end() && success; ++map_iter)
+        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+            iMapIds.push_back(map_iter->first);
+
+        printf("Exporting %u maps on %u threads...\n", uint32(iMapIds.size()), iThreads);
+        BIHCostStats mapCost;
+        success = runJobs(&TileAssembler::exportMap, iMapIds.size(), mapCost);
+
+        // export objects
+        std::cout << "\nConverting Model Files" << std::endl;
+        iModelFiles.assign(iSpawnedModelFiles.begin(), iSpawnedModelFiles.end());
+        BIHCostStats modelCost;
+        if (!runJobs(&TileAssembler::exportModel, iModelFiles.size(), modelCost))
+            success = false;
+
+        if (iCompareBuilders)
         {
-            // build global map tree
-            std::vector<ModelSpawn*> mapSpawns;
-            UniqueEntryMap::iterator entry;
-            printf("Calculating model bounds for map %u...\n", map_iter->first);
-            for (entry = map_iter->second->UniqueEntries.begin(); entry != map_iter->second->UniqueEntries.end(); ++entry)
-            {
-                // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
-                if (entry->second.flags & MOD_M2)
-                {
-                    if (!calculateTransformedBound(entry->second))
-                        break;
-                }
-                else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
-                {
-                    // TODO: remove extractor hack and uncomment below line:
-                    //entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
-                    entry->second.iBound = entry->second.iBound + Vector3(533.33333f*32, 533.33333f*32, 0.f);
-                }
-                mapSpawns.push_back(&(entry->second));
-                spawnedModelFiles.insert(entry->second.name);
-            }
+            printCostStats("map trees", mapCost);
+            printCostStats("model trees", modelCost);
+        }
+
+        //cleanup:
+        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+        {
+            delete map_iter->second;
+        }
+        return success;
+    }
+
+    bool TileAssembler::runJobs(Job job, uint32 count, BIHCostStats& costStats)
+    {
+        if (!count)
+            return true;
+
+        AssemblerTask task(*this, job, count);
+        if (task.activate(THR_NEW_LWP | THR_JOINABLE, std::min(iThreads, count)) == -1)
+        {
+            printf("Could not start worker threads!\n");
+            return false;
+        }
+        task.wait();
+
+        costStats.add(task.getCostStats());
+        return !task.failed();
+    }
+
+    void TileAssembler::printCostStats(const char* name, BIHCostStats const& costStats) const
+    {
+        if (!costStats.trees)
+            return;
 
-            printf("Creating map tree...\n");
-            BIH pTree;
-            pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds);
+        printf("Traversal cost of %u %s: midpoint %.1f, SAH %.1f (%+.1f%%)\n", costStats.trees, name,
+            costStats.midpoint, costStats.sah, costStats.midpoint > 0.0 ? 100.0 * (costStats.sah - costStats.midpoint) / costStats.midpoint : 0.0);
+    }
 
-            // possibly move this code to StaticMapTree class
-            std::map<uint32, uint32> modelNodeIdx;
-            for (uint32 i = 0; i < mapSpawns.size(); ++i)
-                modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i));
+    bool TileAssembler::exportMap(uint32 index, BIHCostStats* costStats)
+    {
+        uint32 mapId = iMapIds[index];
+        MapSpawns* spawns = mapData.find(mapId)->second;
 
-            // write map tree file
-            std::stringstream mapfilename;
-            mapfilename << iDestDir << "/" << std::setfill('0') << std::setw(3) << map_iter->first << ".vmtree";
-            FILE *mapfile = fopen(mapfilename.str().c_str(), "wb");
-            if (!mapfile)
+        // build global map tree
+        std::vector<ModelSpawn*> mapSpawns;
+        std::set<std::string> spawnedModelFiles;
+        UniqueEntryMap::iterator entry;
+        printf("Calculating model bounds for map %u...\n", mapId);
+        for (entry = spawns->UniqueEntries.begin(); entry != spawns->UniqueEntries.end(); ++entry)
+        {
+            // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
+            if (entry->second.flags & MOD_M2)
             {
-                success = false;
-                printf("Cannot open %s\n", mapfilename.str().c_str());
-                break;
+                if (!calculateTransformedBound(entry->second))
+                    break;
             }
-
-            //general info
-            if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) success = false;
-            uint32 globalTileID = StaticMapTree::packTileID(65, 65);
-            pair<TileMap::iterator, TileMap::iterator> globalRange = map_iter->second->TileEntries.equal_range(globalTileID);
-            char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
-            if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) success = false;
-            // Nodes
-            if (success && fwrite("NODE", 4, 1, mapfile) != 1) success = false;
-            if (success) success = pTree.writeToFile(mapfile);
-            // global map spawns (WDT), if any (most instances)
-            if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) success = false;
-
-            for (TileMap::iterator glob=globalRange.first; glob != globalRange.second && success; ++glob)
+            else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
             {
-                success = ModelSpawn::writeToFile(mapfile, map_iter->second->UniqueEntries[glob->second]);
+                // TODO: remove extractor hack and uncomment below line:
+                //entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
+                entry->second.iBound = entry->second.iBound + Vector3(533.33333f*32, 533.33333f*32, 0.f);
             }
+            mapSpawns.push_back(&(entry->second));
+            spawnedModelFiles.insert(entry->second.name);
+        }
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iLock, false);
+            iSpawnedModelFiles.insert(spawnedModelFiles.begin(), spawnedModelFiles.end());
+        }
 
-            fclose(mapfile);
+        printf("Creating map tree for map %u...\n", mapId);
+        BIH pTree;
+        pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds, 3, false, iBuildMethod, costStats);
 
-            // write map tile files, similar to ADT files, only with extra BSP tree node info
-            TileMap &tileEntries = map_iter->second->TileEntries;
-            TileMap::iterator tile;
-            for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
-            {
-                const ModelSpawn &spawn = map_iter->second->UniqueEntries[tile->second];
-                if (spawn.flags & MOD_WORLDSPAWN) // WDT spawn, saved as tile 65/65 currently...
-                    continue;
-                uint32 nSpawns = tileEntries.count(tile->first);
-                std::stringstream tilefilename;
-                tilefilename.fill('0');
-                tilefilename << iDestDir << "/" << std::setw(3) << map_iter->first << "_";
-                uint32 x, y;
-                StaticMapTree::unpackTileID(tile->first, x, y);
-                tilefilename << std::setw(2) << x << "_" << std::setw(2) << y << ".vmtile";
-                FILE *tilefile = fopen(tilefilename.str().c_str(), "wb");
-                // file header
-                if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) success = false;
-                // write number of tile spawns
-                if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) success = false;
-                // write tile spawns
-                for (uint32 s=0; s<nSpawns; ++s)
-                {
-                    if (s)
-                        ++tile;
-                    const ModelSpawn &spawn2 = map_iter->second->UniqueEntries[tile->second];
-                    success = success && ModelSpawn::writeToFile(tilefile, spawn2);
-                    // MapTree nodes to update when loading tile:
-                    std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
-                    if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) success = false;
-                }
-                fclose(tilefile);
-            }
-            // break; //test, extract only first map; TODO: remvoe this line
+        // possibly move this code to StaticMapTree class
+        std::map<uint32, uint32> modelNodeIdx;
+        for (uint32 i = 0; i < mapSpawns.size(); ++i)
+            modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i));
+
+        // write map tree file
+        std::stringstream mapfilename;
+        mapfilename << iDestDir << "/" << std::setfill('0') << std::setw(3) << mapId << ".vmtree";
+        FILE *mapfile = fopen(mapfilename.str().c_str(), "wb");
+        if (!mapfile)
+        {
+            printf("Cannot open %s\n", mapfilename.str().c_str());
+            return false;
         }
 
-        // export objects
-        std::cout << "\nConverting Model Files" << std::endl;
-        for (std::set<std::string>::iterator mfile = spawnedModelFiles.begin(); mfile != spawnedModelFiles.end(); ++mfile)
+        bool success = true;
+        //general info
+        if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) success = false;
+        uint32 globalTileID = StaticMapTree::packTileID(65, 65);
+        pair<TileMap::iterator, TileMap::iterator> globalRange = spawns->TileEntries.equal_range(globalTileID);
+        char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
+        if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) success = false;
+        // Nodes
+        if (success && fwrite("NODE", 4, 1, mapfile) != 1) success = false;
+        if (success) success = pTree.writeToFile(mapfile);
+        // global map spawns (WDT), if any (most instances)
+        if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) success = false;
+
+        for (TileMap::iterator glob=globalRange.first; glob != globalRange.second && success; ++glob)
+        {
+            success = ModelSpawn::writeToFile(mapfile, spawns->UniqueEntries[glob->second]);
+        }
+
+        fclose(mapfile);
+
+        // write map tile files, similar to ADT files, only with extra BSP tree node info
+        TileMap &tileEntries = spawns->TileEntries;
+        TileMap::iterator tile;
+        for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
         {
-            std::cout << "Converting " << *mfile << std::endl;
-            if (!convertRawFile(*mfile))
+            const ModelSpawn &spawn = spawns->UniqueEntries[tile->second];
+            if (spawn.flags & MOD_WORLDSPAWN) // WDT spawn, saved as tile 65/65 currently...
+                continue;
+            uint32 nSpawns = tileEntries.count(tile->first);
+            std::stringstream tilefilename;
+            tilefilename.fill('0');
+            tilefilename << iDestDir << "/" << std::setw(3) << mapId << "_";
+            uint32 x, y;
+            StaticMapTree::unpackTileID(tile->first, x, y);
+            tilefilename << std::setw(2) << x << "_" << std::setw(2) << y << ".vmtile";
+            FILE *tilefile = fopen(tilefilename.str().c_str(), "wb");
+            // file header
+            if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) success = false;
+            // write number of tile spawns
+            if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) success = false;
+            // write tile spawns
+            for (uint32 s=0; s<nSpawns; ++s)
             {
-                std::cout << "error converting " << *mfile << std::endl;
-                success = false;
-                break;
+                if (s)
+                    ++tile;
+                const ModelSpawn &spawn2 = spawns->UniqueEntries[tile->second];
+                success = success && ModelSpawn::writeToFile(tilefile, spawn2);
+                // MapTree nodes to update when loading tile:
+                std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
+                if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) success = false;
             }
+            fclose(tilefile);
         }
+        return success;
+    }
 
-        //cleanup:
-        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+    bool TileAssembler::exportModel(uint32 index, BIHCostStats* costStats)
+    {
+        std::string const& modelFile = iModelFiles[index];
+        printf("Converting %s\n", modelFile.c_str());
+        if (!convertRawFile(modelFile, costStats))
         {
-            delete map_iter->second;
+            printf("error converting %s\n", modelFile.c_str());
+            return false;
         }
-        return success;
+        return true;
     }
 
     bool TileAssembler::readMapSpawns()
@@ -345,7 +448,7 @@ namespace VMAP
         short type;
     };
 
-    bool TileAssembler::convertRawFile(const std::string& pModelFilename)
+    bool TileAssembler::convertRawFile(const std::string& pModelFilename, BIHCostStats* costStats)
     {
         bool success = true;
         std::string filename = iSrcDir;
@@ -469,7 +572,7 @@ namespace VMAP
             }
 
             groupsArray.push_back(GroupModel(mogpflags, GroupWMOID, AABox(Vector3(bbox1), Vector3(bbox2))));
-            groupsArray.back().setMeshData(vertexArray, triangles);
+            groupsArray.back().setMeshData(vertexArray, triangles, iBuildMethod, costStats);
             groupsArray.back().setLiquidData(liquid);
 
             // drop of temporary use defines
@@ -483,7 +586,7 @@ namespace VMAP
         model.setRootWmoID(RootWMOID);
         if (groupsArray.size())
         {
-            model.setGroupModels(groupsArray);
+            model.setGroupModels(groupsArray, iBuildMethod, costStats);
             success = model.writeFile(iDestDir + "/" + pModelFilename + ".vmo");
         }
 
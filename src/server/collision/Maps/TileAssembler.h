@@ -24,8 +24,11 @@
 #include <G3D/Vector3.h>
 #include <G3D/Matrix3.h>
 #include <map>
+#include <set>
+#include <ace/Thread_Mutex.h>
 
 #include "ModelInstance.h"
+#include "BoundingIntervalHierarchy.h"
 
 namespace VMAP
 {
@@ -61,8 +64,14 @@ namespace VMAP
 
     typedef std::map<uint32, MapSpawns*> MapData;
 
+    class AssemblerTask;
+
     class TileAssembler
     {
+        friend class AssemblerTask;
+        // one map or model file, run by the worker threads
+        typedef bool (TileAssembler::*Job)(uint32 index, BIHCostStats* costStats);
+
         private:
             std::string iDestDir;
             std::string iSrcDir;
@@ -71,6 +80,19 @@ namespace VMAP
             unsigned int iCurrentUniqueNameId;
             MapData mapData;
 
+            uint32 iThreads;
+            BIHBuildMethod iBuildMethod;
+            bool iCompareBuilders;
+            ACE_Thread_Mutex iLock;                         // guards iSpawnedModelFiles
+            std::vector<uint32> iMapIds;
+            std::set<std::string> iSpawnedModelFiles;
+            std::vector<std::string> iModelFiles;
+
+            bool runJobs(Job job, uint32 count, BIHCostStats& costStats);
+            bool exportMap(uint32 index, BIHCostStats* costStats);
+            bool exportModel(uint32 index, BIHCostStats* costStats);
+            void printCostStats(const char* name, BIHCostStats const& costStats) const;
+
         public:
             TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName);
             virtual ~TileAssembler();
@@ -79,8 +101,12 @@ namespace VMAP
             bool readMapSpawns();
             bool calculateTransformedBound(ModelSpawn &spawn);
 
-            bool convertRawFile(const std::string& pModelFilename);
+            bool convertRawFile(const std::string& pModelFilename, BIHCostStats* costStats = NULL);
             void setModelNameFilterMethod(bool (*pFilterMethod)(char *pName)) { iFilterMethod = pFilterMethod; }
+            void setThreads(uint32 threads) { iThreads = threads ? threads : 1; }
+            void setBuildMethod(BIHBuildMethod method) { iBuildMethod = method; }
+            // build every tree with both methods and print the traversal cost of each
+            void setCompareBuilders(bool compare) { iCompareBuilders = compare; }
             std::string getDirEntryNameFromModName(unsigned int pMapId, const std::string& pModPosName);
             unsigned int getUniqueNameId(const std::string pName);
     };
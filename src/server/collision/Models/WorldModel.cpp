@@ -247,12 +247,12 @@ namespace VMAP
             iLiquid = new WmoLiquid(*other.iLiquid);
     }
 
-    void GroupModel::setMeshData(std::vector<Vector3> &vert, std::vector<MeshTriangle> &tri)
+    void GroupModel::setMeshData(std::vector<Vector3> &vert, std::vector<MeshTriangle> &tri, BIHBuildMethod method, BIHCostStats* costStats)
     {
         vertices.swap(vert);
         triangles.swap(tri);
         TriBoundFunc bFunc(vertices);
-        meshTree.build(triangles, bFunc);
+        meshTree.build(triangles, bFunc, 3, false, method, costStats);
     }
 
     bool GroupModel::writeToFile(FILE *wf)
@@ -396,10 +396,10 @@ namespace VMAP
         return 0;
     }
 
-    void WorldModel::setGroupModels(std::vector<GroupModel> &models)
+    void WorldModel::setGroupModels(std::vector<GroupModel> &models, BIHBuildMethod method, BIHCostStats* costStats)
     {
         groupModels.swap(models);
-        groupTree.build(groupModels, BoundsTrait<GroupModel>::getBounds, 1);
+        groupTree.build(groupModels, BoundsTrait<GroupModel>::getBounds, 1, false, method, costStats);
     }
 
     struct WModelRayCallBack
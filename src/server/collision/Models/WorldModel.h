@@ -81,7 +81,8 @@ namespace VMAP
             ~GroupModel() { delete iLiquid; }
 
             // pass mesh data to object and create BIH. Passed vectors get get swapped with old geometry.
-            void setMeshData(std::vector<Vector3> &vert, std::vector<MeshTriangle> &tri);
+            void setMeshData(std::vector<Vector3> &vert, std::vector<MeshTriangle> &tri,
+                BIHBuildMethod method = BIH_BUILD_MIDPOINT, BIHCostStats* costStats = NULL);
             void setLiquidData(WmoLiquid *liquid) { iLiquid = liquid; }
             bool IntersectRay(const G3D::Ray &ray, float &distance, bool stopAtFirstHit) const;
             bool IsInsideObject(const Vector3 &pos, const Vector3 &down, float &z_dist) const;
@@ -108,7 +109,8 @@ namespace VMAP
             WorldModel(): RootWMOID(0) {}
 
             // pass group models to WorldModel and create BIH. Passed vector is swapped with old geometry!
-            void setGroupModels(std::vector<GroupModel> &models);
+            void setGroupModels(std::vector<GroupModel> &models,
+                BIHBuildMethod method = BIH_BUILD_MIDPOINT, BIHCostStats* costStats = NULL);
             void setRootWmoID(uint32 id) { RootWMOID = id; }
             bool IntersectRay(const G3D::Ray &ray, float &distance, bool stopAtFirstHit) const;
             bool IntersectPoint(const G3D::Vector3 &p, const G3D::Vector3 &down, float &dist, AreaInfo &info) const;
@@ -72,7 +72,7 @@ void CombatAI::EnterCombat(Unit *who)
         if (AISpellInfo[*i].condition == AICOND_AGGRO)
             me->CastSpell(who, *i, false);
         else if (AISpellInfo[*i].condition == AICOND_COMBAT)
-            events.ScheduleEvent(*i, AISpellInfo[*i].cooldown + rand()%AISpellInfo[*i].cooldown);
+            events.ScheduleEvent(*i, AISpellInfo[*i].cooldown + urand(0, AISpellInfo[*i].cooldown - 1));
     }
 }
 
@@ -89,7 +89,7 @@ void CombatAI::UpdateAI(const uint32 diff)
     if (uint32 spellId = events.ExecuteEvent())
     {
         DoCast(spellId);
-        events.ScheduleEvent(spellId, AISpellInfo[spellId].cooldown + rand()%AISpellInfo[spellId].cooldown);
+        events.ScheduleEvent(spellId, AISpellInfo[spellId].cooldown + urand(0, AISpellInfo[spellId].cooldown - 1));
     }
     else
         DoMeleeAttackIfReady();
@@ -116,7 +116,7 @@ void CasterAI::EnterCombat(Unit *who)
     if (spells.empty())
         return;
 
-    uint32 spell = rand()%spells.size();
+    uint32 spell = urand(0, spells.size() - 1);
     uint32 count = 0;
     for (SpellVct::iterator itr = spells.begin(); itr != spells.end(); ++itr, ++count)
     {
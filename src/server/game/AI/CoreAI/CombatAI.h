@@ -32,6 +32,7 @@ class AggressorAI : public CreatureAI
         explicit AggressorAI(Creature *c) : CreatureAI(c) {}
 
         void UpdateAI(const uint32);
+        bool CanBeDormant() const { return true; }
         static int Permissible(const Creature *);
 };
 
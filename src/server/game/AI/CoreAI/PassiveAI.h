@@ -32,6 +32,7 @@ class PassiveAI : public CreatureAI
         void MoveInLineOfSight(Unit *) {}
         void AttackStart(Unit *) {}
         void UpdateAI(const uint32);
+        bool CanBeDormant() const { return true; }
 
         static int Permissible(const Creature *) { return PERMIT_BASE_IDLE;  }
 };
@@ -60,6 +61,7 @@ class NullCreatureAI : public CreatureAI
         void MoveInLineOfSight(Unit *) {}
         void AttackStart(Unit *) {}
         void UpdateAI(const uint32) {}
+        bool CanBeDormant() const { return true; }
         void EnterEvadeMode() {}
         void OnCharmed(bool apply) {}
 
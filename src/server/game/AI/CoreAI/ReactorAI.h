@@ -34,6 +34,7 @@ class ReactorAI : public CreatureAI
         void MoveInLineOfSight(Unit *);
 
         void UpdateAI(const uint32);
+        bool CanBeDormant() const { return true; }
         static int Permissible(const Creature *);
 };
 #endif
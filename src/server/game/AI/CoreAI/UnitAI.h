@@ -24,6 +24,7 @@
 #include "Define.h"
 #include <list>
 #include "Unit.h"
+#include "ObjectPool.h"
 
 class Unit;
 class Player;
@@ -45,6 +46,9 @@ class UnitAI
         Unit * const me;
     public:
         explicit UnitAI(Unit *u) : me(u) {}
+
+        DECLARE_POOLED_OBJECT(OBJECT_POOL_AI)
+
         virtual bool CanAIAttack(const Unit *who) const { return true; }
         virtual void AttackStart(Unit *);
         virtual void UpdateAI(const uint32 diff) = 0;
@@ -167,6 +167,10 @@ class CreatureAI : public UnitAI
 
         virtual void PassengerBoarded(Unit * /*who*/, int8 /*seatId*/, bool /*apply*/) {}
 
+        // UpdateAI() has nothing to do out of combat, the creature may sleep
+        // while idle (reactions come through MoveInLineOfSight/AttackStart)
+        virtual bool CanBeDormant() const { return false; }
+
     protected:
         virtual void MoveInLineOfSight(Unit *);
 
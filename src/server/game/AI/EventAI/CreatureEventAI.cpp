@@ -355,7 +355,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
         pHolder.Enabled = false;
 
     //Store random here so that all random actions match up
-    uint32 rnd = rand();
+    uint32 rnd = rand32();
 
     //Return if chance for event is not met
     if (pHolder.Event.event_chance <= rnd % 100)
@@ -380,7 +380,7 @@ void CreatureEventAI::ProcessAction(CreatureEventAI_Action const& action, uint32
             int32 temp = 0;
 
             if (action.text.TextId[1] && action.text.TextId[2])
-                temp = action.text.TextId[rand()%3];
+                temp = action.text.TextId[urand(0, 2)];
             else if (action.text.TextId[1] && urand(0, 1))
                 temp = action.text.TextId[1];
             else
@@ -190,7 +190,7 @@ Unit* ScriptedAI::SelectUnit(SelectAggroTarget pTarget, uint32 uiPosition)
     switch (pTarget)
     {
     case SELECT_TARGET_RANDOM:
-        advance (itr , uiPosition +  (rand() % (threatlist.size() - uiPosition)));
+        advance (itr , uiPosition +  urand(0, threatlist.size() - uiPosition - 1));
         return Unit::GetUnit((*me), (*itr)->getUnitGuid());
         break;
 
@@ -291,7 +291,7 @@ SpellEntry const* ScriptedAI::SelectSpell(Unit* pTarget, uint32 uiSchool, uint32
     if (!uiSpellCount)
         return NULL;
 
-    return apSpell[rand()%uiSpellCount];
+    return apSpell[urand(0, uiSpellCount - 1)];
 }
 
 bool ScriptedAI::CanCast(Unit* pTarget, SpellEntry const* pSpell, bool bTriggered)
@@ -269,7 +269,7 @@ void SimpleAI::UpdateAI(const uint32 diff)
 
             //Spell will cast agian when the cooldown is up
             if (Spell[i].CooldownRandomAddition)
-                Spell_Timer[i] = Spell[i].Cooldown + (rand() % Spell[i].CooldownRandomAddition);
+                Spell_Timer[i] = Spell[i].Cooldown + urand(0, Spell[i].CooldownRandomAddition - 1);
             else Spell_Timer[i] = Spell[i].Cooldown;
         } else Spell_Timer[i] -= diff;
     }
@@ -685,13 +685,59 @@ void ArenaTeam::SaveToDB()
 {
     // save team and member stats to db
     // called after a match has ended, or when calculating arena_points
+    std::vector<ArenaTeam*> teams(1, this);
     CharacterDatabase.BeginTransaction();
-    CharacterDatabase.PExecute("UPDATE arena_team_stats SET rating = '%u', games = '%u', played = '%u', rank = '%u', wins = '%u', wins2 = '%u' WHERE arenateamid = '%u'", m_stats.rating, m_stats.games_week, m_stats.games_season, m_stats.rank, m_stats.wins_week, m_stats.wins_season, GetId());
-    for (MemberList::iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
+    SaveStatsToDB(teams);
+    CharacterDatabase.CommitTransaction();
+}
+
+// multi-row upsert, split before the statement outgrows the query buffer
+static void AppendStatsRow(std::string& query, char const* header, char const* footer, char const* row)
+{
+    if (!query.empty() && query.size() + strlen(row) + strlen(footer) >= MAX_QUERY_LEN)
     {
-        CharacterDatabase.PExecute("UPDATE arena_team_member SET played_week = '%u', wons_week = '%u', played_season = '%u', wons_season = '%u', personal_rating = '%u' WHERE arenateamid = '%u' AND guid = '%u'", itr->games_week, itr->wins_week, itr->games_season, itr->wins_season, itr->personal_rating, m_TeamId, GUID_LOPART(itr->guid));
+        query += footer;
+        CharacterDatabase.Execute(query.c_str());
+        query.clear();
     }
-    CharacterDatabase.CommitTransaction();
+
+    if (query.empty())
+        query = header;
+    else
+        query += ',';
+    query += row;
+}
+
+void ArenaTeam::SaveStatsToDB(std::vector<ArenaTeam*> const& teams)
+{
+    // all columns are written, so the upserts only ever update the rows of loaded teams and members
+    static char const* teamHeader = "INSERT INTO arena_team_stats (arenateamid, rating, games, played, rank, wins, wins2) VALUES ";
+    static char const* teamFooter = " ON DUPLICATE KEY UPDATE rating = VALUES(rating), games = VALUES(games), played = VALUES(played), rank = VALUES(rank), wins = VALUES(wins), wins2 = VALUES(wins2)";
+    static char const* memberHeader = "INSERT INTO arena_team_member (arenateamid, guid, played_week, wons_week, played_season, wons_season, personal_rating) VALUES ";
+    static char const* memberFooter = " ON DUPLICATE KEY UPDATE played_week = VALUES(played_week), wons_week = VALUES(wons_week), played_season = VALUES(played_season), wons_season = VALUES(wons_season), personal_rating = VALUES(personal_rating)";
+
+    std::string teamQuery;
+    std::string memberQuery;
+    char row[128];
+
+    for (std::vector<ArenaTeam*>::const_iterator itr = teams.begin(); itr != teams.end(); ++itr)
+    {
+        ArenaTeam const* at = *itr;
+        ArenaTeamStats const& stats = at->m_stats;
+        snprintf(row, 128, "(%u, %u, %u, %u, %u, %u, %u)", at->m_TeamId, stats.rating, stats.games_week, stats.games_season, stats.rank, stats.wins_week, stats.wins_season);
+        AppendStatsRow(teamQuery, teamHeader, teamFooter, row);
+
+        for (MemberList::const_iterator mitr = at->m_members.begin(); mitr != at->m_members.end(); ++mitr)
+        {
+            snprintf(row, 128, "(%u, %u, %u, %u, %u, %u, %u)", at->m_TeamId, GUID_LOPART(mitr->guid), mitr->games_week, mitr->wins_week, mitr->games_season, mitr->wins_season, mitr->personal_rating);
+            AppendStatsRow(memberQuery, memberHeader, memberFooter, row);
+        }
+    }
+
+    if (!teamQuery.empty())
+        CharacterDatabase.Execute((teamQuery + teamFooter).c_str());
+    if (!memberQuery.empty())
+        CharacterDatabase.Execute((memberQuery + memberFooter).c_str());
 }
 
 void ArenaTeam::FinishWeek()
@@ -177,6 +177,8 @@ class ArenaTeam
         void LoadStatsFromDB(uint32 ArenaTeamId);
 
         void SaveToDB();
+        // team and member stats of all given teams as multi-row statements, the caller owns the transaction
+        static void SaveStatsToDB(std::vector<ArenaTeam*> const& teams);
 
         void BroadcastPacket(WorldPacket *packet);
 
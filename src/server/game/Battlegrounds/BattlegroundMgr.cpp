@@ -38,6 +38,7 @@
 #include "World.h"
 #include "Chat.h"
 #include "ArenaTeam.h"
+#include "TickProfiler.h"
 
 /*********************************************************/
 /***            BATTLEGROUND QUEUE SYSTEM              ***/
@@ -67,43 +68,83 @@ BattleGroundQueue::~BattleGroundQueue()
     }
 }
 
-// initialize eligible groups from the given source matching the given specifications
-void BattleGroundQueue::EligibleGroups::Init(BattleGroundQueue::QueuedGroupsList *source, uint32 BgTypeId, uint32 side, uint32 MaxPlayers, uint8 ArenaType, bool IsRated, uint32 MinRating, uint32 MaxRating, uint32 DisregardTime, uint32 excludeTeam)
+BattleGroundQueue::GroupBucket& BattleGroundQueue::GetBucket(uint32 queue_id, bool isRated, uint32 team)
 {
-    // clear from prev initialization
-    clear();
-    BattleGroundQueue::QueuedGroupsList::iterator itr, next;
-    // iterate through the source
-    for (itr = source->begin(); itr != source->end(); itr = next)
+    return m_Buckets[queue_id][isRated ? 1 : 0][team == ALLIANCE ? BG_TEAM_ALLIANCE : BG_TEAM_HORDE];
+}
+
+// groups are taken out of their bucket as soon as they get invited, only waiting groups are matched
+void BattleGroundQueue::AddToBucket(GroupQueueInfo* ginfo)
+{
+    GroupBucket& bucket = GetBucket(ginfo->QueueId, ginfo->IsRated, ginfo->Team);
+    ginfo->BucketPos = bucket.JoinOrder.insert(bucket.JoinOrder.end(), ginfo);
+    if (ginfo->IsRated)
+        ginfo->RatingPos = bucket.ByRating.insert(std::make_pair(ginfo->ArenaTeamRating, ginfo));
+    ginfo->IsInBucket = true;
+}
+
+void BattleGroundQueue::RemoveFromBucket(GroupQueueInfo* ginfo)
+{
+    if (!ginfo->IsInBucket)
+        return;
+
+    GroupBucket& bucket = GetBucket(ginfo->QueueId, ginfo->IsRated, ginfo->Team);
+    bucket.JoinOrder.erase(ginfo->BucketPos);
+    if (ginfo->IsRated)
+        bucket.ByRating.erase(ginfo->RatingPos);
+    ginfo->IsInBucket = false;
+}
+
+bool BattleGroundQueue::HasRatedGroupsPassedDiscardTime(uint32 queue_id, uint32 discardTimer, uint32 elapsed) const
+{
+    uint32 now = getMSTime();
+    for (uint8 team = 0; team < BG_TEAMS_COUNT; ++team)
     {
-        next = itr;
-        ++next;
-        if ((*itr)->BgTypeId == BgTypeId &&     // bg type must match
-            (*itr)->ArenaType == ArenaType &&   // arena type must match
-            (*itr)->IsRated == IsRated &&       // israted must match
-            (*itr)->IsInvitedToBGInstanceGUID == 0 && // leave out already invited groups
-            (*itr)->Team == side &&             // match side
-            (*itr)->Players.size() <= MaxPlayers &&   // the group must fit in the bg
-            (!excludeTeam || (*itr)->ArenaTeamId != excludeTeam) && // if excludeTeam is specified, leave out those arena team ids
-            (!IsRated || (*itr)->Players.size() == MaxPlayers) &&   // if rated, then pass only if the player count is exact NEEDS TESTING! (but now this should never happen)
-            (!DisregardTime || (*itr)->JoinTime <= DisregardTime              // pass if disregard time is greater than join time
-               || (*itr)->ArenaTeamRating == 0                 // pass if no rating info
-               || ((*itr)->ArenaTeamRating >= MinRating       // pass if matches the rating range
-                     && (*itr)->ArenaTeamRating <= MaxRating)))
+        // join order is oldest first, only the groups that already passed the discard time are walked
+        GroupQueueList const& joined = m_Buckets[queue_id][1][team].JoinOrder;
+        for (GroupQueueList::const_iterator itr = joined.begin(); itr != joined.end(); ++itr)
         {
-            // the group matches the conditions
-            // using push_back for proper selecting when inviting
-            push_back((*itr));
+            uint32 waited = getMSTimeDiff((*itr)->JoinTime, now);
+            if (waited < discardTimer)
+                break;
+            if (waited - discardTimer < elapsed)
+                return true;
         }
     }
+    return false;
 }
 
 // selection pool initialization, used to clean up from prev selection
-void BattleGroundQueue::SelectionPool::Init(EligibleGroups * curr)
+void BattleGroundQueue::SelectionPool::Init(uint32 BgTypeId, uint8 ArenaType, uint32 excludeTeam, SelectionPool const* excludePool)
 {
-    m_CurrEligGroups = curr;
     SelectedGroups.clear();
     PlayerCount = 0;
+    m_BgTypeId = BgTypeId;
+    m_ArenaType = ArenaType;
+    m_ExcludeTeam = excludeTeam;
+    m_ExcludePool = excludePool;
+}
+
+bool BattleGroundQueue::SelectionPool::IsEligible(GroupQueueInfo const* ginfo, uint32 MaxPlayers) const
+{
+    if (ginfo->BgTypeId != m_BgTypeId ||                    // bg type must match
+        ginfo->ArenaType != m_ArenaType ||                  // arena type must match
+        ginfo->Players.size() > MaxPlayers)                 // the group must fit in the bg
+        return false;
+
+    // if rated, then pass only if the player count is exact
+    if (ginfo->IsRated && ginfo->Players.size() != MaxPlayers)
+        return false;
+
+    // if excludeTeam is specified, leave out those arena team ids
+    if (m_ExcludeTeam && ginfo->ArenaTeamId == m_ExcludeTeam)
+        return false;
+
+    // leave out the groups already selected as the other team of a one faction arena
+    if (m_ExcludePool && std::find(m_ExcludePool->SelectedGroups.begin(), m_ExcludePool->SelectedGroups.end(), ginfo) != m_ExcludePool->SelectedGroups.end())
+        return false;
+
+    return true;
 }
 
 // remove group info from selection pool
@@ -152,7 +193,9 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, uint32 BgTypeId, ui
 
     ginfo->Players.clear();
 
-    m_QueuedGroups[queue_id].push_back(ginfo);
+    ginfo->QueueId                   = queue_id;
+    ginfo->QueuePos                  = m_QueuedGroups[queue_id].insert(m_QueuedGroups[queue_id].end(), ginfo);
+    AddToBucket(ginfo);
 
     // return ginfo, because it is needed to add players to this group info
     return ginfo;
@@ -265,12 +308,7 @@ void BattleGroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
     }
 
     group = itr->second.GroupInfo;
-
-    for (group_itr=m_QueuedGroups[queue_id].begin(); group_itr != m_QueuedGroups[queue_id].end(); ++group_itr)
-    {
-        if (group == (GroupQueueInfo*)(*group_itr))
-            break;
-    }
+    group_itr = group->QueueId == uint32(queue_id) ? group->QueuePos : m_QueuedGroups[queue_id].end();
 
     // variables are set (what about leveling up when in queue????)
     // remove player from group
@@ -323,6 +361,7 @@ void BattleGroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
         // remove group queue info if needed
         if (group->Players.empty())
         {
+            RemoveFromBucket(group);
             m_QueuedGroups[queue_id].erase(group_itr);
             delete group;
         }
@@ -351,6 +390,9 @@ void BattleGroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
 
 bool BattleGroundQueue::InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * bg, uint32 side)
 {
+    // invited groups can't be matched again, must leave the bucket before the side changes
+    RemoveFromBucket(ginfo);
+
     // set side if needed
     if (side)
         ginfo->Team = side;
@@ -394,15 +436,15 @@ bool BattleGroundQueue::InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * b
 }
 
 // used to recursively select groups from eligible groups
-bool BattleGroundQueue::SelectionPool::Build(uint32 MinPlayers, uint32 MaxPlayers, EligibleGroups::iterator startitr)
+bool BattleGroundQueue::SelectionPool::Build(uint32 MinPlayers, uint32 MaxPlayers, GroupQueueList::const_iterator startitr, GroupQueueList::const_iterator enditr)
 {
     // start from the specified start iterator
-    for (EligibleGroups::iterator itr1 = startitr; itr1 != m_CurrEligGroups->end(); ++itr1)
+    for (GroupQueueList::const_iterator itr1 = startitr; itr1 != enditr; ++itr1)
     {
         // if it fits in, select it
-        if (GetPlayerCount() + (*itr1)->Players.size() <= MaxPlayers)
+        if (IsEligible(*itr1, MaxPlayers) && GetPlayerCount() + (*itr1)->Players.size() <= MaxPlayers)
         {
-            EligibleGroups::iterator next = itr1;
+            GroupQueueList::const_iterator next = itr1;
             ++next;
             AddGroup((*itr1));
             if (GetPlayerCount() >= MinPlayers)
@@ -412,7 +454,7 @@ bool BattleGroundQueue::SelectionPool::Build(uint32 MinPlayers, uint32 MaxPlayer
             }
             // try building from the rest of the elig. groups
             // if that succeeds, return true
-            if (Build(MinPlayers, MaxPlayers, next))
+            if (Build(MinPlayers, MaxPlayers, next, enditr))
                 return true;
             // the rest didn't succeed, so this group cannot be included
             RemoveGroup((*itr1));
@@ -422,8 +464,51 @@ bool BattleGroundQueue::SelectionPool::Build(uint32 MinPlayers, uint32 MaxPlayer
     return false;
 }
 
+// rated groups always fill a whole team, so the pool is the single oldest group that
+// either waited past the disregard time, has no rating yet or is inside the rating window
+bool BattleGroundQueue::SelectionPool::BuildRated(GroupBucket const& bucket, uint32 MaxPlayers, uint32 MinRating, uint32 MaxRating, uint32 DisregardTime)
+{
+    GroupQueueInfo* best = NULL;
+
+    // the groups that joined before the disregard time are a prefix of the join order
+    for (GroupQueueList::const_iterator itr = bucket.JoinOrder.begin(); itr != bucket.JoinOrder.end(); ++itr)
+    {
+        if (DisregardTime && (*itr)->JoinTime > DisregardTime)
+            break;
+        if (IsEligible(*itr, MaxPlayers))
+        {
+            best = *itr;
+            break;
+        }
+    }
+
+    // no disregard time means ratings are not looked at yet, the oldest group found above is the one
+    if (DisregardTime)
+    {
+        // groups without rating info match anyone
+        if (MinRating > 0)
+        {
+            GroupQueueRatingMap::const_iterator end = bucket.ByRating.upper_bound(0);
+            for (GroupQueueRatingMap::const_iterator itr = bucket.ByRating.begin(); itr != end; ++itr)
+                if ((!best || itr->second->JoinTime < best->JoinTime) && IsEligible(itr->second, MaxPlayers))
+                    best = itr->second;
+        }
+
+        GroupQueueRatingMap::const_iterator end = bucket.ByRating.upper_bound(MaxRating);
+        for (GroupQueueRatingMap::const_iterator itr = bucket.ByRating.lower_bound(MinRating); itr != end; ++itr)
+            if ((!best || itr->second->JoinTime < best->JoinTime) && IsEligible(itr->second, MaxPlayers))
+                best = itr->second;
+    }
+
+    if (!best)
+        return false;
+
+    AddGroup(best);
+    return true;
+}
+
 // this function is responsible for the selection of queued groups when trying to create new battlegrounds
-bool BattleGroundQueue::BuildSelectionPool(uint32 bgTypeId, uint32 queue_id, uint32 MinPlayers, uint32 MaxPlayers,  SelectionPoolBuildMode mode, uint8 ArenaType, bool isRated, uint32 MinRating, uint32 MaxRating, uint32 DisregardTime, uint32 excludeTeam)
+bool BattleGroundQueue::BuildSelectionPool(uint32 bgTypeId, uint32 queue_id, uint32 MinPlayers, uint32 MaxPlayers,  SelectionPoolBuildMode mode, uint8 ArenaType, bool isRated, uint32 MinRating, uint32 MaxRating, uint32 DisregardTime, uint32 excludeTeam, SelectionPool const* excludePool)
 {
     uint32 side;
     switch (mode)
@@ -445,14 +530,19 @@ bool BattleGroundQueue::BuildSelectionPool(uint32 bgTypeId, uint32 queue_id, uin
             break;
     }
 
-    // initiate the groups eligible to create the bg
-    m_EligibleGroups.Init(&(m_QueuedGroups[queue_id]), bgTypeId, side, MaxPlayers, ArenaType, isRated, MinRating, MaxRating, DisregardTime, excludeTeam);
-    // init the selected groups (clear)
-    // and set m_CurrEligGroups pointer
-    // we set it this way to only have one EligibleGroups object to save some memory
-    m_SelectionPools[mode].Init(&m_EligibleGroups);
+    // the bucket already holds only the waiting groups of this bracket, side and rated flag,
+    // the pool filters the rest while walking it
+    GroupBucket const& bucket = GetBucket(queue_id, isRated, side);
+    m_SelectionPools[mode].Init(bgTypeId, ArenaType, excludeTeam, excludePool);
+
+    bool built;
+    if (isRated)
+        built = m_SelectionPools[mode].BuildRated(bucket, MaxPlayers, MinRating, MaxRating, DisregardTime);
+    else
+        built = m_SelectionPools[mode].Build(MinPlayers, MaxPlayers, bucket.JoinOrder.begin(), bucket.JoinOrder.end());
+
     // build succeeded
-    if (m_SelectionPools[mode].Build(MinPlayers, MaxPlayers, m_EligibleGroups.begin()))
+    if (built)
     {
         // the selection pool is set, return
         sLog->outDebug("Battleground-debug: pool build succeeded, return true");
@@ -476,6 +566,7 @@ void BattleGroundQueue::BGEndedRemoveInvites(BattleGround *bg)
     uint32 queue_id = bg->GetQueueType();
     uint32 bgInstanceId = bg->GetInstanceID();
     uint32 bgQueueTypeId = sBattleGroundMgr->BGQueueTypeId(bg->GetTypeID(), bg->GetArenaType());
+    bool removed = false;
     QueuedGroupsList::iterator itr, next;
     for (itr = m_QueuedGroups[queue_id].begin(); itr != m_QueuedGroups[queue_id].end(); itr = next)
     {
@@ -514,9 +605,7 @@ void BattleGroundQueue::BGEndedRemoveInvites(BattleGround *bg)
                     plr->RemoveBattleGroundQueueId(bgQueueTypeId);
                     // remove player from queue, this might delete the ginfo as well! don't use that pointer after this!
                     RemovePlayer(itr2->first, true);
-                    // this is probably unneeded, since this player was already invited -> does not fit when initing eligible groups
-                    // but updating the queue can't hurt
-                    Update(bgQueueTypeId, bg->GetQueueType());
+                    removed = true;
                     // send info to client
                     WorldPacket data;
                     sBattleGroundMgr->BuildBattleGroundStatusPacket(&data, bg, team, queueSlot, STATUS_NONE, 0, 0);
@@ -525,6 +614,10 @@ void BattleGroundQueue::BGEndedRemoveInvites(BattleGround *bg)
             }
         }
     }
+
+    // the removed groups left their buckets when invited, one pass is enough to refill free slots
+    if (removed)
+        Update(sBattleGroundMgr->BGTemplateId(bgQueueTypeId), queue_id, sBattleGroundMgr->BGArenaType(bgQueueTypeId), bg->isRated());
 }
 
 /*
@@ -561,16 +654,22 @@ void BattleGroundQueue::Update(uint32 bgTypeId, uint32 queue_id, uint8 arenatype
             BattleGround* bg = *itr; //we have to store battleground pointer here, because when battleground is full, it is removed from free queue (not yet implemented!!)
             // and iterator is invalid
 
-            for (QueuedGroupsList::iterator itr = m_QueuedGroups[queue_id].begin(); itr != m_QueuedGroups[queue_id].end(); ++itr)
+            // only groups still waiting are in the buckets, inviting takes them out
+            for (uint8 team = 0; team < BG_TEAMS_COUNT; ++team)
             {
-                // did the group join for this bg type?
-                if ((*itr)->BgTypeId != bgTypeId)
-                    continue;
-                // if so, check if fits in
-                if (bg->GetFreeSlotsForTeam((*itr)->Team) >= (*itr)->Players.size())
+                GroupQueueList& waiting = m_Buckets[queue_id][0][team].JoinOrder;
+                for (GroupQueueList::iterator gitr = waiting.begin(); gitr != waiting.end();)
                 {
-                    // if group fits in, invite it
-                    InviteGroupToBG((*itr), bg, (*itr)->Team);
+                    GroupQueueInfo* ginfo = *gitr++;
+                    // did the group join for this bg type?
+                    if (ginfo->BgTypeId != bgTypeId)
+                        continue;
+                    // if so, check if fits in
+                    if (bg->GetFreeSlotsForTeam(ginfo->Team) >= ginfo->Players.size())
+                    {
+                        // if group fits in, invite it
+                        InviteGroupToBG(ginfo, bg, ginfo->Team);
+                    }
                 }
             }
 
@@ -767,17 +866,8 @@ void BattleGroundQueue::Update(uint32 bgTypeId, uint32 queue_id, uint8 arenatype
         bOneSideHordeTeam1 = BuildSelectionPool(bgTypeId, queue_id, MaxPlayersPerTeam, MaxPlayersPerTeam, ONESIDE_HORDE_TEAM1, arenatype, isRated, arenaMinRating, arenaMaxRating, discardTime);
         if (bOneSideHordeTeam1)
         {
-            // one team has been selected, find out if other can be selected too
-            std::list<GroupQueueInfo* >::iterator itr;
-            // temporarily change the team side to enable building the next pool excluding the already selected groups
-            for (itr = m_SelectionPools[ONESIDE_HORDE_TEAM1].SelectedGroups.begin(); itr != m_SelectionPools[ONESIDE_HORDE_TEAM1].SelectedGroups.end(); ++itr)
-                (*itr)->Team=ALLIANCE;
-
-            bOneSideHordeTeam2 = BuildSelectionPool(bgTypeId, queue_id, MaxPlayersPerTeam, MaxPlayersPerTeam, ONESIDE_HORDE_TEAM2, arenatype, isRated, arenaMinRating, arenaMaxRating, discardTime, (*(m_SelectionPools[ONESIDE_HORDE_TEAM1].SelectedGroups.begin()))->ArenaTeamId);
-
-            // change back the team to horde
-            for (itr = m_SelectionPools[ONESIDE_HORDE_TEAM1].SelectedGroups.begin(); itr != m_SelectionPools[ONESIDE_HORDE_TEAM1].SelectedGroups.end(); ++itr)
-                (*itr)->Team=HORDE;
+            // one team has been selected, find out if other can be selected too from the same side, excluding the already selected groups
+            bOneSideHordeTeam2 = BuildSelectionPool(bgTypeId, queue_id, MaxPlayersPerTeam, MaxPlayersPerTeam, ONESIDE_HORDE_TEAM2, arenatype, isRated, arenaMinRating, arenaMaxRating, discardTime, (*(m_SelectionPools[ONESIDE_HORDE_TEAM1].SelectedGroups.begin()))->ArenaTeamId, &m_SelectionPools[ONESIDE_HORDE_TEAM1]);
 
             if (!bOneSideHordeTeam2)
                 bOneSideHordeTeam1 = false;
@@ -788,17 +878,8 @@ void BattleGroundQueue::Update(uint32 bgTypeId, uint32 queue_id, uint8 arenatype
             bOneSideAllyTeam1 = BuildSelectionPool(bgTypeId, queue_id, MaxPlayersPerTeam, MaxPlayersPerTeam, ONESIDE_ALLIANCE_TEAM1, arenatype, isRated, arenaMinRating, arenaMaxRating, discardTime);
             if (bOneSideAllyTeam1)
             {
-                // one team has been selected, find out if other can be selected too
-                std::list<GroupQueueInfo* >::iterator itr;
-                // temporarily change the team side to enable building the next pool excluding the already selected groups
-                for (itr = m_SelectionPools[ONESIDE_ALLIANCE_TEAM1].SelectedGroups.begin(); itr != m_SelectionPools[ONESIDE_ALLIANCE_TEAM1].SelectedGroups.end(); ++itr)
-                    (*itr)->Team=HORDE;
-
-                bOneSideAllyTeam2 = BuildSelectionPool(bgTypeId, queue_id, MaxPlayersPerTeam, MaxPlayersPerTeam, ONESIDE_ALLIANCE_TEAM2, arenatype, isRated, arenaMinRating, arenaMaxRating, discardTime, (*(m_SelectionPools[ONESIDE_ALLIANCE_TEAM1].SelectedGroups.begin()))->ArenaTeamId);
-
-                // change back the team to ally
-                for (itr = m_SelectionPools[ONESIDE_ALLIANCE_TEAM1].SelectedGroups.begin(); itr != m_SelectionPools[ONESIDE_ALLIANCE_TEAM1].SelectedGroups.end(); ++itr)
-                    (*itr)->Team=ALLIANCE;
+                // one team has been selected, find out if other can be selected too from the same side, excluding the already selected groups
+                bOneSideAllyTeam2 = BuildSelectionPool(bgTypeId, queue_id, MaxPlayersPerTeam, MaxPlayersPerTeam, ONESIDE_ALLIANCE_TEAM2, arenatype, isRated, arenaMinRating, arenaMaxRating, discardTime, (*(m_SelectionPools[ONESIDE_ALLIANCE_TEAM1].SelectedGroups.begin()))->ArenaTeamId, &m_SelectionPools[ONESIDE_ALLIANCE_TEAM1]);
             }
 
             if (!bOneSideAllyTeam2)
@@ -972,7 +1053,7 @@ bool BGQueueRemoveEvent::Execute(uint64 /*e_time*/, uint32 /*p_time*/)
         {
             plr->RemoveBattleGroundQueueId(bgQueueTypeId);
             sBattleGroundMgr->m_BattleGroundQueues[bgQueueTypeId].RemovePlayer(m_PlayerGuid, true);
-            sBattleGroundMgr->m_BattleGroundQueues[bgQueueTypeId].Update(bgQueueTypeId, bg->GetQueueType());
+            sBattleGroundMgr->m_BattleGroundQueues[bgQueueTypeId].Update(sBattleGroundMgr->BGTemplateId(bgQueueTypeId), bg->GetQueueType(), sBattleGroundMgr->BGArenaType(bgQueueTypeId), bg->isRated());
             WorldPacket data;
             sBattleGroundMgr->BuildBattleGroundStatusPacket(&data, bg, m_PlayersTeam, queueSlot, STATUS_NONE, 0, 0);
             plr->GetSession()->SendPacket(&data);
@@ -1003,6 +1084,7 @@ BattleGroundMgr::BattleGroundMgr()
     m_RatingDiscardTimer = sWorld->getConfig(CONFIG_ARENA_RATING_DISCARD_TIMER);
     m_PrematureFinishTimer = sWorld->getConfig(CONFIG_BATTLEGROUND_PREMATURE_FINISH_TIMER);
     m_NextRatingDiscardUpdate = m_RatingDiscardTimer;
+    m_LastRatingDiscardTime = getMSTime();
     m_AutoDistributionTimeChecker = 0;
     m_ArenaTesting = false;
     m_Testing = false;
@@ -1034,6 +1116,8 @@ void BattleGroundMgr::DeleteAlllBattleGrounds()
 // used to update running battlegrounds, and delete finished ones
 void BattleGroundMgr::Update(time_t diff)
 {
+    TickProfileScope profile(PROFILE_BATTLEGROUND_MGR);
+
     BattleGroundSet::iterator itr, next;
     for (itr = m_BattleGrounds.begin(); itr != m_BattleGrounds.end(); itr = next)
     {
@@ -1055,10 +1139,15 @@ void BattleGroundMgr::Update(time_t diff)
         // it's time to force update
         if (m_NextRatingDiscardUpdate < diff)
         {
-            // forced update for level 70 rated arenas
-            m_BattleGroundQueues[BATTLEGROUND_QUEUE_2v2].Update(BATTLEGROUND_AA, 6, ARENA_TYPE_2v2, true, 0);
-            m_BattleGroundQueues[BATTLEGROUND_QUEUE_3v3].Update(BATTLEGROUND_AA, 6, ARENA_TYPE_3v3, true, 0);
-            m_BattleGroundQueues[BATTLEGROUND_QUEUE_5v5].Update(BATTLEGROUND_AA, 6, ARENA_TYPE_5v5, true, 0);
+            // joins and leaves already update their queue, the timer only matters for level 70 rated
+            // teams whose rating window got lifted since its last pass; the unconditional retry of
+            // every rated queue was dropped, nothing else changes whether two queued teams match
+            uint32 now = getMSTime();
+            uint32 elapsed = getMSTimeDiff(m_LastRatingDiscardTime, now);
+            for (uint32 bgQueueTypeId = BATTLEGROUND_QUEUE_2v2; bgQueueTypeId <= BATTLEGROUND_QUEUE_5v5; ++bgQueueTypeId)
+                if (m_BattleGroundQueues[bgQueueTypeId].HasRatedGroupsPassedDiscardTime(6, m_RatingDiscardTimer, elapsed))
+                    m_BattleGroundQueues[bgQueueTypeId].Update(BATTLEGROUND_AA, 6, BGArenaType(bgQueueTypeId), true, 0);
+            m_LastRatingDiscardTime = now;
             m_NextRatingDiscardUpdate = m_RatingDiscardTimer;
         }
         else
@@ -1644,16 +1733,45 @@ void BattleGroundMgr::DistributeArenaPoints()
         }
     }
 
-    //cycle that gives points to all players
+    // online players only get the points in memory, the next character save writes them;
+    // offline ones are updated with a few CASE statements inside one queued transaction
+    std::vector<ArenaTeam*> teams;
+
+    CharacterDatabase.BeginTransaction();
+
+    std::ostringstream cases;
+    std::ostringstream guids;
+    uint32 offline = 0;
     for (std::map<uint32, uint32>::iterator plr_itr = PlayerPoints.begin(); plr_itr != PlayerPoints.end(); ++plr_itr)
     {
-        //update to database
-        CharacterDatabase.PExecute("UPDATE characters SET arenaPoints = arenaPoints + '%u' WHERE guid = '%u'", plr_itr->second, plr_itr->first);
+        if (!plr_itr->second)
+            continue;
+
         //add points if player is online
-        Player* pl = sObjectMgr->GetPlayer(plr_itr->first);
-        if (pl)
+        if (Player* pl = sObjectMgr->GetPlayer(plr_itr->first))
+        {
             pl->ModifyArenaPoints(plr_itr->second);
+            continue;
+        }
+
+        if (offline)
+        {
+            cases << ' ';
+            guids << ',';
+        }
+        cases << "WHEN " << plr_itr->first << " THEN " << plr_itr->second;
+        guids << plr_itr->first;
+
+        if (++offline >= ARENA_POINTS_BATCH_ROWS)
+        {
+            CharacterDatabase.PExecute("UPDATE characters SET arenaPoints = arenaPoints + CASE guid %s END WHERE guid IN (%s)", cases.str().c_str(), guids.str().c_str());
+            cases.str("");
+            guids.str("");
+            offline = 0;
+        }
     }
+    if (offline)
+        CharacterDatabase.PExecute("UPDATE characters SET arenaPoints = arenaPoints + CASE guid %s END WHERE guid IN (%s)", cases.str().c_str(), guids.str().c_str());
 
     PlayerPoints.clear();
 
@@ -1665,11 +1783,16 @@ void BattleGroundMgr::DistributeArenaPoints()
         if (ArenaTeam * at = titr->second)
         {
             at->FinishWeek();                              // set played this week etc values to 0 in memory, too
-            at->SaveToDB();                                // save changes
-            at->NotifyStatsChanged();                      // notify the players of the changes
+            teams.push_back(at);
         }
     }
 
+    ArenaTeam::SaveStatsToDB(teams);                       // save changes
+    CharacterDatabase.CommitTransaction();
+
+    for (std::vector<ArenaTeam*>::const_iterator itr = teams.begin(); itr != teams.end(); ++itr)
+        (*itr)->NotifyStatsChanged();                      // notify the players of the changes
+
     sWorld->SendGlobalText("Modification done.", NULL);
 
     sWorld->SendGlobalText("Done flushing Arena points.", NULL);
@@ -39,8 +39,13 @@ typedef std::list<BattleGround*> BGFreeSlotQueueType;
 #define MAX_BATTLEGROUND_QUEUE_TYPES 8
 
 #define BATTLEGROUND_ARENA_POINT_DISTRIBUTION_DAY    86400     // seconds in a day
+#define ARENA_POINTS_BATCH_ROWS                      500       // offline characters per arena point UPDATE, keeps it below MAX_QUERY_LEN
 
 struct GroupQueueInfo;                                      // type predefinition
+
+typedef std::list<GroupQueueInfo*> GroupQueueList;
+typedef std::multimap<uint32, GroupQueueInfo*> GroupQueueRatingMap;
+
 struct PlayerQueueInfo                                      // stores information for players in queue
 {
     uint32  InviteTime;                                     // first invite time
@@ -61,6 +66,13 @@ struct GroupQueueInfo                                       // stores informatio
     uint32  IsInvitedToBGInstanceGUID;                      // was invited to certain BG
     uint32  ArenaTeamRating;                                // if rated match, inited to the rating of the team
     uint32  OpponentsTeamRating;                            // for rated arena matches
+
+    // position in the owning BattleGroundQueue, lets removal skip list scans
+    uint32  QueueId;                                        // level bracket
+    GroupQueueList::iterator QueuePos;                      // in m_QueuedGroups
+    bool    IsInBucket;                                     // waiting for a match, false once invited
+    GroupQueueList::iterator BucketPos;                     // in the bucket join order
+    GroupQueueRatingMap::iterator RatingPos;                // in the bucket rating index, rated groups only
 };
 
 class BattleGround;
@@ -81,32 +93,45 @@ class BattleGroundQueue
         typedef std::map<uint64, PlayerQueueInfo> QueuedPlayersMap;
         QueuedPlayersMap m_QueuedPlayers[MAX_BATTLEGROUND_QUEUES];
 
-        typedef std::list<GroupQueueInfo*> QueuedGroupsList;
+        typedef GroupQueueList QueuedGroupsList;
         QueuedGroupsList m_QueuedGroups[MAX_BATTLEGROUND_QUEUES];
 
-        // class to hold pointers to the groups eligible for a specific selection pool building mode
-        class EligibleGroups : public std::list<GroupQueueInfo *>
+        // groups still waiting for a match, split by bracket, rated flag and side;
+        // join order gives the oldest group first, the rating index serves the
+        // rating window of rated arena matches
+        struct GroupBucket
         {
-        public:
-            void Init(QueuedGroupsList * source, uint32 BgTypeId, uint32 side, uint32 MaxPlayers, uint8 ArenaType = 0, bool IsRated = false, uint32 MinRating = 0, uint32 MaxRating = 0, uint32 DisregardTime = 0, uint32 excludeTeam = 0);
+            GroupQueueList JoinOrder;
+            GroupQueueRatingMap ByRating;
         };
 
-        EligibleGroups m_EligibleGroups;
+        GroupBucket m_Buckets[MAX_BATTLEGROUND_QUEUES][2][2];  // [queue_id][rated][team index]
+
+        GroupBucket& GetBucket(uint32 queue_id, bool isRated, uint32 team);
+
+        // true if a rated group of the bracket waited discardTimer ms within the last elapsed ms
+        bool HasRatedGroupsPassedDiscardTime(uint32 queue_id, uint32 discardTimer, uint32 elapsed) const;
 
         // class to select and invite groups to bg
         class SelectionPool
         {
         public:
-            void Init(EligibleGroups * curr);
+            void Init(uint32 BgTypeId, uint8 ArenaType, uint32 excludeTeam = 0, SelectionPool const* excludePool = NULL);
             void AddGroup(GroupQueueInfo * group);
             void RemoveGroup(GroupQueueInfo * group);
             uint32 GetPlayerCount() const {return PlayerCount;}
-            bool Build(uint32 MinPlayers, uint32 MaxPlayers, EligibleGroups::iterator startitr);
+            bool Build(uint32 MinPlayers, uint32 MaxPlayers, GroupQueueList::const_iterator startitr, GroupQueueList::const_iterator enditr);
+            bool BuildRated(GroupBucket const& bucket, uint32 MaxPlayers, uint32 MinRating, uint32 MaxRating, uint32 DisregardTime);
         public:
             std::list<GroupQueueInfo *> SelectedGroups;
         private:
+            bool IsEligible(GroupQueueInfo const* ginfo, uint32 MaxPlayers) const;
+
             uint32 PlayerCount;
-            EligibleGroups * m_CurrEligGroups;
+            uint32 m_BgTypeId;
+            uint8 m_ArenaType;
+            uint32 m_ExcludeTeam;                           // arena team id that may not be selected
+            SelectionPool const* m_ExcludePool;             // groups already picked for the other team
         };
 
         enum SelectionPoolBuildMode
@@ -123,9 +148,12 @@ class BattleGroundQueue
 
         SelectionPool m_SelectionPools[NUM_SELECTION_POOL_TYPES];
 
-        bool BuildSelectionPool(uint32 bgTypeId, uint32 queue_id, uint32 MinPlayers, uint32 MaxPlayers, SelectionPoolBuildMode mode, uint8 ArenaType = 0, bool isRated = false, uint32 MinRating = 0, uint32 MaxRating = 0, uint32 DisregardTime = 0, uint32 excludeTeam = 0);
+        bool BuildSelectionPool(uint32 bgTypeId, uint32 queue_id, uint32 MinPlayers, uint32 MaxPlayers, SelectionPoolBuildMode mode, uint8 ArenaType = 0, bool isRated = false, uint32 MinRating = 0, uint32 MaxRating = 0, uint32 DisregardTime = 0, uint32 excludeTeam = 0, SelectionPool const* excludePool = NULL);
 
     private:
+        void AddToBucket(GroupQueueInfo* ginfo);
+        void RemoveFromBucket(GroupQueueInfo* ginfo);
+
 
         bool InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * bg, uint32 side);
 };
@@ -249,6 +277,7 @@ class BattleGroundMgr
         uint32 m_MaxRatingDifference;
         uint32 m_RatingDiscardTimer;
         uint32 m_NextRatingDiscardUpdate;
+        uint32 m_LastRatingDiscardTime;                     // getMSTime() of the last rated pass of the timer
         bool   m_AutoDistributePoints;
         uint64 m_NextAutoDistributionTime;
         uint32 m_AutoDistributionTimeChecker;
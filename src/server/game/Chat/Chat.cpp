@@ -245,6 +245,17 @@ ChatCommand * ChatHandler::getCommandTable()
         { "arena",         SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugArenaCommand,          "", NULL },
         { "bg",            SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugBattlegroundCommand,   "", NULL },
         { "threatlist",    SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugThreatList,            "", NULL },
+        { "movementtiers", SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugMovementTiersCommand,  "", NULL },
+        { "dormant",       SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugDormantCommand,        "", NULL },
+        { "gridload",      SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugGridLoadCommand,       "", NULL },
+        { "lootstats",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugLootStatsCommand,      "", NULL },
+        { "lookupbench",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugLookupBenchCommand,    "", NULL },
+        { "randbench",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugRandBenchCommand,      "", NULL },
+        { "spellbench",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugSpellBenchCommand,     "", NULL },
+        { "pathbench",     SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugPathBenchCommand,      "", NULL },
+        { "losbench",      SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugLosBenchCommand,       "", NULL },
+        { "objectpools",   SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugObjectPoolsCommand,    "", NULL },
+        { "profiler",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugProfilerCommand,       "", NULL },
         { "setinstdata",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleSetInstanceDataCommand,     "", NULL },
         { "getinstdata",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleGetInstanceDataCommand,     "", NULL },
         { NULL,             0,                  false, NULL,                                           "", NULL }
@@ -556,6 +567,7 @@ ChatCommand * ChatHandler::getCommandTable()
         { "unbind",        SEC_MODERATOR,      false, &ChatHandler::HandleInstanceUnbindCommand,      "", NULL },
         { "stats",         SEC_MODERATOR,      true,  &ChatHandler::HandleInstanceStatsCommand,       "", NULL },
         { "savedata",      SEC_MODERATOR,      false, &ChatHandler::HandleInstanceSaveDataCommand,    "", NULL },
+        { "cleanup",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleInstanceCleanupCommand,     "", NULL },
         { NULL,             0,                  false, NULL,                                           "", NULL }
     };
 
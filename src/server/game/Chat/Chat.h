@@ -309,6 +309,7 @@ class ChatHandler
         bool HandleInstanceUnbindCommand(const char* args);
         bool HandleInstanceStatsCommand(const char* args);
         bool HandleInstanceSaveDataCommand(const char * args);
+        bool HandleInstanceCleanupCommand(const char * args);
 
         bool HandleServerCorpsesCommand(const char* args);
         bool HandleServerExitCommand(const char* args);
@@ -517,6 +518,17 @@ class ChatHandler
         bool HandleDebugArenaCommand(const char * args);
         bool HandleDebugBattlegroundCommand(const char * args);
         bool HandleDebugThreatList(const char * args);
+        bool HandleDebugMovementTiersCommand(const char * args);
+        bool HandleDebugDormantCommand(const char * args);
+        bool HandleDebugGridLoadCommand(const char * args);
+        bool HandleDebugLootStatsCommand(const char * args);
+        bool HandleDebugLookupBenchCommand(const char * args);
+        bool HandleDebugRandBenchCommand(const char * args);
+        bool HandleDebugSpellBenchCommand(const char * args);
+        bool HandleDebugPathBenchCommand(const char * args);
+        bool HandleDebugLosBenchCommand(const char * args);
+        bool HandleDebugObjectPoolsCommand(const char * args);
+        bool HandleDebugProfilerCommand(const char * args);
         bool HandleDebugHostilRefList(const char * args);
         bool HandlePossessCommand(const char* args);
         bool HandleUnPossessCommand(const char* args);
@@ -542,6 +554,9 @@ class ChatHandler
         bool HandleBanHelper(BanMode mode, char const* args);
         bool HandleBanInfoHelper(uint32 accountid, char const* accountname);
         bool HandleUnBanHelper(BanMode mode, char const* args);
+        // count of the .debug *bench commands: defaultCount without argument, at most maxCount
+        bool ExtractBenchCount(char const* arg, uint32 defaultCount, uint32 maxCount, uint32& count);
+        void SendBenchTime(char const* label, uint32 ms, double operations, char const* unit);
 
         /**
          * Stores informations about a deleted character
@@ -36,6 +36,11 @@
 #include <fstream>
 #include "ObjectMgr.h"
 #include "InstanceScript.h"
+#include "SpellMgr.h"
+#include "PathPlanner.h"
+#include "ObjectPool.h"
+#include "TickProfiler.h"
+#include "VMapFactory.h"
 
 bool ChatHandler::HandleDebugInArcCommand(const char* /*args*/)
 {
@@ -607,6 +612,316 @@ bool ChatHandler::HandleDebugArenaCommand(const char * /*args*/)
     return true;
 }
 
+bool ChatHandler::HandleDebugMovementTiersCommand(const char * /*args*/)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+    MovementBroadcastStats const& stats = map->GetMovementBroadcastStats();
+
+    uint64 total = stats.sentBytes + stats.suppressedBytes;
+    PSendSysMessage("Movement broadcasts on map %u (instance %u), tiers %s", map->GetId(), map->GetInstanceId(), map->HasMovementTiers() ? "enabled" : "disabled");
+    PSendSysMessage("Sent: " UI64FMTD " packets, " UI64FMTD " bytes", stats.sentPackets, stats.sentBytes);
+    PSendSysMessage("Suppressed: " UI64FMTD " packets, " UI64FMTD " bytes (%.1f%% saved)", stats.suppressedPackets, stats.suppressedBytes,
+        total ? float(stats.suppressedBytes) * 100.0f / float(total) : 0.0f);
+    return true;
+}
+
+bool ChatHandler::ExtractBenchCount(char const* arg, uint32 defaultCount, uint32 maxCount, uint32& count)
+{
+    int32 value = arg && *arg ? atoi(arg) : int32(defaultCount);
+    if (value <= 0)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    // the benchmarks run on the world thread, some keep a buffer per operation
+    count = std::min(uint32(value), maxCount);
+    if (count < uint32(value))
+        PSendSysMessage("Count limited to %u.", maxCount);
+    return true;
+}
+
+void ChatHandler::SendBenchTime(char const* label, uint32 ms, double operations, char const* unit)
+{
+    double rate = ms ? operations * IN_MILLISECONDS / ms : 0.0;
+    if (rate >= 1000000.0)
+        PSendSysMessage("%s: %u ms (%.2f M %s/s)", label, ms, rate / 1000000.0, unit);
+    else
+        PSendSysMessage("%s: %u ms (%.0f %s/s)", label, ms, rate, unit);
+}
+
+bool ChatHandler::HandleDebugLookupBenchCommand(const char * args)
+{
+    uint32 lookups;
+    if (!ExtractBenchCount(args, 1000000, 50000000, lookups))
+        return false;
+
+    ObjectLookupBenchResult result;
+    ObjectAccessor::BenchmarkLookups(sWorld->getConfig(CONFIG_NUMTHREADS), lookups, result);
+
+    double total = double(result.threads) * lookups;
+    PSendSysMessage("Creature lookups: %u threads x %u, " UI64FMTD " found", result.threads, lookups, result.found);
+    SendBenchTime("Lock free", result.lockFreeTime, total, "lookups");
+    SendBenchTime("Locked", result.lockedTime, total, "lookups");
+    return true;
+}
+
+bool ChatHandler::HandleDebugRandBenchCommand(const char * args)
+{
+    uint32 count;
+    if (!ExtractBenchCount(args, 10000000, 500000000, count))
+        return false;
+
+    RandomBenchResult result;
+    BenchmarkRandom(count, result);
+
+    PSendSysMessage("%u random numbers, engine %s, map streams %s", count, result.engineName,
+        sWorld->getConfig(CONFIG_RANDOM_MAP_SEED) ? "enabled" : "disabled");
+    SendBenchTime("MTRand (TSS lookup per call)", result.mtRandTime, count, "numbers");
+    SendBenchTime("urand()", result.urandTime, count, "numbers");
+    SendBenchTime(fmtstring("%s direct", result.engineName), result.engineTime, count, "numbers");
+    return true;
+}
+
+bool ChatHandler::HandleDebugSpellBenchCommand(const char * args)
+{
+    uint32 events;
+    if (!ExtractBenchCount(args, 2000000, 20000000, events))
+        return false;
+
+    SpellInfoBenchResult result;
+    sSpellMgr->BenchmarkSpellInfo(events, result);
+
+    PSendSysMessage("Combat log replay: %u events over %u spells, SpellInfo %u bytes, SpellEntry %u bytes", events, result.spells,
+        uint32(sizeof(SpellInfo)), uint32(sizeof(SpellEntry)));
+    SendBenchTime("SpellEntry", result.entryTime, events, "events");
+    SendBenchTime("SpellInfo", result.infoTime, events, "events");
+    if (!result.match)
+        SendSysMessage("Results differ, the spell info store is out of date.");
+    return true;
+}
+
+bool ChatHandler::HandleDebugPathBenchCommand(const char * args)
+{
+    char* countStr = strtok((char*)args, " ");
+    char* radiusStr = strtok(NULL, " ");
+
+    uint32 count;
+    if (!ExtractBenchCount(countStr, 1000, 100000, count))
+        return false;
+
+    float radius = radiusStr ? (float)atof(radiusStr) : 100.0f;
+    if (radius <= 0.0f)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    Player* player = m_session->GetPlayer();
+    Map* map = player->GetMap();
+    PathPlanner& planner = map->GetPathPlanner();
+
+    PathBenchResult result;
+    planner.Benchmark(player->GetPositionX(), player->GetPositionY(), radius, count, result);
+
+    PSendSysMessage("%u random pairs within %.1f yards on map %u (instance %u), pathfinding %s", count, radius, map->GetId(), map->GetInstanceId(),
+        sWorld->getConfig(CONFIG_PATHFINDING_ENABLE) ? "enabled" : "disabled");
+    PSendSysMessage("Around obstacles: %u, straight: %u, no walk map: %u, not found: %u, %.1f nodes expanded per search",
+        result.paths, result.straight, result.noData, result.failed,
+        result.paths + result.failed ? float(result.expandedNodes) / float(result.paths + result.failed) : 0.0f);
+    SendBenchTime("Searched", result.searchTime, count, "paths");
+    SendBenchTime(fmtstring("Cached, first %u pairs", result.cachedPairs), result.cachedTime, result.cachedPairs, "paths");
+    PSendSysMessage("Map cache: %u of %u paths", planner.GetCacheSize(), sWorld->getConfig(CONFIG_PATHFINDING_CACHE_SIZE));
+
+    PathPlannerStats const& stats = planner.GetStats();
+    PSendSysMessage("Map planner since the map was created: %u requests, %u straight, %u without walk map, %u cache hits, %u searches, %u not found",
+        stats.requests, stats.straight, stats.noData, stats.cacheHits, stats.searches, stats.failed);
+    return true;
+}
+
+bool ChatHandler::HandleDebugLosBenchCommand(const char * args)
+{
+    char* countStr = strtok((char*)args, " ");
+    char* radiusStr = strtok(NULL, " ");
+
+    uint32 count;
+    if (!ExtractBenchCount(countStr, 10000, 1000000, count))
+        return false;
+
+    float radius = radiusStr ? (float)atof(radiusStr) : 50.0f;
+    if (radius <= 0.0f)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    Player* player = m_session->GetPlayer();
+    Map* map = player->GetMap();
+
+    VMapBenchResult result;
+    map->BenchmarkVMapQueries(player->GetPositionX(), player->GetPositionY(), player->GetPositionZ(), radius, count, result);
+
+    VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+    PSendSysMessage("%u random segments and points within %.1f yards on map %u (instance %u), vmap LOS %s, vmap height %s", count, radius, map->GetId(), map->GetInstanceId(),
+        vmgr->isLineOfSightCalcEnabled() ? "enabled" : "disabled", vmgr->isHeightCalcEnabled() ? "enabled" : "disabled");
+    PSendSysMessage("Line of sight: %u visible, %u results differ", result.losVisible, result.losMismatches);
+    SendBenchTime("Single rays", result.losScalarTime, count, "rays");
+    SendBenchTime("Batched rays", result.losBatchTime, count, "rays");
+    PSendSysMessage("Height: %u found, %u results differ", result.heightFound, result.heightMismatches);
+    SendBenchTime("Single points", result.heightScalarTime, count, "points");
+    SendBenchTime("Batched points", result.heightBatchTime, count, "points");
+    return true;
+}
+
+bool ChatHandler::HandleDebugObjectPoolsCommand(const char * args)
+{
+    if (*args)
+    {
+        if (strncmp(args, "reset", strlen(args)) != 0)
+            return false;
+
+        sObjectPoolMgr->ResetStats();
+        SendSysMessage("Object pool allocation counters reset.");
+        return true;
+    }
+
+    static char const* const kindNames[MAX_OBJECT_POOL_KINDS] = { "Creatures", "GameObjects", "Update fields", "AIs", "Movement generators" };
+
+    uint32 age = sObjectPoolMgr->GetStatsAge();
+    PSendSysMessage("Object pools, at most %u free blocks per class, counters of the last %u s", sWorld->getConfig(CONFIG_OBJECT_POOL_MAX_FREE), age / IN_MILLISECONDS);
+
+    ObjectPoolStats stats[MAX_OBJECT_POOL_KINDS];
+    for (uint8 i = 0; i < MAX_OBJECT_POOL_KINDS; ++i)
+    {
+        sObjectPoolMgr->GetStats(ObjectPoolKind(i), stats[i]);
+        PSendSysMessage("%s: %u live (" UI64FMTD " KB), %u free (" UI64FMTD " KB) in %u classes, " UI64FMTD " allocations (%.1f/s), %.1f%% reused",
+            kindNames[i], stats[i].live, stats[i].liveBytes / 1024, stats[i].free, stats[i].freeBytes / 1024, stats[i].sizes,
+            stats[i].allocations, age ? double(stats[i].allocations) * IN_MILLISECONDS / age : 0.0,
+            stats[i].allocations ? float(stats[i].allocations - stats[i].heapAllocations) * 100.0f / float(stats[i].allocations) : 0.0f);
+    }
+
+    // the creature itself and its two update field arrays; auras, spells and the like come on top
+    ObjectPoolStats const& creatures = stats[OBJECT_POOL_CREATURE];
+    if (creatures.live)
+        PSendSysMessage("Memory per creature: " UI64FMTD " bytes", creatures.liveBytes / creatures.live + 2 * UNIT_END * sizeof(uint32));
+    return true;
+}
+
+bool ChatHandler::HandleDebugProfilerCommand(const char * args)
+{
+    char* action = strtok((char*)args, " ");
+    if (action)
+    {
+        std::string arg = action;
+        if (arg == "on" || arg == "off")
+        {
+            sTickProfiler->SetEnabled(arg == "on");
+            PSendSysMessage("Tick profiler %s.", arg == "on" ? "enabled" : "disabled");
+            return true;
+        }
+
+        if (arg == "reset")
+        {
+            sTickProfiler->Reset();
+            SendSysMessage("Tick profiler buffers cleared.");
+            return true;
+        }
+
+        if (arg == "dump")
+        {
+            char* fileStr = strtok(NULL, " ");
+
+            // a plain file name, the trace always goes to the logs directory
+            if (fileStr && (strpbrk(fileStr, "/\\:") || strstr(fileStr, "..")))
+            {
+                SendSysMessage(LANG_BAD_VALUE);
+                SetSentErrorMessage(true);
+                return false;
+            }
+
+            std::string fileName = sLog->GetLogsDir() + (fileStr ? fileStr : "tickprofile.json");
+
+            uint32 events;
+            if (!sTickProfiler->DumpChromeTrace(fileName.c_str(), events))
+            {
+                PSendSysMessage("Cannot write %s.", fileName.c_str());
+                SetSentErrorMessage(true);
+                return false;
+            }
+
+            PSendSysMessage("%u zones written to %s in Chrome trace format.", events, fileName.c_str());
+            return true;
+        }
+
+        return false;
+    }
+
+    TickProfileZoneStats stats[MAX_PROFILE_ZONES];
+    uint64 window;
+    sTickProfiler->GetZoneStats(stats, window);
+
+    PSendSysMessage("Tick profiler %s, last %.1f s, times in ms (p50 / p95 / p99 / max, total)",
+        sTickProfiler->IsEnabled() ? "enabled" : "disabled", float(window) / 1000000.0f);
+    for (uint8 i = 0; i < MAX_PROFILE_ZONES; ++i)
+    {
+        if (!stats[i].count)
+            continue;
+
+        PSendSysMessage("%s x%u: %.2f / %.2f / %.2f / %.2f, %.1f", TickProfiler::GetZoneName(TickProfileZone(i)), stats[i].count,
+            stats[i].p50 / 1000.0f, stats[i].p95 / 1000.0f, stats[i].p99 / 1000.0f, stats[i].max / 1000.0f, float(stats[i].total) / 1000.0f);
+    }
+
+    std::vector<TickProfileMapStats> maps;
+    sTickProfiler->GetMapStats(maps);
+    for (uint32 i = 0; i < maps.size() && i < 5; ++i)
+        PSendSysMessage("Map %u (instance %u) x%u: p95 %.2f, max %.2f, total %.1f", maps[i].mapId, maps[i].instanceId, maps[i].count,
+            maps[i].p95 / 1000.0f, maps[i].max / 1000.0f, float(maps[i].total) / 1000.0f);
+    return true;
+}
+
+bool ChatHandler::HandleDebugDormantCommand(const char * /*args*/)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+
+    uint32 awake = map->GetAwakeObjectCount();
+    uint32 dormant = map->GetDormantObjectCount();
+    PSendSysMessage("Objects in updated cells on map %u (instance %u), dormant objects %s", map->GetId(), map->GetInstanceId(),
+        sWorld->getConfig(CONFIG_DORMANT_OBJECTS) ? "enabled" : "disabled");
+    PSendSysMessage("Awake: %u, dormant: %u (%.1f%% skipped)", awake, dormant,
+        awake + dormant ? float(dormant) * 100.0f / float(awake + dormant) : 0.0f);
+
+    if (Creature* target = getSelectedCreature())
+        PSendSysMessage("Selected creature is %s", target->IsDormant() ? "dormant" : "awake");
+    return true;
+}
+
+bool ChatHandler::HandleDebugGridLoadCommand(const char * /*args*/)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+    GridLoadStats const& stats = map->GetGridLoadStats();
+
+    PSendSysMessage("Grid loading on map %u (instance %u), tick budget %u ms, near cells %u, %u cells pending", map->GetId(), map->GetInstanceId(),
+        sWorld->getConfig(CONFIG_GRID_LOAD_TICK_BUDGET), sWorld->getConfig(CONFIG_GRID_LOAD_NEAR_CELLS), map->GetPendingCellLoadCount());
+    PSendSysMessage("Terrain: %u tiles in %u ms", stats.terrainLoads, stats.terrainTime);
+    PSendSysMessage("Near: %u grids, %u cells, %u objects in %u ms", stats.grids, stats.nearCells, stats.nearObjects, stats.nearTime);
+    PSendSysMessage("Deferred: %u cells, %u objects in %u ms, longest tick %u ms", stats.deferredCells, stats.deferredObjects, stats.deferredTime, stats.deferredMaxTick);
+    PSendSysMessage("Early: %u cells, %u objects in %u ms", stats.forcedCells, stats.forcedObjects, stats.forcedTime);
+    return true;
+}
+
+bool ChatHandler::HandleDebugLootStatsCommand(const char * /*args*/)
+{
+    DeferredLootStats stats;
+    GetDeferredLootStats(stats);
+
+    PSendSysMessage("Creature loot since startup: %u corpses lootable, %u loots generated, %u corpses gone unopened (%.1f%% not generated)",
+        stats.taken, stats.generated, stats.discarded, stats.generated + stats.discarded ? float(stats.discarded) * 100.0f / float(stats.generated + stats.discarded) : 0.0f);
+    return true;
+}
+
 bool ChatHandler::HandleDebugThreatList(const char * /*args*/)
 {
     Creature* target = getSelectedCreature();
@@ -33,6 +33,7 @@
 #include "SystemConfig.h"
 #include "revision.h"
 #include "Util.h"
+#include "PlayerSaveScheduler.h"
 
 bool ChatHandler::HandleHelpCommand(const char* args)
 {
@@ -107,6 +108,10 @@ bool ChatHandler::HandleServerInfoCommand(const char* /*args*/)
     PSendSysMessage(LANG_CONNECTED_USERS, activeClientsNum, maxActiveClientsNum, queuedClientsNum, maxQueuedClientsNum);
     PSendSysMessage(LANG_UPTIME, str.c_str());
     PSendSysMessage("Update time diff: %u.", updateTime);
+    if (sWorld->GetLoginCount())
+        PSendSysMessage("Login time: avg %u ms, max %u ms over %u logins.", sWorld->GetLoginTimeAvg(), sWorld->GetLoginTimeMax(), sWorld->GetLoginCount());
+    PSendSysMessage("Player saves: %u queued, %u saved, avg %u ms, max %u ms from request to built row.", sPlayerSaveScheduler->GetQueueSize(),
+        sPlayerSaveScheduler->GetSaveCount(), sPlayerSaveScheduler->GetLatencyAvg(), sPlayerSaveScheduler->GetLatencyMax());
 
     return true;
 }
@@ -486,6 +486,7 @@ bool ChatHandler::HandleReloadSpellLinkedSpellCommand(const char*)
 {
     sLog->outString("Re-Loading Spell Linked Spells...");
     sSpellMgr->LoadSpellLinked();
+    sSpellMgr->LoadSpellInfoStore();
     SendGlobalGMSysMessage("DB table spell_linked_spell reloaded.");
     return true;
 }
@@ -494,6 +495,7 @@ bool ChatHandler::HandleReloadSpellProcEventCommand(const char*)
 {
     sLog->outString("Re-Loading Spell Proc Event conditions...");
     sSpellMgr->LoadSpellProcEvents();
+    sSpellMgr->LoadSpellInfoStore();
     SendGlobalGMSysMessage("DB table spell_proc_event (spell proc trigger requirements) reloaded.");
     return true;
 }
@@ -6297,6 +6299,19 @@ bool ChatHandler::HandleInstanceStatsCommand(const char* /*args*/)
     return true;
 }
 
+bool ChatHandler::HandleInstanceCleanupCommand(const char * /*args*/)
+{
+    if (!sInstanceSaveMgr->StartOnlineCleanup())
+    {
+        PSendSysMessage("Instance cleanup is already running.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    PSendSysMessage("Instance cleanup started in the background, progress is written to the server log.");
+    return true;
+}
+
 bool ChatHandler::HandleInstanceSaveDataCommand(const char * /*args*/)
 {
     Player* pl = m_session->GetPlayer();
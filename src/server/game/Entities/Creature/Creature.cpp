@@ -239,6 +239,7 @@ void Creature::RemoveCorpse(bool setSpawnTime)
     setDeathState(DEAD);
     UpdateObjectVisibility();
     loot.clear();
+    lootSnapshot.Release();
     // Should get removed later, just keep "compatibility" with scripts
     if (setSpawnTime)
         m_respawnTime = time(NULL) + m_respawnDelay;
@@ -605,6 +606,45 @@ void Creature::Update(uint32 diff)
         default:
             break;
     }
+
+    if (sWorld->getConfig(CONFIG_DORMANT_OBJECTS) && IsInWorld())
+        SleepIfIdle();
+}
+
+void Creature::SleepIfIdle()
+{
+    // summons have their own timers
+    if (m_summonMask != SUMMON_MASK_NONE || isActiveObject())
+        return;
+
+    switch (m_deathState)
+    {
+        case DEAD:
+            // waiting for the respawn time only
+            if (m_respawnTime > time(NULL))
+                SetDormant(m_respawnTime);
+            break;
+        case CORPSE:
+            // group loot rolls are counted down by the update diff
+            if (!m_groupLootTimer)
+                SetDormant(m_isDeadByDefault ? 0 : m_corpseRemoveTime);
+            break;
+        case ALIVE:
+        {
+            uint32 sleepTime = sWorld->getConfig(CONFIG_DORMANT_IDLE_CREATURE_TIME);
+            if (!sleepTime || m_isDeadByDefault || NeedChangeAI || !IsAIEnabled || !AI()->CanBeDormant())
+                break;
+
+            if (HasFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_OTHER_TAGGER) || !IsIdle())
+                break;
+
+            // woken up earlier by combat, casts, auras, movement, gossip ...
+            SetDormant(time(NULL) + sleepTime);
+            break;
+        }
+        default:
+            break;
+    }
 }
 
 void Creature::RegenerateMana()
@@ -1370,6 +1410,8 @@ float Creature::GetAttackDistance(Unit const* pl) const
 
 void Creature::setDeathState(DeathState s)
 {
+    WakeUp();
+
     if ((s == JUST_DIED && !m_isDeadByDefault)||(s == JUST_ALIVED && m_isDeadByDefault))
     {
         m_corpseRemoveTime = time(NULL) + m_corpseDelay;
@@ -1474,6 +1516,7 @@ void Creature::Respawn(bool force)
         m_respawnTime = 0;
         lootForPickPocketed = false;
         lootForBody         = false;
+        lootSnapshot.Release();
 
         if (m_originalEntry != GetEntry())
             UpdateEntry(m_originalEntry);
@@ -2083,6 +2126,7 @@ void Creature::AllLootRemovedFromCorpse()
 
         m_corpseRemoveTime -= diff;
         m_respawnTime -= diff;
+        WakeUp();
     }
 }
 
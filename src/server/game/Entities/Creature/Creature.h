@@ -29,6 +29,7 @@
 #include "DatabaseEnv.h"
 #include "Cell.h"
 #include "CreatureGroups.h"
+#include "ObjectPool.h"
 
 #include <list>
 
@@ -416,6 +417,8 @@ class Creature : public Unit, public GridObject<Creature>
         explicit Creature();
         virtual ~Creature();
 
+        DECLARE_POOLED_OBJECT(OBJECT_POOL_CREATURE)
+
         void AddToWorld();
         void RemoveFromWorld();
 
@@ -430,6 +433,7 @@ class Creature : public Unit, public GridObject<Creature>
         char const* GetSubName() const { return GetCreatureTemplate()->SubName; }
 
         void Update(uint32 time);                         // overwrited Unit::Update
+        void SleepIfIdle();                               // make dormant while Update() only waits
         void GetRespawnCoord(float &x, float &y, float &z, float* ori = NULL, float* dist =NULL) const;
         uint32 GetEquipmentId() const { return m_equipmentId; }
 
@@ -552,6 +556,7 @@ class Creature : public Unit, public GridObject<Creature>
         Loot loot;
         bool lootForPickPocketed;
         bool lootForBody;
+        LootSnapshot lootSnapshot;                          // taken at the death, lootForBody once the loot was generated from it
         Player *GetLootRecipient() const;
         bool hasLootRecipient() const { return m_lootRecipient != 0; }
 
@@ -593,7 +598,7 @@ class Creature : public Unit, public GridObject<Creature>
 
         time_t const& GetRespawnTime() const { return m_respawnTime; }
         time_t GetRespawnTimeEx() const;
-        void SetRespawnTime(uint32 respawn) { m_respawnTime = respawn ? time(NULL) + respawn : 0; }
+        void SetRespawnTime(uint32 respawn) { m_respawnTime = respawn ? time(NULL) + respawn : 0; WakeUp(); }
         void Respawn(bool force = false);
         void SaveRespawnTime();
 
@@ -383,6 +383,10 @@ void GameObject::Update(uint32 diff)
                 }
             }
 
+            // nothing left to do but wait for the respawn/despawn time
+            if (m_lootState == GO_READY && GetGoType() != GAMEOBJECT_TYPE_TRAP && !GetGOInfo()->GetCharges() &&
+                sWorld->getConfig(CONFIG_DORMANT_OBJECTS) && !isActiveObject())
+                SetDormant(m_respawnTime);
             break;
         }
         case GO_ACTIVATED:
@@ -800,6 +804,7 @@ void GameObject::Respawn()
     {
         m_respawnTime = time(NULL);
         sObjectMgr->SaveGORespawnTime(m_DBTableGuid, GetInstanceId(), 0);
+        WakeUp();
     }
 }
 
@@ -26,6 +26,7 @@
 #include "Object.h"
 #include "LootMgr.h"
 #include "DatabaseEnv.h"
+#include "ObjectPool.h"
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push, N), also any gcc version not support it at some platform
 #if defined(__GNUC__)
@@ -456,6 +457,8 @@ class GameObject : public WorldObject, public GridObject<GameObject>
         explicit GameObject();
         ~GameObject();
 
+        DECLARE_POOLED_OBJECT(OBJECT_POOL_GAMEOBJECT)
+
         void AddToWorld();
         void RemoveFromWorld();
         void CleanupsBeforeDelete();
@@ -558,6 +561,7 @@ class GameObject : public WorldObject, public GridObject<GameObject>
         {
             m_respawnTime = respawn > 0 ? time(NULL) + respawn : 0;
             m_respawnDelayTime = respawn > 0 ? respawn : 0;
+            WakeUp();
         }
         void Respawn();
         bool isSpawned() const
@@ -584,7 +588,7 @@ class GameObject : public WorldObject, public GridObject<GameObject>
         void Use(Unit* user);
 
         LootState getLootState() const { return m_lootState; }
-        void SetLootState(LootState s) { m_lootState = s; }
+        void SetLootState(LootState s) { m_lootState = s; WakeUp(); }
 
         void AddToSkillupList(uint32 PlayerGuidLow) { m_SkillupList.push_back(PlayerGuidLow); }
         bool IsInSkillupList(uint32 PlayerGuidLow) const
@@ -46,6 +46,7 @@
 #include "TemporarySummon.h"
 #include "Totem.h"
 #include "OutdoorPvPMgr.h"
+#include "ObjectPool.h"
 
 uint32 GuidHigh2TypeId(uint32 guid_hi)
 {
@@ -106,16 +107,16 @@ Object::~Object()
         ASSERT(false);
     }
 
-    delete [] m_uint32Values;
-    delete [] m_uint32Values_mirror;
+    sObjectPoolMgr->Release(m_uint32Values);
+    sObjectPoolMgr->Release(m_uint32Values_mirror);
 }
 
 void Object::_InitValues()
 {
-    m_uint32Values = new uint32[ m_valuesCount ];
+    m_uint32Values = static_cast<uint32*>(sObjectPoolMgr->Allocate(OBJECT_POOL_VALUES, m_valuesCount*sizeof(uint32)));
     memset(m_uint32Values, 0, m_valuesCount*sizeof(uint32));
 
-    m_uint32Values_mirror = new uint32[ m_valuesCount ];
+    m_uint32Values_mirror = static_cast<uint32*>(sObjectPoolMgr->Allocate(OBJECT_POOL_VALUES, m_valuesCount*sizeof(uint32)));
     memset(m_uint32Values_mirror, 0, m_valuesCount*sizeof(uint32));
 
     m_objectUpdated = false;
@@ -1110,6 +1111,7 @@ WorldObject::WorldObject()
     , m_isActive(false), m_isWorldObject(false)
     , m_name("")
     , m_notifyflags(0), m_executed_notifies(0)
+    , m_isDormant(false), m_dormantWakeTime(0)
 {
     m_groupLootTimer    = 0;
     lootingGroupLeaderGUID = 0;
@@ -1585,6 +1587,25 @@ void WorldObject::SendGameObjectCustomAnim(uint64 guid)
     SendMessageToSet(&data, true);
 }
 
+void WorldObject::AddToWorld()
+{
+    // register for the map local guid lookups
+    if (!IsInWorld() && m_currMap)
+        m_currMap->AddToObjectIndex(this);
+
+    WakeUp();
+
+    Object::AddToWorld();
+}
+
+void WorldObject::RemoveFromWorld()
+{
+    if (IsInWorld() && m_currMap)
+        m_currMap->RemoveFromObjectIndex(this);
+
+    Object::RemoveFromWorld();
+}
+
 void WorldObject::SetMap(Map * map)
 {
     ASSERT(map);
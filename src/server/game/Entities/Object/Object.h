@@ -559,6 +559,9 @@ class WorldObject : public Object, public WorldLocation
 
         virtual void Update (uint32 /*time_diff*/) { }
 
+        void AddToWorld();
+        void RemoveFromWorld();
+
         void _Create(uint32 guidlow, HighGuid guidhigh);
 
         void GetNearPoint2D(float &x, float &y, float distance, float absAngle) const;
@@ -757,6 +760,19 @@ class WorldObject : public Object, public WorldLocation
         bool isActiveObject() const { return m_isActive; }
         void setActive(bool isActiveObject);
         void SetWorldObject(bool apply);
+
+        // Dormant objects are skipped by the map update until their wake time
+        // (0 = until WakeUp()); only used in states where Update() waits for a
+        // timestamp and does not consume the update diff
+        void SetDormant(time_t wakeTime) { m_isDormant = true; m_dormantWakeTime = wakeTime; }
+        void WakeUp() { m_isDormant = false; }
+        bool IsDormant() const { return m_isDormant; }
+        bool UpdateDormancy(time_t now)
+        {
+            if (m_isDormant && m_dormantWakeTime && m_dormantWakeTime <= now)
+                m_isDormant = false;
+            return m_isDormant;
+        }
         template<class NOTIFIER> void VisitNearbyObject(const float &radius, NOTIFIER &notifier) const { GetMap()->VisitAll(GetPositionX(), GetPositionY(), radius, notifier); }
         template<class NOTIFIER> void VisitNearbyGridObject(const float &radius, NOTIFIER &notifier) const { GetMap()->VisitGrid(GetPositionX(), GetPositionY(), radius, notifier); }
         template<class NOTIFIER> void VisitNearbyWorldObject(const float &radius, NOTIFIER &notifier) const { GetMap()->VisitWorld(GetPositionX(), GetPositionY(), radius, notifier); }
@@ -788,6 +804,9 @@ class WorldObject : public Object, public WorldLocation
 
         uint16 m_notifyflags;
         uint16 m_executed_notifies;
+
+        bool m_isDormant;
+        time_t m_dormantWakeTime;
 };
 
 namespace Trinity
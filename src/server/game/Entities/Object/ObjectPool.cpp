@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ObjectPool.h"
+#include "Timer.h"
+
+#include <ace/Guard_T.h>
+#include <new>
+
+// in front of every block, tells Release the pool without trusting the size of the deleted type;
+// 16 bytes keep the block behind it aligned like the heap would
+union PoolBlockHeader
+{
+    void* pool;
+    double align[2];
+};
+
+ObjectPoolMgr::ObjectPoolMgr() : m_maxFreeBlocks(0), m_statsTime(getMSTime())
+{
+}
+
+ObjectPoolMgr::~ObjectPoolMgr()
+{
+    for (PoolMap::iterator itr = m_pools.begin(); itr != m_pools.end(); ++itr)
+    {
+        for (std::vector<void*>::iterator block = itr->second->freeBlocks.begin(); block != itr->second->freeBlocks.end(); ++block)
+            ::operator delete(*block);
+
+        // blocks still in use keep pointing at their pool
+        if (!itr->second->live)
+            delete itr->second;
+    }
+}
+
+void* ObjectPoolMgr::Allocate(ObjectPoolKind kind, size_t size)
+{
+    Pool* pool;
+    void* block = NULL;
+    {
+        // backs operator new, which must not return NULL
+        ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+        if (!guard.locked())
+            throw std::bad_alloc();
+
+        Pool*& entry = m_pools[std::make_pair(uint32(kind), size)];
+        if (!entry)
+            entry = new Pool(size);
+        pool = entry;
+
+        ++pool->live;
+        ++pool->allocations;
+        if (!pool->freeBlocks.empty())
+        {
+            block = pool->freeBlocks.back();
+            pool->freeBlocks.pop_back();
+        }
+        else
+            ++pool->heapAllocations;
+    }
+
+    if (!block)
+    {
+        block = ::operator new(sizeof(PoolBlockHeader) + size);
+        static_cast<PoolBlockHeader*>(block)->pool = pool;
+    }
+
+    return static_cast<PoolBlockHeader*>(block) + 1;
+}
+
+void ObjectPoolMgr::Release(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    PoolBlockHeader* block = static_cast<PoolBlockHeader*>(ptr) - 1;
+    Pool* pool = static_cast<Pool*>(block->pool);
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        --pool->live;
+        if (pool->freeBlocks.size() < m_maxFreeBlocks)
+        {
+            pool->freeBlocks.push_back(block);
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+void ObjectPoolMgr::GetStats(ObjectPoolKind kind, ObjectPoolStats& stats)
+{
+    stats = ObjectPoolStats();
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    for (PoolMap::const_iterator itr = m_pools.lower_bound(std::make_pair(uint32(kind), size_t(0)));
+        itr != m_pools.end() && itr->first.first == uint32(kind); ++itr)
+    {
+        Pool const* pool = itr->second;
+        ++stats.sizes;
+        stats.live += pool->live;
+        stats.free += pool->freeBlocks.size();
+        stats.liveBytes += uint64(pool->live) * pool->size;
+        stats.freeBytes += uint64(pool->freeBlocks.size()) * pool->size;
+        stats.allocations += pool->allocations;
+        stats.heapAllocations += pool->heapAllocations;
+    }
+}
+
+uint32 ObjectPoolMgr::GetStatsAge() const
+{
+    return getMSTimeDiff(m_statsTime, getMSTime());
+}
+
+void ObjectPoolMgr::ResetStats()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    for (PoolMap::iterator itr = m_pools.begin(); itr != m_pools.end(); ++itr)
+    {
+        itr->second->allocations = 0;
+        itr->second->heapAllocations = 0;
+    }
+    m_statsTime = getMSTime();
+}
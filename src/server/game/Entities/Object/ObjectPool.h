@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _OBJECT_POOL_H
+#define _OBJECT_POOL_H
+
+#include "Define.h"
+
+#include <ace/Null_Mutex.h>
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+#include <map>
+#include <vector>
+
+enum ObjectPoolKind
+{
+    OBJECT_POOL_CREATURE,                                   // Creature and everything derived from it
+    OBJECT_POOL_GAMEOBJECT,                                 // GameObject and Transport
+    OBJECT_POOL_VALUES,                                     // update field arrays of all objects
+    OBJECT_POOL_AI,
+    OBJECT_POOL_MOVEMENT,                                   // movement generators
+    MAX_OBJECT_POOL_KINDS
+};
+
+struct ObjectPoolStats
+{
+    ObjectPoolStats() : sizes(0), live(0), free(0), liveBytes(0), freeBytes(0), allocations(0), heapAllocations(0) {}
+
+    uint32 sizes;                                           // distinct block sizes, one per derived class
+    uint32 live;                                            // blocks in use
+    uint32 free;                                            // released blocks kept for reuse
+    uint64 liveBytes;
+    uint64 freeBytes;
+    uint64 allocations;                                     // since the last reset
+    uint64 heapAllocations;                                 // of them taken from the heap, no kept block fitting
+};
+
+/*
+ * Keeps released world objects, their update field arrays, AIs and movement
+ * generators in free lists per kind and block size, so that the objects of a
+ * grid unloaded and loaded again, respawns and summons reuse the memory of
+ * the ones before instead of going through the heap each time. At most
+ * ObjectPool.MaxFreeBlocks blocks are kept per size, the rest goes back to
+ * the heap. Thread safe, map threads create and delete objects in parallel.
+ */
+class ObjectPoolMgr
+{
+    friend class ACE_Singleton<ObjectPoolMgr, ACE_Null_Mutex>;
+
+    ObjectPoolMgr();
+    ~ObjectPoolMgr();
+
+    public:
+        void* Allocate(ObjectPoolKind kind, size_t size);
+        // any block of Allocate, whichever type it is deleted as
+        void Release(void* ptr);
+
+        void SetMaxFreeBlocks(uint32 count) { m_maxFreeBlocks = count; }
+
+        void GetStats(ObjectPoolKind kind, ObjectPoolStats& stats);
+        // ms since the allocation counters were reset
+        uint32 GetStatsAge() const;
+        void ResetStats();
+
+    private:
+        struct Pool
+        {
+            Pool(size_t _size) : size(_size), live(0), allocations(0), heapAllocations(0) {}
+
+            size_t size;
+            std::vector<void*> freeBlocks;
+            uint32 live;
+            uint64 allocations;
+            uint64 heapAllocations;
+        };
+        typedef std::map<std::pair<uint32, size_t>, Pool*> PoolMap;
+
+        ACE_Thread_Mutex m_lock;
+        PoolMap m_pools;
+        uint32 m_maxFreeBlocks;
+        uint32 m_statsTime;
+};
+
+#define sObjectPoolMgr ACE_Singleton<ObjectPoolMgr, ACE_Null_Mutex>::instance()
+
+// class operators routing every new and delete of the class and its derived classes through the pool of kind
+#define DECLARE_POOLED_OBJECT(kind) \
+    static void* operator new(size_t size) { return sObjectPoolMgr->Allocate(kind, size); } \
+    static void operator delete(void* ptr) { sObjectPoolMgr->Release(ptr); }
+
+#endif
@@ -65,10 +65,12 @@
 #include "SocialMgr.h"
 #include "Mail.h"
 #include "GameEventMgr.h"
+#include "PlayerSaveScheduler.h"
 
 #include <cmath>
 
 #define ZONE_UPDATE_INTERVAL (1*IN_MILLISECONDS)
+#define MOVEMENT_HEARTBEAT_PRUNE_INTERVAL (10*IN_MILLISECONDS)
 
 #define PLAYER_SKILL_INDEX(x)       (PLAYER_SKILL_INFO_1_1 + ((x)*3))
 #define PLAYER_SKILL_VALUE_INDEX(x) (PLAYER_SKILL_INDEX(x)+1)
@@ -291,6 +293,8 @@ Player::Player (WorldSession *session): Unit()
 
     m_areaUpdateId = 0;
 
+    m_movementHeartbeatPruneTimer = MOVEMENT_HEARTBEAT_PRUNE_INTERVAL;
+
     m_nextSave = sWorld->getConfig(CONFIG_INTERVAL_SAVE);
 
     clearResurrectRequestData();
@@ -1227,6 +1231,23 @@ void Player::Update(uint32 p_time)
             m_zoneUpdateTimer -= p_time;
     }
 
+    if (p_time >= m_movementHeartbeatPruneTimer)
+    {
+        // movers out of sight or gone, their next heartbeat is due anyway
+        uint32 now = getMSTime();
+        uint32 maxAge = 2 * sWorld->getConfig(CONFIG_MOVEMENT_TIER_FAR_INTERVAL);
+        for (MovementHeartbeatTimes::iterator itr = m_movementHeartbeatTimes.begin(); itr != m_movementHeartbeatTimes.end();)
+        {
+            if (getMSTimeDiff(itr->second, now) > maxAge)
+                m_movementHeartbeatTimes.erase(itr++);
+            else
+                ++itr;
+        }
+        m_movementHeartbeatPruneTimer = MOVEMENT_HEARTBEAT_PRUNE_INTERVAL;
+    }
+    else
+        m_movementHeartbeatPruneTimer -= p_time;
+
     if (m_timeSyncTimer > 0)
     {
         if (p_time >= m_timeSyncTimer)
@@ -1247,9 +1268,10 @@ void Player::Update(uint32 p_time)
     {
         if (p_time >= m_nextSave)
         {
-            // m_nextSave reseted in SaveToDB call
-            SaveToDB();
-            sLog->outDetail("Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
+            // the save itself is paced by the scheduler, which resets m_nextSave again;
+            // if it drops the request (player gone from world) the next interval asks again
+            m_nextSave = sWorld->getConfig(CONFIG_INTERVAL_SAVE);
+            sPlayerSaveScheduler->RequestSave(GetGUIDLow());
         }
         else
             m_nextSave -= p_time;
@@ -2110,7 +2132,8 @@ Creature* Player::GetNPCIfCanInteractWith(uint64 guid, uint32 npcflagmask)
                 if (faction->reputationListID >= 0 && GetReputationRank(faction) <= REP_UNFRIENDLY)
                     return NULL;
 
-    // not too far
+    // not too far, from where it really is on its path
+    unit->GetMotionMaster()->SyncPosition();
     if (!unit->IsWithinDistInMap(this, INTERACTION_DISTANCE))
         return NULL;
 
@@ -7827,10 +7850,20 @@ void Player::SendLoot(uint64 guid, LootType loot_type)
                 creature->lootForBody = true;
                 loot->clear();
 
-                if (uint32 lootid = creature->GetCreatureTemplate()->lootid)
-                    loot->FillLoot(lootid, LootTemplates_Creature, recipient);
+                // same rolls and quest drops as at the death
+                LootSnapshot* snapshot = creature->lootSnapshot.taken ? &creature->lootSnapshot : NULL;
+                RandomStream stream(snapshot ? snapshot->seed : 0);
+                {
+                    RandomStreamSelector selector(snapshot ? &stream : GetSelectedRandomStream());
 
-                loot->generateMoneyLoot(creature->GetCreatureTemplate()->mingold, creature->GetCreatureTemplate()->maxgold);
+                    if (uint32 lootid = creature->GetCreatureTemplate()->lootid)
+                        loot->FillLoot(lootid, LootTemplates_Creature, recipient, snapshot);
+
+                    loot->generateMoneyLoot(creature->GetCreatureTemplate()->mingold, creature->GetCreatureTemplate()->maxgold);
+                }
+
+                if (snapshot)
+                    snapshot->SetGenerated();
 
                 if (Group* group = recipient->GetGroup())
                 {
@@ -15533,6 +15566,9 @@ void Player::_LoadMailInit(QueryResult_AutoPtr resultUnread, QueryResult_AutoPtr
 
 void Player::_LoadMail()
 {
+    // after the expired mail batch in progress, the next ones leave this mailbox alone
+    sObjectMgr->SkipOldMails(GetGUIDLow());
+
     m_mail.clear();
     //mails are in right order                                    0  1           2      3        4       5          6         7           8            9     10  11      12         13
     QueryResult_AutoPtr result = CharacterDatabase.PQuery("SELECT id, messageType, sender, receiver, subject, itemTextId, has_items, expire_time, deliver_time, money, cod, checked, stationery, mailTemplateId FROM mail WHERE receiver = '%u' ORDER BY id DESC", GetGUIDLow());
@@ -16269,7 +16305,7 @@ bool Player::_LoadHomeBind(QueryResult_AutoPtr result)
 /***                   SAVE SYSTEM                     ***/
 /*********************************************************/
 
-void Player::SaveToDB()
+void Player::SaveToDB(bool async)
 {
     // delay auto save at any saves (manual, in code, or autosave)
     m_nextSave = sWorld->getConfig(CONFIG_INTERVAL_SAVE);
@@ -16290,9 +16326,6 @@ void Player::SaveToDB()
     if (!me || me->IsBattleArena())
         return;
 
-    int is_save_resting = HasFlag(PLAYER_FLAGS, PLAYER_FLAGS_RESTING) ? 1 : 0;
-                                                            //save, far from tavern/city
-                                                            //save, but in tavern/city
     sLog->outDebug("The value of player %s at save: ", m_name.c_str());
     outDebugValues();
 
@@ -16310,9 +16343,124 @@ void Player::SaveToDB()
     RemoveFlag(UNIT_FIELD_FLAGS, UNIT_FLAG_STUNNED);
     SetDisplayId(GetNativeDisplayId());
 
-    bool inworld = IsInWorld();
+    PlayerSaveData* data = new PlayerSaveData;
+    data->guid = GetGUIDLow();
+    data->account = GetSession()->GetAccountId();
+    data->name = m_name;
+    data->race = getRace();
+    data->class_ = getClass();
+    data->gender = getGender();
+    data->level = getLevel();
+    data->xp = GetUInt32Value(PLAYER_XP);
+    data->money = GetMoney();
+    data->playerBytes = GetUInt32Value(PLAYER_BYTES);
+    data->playerBytes2 = GetUInt32Value(PLAYER_BYTES_2);
+    data->playerFlags = GetUInt32Value(PLAYER_FLAGS);
+
+    if (!IsBeingTeleported())
+    {
+        data->map = GetMapId();
+        data->instanceId = GetInstanceId();
+        data->posX = GetPositionX();
+        data->posY = GetPositionY();
+        data->posZ = GetPositionZ();
+        data->orientation = GetOrientation();
+    }
+    else
+    {
+        data->map = GetTeleportDest().GetMapId();
+        data->instanceId = 0;
+        data->posX = GetTeleportDest().GetPositionX();
+        data->posY = GetTeleportDest().GetPositionY();
+        data->posZ = GetTeleportDest().GetPositionZ();
+        data->orientation = GetTeleportDest().GetOrientation();
+    }
+    data->difficulty = GetDifficulty();
+
+    data->values.assign(m_uint32Values, m_uint32Values + m_valuesCount);
+
+    for (uint8 i = 0; i < 8; ++i)
+        data->taximask[i] = m_taxi.GetTaximask(i);
+
+    data->online = IsInWorld();
+    data->cinematic = m_cinematic;
+    data->totalTime = m_Played_time[PLAYED_TIME_TOTAL];
+    data->levelTime = m_Played_time[PLAYED_TIME_LEVEL];
+    data->restBonus = m_rest_bonus;
+    data->logoutTime = uint64(time(NULL));
+    data->resting = HasFlag(PLAYER_FLAGS, PLAYER_FLAGS_RESTING);
+    data->resetTalentsCost = m_resetTalentsCost;
+    data->resetTalentsTime = uint64(m_resetTalentsTime);
+    data->transX = m_movementInfo.GetTransportPos()->GetPositionX();
+    data->transY = m_movementInfo.GetTransportPos()->GetPositionY();
+    data->transZ = m_movementInfo.GetTransportPos()->GetPositionZ();
+    data->transO = m_movementInfo.GetTransportPos()->GetOrientation();
+    data->transGuid = m_transport ? m_transport->GetGUIDLow() : 0;
+    data->extraFlags = m_ExtraFlags;
+    data->stableSlots = m_stableSlots;
+    data->atLoginFlags = m_atLoginFlags;
+    data->zone = GetZoneId();
+    data->deathExpireTime = uint64(m_deathExpireTime);
+    data->taxiPath = m_taxi.SaveTaxiDestinationsToString();
+    data->arenaPoints = GetArenaPoints();
+    data->totalHonorPoints = GetHonorPoints();
+    data->todayHonorPoints = GetUInt32Value(PLAYER_FIELD_TODAY_CONTRIBUTION);
+    data->yesterdayHonorPoints = GetUInt32Value(PLAYER_FIELD_YESTERDAY_CONTRIBUTION);
+    data->totalKills = GetUInt32Value(PLAYER_FIELD_LIFETIME_HONORABLE_KILLS);
+    data->todayKills = GetUInt16Value(PLAYER_FIELD_KILLS, 0);
+    data->yesterdayKills = GetUInt16Value(PLAYER_FIELD_KILLS, 1);
+    data->chosenTitle = GetUInt32Value(PLAYER_CHOSEN_TITLE);
+    data->watchedFaction = GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX);
+    data->drunk = uint16(GetUInt32Value(PLAYER_BYTES_3) & 0xFFFE);
+    data->health = GetHealth();
+    for (uint8 i = 0; i < MAX_POWERS; ++i)
+        data->power[i] = GetPower(Powers(i));
+    data->latency = GetSession()->GetLatency();
+
+    CharacterDatabase.BeginTransaction();
+
+    if (m_mailsUpdated)                                     //save mails only when needed
+        _SaveMail();
+
+    _SaveBGData();
+    _SaveInventory();
+    _SaveQuestStatus();
+    _SaveDailyQuestStatus();
+    _SaveTutorials();
+    _SaveSpells();
+    _SaveSpellCooldowns();
+    _SaveActions();
+    _SaveAuras();
+    _SaveSkills();
+    _SaveReputation();
+
+    // the `characters` row goes last into the transaction, with async the transaction is queued now
+    // and a save worker appends the row; without a delay thread there is nothing to hand over
+    SqlTransaction* trans = async ? CharacterDatabase.DetachTransaction() : NULL;
+    if (trans)
+        sPlayerSaveScheduler->QueueSave(data, trans);
+    else
+    {
+        CharacterDatabase.Execute(BuildSaveQuery(*data).c_str());
+        CharacterDatabase.CommitTransaction();
+        delete data;
+    }
+
+    // restore state (before aura apply, if aura remove flag then aura must set it ack by self)
+    SetDisplayId(tmp_displayid);
+    SetUInt32Value(UNIT_FIELD_BYTES_1, tmp_bytes);
+    SetUInt32Value(UNIT_FIELD_BYTES_2, tmp_bytes2);
+    SetUInt32Value(UNIT_FIELD_FLAGS, tmp_flags);
+    SetUInt32Value(PLAYER_FLAGS, tmp_pflags);
+
+    // save pet (hunter pet level and experience and all type pets health/mana).
+    if (Pet* pet = GetPet())
+        pet->SavePetToDB(PET_SAVE_AS_CURRENT);
+}
 
-    std::string sql_name = m_name;
+std::string Player::BuildSaveQuery(PlayerSaveData const& data)
+{
+    std::string sql_name = data.name;
     CharacterDatabase.EscapeString(sql_name);
 
     std::ostringstream ss;
@@ -16324,146 +16472,97 @@ void Player::SaveToDB()
         "death_expire_time, taxi_path, arenaPoints, totalHonorPoints, todayHonorPoints, yesterdayHonorPoints, "
         "totalKills, todayKills, yesterdayKills, chosenTitle, watchedFaction, drunk, health, "
         "powerMana, powerRage, powerFocus, powerEnergy, powerHappiness, latency) VALUES ("
-        << GetGUIDLow() << ", "
-        << GetSession()->GetAccountId() << ", '"
+        << data.guid << ", "
+        << data.account << ", '"
         << sql_name << "', "
-        << uint32(getRace()) << ", "
-        << uint32(getClass()) << ", "
-        << uint32(getGender()) << ", "
-        << uint32(getLevel()) << ", "
-        << GetUInt32Value(PLAYER_XP) << ", "
-        << GetMoney() << ", "
-        << GetUInt32Value(PLAYER_BYTES) << ", "
-        << GetUInt32Value(PLAYER_BYTES_2) << ", "
-        << GetUInt32Value(PLAYER_FLAGS) << ", ";
-
-    if (!IsBeingTeleported())
-    {
-        ss << GetMapId() << ", "
-        << (uint32)GetInstanceId() << ", "
-        << (uint32)GetDifficulty() << ", "
-        << finiteAlways(GetPositionX()) << ", "
-        << finiteAlways(GetPositionY()) << ", "
-        << finiteAlways(GetPositionZ()) << ", "
-        << finiteAlways(GetOrientation()) << ", '";
-    }
-    else
-    {
-        ss << GetTeleportDest().GetMapId() << ", "
-        << (uint32)0 << ", "
-        << (uint32)GetDifficulty() << ", "
-        << finiteAlways(GetTeleportDest().GetPositionX()) << ", "
-        << finiteAlways(GetTeleportDest().GetPositionY()) << ", "
-        << finiteAlways(GetTeleportDest().GetPositionZ()) << ", "
-        << finiteAlways(GetTeleportDest().GetOrientation()) << ", '";
-    }
-
-    uint16 i;
-    for (i = 0; i < m_valuesCount; ++i)
-        ss << GetUInt32Value(i) << " ";
+        << uint32(data.race) << ", "
+        << uint32(data.class_) << ", "
+        << uint32(data.gender) << ", "
+        << uint32(data.level) << ", "
+        << data.xp << ", "
+        << data.money << ", "
+        << data.playerBytes << ", "
+        << data.playerBytes2 << ", "
+        << data.playerFlags << ", ";
+
+    ss << data.map << ", "
+    << data.instanceId << ", "
+    << data.difficulty << ", "
+    << finiteAlways(data.posX) << ", "
+    << finiteAlways(data.posY) << ", "
+    << finiteAlways(data.posZ) << ", "
+    << finiteAlways(data.orientation) << ", '";
+
+    for (size_t i = 0; i < data.values.size(); ++i)
+        ss << data.values[i] << " ";
 
     ss << "', '";
 
-    for (i = 0; i < 8; i++)
-        ss << m_taxi.GetTaximask(i) << " ";
+    for (uint8 i = 0; i < 8; ++i)
+        ss << data.taximask[i] << " ";
 
     ss << "', ";
-    ss << (IsInWorld() ? 1 : 0) << ", ";
+    ss << (data.online ? 1 : 0) << ", ";
 
-    ss << m_cinematic << ", ";
+    ss << data.cinematic << ", ";
 
-    ss << m_Played_time[PLAYED_TIME_TOTAL] << ", ";
-    ss << m_Played_time[PLAYED_TIME_LEVEL] << ", ";
+    ss << data.totalTime << ", ";
+    ss << data.levelTime << ", ";
 
-    ss << finiteAlways(m_rest_bonus) << ", ";
-    ss << (uint64)time(NULL) << ", ";
-    ss << is_save_resting << ", ";
-    ss << m_resetTalentsCost << ", ";
-    ss << (uint64)m_resetTalentsTime << ", ";
+    ss << finiteAlways(data.restBonus) << ", ";
+    ss << data.logoutTime << ", ";
+    ss << (data.resting ? 1 : 0) << ", ";
+    ss << data.resetTalentsCost << ", ";
+    ss << data.resetTalentsTime << ", ";
 
-    ss << finiteAlways(m_movementInfo.GetTransportPos()->GetPositionX()) << ", ";
-    ss << finiteAlways(m_movementInfo.GetTransportPos()->GetPositionY()) << ", ";
-    ss << finiteAlways(m_movementInfo.GetTransportPos()->GetPositionZ()) << ", ";
-    ss << finiteAlways(m_movementInfo.GetTransportPos()->GetOrientation()) << ", ";
-    if (m_transport)
-        ss << m_transport->GetGUIDLow();
-    else
-        ss << "0";
-
-    ss << ", ";
+    ss << finiteAlways(data.transX) << ", ";
+    ss << finiteAlways(data.transY) << ", ";
+    ss << finiteAlways(data.transZ) << ", ";
+    ss << finiteAlways(data.transO) << ", ";
+    ss << data.transGuid << ", ";
 
-    ss << m_ExtraFlags << ", ";
+    ss << data.extraFlags << ", ";
 
-    ss << uint32(m_stableSlots) << ", ";                    // to prevent save uint8 as char
+    ss << data.stableSlots << ", ";
 
-    ss << uint32(m_atLoginFlags) << ", ";
+    ss << data.atLoginFlags << ", ";
 
-    ss << GetZoneId() << ", ";
+    ss << data.zone << ", ";
 
-    ss << (uint64)m_deathExpireTime << ", '";
+    ss << data.deathExpireTime << ", '";
 
-    ss << m_taxi.SaveTaxiDestinationsToString() << "', ";
+    ss << data.taxiPath << "', ";
 
-    ss << GetArenaPoints() << ", ";
+    ss << data.arenaPoints << ", ";
 
-    ss << GetHonorPoints() << ", ";
+    ss << data.totalHonorPoints << ", ";
 
-    ss << GetUInt32Value(PLAYER_FIELD_TODAY_CONTRIBUTION) << ", ";
+    ss << data.todayHonorPoints << ", ";
 
-    ss << GetUInt32Value(PLAYER_FIELD_YESTERDAY_CONTRIBUTION) << ", ";
+    ss << data.yesterdayHonorPoints << ", ";
 
-    ss << GetUInt32Value(PLAYER_FIELD_LIFETIME_HONORABLE_KILLS) << ", ";
+    ss << data.totalKills << ", ";
 
-    ss << GetUInt16Value(PLAYER_FIELD_KILLS, 0) << ", ";
+    ss << data.todayKills << ", ";
 
-    ss << GetUInt16Value(PLAYER_FIELD_KILLS, 1) << ", ";
+    ss << data.yesterdayKills << ", ";
 
-    ss << GetUInt32Value(PLAYER_CHOSEN_TITLE) << ", ";
+    ss << data.chosenTitle << ", ";
 
-    ss << GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX) << ", ";
+    ss << data.watchedFaction << ", ";
 
-    ss << (uint16)(GetUInt32Value(PLAYER_BYTES_3) & 0xFFFE) << ", ";
+    ss << data.drunk << ", ";
 
-    ss << GetHealth();
+    ss << data.health;
 
     for (uint32 i = 0; i < MAX_POWERS; ++i)
-        ss << ", " << GetPower(Powers(i));
+        ss << ", " << data.power[i];
     ss << ", '";
 
-    ss << GetSession()->GetLatency();
+    ss << data.latency;
     ss << "')";
 
-    CharacterDatabase.BeginTransaction();
-
-    CharacterDatabase.Execute(ss.str().c_str());
-
-    if (m_mailsUpdated)                                     //save mails only when needed
-        _SaveMail();
-
-    _SaveBGData();
-    _SaveInventory();
-    _SaveQuestStatus();
-    _SaveDailyQuestStatus();
-    _SaveTutorials();
-    _SaveSpells();
-    _SaveSpellCooldowns();
-    _SaveActions();
-    _SaveAuras();
-    _SaveSkills();
-    _SaveReputation();
-
-    CharacterDatabase.CommitTransaction();
-
-    // restore state (before aura apply, if aura remove flag then aura must set it ack by self)
-    SetDisplayId(tmp_displayid);
-    SetUInt32Value(UNIT_FIELD_BYTES_1, tmp_bytes);
-    SetUInt32Value(UNIT_FIELD_BYTES_2, tmp_bytes2);
-    SetUInt32Value(UNIT_FIELD_FLAGS, tmp_flags);
-    SetUInt32Value(PLAYER_FLAGS, tmp_pflags);
-
-    // save pet (hunter pet level and experience and all type pets health/mana).
-    if (Pet* pet = GetPet())
-        pet->SavePetToDB(PET_SAVE_AS_CURRENT);
+    return ss.str();
 }
 
 // fast save function for item/money cheating preventing - save only inventory and money state
@@ -20657,6 +20756,22 @@ void Player::ResetTimeSync()
     m_timeSyncServer = getMSTime();
 }
 
+bool Player::IsMovementHeartbeatDue(uint64 mover, uint32 now, uint32 interval)
+{
+    MovementHeartbeatTimes::iterator itr = m_movementHeartbeatTimes.find(mover);
+    if (itr == m_movementHeartbeatTimes.end())
+    {
+        m_movementHeartbeatTimes[mover] = now;
+        return true;
+    }
+
+    if (getMSTimeDiff(itr->second, now) < interval)
+        return false;
+
+    itr->second = now;
+    return true;
+}
+
 void Player::SendTimeSync()
 {
     WorldPacket data(SMSG_TIME_SYNC_REQ, 4);
@@ -859,6 +859,60 @@ struct BGData
     bool HasTaxiPath() const { return taxiPath[0] && taxiPath[1]; }
 };
 
+// Copy of the `characters` row taken by SaveToDB, the query is built from it
+// (escaping, number formatting) by Player::BuildSaveQuery, possibly on a save worker
+struct PlayerSaveData
+{
+    uint32 guid;
+    uint32 account;
+    std::string name;
+    uint8 race;
+    uint8 class_;
+    uint8 gender;
+    uint8 level;
+    uint32 xp;
+    uint32 money;
+    uint32 playerBytes;
+    uint32 playerBytes2;
+    uint32 playerFlags;
+    uint32 map;
+    uint32 instanceId;
+    uint32 difficulty;
+    float posX, posY, posZ, orientation;
+    std::vector<uint32> values;
+    uint32 taximask[8];
+    bool online;
+    uint32 cinematic;
+    uint32 totalTime;
+    uint32 levelTime;
+    float restBonus;
+    uint64 logoutTime;
+    bool resting;
+    uint32 resetTalentsCost;
+    uint64 resetTalentsTime;
+    float transX, transY, transZ, transO;
+    uint32 transGuid;
+    uint32 extraFlags;
+    uint32 stableSlots;
+    uint32 atLoginFlags;
+    uint32 zone;
+    uint64 deathExpireTime;
+    std::string taxiPath;
+    uint32 arenaPoints;
+    uint32 totalHonorPoints;
+    uint32 todayHonorPoints;
+    uint32 yesterdayHonorPoints;
+    uint32 totalKills;
+    uint16 todayKills;
+    uint16 yesterdayKills;
+    uint32 chosenTitle;
+    uint32 watchedFaction;
+    uint16 drunk;
+    uint32 health;
+    uint32 power[MAX_POWERS];
+    uint32 latency;
+};
+
 class Player : public Unit, public GridObject<Player>
 {
     friend class WorldSession;
@@ -1263,7 +1317,9 @@ class Player : public Unit, public GridObject<Player>
         /***                   SAVE SYSTEM                     ***/
         /*********************************************************/
 
-        void SaveToDB();
+        // async: build and queue the `characters` row on the save workers (PlayerSaveScheduler)
+        void SaveToDB(bool async = false);
+        static std::string BuildSaveQuery(PlayerSaveData const& data);
         void SaveInventoryAndGoldToDB();                    // fast save function for item/money cheating preventing
         void SaveGoldToDB();
         void SaveDataFieldToDB();
@@ -2007,6 +2063,9 @@ class Player : public Unit, public GridObject<Player>
         uint32 GetSaveTimer() const { return m_nextSave; }
         void   SetSaveTimer(uint32 timer) { m_nextSave = timer; }
 
+        // whether interval ms passed since this player got the last heartbeat of mover, marks it sent if so
+        bool IsMovementHeartbeatDue(uint64 mover, uint32 now, uint32 interval);
+
         // Recall position
         uint32 m_recallMap;
         float  m_recallX;
@@ -2290,6 +2349,10 @@ class Player : public Unit, public GridObject<Player>
         uint32 m_zoneUpdateTimer;
         uint32 m_areaUpdateId;
 
+        typedef UNORDERED_MAP<uint64, uint32> MovementHeartbeatTimes;
+        MovementHeartbeatTimes m_movementHeartbeatTimes;    // last throttled heartbeat received per mover
+        uint32 m_movementHeartbeatPruneTimer;
+
         uint32 m_deathTimer;
         time_t m_deathExpireTime;
 
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PlayerSaveScheduler.h"
+#include "Player.h"
+#include "ObjectAccessor.h"
+#include "World.h"
+#include "DatabaseEnv.h"
+#include "SqlOperations.h"
+#include "Timer.h"
+#include "TickProfiler.h"
+
+#include <ace/Guard_T.h>
+#include <ace/Method_Request.h>
+
+class CDBThreadStartReq : public ACE_Method_Request
+{
+    public:
+        int call()
+        {
+            CharacterDatabase.ThreadStart();
+            return 0;
+        }
+};
+
+class CDBThreadEndReq : public ACE_Method_Request
+{
+    public:
+        int call()
+        {
+            CharacterDatabase.ThreadEnd();
+            return 0;
+        }
+};
+
+// takes the place of the save transaction in the DB queue, so that the writes the world thread
+// queues after the save cannot overtake it; executes it once the worker appended the row
+class PlayerSaveTransaction : public SqlTransaction
+{
+    public:
+        explicit PlayerSaveTransaction(SqlTransaction* trans) : m_trans(trans), m_readyCond(m_readyLock), m_ready(false) {}
+        ~PlayerSaveTransaction() { delete m_trans; }
+
+        // worker, the transaction must not be touched afterwards
+        void Complete(std::string const& row)
+        {
+            m_trans->DelayExecute(row.c_str());
+
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_readyLock);
+            m_ready = true;
+            m_readyCond.signal();
+        }
+
+        // DB thread
+        void Execute(Database* db)
+        {
+            {
+                ACE_GUARD(ACE_Thread_Mutex, guard, m_readyLock);
+                while (!m_ready)
+                    m_readyCond.wait();
+            }
+
+            m_trans->Execute(db);
+        }
+
+    private:
+        SqlTransaction* m_trans;
+        ACE_Thread_Mutex m_readyLock;
+        ACE_Condition_Thread_Mutex m_readyCond;
+        bool m_ready;
+};
+
+class PlayerSaveRequest : public ACE_Method_Request
+{
+    public:
+        PlayerSaveRequest(PlayerSaveData* data, PlayerSaveTransaction* trans, uint32 requestTime)
+            : m_data(data), m_trans(trans), m_requestTime(requestTime) {}
+
+        // also used directly when there are no workers
+        static void Process(PlayerSaveData* data, PlayerSaveTransaction* trans, uint32 requestTime)
+        {
+            uint32 guidLow = data->guid;
+            trans->Complete(Player::BuildSaveQuery(*data));
+            delete data;
+            sPlayerSaveScheduler->SaveFinished(guidLow, requestTime);
+        }
+
+        int call()
+        {
+            Process(m_data, m_trans, m_requestTime);
+            return 0;
+        }
+
+    private:
+        PlayerSaveData* m_data;
+        PlayerSaveTransaction* m_trans;
+        uint32 m_requestTime;
+};
+
+PlayerSaveScheduler::PlayerSaveScheduler() : m_pendingCond(m_pendingLock), m_currentRequestTime(0),
+    m_maxQueueSize(0), m_saveCount(0), m_latencySum(0), m_latencyMax(0)
+{
+}
+
+PlayerSaveScheduler::~PlayerSaveScheduler()
+{
+    Stop();
+}
+
+void PlayerSaveScheduler::Initialize(uint32 threads)
+{
+    if (threads)
+        m_executor.activate(int(threads), new CDBThreadStartReq, new CDBThreadEndReq);
+}
+
+void PlayerSaveScheduler::Stop()
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_pendingLock);
+        while (!m_pending.empty())
+            m_pendingCond.wait();
+    }
+
+    if (m_executor.activated())
+        m_executor.deactivate();
+}
+
+void PlayerSaveScheduler::RequestSave(uint32 guidLow)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_requestLock);
+    if (!m_requested.insert(guidLow).second)
+        return;
+
+    Request req;
+    req.guidLow = guidLow;
+    req.time = getMSTime();
+    m_requests.push_back(req);
+
+    if (m_requests.size() > m_maxQueueSize)
+        m_maxQueueSize = m_requests.size();
+}
+
+void PlayerSaveScheduler::Update()
+{
+    TickProfileScope profile(PROFILE_PLAYER_SAVES);
+
+    uint32 maxPerTick = sWorld->getConfig(CONFIG_PLAYER_SAVE_MAX_PER_TICK);
+
+    for (uint32 saved = 0; !maxPerTick || saved < maxPerTick;)
+    {
+        Request req;
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_requestLock);
+            if (m_requests.empty())
+                break;
+
+            req = m_requests.front();
+            m_requests.pop_front();
+            m_requested.erase(req.guidLow);
+        }
+
+        // logged out (and saved) or between maps, its timer asks again next interval
+        Player* player = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(req.guidLow, 0, HIGHGUID_PLAYER));
+        if (!player)
+            continue;
+
+        m_currentRequestTime = req.time;
+        player->SaveToDB(true);
+        m_currentRequestTime = 0;
+        ++saved;
+
+        sLog->outDetail("Player '%s' (GUID: %u) saved", player->GetName(), req.guidLow);
+    }
+}
+
+void PlayerSaveScheduler::QueueSave(PlayerSaveData* data, SqlTransaction* trans)
+{
+    uint32 requestTime = m_currentRequestTime ? m_currentRequestTime : getMSTime();
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_pendingLock);
+        m_pending.insert(data->guid);
+    }
+
+    // queued now, where the world thread saved; the DB thread waits there for the row
+    PlayerSaveTransaction* save = new PlayerSaveTransaction(trans);
+    CharacterDatabase.CommitTransaction(save);
+
+    if (!m_executor.activated() || m_executor.execute(new PlayerSaveRequest(data, save, requestTime)) == -1)
+        PlayerSaveRequest::Process(data, save, requestTime);
+}
+
+void PlayerSaveScheduler::SaveFinished(uint32 guidLow, uint32 requestTime)
+{
+    uint32 latency = getMSTimeDiff(requestTime, getMSTime());
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_pendingLock);
+    std::multiset<uint32>::iterator itr = m_pending.find(guidLow);
+    if (itr != m_pending.end())
+        m_pending.erase(itr);
+
+    ++m_saveCount;
+    m_latencySum += latency;
+    if (latency > m_latencyMax)
+        m_latencyMax = latency;
+
+    m_pendingCond.broadcast();
+}
+
+uint32 PlayerSaveScheduler::GetQueueSize()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_requestLock, 0);
+    return m_requests.size();
+}
+
+void PlayerSaveScheduler::ResetStats()
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_requestLock);
+        m_maxQueueSize = m_requests.size();
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_pendingLock);
+    m_saveCount = 0;
+    m_latencySum = 0;
+    m_latencyMax = 0;
+}
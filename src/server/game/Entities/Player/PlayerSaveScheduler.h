@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PLAYER_SAVE_SCHEDULER_H
+#define _PLAYER_SAVE_SCHEDULER_H
+
+#include "Common.h"
+#include "DelayExecutor.h"
+
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <deque>
+#include <set>
+
+struct PlayerSaveData;
+class SqlTransaction;
+
+/*
+ * Paces player autosaves. Player::Update only requests a save when its timer
+ * expires; the world thread performs at most PlayerSave.MaxPerTick of them per
+ * tick in request order, so a burst of expiring timers is spread over the
+ * following ticks instead of landing in one. A save snapshots the `characters`
+ * row and queues its transaction to the DB thread at once, in order with every
+ * other character write of the world thread; a save worker builds the row query
+ * meanwhile and the DB thread waits for it if it gets there first.
+ */
+class PlayerSaveScheduler
+{
+    friend class ACE_Singleton<PlayerSaveScheduler, ACE_Null_Mutex>;
+    friend class PlayerSaveRequest;
+
+    PlayerSaveScheduler();
+    ~PlayerSaveScheduler();
+
+    public:
+        // starts the save workers, 0 builds the queries on the saving thread
+        void Initialize(uint32 threads);
+        // waits for the queued saves and stops the workers
+        void Stop();
+
+        // thread safe, one pending request per player
+        void RequestSave(uint32 guidLow);
+        // world thread, between the map updates
+        void Update();
+
+        // takes ownership of both, commits trans now and has a worker append the `characters` row to it
+        void QueueSave(PlayerSaveData* data, SqlTransaction* trans);
+
+        uint32 GetQueueSize();
+        uint32 GetMaxQueueSize() const { return m_maxQueueSize; }
+        uint32 GetSaveCount() const { return m_saveCount; }
+        // ms from the request to the row being built
+        uint32 GetLatencyAvg() const { return m_saveCount ? uint32(m_latencySum / m_saveCount) : 0; }
+        uint32 GetLatencyMax() const { return m_latencyMax; }
+        void ResetStats();
+
+    private:
+        void SaveFinished(uint32 guidLow, uint32 requestTime);
+
+        struct Request
+        {
+            uint32 guidLow;
+            uint32 time;                                    // getMSTime() of the request
+        };
+        typedef std::deque<Request> RequestQueue;
+
+        ACE_Thread_Mutex m_requestLock;
+        RequestQueue m_requests;
+        std::set<uint32> m_requested;
+
+        // saves handed to the workers and still without their row, by guid
+        ACE_Thread_Mutex m_pendingLock;
+        ACE_Condition_Thread_Mutex m_pendingCond;
+        std::multiset<uint32> m_pending;
+        // request time of the save the world thread is performing right now
+        uint32 m_currentRequestTime;
+
+        DelayExecutor m_executor;
+
+        uint32 m_maxQueueSize;
+        uint32 m_saveCount;
+        uint64 m_latencySum;
+        uint32 m_latencyMax;
+};
+
+#define sPlayerSaveScheduler ACE_Singleton<PlayerSaveScheduler, ACE_Null_Mutex>::instance()
+#endif
@@ -393,6 +393,38 @@ void Unit::Update(uint32 p_time)
     i_motionMaster.UpdateMotion(p_time);
 }
 
+bool Unit::IsIdle() const
+{
+    if (isInCombat() || getVictim() || isCharmed() || !m_Events.Empty() || IsNonMeleeSpellCasted(true))
+        return false;
+
+    if (!m_gameObj.empty() || !m_dynObjGUIDs.empty())
+        return false;
+
+    // no regeneration
+    if (GetHealth() < GetMaxHealth() || GetPower(POWER_MANA) < GetMaxPower(POWER_MANA))
+        return false;
+
+    for (uint8 i = 0; i < MAX_ATTACK; ++i)
+        if (m_attackTimer[i])
+            return false;
+
+    for (uint8 i = 0; i < MAX_REACTIVE; ++i)
+        if (m_reactiveTimer[i])
+            return false;
+
+    // only the default idle movement
+    if (i_motionMaster.size() != 1 || i_motionMaster.GetCurrentMovementGeneratorType() != IDLE_MOTION_TYPE)
+        return false;
+
+    // timed and periodic auras need the update diff
+    for (AuraMap::const_iterator itr = m_Auras.begin(); itr != m_Auras.end(); ++itr)
+        if (itr->second->GetAuraDuration() >= 0 || itr->second->IsPeriodic())
+            return false;
+
+    return true;
+}
+
 bool Unit::haveOffhandWeapon() const
 {
     if (GetTypeId() == TYPEID_PLAYER)
@@ -527,6 +559,17 @@ void Unit::BuildHeartBeatMsg(WorldPacket *data) const
     *data << uint32(0);
 }
 
+void Unit::SendMovementMessageToSet(WorldPacket *data, bool heartbeat)
+{
+    Map* map = GetMap();
+
+    Trinity::MovementHeartbeatThrottle throttle(this, heartbeat);
+    Trinity::MessageDistDeliverer notifier(this, data, map->GetVisibilityDistance(), false, &throttle);
+    VisitNearbyWorldObject(map->GetVisibilityDistance(), notifier);
+
+    map->AddMovementBroadcastStats(throttle.i_sent, throttle.i_suppressed, data->size());
+}
+
 void Unit::resetAttackTimer(WeaponAttackType type)
 {
     m_attackTimer[type] = uint32(GetAttackTime(type) * m_modAttackSpeedPct[type]);
@@ -800,7 +843,10 @@ uint32 Unit::DealDamage(Unit *pVictim, uint32 damage, CleanDamage const* cleanDa
 
                 CreatureTemplate const* cInfo = pVictim->ToCreature()->GetCreatureTemplate();
                 if (cInfo && cInfo->lootid)
+                {
                     pVictim->SetFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE);
+                    pVictim->ToCreature()->lootSnapshot.Take(cInfo->lootid, LootTemplates_Creature, pVictim->ToCreature()->GetLootRecipient());
+                }
 
                 // some critters required for quests
                 if (GetTypeId() == TYPEID_PLAYER)
@@ -3022,6 +3068,8 @@ void Unit::_UpdateAutoRepeatSpell()
 
 void Unit::SetCurrentCastedSpell(Spell * pSpell)
 {
+    WakeUp();
+
     ASSERT(pSpell);                                         // NULL may be never passed here, use InterruptSpell or InterruptNonMeleeSpells
 
     CurrentSpellTypes CSpellType = pSpell->GetCurrentContainer();
@@ -3404,6 +3452,8 @@ int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 misc_
 
 bool Unit::AddAura(Aura *Aur)
 {
+    WakeUp();
+
     // ghost spell check, allow apply any auras at player loading in ghost mode (will be cleanup after load)
     if (!isAlive() && Aur->GetId() != 20584 && Aur->GetId() != 8326 && Aur->GetId() != 2584 &&
         (GetTypeId() != TYPEID_PLAYER || !ToPlayer()->GetSession()->PlayerLoading()))
@@ -4207,6 +4257,7 @@ Aura* Unit::GetAura(uint32 spellId, uint32 effindex)
 
 void Unit::AddDynObject(DynamicObject* dynObj)
 {
+    WakeUp();
     m_dynObjGUIDs.push_back(dynObj->GetGUID());
 }
 
@@ -4280,6 +4331,8 @@ DynamicObject * Unit::GetDynObject(uint32 spellId)
 
 void Unit::AddGameObject(GameObject* gameObj)
 {
+    WakeUp();
+
     if (!gameObj || !gameObj->GetOwnerGUID() == 0) return;
     m_gameObj.push_back(gameObj);
     gameObj->SetOwnerGUID(GetGUID());
@@ -6691,6 +6744,8 @@ bool Unit::IsNeutralToAll() const
 
 bool Unit::Attack(Unit *victim, bool meleeAttack)
 {
+    WakeUp();
+
     if (!victim || victim == this)
         return false;
 
@@ -8554,6 +8609,8 @@ void Unit::CombatStart(Unit* target, bool initialAggro)
 
 void Unit::SetInCombatState(bool PvP, Unit* enemy)
 {
+    WakeUp();
+
     // only alive units can be in combat
     if (!isAlive())
         return;
@@ -9169,6 +9226,8 @@ float Unit::ApplyTotalThreatModifier(float threat, SpellSchoolMask schoolMask)
 
 void Unit::AddThreat(Unit* pVictim, float threat, SpellSchoolMask schoolMask, SpellEntry const *threatSpell)
 {
+    WakeUp();
+
     // Only mobs can manage threat lists
     if (CanHaveThreatList())
         m_ThreatManager.addThreat(pVictim, threat, schoolMask, threatSpell);
@@ -9774,6 +9833,8 @@ void Unit::SetLevel(uint32 lvl)
 
 void Unit::SetHealth(uint32 val)
 {
+    WakeUp();
+
     if (getDeathState() == JUST_DIED)
         val = 0;
     else
@@ -9831,6 +9892,8 @@ void Unit::SetMaxHealth(uint32 val)
 
 void Unit::SetPower(Powers power, uint32 val)
 {
+    WakeUp();
+
     if (GetPower(power) == val)
         return;
 
@@ -10870,6 +10933,10 @@ void Unit::SendPetAIReaction(uint64 guid)
 
 void Unit::StopMoving()
 {
+    // stop where the unit is now, not where its position was last written back
+    if (IsInWorld())
+        i_motionMaster.SyncPosition();
+
     clearUnitState(UNIT_STAT_MOVING);
 
     // not need send any packets if not in world
@@ -11312,9 +11379,10 @@ Pet* Unit::CreateTamedPetFrom(Creature* creatureTarget, uint32 spell_id)
 bool Unit::IsTriggeredAtSpellProcEvent(Unit *pVictim, Aura* aura, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, bool active, SpellProcEventEntry const*& spellProcEvent )
 {
     SpellEntry const *spellProto = aura->GetSpellProto();
+    SpellInfo const* spellInfo = sSpellMgr->GetSpellInfo(spellProto->Id);
 
     // Get proc Event Entry
-    spellProcEvent = sSpellMgr->GetSpellProcEvent(spellProto->Id);
+    spellProcEvent = spellInfo ? spellInfo->ProcEvent : sSpellMgr->GetSpellProcEvent(spellProto->Id);
 
     // Aura info stored here
     Modifier *mod = aura->GetModifier();
@@ -11330,7 +11398,7 @@ bool Unit::IsTriggeredAtSpellProcEvent(Unit *pVictim, Aura* aura, SpellEntry con
     if (spellProcEvent && spellProcEvent->procFlags) // if exist get custom spellProcEvent->procFlags
         EventProcFlag = spellProcEvent->procFlags;
     else
-        EventProcFlag = spellProto->procFlags;       // else get from spell proto
+        EventProcFlag = spellInfo ? spellInfo->ProcFlags : spellProto->procFlags; // else get from spell proto
     // Continue if no trigger exist
     if (!EventProcFlag)
         return false;
@@ -11625,6 +11693,9 @@ void Unit::Kill(Unit *pVictim, bool durabilityLoss)
         {
             creature->DeleteThreatList();
             creature->SetFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE);
+            // the loot is generated by the first loot request
+            if (uint32 lootid = creature->GetCreatureTemplate()->lootid)
+                creature->lootSnapshot.Take(lootid, LootTemplates_Creature, creature->GetLootRecipient());
         }
 
         // Call KilledUnit for creatures, this needs to be called after the lootable flag is set
@@ -11874,6 +11945,8 @@ void Unit::SetConfused(bool apply)
 
 void Unit::SetCharmedBy(Unit* charmer, CharmType type)
 {
+    WakeUp();
+
     if (!charmer)
         return;
 
@@ -11986,6 +12059,8 @@ void Unit::SetCharmedBy(Unit* charmer, CharmType type)
 
 void Unit::RemoveCharmedBy(Unit *charmer)
 {
+    WakeUp();
+
     if (!isCharmed())
         return;
 
@@ -1126,6 +1126,8 @@ class Unit : public WorldObject
         void SendMovementFlagUpdate();
 
         void BuildHeartBeatMsg(WorldPacket *data) const;
+        // client movement relay; heartbeats to observers outside the near tier are throttled
+        void SendMovementMessageToSet(WorldPacket *data, bool heartbeat);
 
         virtual void MoveOutOfRange(Player &) {  };
 
@@ -1275,6 +1277,10 @@ class Unit : public WorldObject
         // we can skip channeled or delayed checks using flags
         bool IsNonMeleeSpellCasted(bool withDelayed, bool skipChanneled = false, bool skipAutorepeat = false) const;
 
+        // nothing in Update() depends on the passing time: no combat, casts,
+        // events, timed auras, regeneration or movement
+        bool IsIdle() const;
+
         // set withDelayed to true to interrupt delayed spells too
         // delayed+channeled spells are always interrupted
         void InterruptNonMeleeSpells(bool withDelayed, uint32 spellid = 0, bool withInstant = true);
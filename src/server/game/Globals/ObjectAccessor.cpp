@@ -38,8 +38,11 @@
 #include "ObjectGuid.h"
 #include "MapInstanced.h"
 #include "World.h"
+#include "TickProfiler.h"
 
 #include <cmath>
+#include <ace/Task.h>
+#include <ace/Atomic_Op.h>
 
 ObjectAccessor::ObjectAccessor()
 {
@@ -98,43 +101,37 @@ Corpse* ObjectAccessor::GetCorpse(WorldObject const& u, uint64 guid)
 
 GameObject* ObjectAccessor::GetGameObject(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (GameObject*)NULL);
+    return u.GetMap()->GetGameObject(guid);
 }
 
 DynamicObject* ObjectAccessor::GetDynamicObject(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (DynamicObject*)NULL);
+    return u.GetMap()->GetDynamicObject(guid);
 }
 
 Unit* ObjectAccessor::GetUnit(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (Unit*)NULL);
+    return u.GetMap()->GetUnit(guid);
 }
 
 Creature* ObjectAccessor::GetCreature(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (Creature*)NULL);
+    return u.GetMap()->GetCreature(guid);
 }
 
 Pet* ObjectAccessor::GetPet(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (Pet*)NULL);
+    return u.GetMap()->GetPet(guid);
 }
 
 Player* ObjectAccessor::GetPlayer(WorldObject const& u, uint64 guid)
 {
-    return GetObjectInMap(guid, u.GetMap(), (Player*)NULL);
+    return u.GetMap()->GetPlayer(guid);
 }
 
 Creature* ObjectAccessor::GetCreatureOrPet(WorldObject const& u, uint64 guid)
 {
-    if (IS_PET_GUID(guid))
-        return GetPet(u, guid);
-
-    if (IS_CREATURE_GUID(guid))
-        return GetCreature(u, guid);
-
-    return NULL;
+    return u.GetMap()->GetCreatureOrPet(guid);
 }
 
 Pet* ObjectAccessor::FindPet(uint64 guid)
@@ -165,10 +162,104 @@ Player* ObjectAccessor::FindPlayerByName(const char* name)
 
 void ObjectAccessor::SaveAllPlayers()
 {
-    ACE_GUARD(LockType, g, *HashMapHolder<Player>::GetLock());
-    HashMapHolder<Player>::MapType& m = HashMapHolder<Player>::GetContainer();
-    for (HashMapHolder<Player>::MapType::iterator itr = m.begin(); itr != m.end(); ++itr)
-        itr->second->SaveToDB();
+    // only copy the list under the lock, the rows are built by the save workers
+    std::vector<Player*> players;
+    {
+        ACE_GUARD(LockType, g, *HashMapHolder<Player>::GetLock());
+        HashMapHolder<Player>::MapType& m = HashMapHolder<Player>::GetContainer();
+        players.reserve(m.size());
+        for (HashMapHolder<Player>::MapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+            players.push_back(itr->second);
+    }
+
+    for (std::vector<Player*>::const_iterator itr = players.begin(); itr != players.end(); ++itr)
+        (*itr)->SaveToDB(true);
+}
+
+class ObjectLookupBenchTask : public ACE_Task_Base
+{
+    public:
+        ObjectLookupBenchTask(std::vector<uint64> const& guids, uint32 lookups, bool locked)
+            : m_guids(guids), m_lookups(lookups), m_locked(locked), m_nextThread(0), m_found(0) {}
+
+        int svc()
+        {
+            uint32 offset = uint32(m_nextThread++) * 7919;
+            uint32 size = m_guids.size();
+            uint32 found = 0;
+
+            for (uint32 i = 0; i < m_lookups; ++i)
+            {
+                uint64 guid = m_guids[(offset + i * 31) % size];
+                if (m_locked)
+                {
+                    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, *HashMapHolder<Creature>::GetLock(), -1);
+                    HashMapHolder<Creature>::MapType& m = HashMapHolder<Creature>::GetContainer();
+                    if (m.find(guid) != m.end())
+                        ++found;
+                }
+                else if (HashMapHolder<Creature>::Find(guid))
+                    ++found;
+            }
+
+            m_found += found;
+            return 0;
+        }
+
+        uint64 GetFound() const { return m_found.value(); }
+
+    private:
+        std::vector<uint64> const& m_guids;
+        uint32 m_lookups;
+        bool m_locked;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_nextThread;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_found;
+};
+
+void ObjectAccessor::BenchmarkLookups(uint32 threads, uint32 lookupsPerThread, ObjectLookupBenchResult& result)
+{
+    result.threads = threads ? threads : 1;
+    result.lookupsPerThread = lookupsPerThread;
+    result.lockFreeTime = 0;
+    result.lockedTime = 0;
+    result.found = 0;
+
+    // every tenth lookup misses, like lookups of despawned objects do
+    std::vector<uint64> guids;
+    {
+        ACE_GUARD(LockType, g, *HashMapHolder<Creature>::GetLock());
+        HashMapHolder<Creature>::MapType& m = HashMapHolder<Creature>::GetContainer();
+        guids.reserve(m.size() + m.size() / 9 + 1);
+        for (HashMapHolder<Creature>::MapType::const_iterator itr = m.begin(); itr != m.end(); ++itr)
+        {
+            guids.push_back(itr->first);
+            if (guids.size() % 10 == 9)
+                guids.push_back(MAKE_NEW_GUID(0xFFFFFF - guids.size(), 0, HIGHGUID_UNIT));
+        }
+    }
+    if (guids.empty())
+        guids.push_back(MAKE_NEW_GUID(0xFFFFFF, 0, HIGHGUID_UNIT));
+
+    for (int locked = 0; locked < 2; ++locked)
+    {
+        ObjectLookupBenchTask task(guids, lookupsPerThread, locked != 0);
+        uint32 start = getMSTime();
+        if (task.activate(THR_NEW_LWP | THR_JOINABLE, result.threads) == -1)
+        {
+            sLog->outError("ObjectAccessor::BenchmarkLookups: cannot start %u threads", result.threads);
+            return;
+        }
+        task.wait();
+
+        uint32 time = getMSTimeDiff(start, getMSTime());
+        if (locked)
+            result.lockedTime = time;
+        else
+        {
+            result.lockFreeTime = time;
+            result.found = task.GetFound();
+        }
+    }
 }
 
 Corpse* ObjectAccessor::GetCorpseForPlayerGUID(uint64 guid)
@@ -335,6 +426,11 @@ void ObjectAccessor::RemoveOldCorpses()
 
 void ObjectAccessor::Update(uint32 /*diff*/)
 {
+    TickProfileScope profile(PROFILE_OBJECT_ACCESSOR);
+
+    // lookup tables replaced while a reader was inside them
+    ObjectRegistryEpoch::Reclaim();
+
     UpdateDataMapType update_players;
 
     // Critical section
@@ -363,6 +459,7 @@ void ObjectAccessor::Update(uint32 /*diff*/)
 
 template <class T> UNORDERED_MAP< uint64, T* > HashMapHolder<T>::m_objectMap;
 template <class T> ACE_Thread_Mutex HashMapHolder<T>::i_lock;
+template <class T> ObjectGuidTable<T> HashMapHolder<T>::m_lookupTable;
 
 // Global definitions for the hashmap storage
 
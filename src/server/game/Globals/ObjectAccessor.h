@@ -30,6 +30,7 @@
 #include "GridDefines.h"
 #include "Object.h"
 #include "Player.h"
+#include "ObjectGuidTable.h"
 
 #include <ace/Singleton.h>
 #include <ace/Thread_Mutex.h>
@@ -43,6 +44,8 @@ class DynamicObject;
 class WorldObject;
 class Map;
 
+// Find() reads a lock free copy of the map, the lock only serializes the
+// writers and whoever iterates the container
 template <class T>
 class HashMapHolder
 {
@@ -55,19 +58,19 @@ class HashMapHolder
         {
             ACE_GUARD(LockType, Guard, i_lock);
             m_objectMap[o->GetGUID()] = o;
+            m_lookupTable.Insert(o->GetGUID(), o);
         }
 
         static void Remove(T* o)
         {
             ACE_GUARD(LockType, Guard, i_lock);
             m_objectMap.erase(o->GetGUID());
+            m_lookupTable.Remove(o->GetGUID());
         }
 
         static T* Find(uint64 guid)
         {
-            ACE_GUARD_RETURN(LockType, Guard, i_lock, NULL);
-            typename MapType::iterator itr = m_objectMap.find(guid);
-            return (itr != m_objectMap.end()) ? itr->second : NULL;
+            return m_lookupTable.Find(guid);
         }
 
         static MapType& GetContainer() { return m_objectMap; }
@@ -80,6 +83,16 @@ class HashMapHolder
 
         static LockType i_lock;
         static MapType  m_objectMap;
+        static ObjectGuidTable<T> m_lookupTable;
+};
+
+struct ObjectLookupBenchResult
+{
+    uint32 threads;
+    uint32 lookupsPerThread;
+    uint32 lockFreeTime;                                    // ms
+    uint32 lockedTime;                                      // ms, same lookups through the container lock
+    uint64 found;
 };
 
 class ObjectAccessor
@@ -160,7 +173,8 @@ class ObjectAccessor
                 return NULL;
         }
 
-        // these functions return objects only if in map of specified object
+        // these functions return objects only if in map of specified object,
+        // all but GetCorpse are answered by the index of that map
         static Object* GetObjectByTypeMask(WorldObject const&, uint64, uint32 typemask);
         static Corpse* GetCorpse(WorldObject const& u, uint64 guid);
         static GameObject* GetGameObject(WorldObject const& u, uint64 guid);
@@ -202,6 +216,9 @@ class ObjectAccessor
 
         void SaveAllPlayers();
 
+        // creature lookups from as many threads as map updates use, lock free and through the container lock
+        static void BenchmarkLookups(uint32 threads, uint32 lookupsPerThread, ObjectLookupBenchResult& result);
+
         void AddUpdateObject(Object* obj)
         {
             ACE_GUARD(LockType, Guard, i_updateGuard);
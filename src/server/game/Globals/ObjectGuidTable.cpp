@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ObjectGuidTable.h"
+
+#include <ace/TSS_T.h>
+#include <algorithm>
+
+ACE_TSS<ObjectRegistryEpoch::ReaderSlot> ObjectRegistryEpoch::s_slot;
+volatile uint64 ObjectRegistryEpoch::s_epoch = 1;
+ACE_Thread_Mutex ObjectRegistryEpoch::s_lock;
+std::vector<ObjectRegistryEpoch::ReaderRecord*> ObjectRegistryEpoch::s_readers;
+std::vector<ObjectRegistryEpoch::RetiredEntry> ObjectRegistryEpoch::s_retired;
+
+ObjectRegistryEpoch::ReaderSlot::ReaderSlot() : record(new ReaderRecord)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, s_lock);
+    s_readers.push_back(record);
+}
+
+ObjectRegistryEpoch::ReaderSlot::~ReaderSlot()
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, s_lock);
+        s_readers.erase(std::remove(s_readers.begin(), s_readers.end(), record), s_readers.end());
+    }
+    delete record;
+}
+
+ObjectRegistryEpoch::ReaderRecord* ObjectRegistryEpoch::GetRecord()
+{
+    return s_slot->record;
+}
+
+void ObjectRegistryEpoch::Enter()
+{
+    ReaderRecord* record = GetRecord();
+    if (record->nesting++)
+        return;
+
+    record->epoch = s_epoch;
+    // the epoch must be visible before any table pointer is read
+    REGISTRY_MEMORY_BARRIER();
+}
+
+void ObjectRegistryEpoch::Leave()
+{
+    ReaderRecord* record = GetRecord();
+    if (--record->nesting)
+        return;
+
+    REGISTRY_MEMORY_BARRIER();
+    record->epoch = 0;
+}
+
+void ObjectRegistryEpoch::Retire(void* ptr, Deleter deleter)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, s_lock);
+
+    RetiredEntry entry;
+    entry.ptr = ptr;
+    entry.deleter = deleter;
+    entry.epoch = s_epoch;
+    s_retired.push_back(entry);
+
+    // readers entering from now on can only find the replacement
+    REGISTRY_MEMORY_BARRIER();
+    ++s_epoch;
+
+    ReclaimLocked();
+}
+
+void ObjectRegistryEpoch::Reclaim()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, s_lock);
+    ReclaimLocked();
+}
+
+void ObjectRegistryEpoch::ReclaimLocked()
+{
+    if (s_retired.empty())
+        return;
+
+    REGISTRY_MEMORY_BARRIER();
+
+    // oldest epoch a reader is still inside
+    uint64 oldest = s_epoch;
+    for (std::vector<ReaderRecord*>::const_iterator itr = s_readers.begin(); itr != s_readers.end(); ++itr)
+    {
+        uint64 epoch = (*itr)->epoch;
+        if (epoch && epoch < oldest)
+            oldest = epoch;
+    }
+
+    std::vector<RetiredEntry>::iterator keep = s_retired.begin();
+    for (std::vector<RetiredEntry>::iterator itr = s_retired.begin(); itr != s_retired.end(); ++itr)
+    {
+        // a reader in the retire epoch may still hold the pointer
+        if (itr->epoch < oldest)
+            itr->deleter(itr->ptr);
+        else
+            *keep++ = *itr;
+    }
+    s_retired.erase(keep, s_retired.end());
+}
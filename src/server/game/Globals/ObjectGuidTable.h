@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_OBJECTGUIDTABLE_H
+#define TRINITY_OBJECTGUIDTABLE_H
+
+#include "Common.h"
+
+#include <ace/Thread_Mutex.h>
+#include <vector>
+
+template <class TYPE> class ACE_TSS;
+
+#if COMPILER == COMPILER_MICROSOFT
+#  include <intrin.h>
+#  define REGISTRY_MEMORY_BARRIER() _mm_mfence()
+#else
+#  define REGISTRY_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+/*
+    Epoch based reclamation for the GUID tables.
+
+    Readers announce the global epoch they started in and clear it when done,
+    which only touches their own record. Memory unlinked by a writer is freed
+    once no reader is still inside an epoch that could have seen it.
+*/
+class ObjectRegistryEpoch
+{
+    public:
+        typedef void (*Deleter)(void* ptr);
+
+        // reader side, wait-free
+        static void Enter();
+        static void Leave();
+
+        // writer side, ptr must already be unreachable for new readers
+        static void Retire(void* ptr, Deleter deleter);
+        // free what no reader can see anymore, called by Retire and from the world update
+        static void Reclaim();
+
+    private:
+        struct ReaderRecord
+        {
+            ReaderRecord() : epoch(0), nesting(0) {}
+            volatile uint64 epoch;                          // 0 while outside a read
+            uint32 nesting;
+            char padding[64 - sizeof(uint64) - sizeof(uint32)]; // keep records of different threads on their own cache line
+        };
+
+        // owns the record of one thread, registered on its first lookup and dropped when the thread ends
+        struct ReaderSlot
+        {
+            ReaderSlot();
+            ~ReaderSlot();
+            ReaderRecord* record;
+        };
+
+        struct RetiredEntry
+        {
+            void* ptr;
+            Deleter deleter;
+            uint64 epoch;
+        };
+
+        static ReaderRecord* GetRecord();
+        static void ReclaimLocked();
+
+        static ACE_TSS<ReaderSlot> s_slot;
+        static volatile uint64 s_epoch;
+        static ACE_Thread_Mutex s_lock;                     // reader registration and retire list
+        static std::vector<ReaderRecord*> s_readers;
+        static std::vector<RetiredEntry> s_retired;
+};
+
+class ObjectRegistryReadGuard
+{
+    public:
+        ObjectRegistryReadGuard() { ObjectRegistryEpoch::Enter(); }
+        ~ObjectRegistryReadGuard() { ObjectRegistryEpoch::Leave(); }
+};
+
+/*
+    GUID -> object table with lock free lookups.
+
+    Sharded open addressing with linear probing, each shard grows and drops its
+    tombstones by copying into a new array which is published with one pointer
+    store, the old array is retired through ObjectRegistryEpoch. Writers must be
+    serialized by the caller, HashMapHolder does that with its lock.
+*/
+template <class T>
+class ObjectGuidTable
+{
+    public:
+        ObjectGuidTable()
+        {
+            for (uint32 i = 0; i < SHARD_COUNT; ++i)
+                m_shards[i] = CreateShard(MIN_CAPACITY);
+        }
+
+        ~ObjectGuidTable()
+        {
+            for (uint32 i = 0; i < SHARD_COUNT; ++i)
+                DeleteShard(m_shards[i]);
+        }
+
+        T* Find(uint64 guid) const
+        {
+            if (guid == EMPTY_KEY || guid == DELETED_KEY)
+                return NULL;
+
+            ObjectRegistryReadGuard guard;
+
+            uint64 hash = Hash(guid);
+            Shard const* shard = m_shards[hash >> (64 - SHARD_BITS)];
+            REGISTRY_MEMORY_BARRIER();
+
+            uint32 mask = shard->capacity - 1;
+            for (uint32 i = 0, pos = uint32(hash) & mask; i < shard->capacity; ++i, pos = (pos + 1) & mask)
+            {
+                Slot const& slot = shard->slots[pos];
+                uint64 key = slot.key;
+                if (key == EMPTY_KEY)
+                    return NULL;
+                if (key != guid)
+                    continue;
+
+                T* value = slot.value;
+                REGISTRY_MEMORY_BARRIER();
+                // the slot was not removed and reused while reading the value
+                if (slot.key == guid)
+                    return value;
+            }
+
+            return NULL;
+        }
+
+        void Insert(uint64 guid, T* value)
+        {
+            uint64 hash = Hash(guid);
+            uint32 index = uint32(hash >> (64 - SHARD_BITS));
+            Shard* shard = m_shards[index];
+
+            if (Slot* slot = FindSlot(shard, guid, hash))
+            {
+                slot->value = value;
+                return;
+            }
+
+            // keep probe chains short, tombstones count as used
+            if ((shard->used + 1) * 2 > shard->capacity)
+                shard = Rebuild(index);
+
+            uint32 mask = shard->capacity - 1;
+            uint32 pos = uint32(hash) & mask;
+            while (shard->slots[pos].key != EMPTY_KEY && shard->slots[pos].key != DELETED_KEY)
+                pos = (pos + 1) & mask;
+
+            Slot& slot = shard->slots[pos];
+            if (slot.key == EMPTY_KEY)
+                ++shard->used;
+            ++shard->live;
+            slot.value = value;
+            REGISTRY_MEMORY_BARRIER();
+            slot.key = guid;
+        }
+
+        void Remove(uint64 guid)
+        {
+            uint64 hash = Hash(guid);
+            Shard* shard = m_shards[hash >> (64 - SHARD_BITS)];
+
+            if (Slot* slot = FindSlot(shard, guid, hash))
+            {
+                slot->key = DELETED_KEY;
+                REGISTRY_MEMORY_BARRIER();
+                slot->value = NULL;
+                --shard->live;
+            }
+        }
+
+    private:
+        enum
+        {
+            SHARD_BITS      = 6,
+            SHARD_COUNT     = 1 << SHARD_BITS,
+            MIN_CAPACITY    = 64
+        };
+
+        static const uint64 EMPTY_KEY = 0;
+        static const uint64 DELETED_KEY = ~uint64(0);
+
+        struct Slot
+        {
+            volatile uint64 key;
+            T* volatile value;
+        };
+
+        struct Shard
+        {
+            uint32 capacity;                                // power of two
+            uint32 used;                                    // live entries and tombstones
+            uint32 live;
+            Slot* slots;
+        };
+
+        static uint64 Hash(uint64 guid)
+        {
+            // 64 bit finalizer of MurmurHash3, low guid bits alone cluster badly
+            guid ^= guid >> 33;
+            guid *= UI64LIT(0xff51afd7ed558ccd);
+            guid ^= guid >> 33;
+            guid *= UI64LIT(0xc4ceb9fe1a85ec53);
+            guid ^= guid >> 33;
+            return guid;
+        }
+
+        static Shard* CreateShard(uint32 capacity)
+        {
+            Shard* shard = new Shard;
+            shard->capacity = capacity;
+            shard->used = 0;
+            shard->live = 0;
+            shard->slots = new Slot[capacity];
+            for (uint32 i = 0; i < capacity; ++i)
+            {
+                shard->slots[i].key = EMPTY_KEY;
+                shard->slots[i].value = NULL;
+            }
+            return shard;
+        }
+
+        static void DeleteShard(void* ptr)
+        {
+            Shard* shard = static_cast<Shard*>(ptr);
+            delete[] shard->slots;
+            delete shard;
+        }
+
+        static Slot* FindSlot(Shard* shard, uint64 guid, uint64 hash)
+        {
+            uint32 mask = shard->capacity - 1;
+            for (uint32 i = 0, pos = uint32(hash) & mask; i < shard->capacity; ++i, pos = (pos + 1) & mask)
+            {
+                if (shard->slots[pos].key == EMPTY_KEY)
+                    return NULL;
+                if (shard->slots[pos].key == guid)
+                    return &shard->slots[pos];
+            }
+            return NULL;
+        }
+
+        // copy the live entries into a fresh array sized for them and publish it
+        Shard* Rebuild(uint32 index)
+        {
+            Shard* shard = m_shards[index];
+            uint32 capacity = MIN_CAPACITY;
+            while (capacity < (shard->live + 1) * 4)
+                capacity <<= 1;
+
+            Shard* rebuilt = CreateShard(capacity);
+            uint32 mask = capacity - 1;
+            for (uint32 i = 0; i < shard->capacity; ++i)
+            {
+                Slot const& slot = shard->slots[i];
+                if (slot.key == EMPTY_KEY || slot.key == DELETED_KEY)
+                    continue;
+
+                uint32 pos = uint32(Hash(slot.key)) & mask;
+                while (rebuilt->slots[pos].key != EMPTY_KEY)
+                    pos = (pos + 1) & mask;
+                rebuilt->slots[pos].key = slot.key;
+                rebuilt->slots[pos].value = slot.value;
+                ++rebuilt->used;
+                ++rebuilt->live;
+            }
+
+            REGISTRY_MEMORY_BARRIER();
+            m_shards[index] = rebuilt;
+            REGISTRY_MEMORY_BARRIER();
+            ObjectRegistryEpoch::Retire(shard, &DeleteShard);
+            return rebuilt;
+        }
+
+        Shard* volatile m_shards[SHARD_COUNT];
+};
+
+#endif
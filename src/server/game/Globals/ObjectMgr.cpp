@@ -45,6 +45,7 @@
 #include "WaypointManager.h"
 #include "GossipDef.h"
 #include "InstanceScript.h"
+#include "SqlOperations.h"
 
 ScriptMapMap sQuestEndScripts;
 ScriptMapMap sQuestStartScripts;
@@ -193,7 +194,7 @@ LanguageDesc const* GetLanguageDescByID(uint32 lang)
     return NULL;
 }
 
-ObjectMgr::ObjectMgr()
+ObjectMgr::ObjectMgr() : m_oldMailCond(m_oldMailLock)
 {
     m_hiCharGuid        = 1;
     m_hiCreatureGuid    = 1;
@@ -208,6 +209,10 @@ ObjectMgr::ObjectMgr()
     m_guildId           = 1;
     m_arenaTeamId       = 1;
     m_auctionid         = 1;
+    m_oldMailJob        = NULL;
+    m_oldMailThread     = NULL;
+    m_oldMailBatchesQueued  = 0;
+    m_oldMailBatchesWritten = 0;
 
     mGuildBankTabPrice.resize(GUILD_BANK_MAX_TABS);
     mGuildBankTabPrice[0] = 100;
@@ -223,6 +228,8 @@ ObjectMgr::ObjectMgr()
 
 ObjectMgr::~ObjectMgr()
 {
+    WaitOldMails();
+
     for (QuestMap::iterator i = mQuestTemplates.begin(); i != mQuestTemplates.end(); ++i)
     {
         delete i->second;
@@ -2534,7 +2541,9 @@ void ObjectMgr::LoadGuilds()
     //   13                14               15                16               17                18
         "BankResetTimeTab3, BankRemSlotsTab3, BankResetTimeTab4, BankRemSlotsTab4, BankResetTimeTab5, BankRemSlotsTab5, "
     //   19               20                21                22               23                       24
-         "characters.name, characters.level, characters.class, characters.zone, characters.logout_time, characters.account "
+         "characters.name, characters.level, characters.class, characters.zone, characters.logout_time, characters.account, "
+    //   25              26                    27                    28
+        "characters.map, characters.position_x, characters.position_y, characters.position_z "
         "FROM guild_member LEFT JOIN characters ON characters.guid = guild_member.guid ORDER BY guildid ASC");
 
     // load guild bank tab rights
@@ -2558,9 +2567,7 @@ void ObjectMgr::LoadGuilds()
             delete newGuild;
             continue;
         }
-        newGuild->LoadGuildEventLogFromDB();
-        newGuild->LoadGuildBankEventLogFromDB();
-        newGuild->LoadGuildBankFromDB();
+        // bank and eventlog are loaded asynchronously when a member first asks for them
         AddGuild(newGuild);
     } while (result->NextRow());
 
@@ -4348,89 +4355,212 @@ void ObjectMgr::LoadNpcTextLocales()
     sLog->outString(">> Loaded %u NpcText locale strings", mNpcTextLocaleMap.size());
 }
 
-//not very fast function but it is called only once a day, or on starting-up
-void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
+#define OLD_MAIL_BATCH_DELAY 50                             // ms between two batches of the expired mail job
+
+class OldMailRunnable : public ACE_Based::Runnable
+{
+    public:
+        OldMailRunnable(ObjectMgr::OldMailJob* job) : m_job(job) {}
+        ~OldMailRunnable() { delete m_job; }
+
+        void run()
+        {
+            CharacterDatabase.ThreadStart();
+
+            sObjectMgr->_ReturnOrDeleteOldMails(*m_job);
+
+            ObjectMgr* mgr = sObjectMgr;
+            {
+                ACE_GUARD(ACE_Thread_Mutex, guard, mgr->m_oldMailLock);
+                mgr->m_oldMailJob = NULL;
+            }
+
+            CharacterDatabase.ThreadEnd();
+        }
+
+    private:
+        ObjectMgr::OldMailJob* m_job;
+};
+
+// one expired mail batch in the DB queue, tells the job and the mailboxes waiting for it when it is written
+class OldMailBatchTransaction : public SqlTransaction
+{
+    public:
+        explicit OldMailBatchTransaction(SqlTransaction* trans) : m_trans(trans) {}
+        ~OldMailBatchTransaction() { delete m_trans; }
+
+        // DB thread
+        void Execute(Database* db)
+        {
+            m_trans->Execute(db);
+            sObjectMgr->_OldMailBatchWritten();
+        }
+
+    private:
+        SqlTransaction* m_trans;
+};
+
+// called at startup and once a day
+bool ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
+{
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_oldMailLock, false);
+        if (m_oldMailJob)
+            return false;
+    }
+
+    // the previous run is done, only its thread is left to join
+    WaitOldMails();
+
+    OldMailJob* job = new OldMailJob();
+    job->basetime = time(NULL);
+    job->serverUp = serverUp;
+
+    // players who already listed their mailbox keep their old mail until the next run, the ones
+    // listing it during the run are added by SkipOldMails; the background thread never touches players
+    if (serverUp)
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, g, *HashMapHolder<Player>::GetLock(), false);
+        HashMapHolder<Player>::MapType const& players = sObjectAccessor->GetPlayers();
+        for (HashMapHolder<Player>::MapType::const_iterator itr = players.begin(); itr != players.end(); ++itr)
+            if (itr->second->m_mailsLoaded)
+                job->skippedReceivers.insert(itr->second->GetGUIDLow());
+    }
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_oldMailLock, false);
+        m_oldMailJob = job;
+    }
+
+    m_oldMailThread = new ACE_Based::Thread(new OldMailRunnable(job));
+    return true;
+}
+
+void ObjectMgr::WaitOldMails()
 {
-    time_t basetime = time(NULL);
-    sLog->outDebug("Returning mails current time: hour: %d, minute: %d, second: %d ", localtime(&basetime)->tm_hour, localtime(&basetime)->tm_min, localtime(&basetime)->tm_sec);
-    //delete all old mails without item and without body immediately, if starting server
-    if (!serverUp)
-        CharacterDatabase.PExecute("DELETE FROM mail WHERE expire_time < '" UI64FMTD "' AND has_items = '0' AND itemTextId = 0", (uint64)basetime);
-    //                                                            0  1           2      3        4          5         6           7   8       9
-    QueryResult_AutoPtr result = CharacterDatabase.PQuery("SELECT id, messageType, sender, receiver, itemTextId, has_items, expire_time, cod, checked, mailTemplateId FROM mail WHERE expire_time < '" UI64FMTD "'", (uint64)basetime);
+    if (!m_oldMailThread)
+        return;
+
+    m_oldMailThread->wait();
+    delete m_oldMailThread;
+    m_oldMailThread = NULL;
+}
+
+void ObjectMgr::SkipOldMails(uint32 receiver)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_oldMailLock);
+    if (!m_oldMailJob)
+        return;
+
+    m_oldMailJob->skippedReceivers.insert(receiver);
+
+    // the batch already queued may still hold mail of this receiver, the later ones do not
+    uint32 queued = m_oldMailBatchesQueued;
+    while (int32(queued - m_oldMailBatchesWritten) > 0)
+        m_oldMailCond.wait();
+}
+
+void ObjectMgr::_OldMailBatchWritten()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_oldMailLock);
+    ++m_oldMailBatchesWritten;
+    m_oldMailCond.broadcast();
+}
+
+void ObjectMgr::_ReturnOrDeleteOldMails(OldMailJob const& job)
+{
+    uint32 oldMSTime = getMSTime();
+    uint32 lastId = 0;
+    uint32 returned = 0;
+    uint32 deleted = 0;
+
+    // the rest waits for the next run
+    while (_ReturnOrDeleteOldMailBatch(job, lastId, returned, deleted) && !World::IsStopped())
+        ACE_Based::Thread::Sleep(OLD_MAIL_BATCH_DELAY);
+
+    sLog->outString("Expired mail: %u returned, %u deleted in %u ms", returned, deleted, GetMSTimeDiffToNow(oldMSTime));
+}
+
+bool ObjectMgr::_ReturnOrDeleteOldMailBatch(OldMailJob const& job, uint32& lastId, uint32& returned, uint32& deleted)
+{
+    uint32 batchSize = sWorld->getConfig(CONFIG_EXPIRED_MAIL_BATCH_SIZE);
+
+    //                                                            0   1            2       3         4           5          6
+    QueryResult_AutoPtr result = CharacterDatabase.PQuery("SELECT id, messageType, sender, receiver, itemTextId, has_items, checked FROM mail "
+        "WHERE expire_time < '" UI64FMTD "' AND id > '%u' ORDER BY id LIMIT %u", (uint64)job.basetime, lastId, batchSize);
     if (!result)
-        return;                                             // any mails need to be returned or deleted
-    Field *fields;
-    //std::ostringstream delitems, delmails; //will be here for optimization
-    //bool deletemail = false, deleteitem = false;
-    //delitems << "DELETE FROM item_instance WHERE guid IN (";
-    //delmails << "DELETE FROM mail WHERE id IN ("
+        return false;
+
+    uint64 rows = result->GetRowCount();
+
+    std::ostringstream deleteIds, itemMailIds, textIds;
+
+    // the receivers are filtered and the batch queued under the lock: a mailbox loading meanwhile is
+    // either skipped by this batch or waits until it is written, see SkipOldMails
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_oldMailLock, false);
+
+    CharacterDatabase.BeginTransaction();
+
     do
     {
-        fields = result->Fetch();
-        Mail *m = new Mail;
-        m->messageID = fields[0].GetUInt32();
-        m->messageType = fields[1].GetUInt8();
-        m->sender = fields[2].GetUInt32();
-        m->receiver = fields[3].GetUInt32();
-        m->itemTextId = fields[4].GetUInt32();
+        Field *fields = result->Fetch();
+        uint32 id = fields[0].GetUInt32();
+        uint8 messageType = fields[1].GetUInt8();
+        uint32 sender = fields[2].GetUInt32();
+        uint32 receiver = fields[3].GetUInt32();
+        uint32 itemTextId = fields[4].GetUInt32();
         bool has_items = fields[5].GetBool();
-        m->expire_time = (time_t)fields[6].GetUInt64();
-        m->deliver_time = 0;
-        m->COD = fields[7].GetUInt32();
-        m->checked = fields[8].GetUInt32();
-        m->mailTemplateId = fields[9].GetInt16();
-
-        Player *pl = 0;
-        if (serverUp)
-            pl = GetPlayer((uint64)m->receiver);
-        if (pl && pl->m_mailsLoaded)
-        {                                                   //this code will run very improbably (the time is between 4 and 5 am, in game is online a player, who has old mail
-            //his in mailbox and he has already listed his mails)
-            delete m;
+        uint32 checked = fields[6].GetUInt32();
+
+        lastId = id;
+
+        if (job.skippedReceivers.find(receiver) != job.skippedReceivers.end())
+            continue;
+
+        // normal mail with items is returned, unless it is COD paid or already returned
+        if (has_items && messageType == MAIL_NORMAL && !(checked & (MAIL_CHECK_MASK_COD_PAYMENT | MAIL_CHECK_MASK_RETURNED)))
+        {
+            CharacterDatabase.PExecute("UPDATE mail SET sender = '%u', receiver = '%u', expire_time = '" UI64FMTD "', deliver_time = '" UI64FMTD "', cod = '0', checked = '%u' WHERE id = '%u'",
+                receiver, sender, (uint64)(job.basetime + 30*DAY), (uint64)job.basetime, MAIL_CHECK_MASK_RETURNED, id);
+            ++returned;
             continue;
         }
-        //delete or return mail:
+
         if (has_items)
-        {
-            QueryResult_AutoPtr resultItems = CharacterDatabase.PQuery("SELECT item_guid, item_template FROM mail_items WHERE mail_id='%u'", m->messageID);
-            if (resultItems)
-            {
-                do
-                {
-                    Field *fields2 = resultItems->Fetch();
+            itemMailIds << (itemMailIds.tellp() ? "," : "") << id;
+        if (itemTextId)
+            textIds << (textIds.tellp() ? "," : "") << itemTextId;
+        deleteIds << (deleteIds.tellp() ? "," : "") << id;
+        ++deleted;
+    }
+    while (result->NextRow());
 
-                    uint32 item_guid_low = fields2[0].GetUInt32();
-                    uint32 item_template = fields2[1].GetUInt32();
+    if (itemMailIds.tellp())
+    {
+        CharacterDatabase.PExecute("DELETE item_instance FROM item_instance JOIN mail_items ON item_instance.guid = mail_items.item_guid WHERE mail_items.mail_id IN (%s)", itemMailIds.str().c_str());
+        CharacterDatabase.PExecute("DELETE FROM mail_items WHERE mail_id IN (%s)", itemMailIds.str().c_str());
+    }
+    if (textIds.tellp())
+        CharacterDatabase.PExecute("DELETE FROM item_text WHERE id IN (%s)", textIds.str().c_str());
+    if (deleteIds.tellp())
+        CharacterDatabase.PExecute("DELETE FROM mail WHERE id IN (%s)", deleteIds.str().c_str());
 
-                    m->AddItem(item_guid_low, item_template);
-                }
-                while (resultItems->NextRow());
-            }
-            // if it is mail from AH, it shouldn't be returned, but deleted
-            if (m->messageType != MAIL_NORMAL || m->messageType == MAIL_AUCTION || (m->checked & (MAIL_CHECK_MASK_COD_PAYMENT | MAIL_CHECK_MASK_RETURNED)))
-            {
-                // mail open and then not returned
-                for (std::vector<MailItemInfo>::iterator itr2 = m->items.begin(); itr2 != m->items.end(); ++itr2)
-                    CharacterDatabase.PExecute("DELETE FROM item_instance WHERE guid = '%u'", itr2->item_guid);
-            }
-            else
-            {
-                //mail will be returned:
-                CharacterDatabase.PExecute("UPDATE mail SET sender = '%u', receiver = '%u', expire_time = '" UI64FMTD "', deliver_time = '" UI64FMTD "', cod = '0', checked = '%u' WHERE id = '%u'", m->receiver, m->sender, (uint64)(basetime + 30*DAY), (uint64)basetime, MAIL_CHECK_MASK_RETURNED, m->messageID);
-                delete m;
-                continue;
-            }
-        }
+    SqlTransaction* trans = CharacterDatabase.DetachTransaction();
+    if (!trans)
+    {
+        // no DB queue, the statements already ran in the transaction BeginTransaction started
+        CharacterDatabase.CommitTransaction();
+        return rows == batchSize;
+    }
 
-        if (m->itemTextId)
-            CharacterDatabase.PExecute("DELETE FROM item_text WHERE id = '%u'", m->itemTextId);
+    ++m_oldMailBatchesQueued;
+    CharacterDatabase.CommitTransaction(new OldMailBatchTransaction(trans));
 
-        //deletemail = true;
-        //delmails << m->messageID << ", ";
-        CharacterDatabase.PExecute("DELETE FROM mail WHERE id = '%u'", m->messageID);
-        delete m;
-    } while (result->NextRow());
+    // one batch at a time in the queue
+    while (int32(m_oldMailBatchesQueued - m_oldMailBatchesWritten) > 0)
+        m_oldMailCond.wait();
+
+    return rows == batchSize;
 }
 
 void ObjectMgr::LoadQuestAreaTriggers()
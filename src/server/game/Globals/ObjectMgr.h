@@ -41,6 +41,7 @@
 #include "SQLStorage.h"
 
 #include <ace/Singleton.h>
+#include <ace/Condition_Thread_Mutex.h>
 #include <string>
 #include <map>
 #include <limits>
@@ -806,7 +807,13 @@ class ObjectMgr
             return itr != mFishingBaseForArea.end() ? itr->second : 0;
         }
 
-        void ReturnOrDeleteOldMails(bool serverUp);
+        // start returning/deleting expired mail in the background, false if a run is still going
+        bool ReturnOrDeleteOldMails(bool serverUp);
+        // waits until the expired mail job is done
+        void WaitOldMails();
+        // called by a mailbox loading from the DB: keeps the later expired mail batches off it and
+        // waits until the batch already in the DB queue is written
+        void SkipOldMails(uint32 receiver);
 
         void SetHighestGuids();
         uint32 GenerateLowGuid(HighGuid guidhigh);
@@ -1102,6 +1109,27 @@ class ObjectMgr
         int DBCLocaleIndex;
 
     private:
+        friend class OldMailRunnable;
+        friend class OldMailBatchTransaction;
+
+        struct OldMailJob
+        {
+            time_t basetime;
+            bool serverUp;
+            std::set<uint32> skippedReceivers;              // mailbox loaded before or during the run
+        };
+        void _ReturnOrDeleteOldMails(OldMailJob const& job);
+        // false once no expired mail is left
+        bool _ReturnOrDeleteOldMailBatch(OldMailJob const& job, uint32& lastId, uint32& returned, uint32& deleted);
+        void _OldMailBatchWritten();
+
+        ACE_Thread_Mutex m_oldMailLock;
+        ACE_Condition_Thread_Mutex m_oldMailCond;           // a batch was written
+        OldMailJob* m_oldMailJob;                           // the running job, NULL when there is none
+        ACE_Based::Thread* m_oldMailThread;
+        uint32 m_oldMailBatchesQueued;
+        uint32 m_oldMailBatchesWritten;
+
         void LoadScripts(ScriptsType type);
         void CheckScripts(ScriptsType type, std::set<int32>& ids);
         void ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const* table, char const* guidEntryStr);
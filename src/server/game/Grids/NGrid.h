@@ -28,6 +28,8 @@
 #include "Timer.h"
 #include "Util.h"
 
+#include <bitset>
+
 #define DEFAULT_VISIBILITY_NOTIFY_PERIOD      1000
 
 class GridInfo
@@ -113,6 +115,10 @@ class NGrid
         }
         bool isGridObjectDataLoaded() const { return i_GridObjectDataLoaded; }
         void setGridObjectDataLoaded(bool pLoaded) { i_GridObjectDataLoaded = pLoaded; }
+        // the cells of a loaded grid get their objects one by one, see Map::EnsureGridLoaded
+        bool isCellObjectDataLoaded(uint32 x, uint32 y) const { return i_CellObjectDataLoaded.test(x*N + y); }
+        void setCellObjectDataLoaded(uint32 x, uint32 y) { i_CellObjectDataLoaded.set(x*N + y); }
+        bool isAllCellObjectDataLoaded() const { return i_CellObjectDataLoaded.count() == N*N; }
 
         GridInfo* getGridInfoRef() { return &i_GridInfo; }
         const TimeTracker& getTimeTracker() const { return i_GridInfo.getTimeTracker(); }
@@ -182,6 +188,7 @@ class NGrid
         grid_state_t i_cellstate;
         GridType i_cells[N][N];
         bool i_GridObjectDataLoaded;
+        std::bitset<N*N> i_CellObjectDataLoaded;
 };
 #endif
 
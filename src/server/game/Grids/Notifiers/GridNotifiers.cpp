@@ -30,6 +30,7 @@
 #include "ObjectAccessor.h"
 #include "CellImpl.h"
 #include "SpellAuras.h"
+#include "World.h"
 
 using namespace Trinity;
 
@@ -317,6 +318,37 @@ void DynamicObjectUpdater::Visit(PlayerMapType &m)
         VisitHelper(itr->getSource());
 }
 
+MovementHeartbeatThrottle::MovementHeartbeatThrottle(WorldObject const* mover, bool heartbeat)
+    : i_map(*mover->GetMap()), i_mover(mover->GetGUID()), i_now(getMSTime()), i_heartbeat(heartbeat && i_map.HasMovementTiers())
+    , i_sent(0), i_suppressed(0)
+{
+}
+
+bool
+MovementHeartbeatThrottle::IsDue(Player* plr, float distSq)
+{
+    // state changes always reach everyone, the next heartbeat sent carries the latest position
+    if (i_heartbeat)
+    {
+        uint32 interval;
+        switch (i_map.GetMovementTier(distSq))
+        {
+            case MOVEMENT_TIER_MID: interval = sWorld->getConfig(CONFIG_MOVEMENT_TIER_MID_INTERVAL); break;
+            case MOVEMENT_TIER_FAR: interval = sWorld->getConfig(CONFIG_MOVEMENT_TIER_FAR_INTERVAL); break;
+            default:                interval = 0; break;
+        }
+
+        if (interval && !plr->IsMovementHeartbeatDue(i_mover, i_now, interval))
+        {
+            ++i_suppressed;
+            return false;
+        }
+    }
+
+    ++i_sent;
+    return true;
+}
+
 void
 MessageDistDeliverer::Visit(PlayerMapType &m)
 {
@@ -324,7 +356,8 @@ MessageDistDeliverer::Visit(PlayerMapType &m)
     {
         Player *target = iter->getSource();
 
-        if (target->GetExactDistSq(i_source) > i_distSq)
+        float distSq = target->GetExactDistSq(i_source);
+        if (distSq > i_distSq)
             continue;
 
         // Send packet to all who are sharing the player's vision
@@ -333,11 +366,11 @@ MessageDistDeliverer::Visit(PlayerMapType &m)
             SharedVisionList::const_iterator i = target->GetSharedVisionList().begin();
             for (; i != target->GetSharedVisionList().end(); ++i)
                 if ((*i)->m_seer == target)
-                    SendPacket(*i);
+                    SendPacket(*i, distSq);
         }
 
         if (target->m_seer == target)
-            SendPacket(target);
+            SendPacket(target, distSq);
     }
 }
 
@@ -346,17 +379,18 @@ MessageDistDeliverer::Visit(CreatureMapType &m)
 {
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
-        if (iter->getSource()->GetExactDistSq(i_source) > i_distSq)
+        if (iter->getSource()->GetSharedVisionList().empty())
+            continue;
+
+        float distSq = iter->getSource()->GetExactDistSq(i_source);
+        if (distSq > i_distSq)
             continue;
 
         // Send packet to all who are sharing the creature's vision
-        if (!iter->getSource()->GetSharedVisionList().empty())
-        {
-            SharedVisionList::const_iterator i = iter->getSource()->GetSharedVisionList().begin();
-            for (; i != iter->getSource()->GetSharedVisionList().end(); ++i)
-                if ((*i)->m_seer == iter->getSource())
-                    SendPacket(*i);
-        }
+        SharedVisionList::const_iterator i = iter->getSource()->GetSharedVisionList().begin();
+        for (; i != iter->getSource()->GetSharedVisionList().end(); ++i)
+            if ((*i)->m_seer == iter->getSource())
+                SendPacket(*i, distSq);
     }
 }
 
@@ -365,16 +399,15 @@ MessageDistDeliverer::Visit(DynamicObjectMapType &m)
 {
     for (DynamicObjectMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
-        if (iter->getSource()->GetExactDistSq(i_source) > i_distSq)
+        float distSq = iter->getSource()->GetExactDistSq(i_source);
+        if (distSq > i_distSq)
             continue;
 
-        if (iter->getSource()->GetTypeId() == TYPEID_PLAYER)
-        {
-            // Send packet back to the caster if the caster has vision of dynamic object
-            Player* caster = iter->getSource()->GetCaster()->ToPlayer();
-            if (caster && caster->m_seer == iter->getSource())
-                SendPacket(caster);
-        }
+        // Send packet back to the caster if the caster has vision of dynamic object
+        Unit* caster = iter->getSource()->GetCaster();
+        Player* player = caster ? caster->ToPlayer() : NULL;
+        if (player && player->m_seer == iter->getSource())
+            SendPacket(player, distSq);
     }
 }
 
@@ -394,8 +427,18 @@ ObjectUpdater::Visit(GridRefManager<T> &m)
 {
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
-        if (iter->getSource()->IsInWorld())
-            iter->getSource()->Update(i_timeDiff);
+        T* obj = iter->getSource();
+        if (!obj->IsInWorld())
+            continue;
+
+        if (obj->UpdateDormancy(i_now))
+        {
+            ++i_dormant;
+            continue;
+        }
+
+        ++i_awake;
+        obj->Update(i_timeDiff);
     }
 }
 
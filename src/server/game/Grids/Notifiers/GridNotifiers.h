@@ -121,15 +121,32 @@ namespace Trinity
         void Visit(CorpseMapType &m) { updateObjects<Corpse>(m); }
     };
 
+    // heartbeat throttle of MessageDistDeliverer: a receiver in the mid or far movement
+    // tier gets the heartbeats of a mover once per tier interval, timed per receiver
+    struct MovementHeartbeatThrottle
+    {
+        Map const& i_map;
+        uint64 i_mover;
+        uint32 i_now;
+        bool i_heartbeat;
+        uint32 i_sent;
+        uint32 i_suppressed;
+        MovementHeartbeatThrottle(WorldObject const* mover, bool heartbeat);
+
+        bool IsDue(Player* plr, float distSq);
+    };
+
     struct MessageDistDeliverer
     {
         WorldObject *i_source;
         WorldPacket *i_message;
         float i_distSq;
         uint32 team;
-        MessageDistDeliverer(WorldObject *src, WorldPacket *msg, float dist, bool own_team_only = false)
+        MovementHeartbeatThrottle* i_throttle;
+        MessageDistDeliverer(WorldObject *src, WorldPacket *msg, float dist, bool own_team_only = false, MovementHeartbeatThrottle* throttle = NULL)
             : i_source(src), i_message(msg), i_distSq(dist * dist)
             , team((own_team_only && src->GetTypeId() == TYPEID_PLAYER) ? ((Player*)src)->GetTeam() : 0)
+            , i_throttle(throttle)
         {
         }
         void Visit(PlayerMapType &m);
@@ -137,12 +154,15 @@ namespace Trinity
         void Visit(DynamicObjectMapType &m);
         template<class SKIP> void Visit(GridRefManager<SKIP> &) {}
 
-        void SendPacket(Player* plr)
+        void SendPacket(Player* plr, float distSq)
         {
             // never send packet to self
             if (plr == i_source || team && plr->GetTeam() != team)
                 return;
 
+            if (i_throttle && !i_throttle->IsDue(plr, distSq))
+                return;
+
             if (WorldSession* session = plr->GetSession())
                 session->SendPacket(i_message);
         }
@@ -151,7 +171,10 @@ namespace Trinity
     struct ObjectUpdater
     {
         uint32 i_timeDiff;
-        explicit ObjectUpdater(const uint32 &diff) : i_timeDiff(diff) {}
+        time_t i_now;
+        uint32 i_awake;                                     // updated objects
+        uint32 i_dormant;                                   // skipped dormant objects
+        explicit ObjectUpdater(const uint32 &diff) : i_timeDiff(diff), i_now(time(NULL)), i_awake(0), i_dormant(0) {}
         template<class T> void Visit(GridRefManager<T> &m);
         void Visit(PlayerMapType &) {}
         void Visit(CorpseMapType &) {}
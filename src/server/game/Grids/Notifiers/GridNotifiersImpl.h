@@ -44,8 +44,26 @@ inline void
 Trinity::ObjectUpdater::Visit(CreatureMapType &m)
 {
     for (CreatureMapType::iterator iter=m.begin(); iter != m.end(); ++iter)
-        if (iter->getSource()->IsInWorld() && !iter->getSource()->isSpiritService())
-            iter->getSource()->Update(i_timeDiff);
+    {
+        Creature* creature = iter->getSource();
+        if (!creature->IsInWorld() || creature->isSpiritService())
+            continue;
+
+        if (creature->UpdateDormancy(i_now))
+        {
+            // events can be scheduled on a sleeping creature, they need the update
+            if (creature->m_Events.Empty())
+            {
+                ++i_dormant;
+                continue;
+            }
+
+            creature->WakeUp();
+        }
+
+        ++i_awake;
+        creature->Update(i_timeDiff);
+    }
 }
 
 // SEARCHERS & LIST SEARCHERS & WORKERS
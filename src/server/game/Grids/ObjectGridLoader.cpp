@@ -222,20 +222,26 @@ ObjectGridLoader::Load(GridType &grid)
 void ObjectGridLoader::LoadN(void)
 {
     i_gameObjects = 0; i_creatures = 0; i_corpses = 0;
-    i_cell.data.Part.cell_y = 0;
     for (unsigned int x=0; x < MAX_NUMBER_OF_CELLS; ++x)
-    {
-        i_cell.data.Part.cell_x = x;
         for (unsigned int y=0; y < MAX_NUMBER_OF_CELLS; ++y)
-        {
-            i_cell.data.Part.cell_y = y;
-            GridLoader<Player, AllWorldObjectTypes, AllGridObjectTypes> loader;
-            loader.Load(i_grid(x, y), *this);
-        }
-    }
+            LoadCell(x, y);
     sLog->outDebug("%u GameObjects, %u Creatures, and %u Corpses/Bones loaded for grid %u on map %u", i_gameObjects, i_creatures, i_corpses, i_grid.GetGridId(), i_map->GetId());
 }
 
+bool ObjectGridLoader::LoadCell(uint32 x, uint32 y)
+{
+    if (i_grid.isCellObjectDataLoaded(x, y))
+        return false;
+
+    i_grid.setCellObjectDataLoaded(x, y);
+
+    i_cell.data.Part.cell_x = x;
+    i_cell.data.Part.cell_y = y;
+    GridLoader<Player, AllWorldObjectTypes, AllGridObjectTypes> loader;
+    loader.Load(i_grid(x, y), *this);
+    return true;
+}
+
 void ObjectGridUnloader::MoveToRespawnN()
 {
     for (unsigned int x=0; x < MAX_NUMBER_OF_CELLS; ++x)
@@ -46,6 +46,10 @@ class ObjectGridLoader
         void Visit(DynamicObjectMapType&) { }
 
         void LoadN(void);
+        // loads the objects of one cell unless already loaded, returns false if it was
+        bool LoadCell(uint32 x, uint32 y);
+
+        uint32 GetLoadedObjectCount() const { return i_gameObjects + i_creatures + i_corpses; }
 
     private:
         Cell i_cell;
@@ -563,6 +563,7 @@ void Group::GroupLoot(const uint64& playerGUID, Loot *loot, WorldObject* object)
             loot->items[itemSlot].is_blocked = true;
             object->m_groupLootTimer = 60000;
             object->lootingGroupLeaderGUID = GetLeaderGUID();
+            object->WakeUp();
 
             RollId.push_back(r);
         }
@@ -19,6 +19,7 @@
  */
 
 #include "DatabaseEnv.h"
+#include "DatabaseImpl.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
 #include "Player.h"
@@ -29,6 +30,37 @@
 #include "SocialMgr.h"
 #include "Util.h"
 #include "Language.h"
+#include "World.h"
+#include "MapManager.h"
+
+// remembers which parts were queried, the guild may have loaded or unloaded them meanwhile
+class GuildLoadQueryHolder : public SqlQueryHolder
+{
+    private:
+        bool m_bank;
+        bool m_eventLog;
+    public:
+        GuildLoadQueryHolder(bool bank, bool eventLog) : m_bank(bank), m_eventLog(eventLog) { }
+        bool HasBank() const { return m_bank; }
+        bool HasEventLog() const { return m_eventLog; }
+};
+
+// the guild may get disbanded before the query callback is executed,
+// so only the guild id is passed to this handler
+class GuildLoadHandler
+{
+    public:
+        void HandleLoadCallback(QueryResult_AutoPtr /*dummy*/, SqlQueryHolder* holder, uint32 guildId)
+        {
+            if (!holder)
+                return;
+
+            if (Guild* guild = sObjectMgr->GetGuildById(guildId))
+                guild->HandleLoadResult((GuildLoadQueryHolder*)holder);
+
+            delete (GuildLoadQueryHolder*)holder;
+        }
+} guildLoadHandler;
 
 Guild::Guild()
 {
@@ -55,6 +87,16 @@ Guild::Guild()
 
     for (uint8 i = 0; i < GUILD_BANK_MAX_TABS; ++i)
         m_GuildBankEventLogNextGuid_Item[i] = 0;
+
+    m_bankloaded = false;
+    m_eventlogloaded = false;
+    m_onlinemembers = 0;
+    LogMaxGuid = 0;
+    GuildEventlogMaxGuid = 0;
+
+    m_dataLoading = false;
+    m_loadEventLogGuid = 0;
+    m_loadBankLogGuid = 0;
 }
 
 Guild::~Guild()
@@ -376,9 +418,9 @@ bool Guild::LoadMembersFromDB(QueryResult_AutoPtr guildMembersResult)
         if (!newmember.ZoneId)
         {
             sLog->outError("Player (GUID: %u) has broken zone-data", GUID_LOPART(guid));
-            // here it will also try the same, to get the zone from characters-table, but additional it tries to find
-            // the zone through xy coords .. this is a bit redundant, but shouldn't be called often
-            newmember.ZoneId = Player::GetZoneIdFromDB(guid);
+            // find the zone through the position loaded with the member, no extra query per member
+            newmember.ZoneId = sMapMgr->GetZoneId(fields[25].GetUInt32(), fields[26].GetFloat(), fields[27].GetFloat(), fields[28].GetFloat());
+            CharacterDatabase.PExecute("UPDATE characters SET zone = '%u' WHERE guid = '%u'", newmember.ZoneId, GUID_LOPART(guid));
         }
         if (newmember.Class < CLASS_WARRIOR || newmember.Class >= MAX_CLASSES) // can be at broken `class` field
         {
@@ -865,9 +907,12 @@ void Guild::UpdateAccountsNumber()
 // Display guild eventlog
 void Guild::DisplayGuildEventlog(WorldSession *session)
 {
-    // Load guild eventlog, if not already done
+    // Load guild eventlog, if not already done, and answer when it arrives
     if (!m_eventlogloaded)
-        LoadGuildEventLogFromDB();
+    {
+        AddPendingRequest(session, GUILD_REQUEST_EVENTLOG);
+        return;
+    }
 
     // Sending result
     WorldPacket data(MSG_GUILD_EVENT_LOG_QUERY, 0);
@@ -892,16 +937,26 @@ void Guild::DisplayGuildEventlog(WorldSession *session)
     sLog->outDebug("WORLD: Sent (MSG_GUILD_EVENT_LOG_QUERY)");
 }
 
-// Load guild eventlog from DB
-void Guild::LoadGuildEventLogFromDB()
+// Load guild eventlog from the GUILD_LOAD_QUERY_EVENTLOG result
+void Guild::LoadGuildEventLogFromDB(QueryResult_AutoPtr result)
 {
     // Return if already loaded
     if (m_eventlogloaded)
         return;
 
-    QueryResult_AutoPtr result = CharacterDatabase.PQuery("SELECT LogGuid, EventType, PlayerGuid1, PlayerGuid2, NewRank, TimeStamp FROM guild_eventlog WHERE guildid=%u ORDER BY LogGuid DESC LIMIT %u", m_Id, GUILD_EVENTLOG_MAX_ENTRIES);
+    m_eventlogloaded = true;
+
+    // entries logged while the query was running are not part of the result, keep them
+    GuildEventlog logged;
+    for (GuildEventlog::const_iterator itr = m_GuildEventlog.begin(); itr != m_GuildEventlog.end(); ++itr)
+        if (itr->LogGuid >= m_loadEventLogGuid)
+            logged.push_back(*itr);
+    m_GuildEventlog.swap(logged);
+
     if (!result)
         return;
+
+    GuildEventlog loaded;
     do
     {
         Field *fields = result->Fetch();
@@ -914,15 +969,15 @@ void Guild::LoadGuildEventLogFromDB()
         NewEvent.NewRank = fields[4].GetUInt8();
         NewEvent.TimeStamp = fields[5].GetUInt64();
         // Add entry to map
-        m_GuildEventlog.push_front(NewEvent);
+        loaded.push_front(NewEvent);
     } while (result->NextRow());
 
     // Check lists size in case to many event entries in db
     // This cases can happen only if a crash occured somewhere and table has too many log entries
-    if (!m_GuildEventlog.empty())
-        CharacterDatabase.PExecute("DELETE FROM guild_eventlog WHERE guildid=%u AND LogGuid < %u", m_Id, m_GuildEventlog.front().LogGuid);
+    if (!loaded.empty())
+        CharacterDatabase.PExecute("DELETE FROM guild_eventlog WHERE guildid=%u AND LogGuid < %u", m_Id, loaded.front().LogGuid);
 
-    m_eventlogloaded = true;
+    m_GuildEventlog.splice(m_GuildEventlog.begin(), loaded);
 }
 
 // Unload guild eventlog
@@ -977,6 +1032,12 @@ void Guild::LogGuildEvent(uint8 EventType, uint32 PlayerGuid1, uint32 PlayerGuid
 // Bank content related
 void Guild::DisplayGuildBankContent(WorldSession *session, uint8 TabId)
 {
+    if (!m_bankloaded)
+    {
+        AddPendingRequest(session, GUILD_REQUEST_BANK_CONTENT, TabId);
+        return;
+    }
+
     WorldPacket data(SMSG_GUILD_BANK_LIST, 1200);
 
     GuildBankTab const* tab = GetBankTab(TabId);
@@ -1114,9 +1175,12 @@ Item* Guild::GetItem(uint8 TabId, uint8 SlotId)
 
 void Guild::DisplayGuildBankTabsInfo(WorldSession *session)
 {
-    // Time to load bank if not already done
+    // Time to load bank if not already done, the tabs are sent when it arrives
     if (!m_bankloaded)
-        LoadGuildBankFromDB();
+    {
+        AddPendingRequest(session, GUILD_REQUEST_BANK_TABS_INFO);
+        return;
+    }
 
     WorldPacket data(SMSG_GUILD_BANK_LIST, 500);
 
@@ -1202,17 +1266,15 @@ uint32 Guild::GetBankRights(uint32 rankId, uint8 TabId) const
 // *************************************************
 // Guild bank loading/unloading related
 
-// This load should be called when the bank is first accessed by a guild member
-void Guild::LoadGuildBankFromDB()
+// Fills the bank from the GUILD_LOAD_QUERY_BANK_TABS and GUILD_LOAD_QUERY_BANK_ITEMS results
+void Guild::LoadGuildBankFromDB(QueryResult_AutoPtr tabsResult, QueryResult_AutoPtr itemsResult)
 {
     if (m_bankloaded)
         return;
 
     m_bankloaded = true;
-    LoadGuildBankEventLogFromDB();
 
-    //                                                     0      1        2        3
-    QueryResult_AutoPtr result = CharacterDatabase.PQuery("SELECT TabId, TabName, TabIcon, TabText FROM guild_bank_tab WHERE guildid='%u' ORDER BY TabId", m_Id);
+    QueryResult_AutoPtr result = tabsResult;
     if (!result)
     {
         m_PurchasedTabs = 0;
@@ -1225,6 +1287,9 @@ void Guild::LoadGuildBankFromDB()
         Field *fields = result->Fetch();
         uint8 TabId = fields[0].GetUInt8();
 
+        if (TabId >= m_PurchasedTabs)
+            continue;
+
         GuildBankTab *NewTab = new GuildBankTab;
         memset(NewTab->Slots, 0, GUILD_BANK_MAX_SLOTS * sizeof(Item*));
 
@@ -1235,9 +1300,7 @@ void Guild::LoadGuildBankFromDB()
         m_TabListMap[TabId] = NewTab;
     } while (result->NextRow());
 
-    // data needs to be at first place for Item::LoadFromDB
-    //                                        0     1      2       3          4
-    result = CharacterDatabase.PQuery("SELECT data, TabId, SlotId, item_guid, item_entry FROM guild_bank_item JOIN item_instance ON item_guid = guid WHERE guildid='%u' ORDER BY TabId", m_Id);
+    result = itemsResult;
     if (!result)
         return;
 
@@ -1306,6 +1369,99 @@ void Guild::UnloadGuildBank()
     m_bankloaded = false;
 }
 
+// Queries the parts of bank and eventlog that are not loaded yet without blocking the world thread,
+// the requests queued meanwhile are answered in HandleLoadResult()
+void Guild::LoadBankAndEventLogAsync()
+{
+    if (m_dataLoading || (m_bankloaded && m_eventlogloaded))
+        return;
+
+    // everything logged from now on is not in the query results
+    m_loadEventLogGuid = GuildEventlogMaxGuid;
+    m_loadBankLogGuid = LogMaxGuid;
+
+    GuildLoadQueryHolder* holder = new GuildLoadQueryHolder(!m_bankloaded, !m_eventlogloaded);
+    holder->SetSize(MAX_GUILD_LOAD_QUERY);
+
+    if (!m_bankloaded)
+    {
+        //                                                            0      1        2        3
+        holder->SetPQuery(GUILD_LOAD_QUERY_BANK_TABS,       "SELECT TabId, TabName, TabIcon, TabText FROM guild_bank_tab WHERE guildid='%u' ORDER BY TabId", m_Id);
+        // data needs to be at first place for Item::LoadFromDB
+        //                                                            0     1      2       3          4
+        holder->SetPQuery(GUILD_LOAD_QUERY_BANK_ITEMS,      "SELECT data, TabId, SlotId, item_guid, item_entry FROM guild_bank_item JOIN item_instance ON item_guid = guid WHERE guildid='%u' ORDER BY TabId", m_Id);
+        // We can't add a limit as for the guild eventlog since we fetch both money and bank log and know nothing about the composition
+        //                                                            0        1         2      3           4            5               6          7
+        holder->SetPQuery(GUILD_LOAD_QUERY_BANK_EVENTLOG,   "SELECT LogGuid, LogEntry, TabId, PlayerGuid, ItemOrMoney, ItemStackCount, DestTabId, TimeStamp FROM guild_bank_eventlog WHERE guildid='%u' ORDER BY TimeStamp DESC", m_Id);
+    }
+
+    if (!m_eventlogloaded)
+        //                                                            0        1          2            3            4        5
+        holder->SetPQuery(GUILD_LOAD_QUERY_EVENTLOG,        "SELECT LogGuid, EventType, PlayerGuid1, PlayerGuid2, NewRank, TimeStamp FROM guild_eventlog WHERE guildid=%u ORDER BY LogGuid DESC LIMIT %u", m_Id, GUILD_EVENTLOG_MAX_ENTRIES);
+
+    m_dataLoading = true;
+    CharacterDatabase.DelayQueryHolder(&guildLoadHandler, &GuildLoadHandler::HandleLoadCallback, holder, m_Id);
+}
+
+void Guild::HandleLoadResult(GuildLoadQueryHolder* holder)
+{
+    m_dataLoading = false;
+
+    // a part not queried has no results, whatever state it is in now
+    if (holder->HasBank() && !m_bankloaded)
+    {
+        LoadGuildBankEventLogFromDB(holder->GetResult(GUILD_LOAD_QUERY_BANK_EVENTLOG));
+        LoadGuildBankFromDB(holder->GetResult(GUILD_LOAD_QUERY_BANK_TABS), holder->GetResult(GUILD_LOAD_QUERY_BANK_ITEMS));
+    }
+
+    if (holder->HasEventLog() && !m_eventlogloaded)
+        LoadGuildEventLogFromDB(holder->GetResult(GUILD_LOAD_QUERY_EVENTLOG));
+
+    SendPendingRequests();
+}
+
+void Guild::AddPendingRequest(WorldSession *session, GuildPendingRequestType type, uint8 TabId)
+{
+    GuildPendingRequest request(session->GetAccountId(), type, TabId);
+    if (std::find(m_pendingRequests.begin(), m_pendingRequests.end(), request) == m_pendingRequests.end())
+        m_pendingRequests.push_back(request);
+
+    LoadBankAndEventLogAsync();
+}
+
+void Guild::SendPendingRequests()
+{
+    PendingRequestList requests;
+    requests.swap(m_pendingRequests);
+
+    for (PendingRequestList::const_iterator itr = requests.begin(); itr != requests.end(); ++itr)
+    {
+        // the player may have logged out or left the guild while the data was loading
+        WorldSession* session = sWorld->FindSession(itr->accountId);
+        if (!session || !session->GetPlayer() || session->GetPlayer()->GetGuildId() != m_Id)
+            continue;
+
+        switch (itr->type)
+        {
+            case GUILD_REQUEST_BANK_TABS_INFO:
+                DisplayGuildBankTabsInfo(session);
+                break;
+            case GUILD_REQUEST_BANK_CONTENT:
+                DisplayGuildBankContent(session, itr->tabId);
+                break;
+            case GUILD_REQUEST_BANK_LOGS:
+                DisplayGuildBankLogs(session, itr->tabId);
+                break;
+            case GUILD_REQUEST_BANK_TAB_TEXT:
+                SendGuildBankTabText(session, itr->tabId);
+                break;
+            case GUILD_REQUEST_EVENTLOG:
+                DisplayGuildEventlog(session);
+                break;
+        }
+    }
+}
+
 // *************************************************
 // Money deposit/withdraw related
 
@@ -1537,43 +1693,53 @@ bool Guild::LoadBankRightsFromDB(QueryResult_AutoPtr guildBankTabRightsResult)
 // *************************************************
 // Bank log related
 
-void Guild::LoadGuildBankEventLogFromDB()
+void Guild::LoadGuildBankEventLogFromDB(QueryResult_AutoPtr result)
 {
-    // We can't add a limit as in Guild::LoadGuildEventLogFromDB since we fetch both money and bank log and know nothing about the composition
-    //                                                     0        1         2      3           4            5               6          7
-    QueryResult_AutoPtr result = CharacterDatabase.PQuery("SELECT LogGuid, LogEntry, TabId, PlayerGuid, ItemOrMoney, ItemStackCount, DestTabId, TimeStamp FROM guild_bank_eventlog WHERE guildid='%u' ORDER BY TimeStamp DESC", m_Id);
-    if (!result)
-        return;
+    // entries logged while the query was running are not part of the result, keep them
+    GuildBankEventLog loggedMoney;
+    GuildBankEventLog loggedItem[GUILD_BANK_MAX_TABS];
+    for (GuildBankEventLog::const_iterator itr = m_GuildBankEventLog_Money.begin(); itr != m_GuildBankEventLog_Money.end(); ++itr)
+        if (itr->LogGuid >= m_loadBankLogGuid)
+            loggedMoney.push_back(*itr);
+    for (uint8 i = 0; i < GUILD_BANK_MAX_TABS; ++i)
+        for (GuildBankEventLog::const_iterator itr = m_GuildBankEventLog_Item[i].begin(); itr != m_GuildBankEventLog_Item[i].end(); ++itr)
+            if (itr->LogGuid >= m_loadBankLogGuid)
+                loggedItem[i].push_back(*itr);
 
-    do
-    {
-        Field *fields = result->Fetch();
-        GuildBankEvent NewEvent;
+    UnloadGuildBankEventLog();
 
-        NewEvent.LogGuid = fields[0].GetUInt32();
-        NewEvent.LogEntry = fields[1].GetUInt8();
-        uint8 TabId = fields[2].GetUInt8();
-        NewEvent.PlayerGuid = fields[3].GetUInt32();
-        NewEvent.ItemOrMoney = fields[4].GetUInt32();
-        NewEvent.ItemStackCount = fields[5].GetUInt8();
-        NewEvent.DestTabId = fields[6].GetUInt8();
-        NewEvent.TimeStamp = fields[7].GetUInt64();
-
-        if (TabId >= GUILD_BANK_MAX_TABS)
+    if (result)
+    {
+        do
         {
-            sLog->outError("Guild::LoadGuildBankEventLogFromDB: Invalid tabid '%u' for guild bank log entry (guild: '%s', LogGuid: %u), skipped.", TabId, GetName().c_str(), NewEvent.LogGuid);
-            continue;
-        }
+            Field *fields = result->Fetch();
+            GuildBankEvent NewEvent;
+
+            NewEvent.LogGuid = fields[0].GetUInt32();
+            NewEvent.LogEntry = fields[1].GetUInt8();
+            uint8 TabId = fields[2].GetUInt8();
+            NewEvent.PlayerGuid = fields[3].GetUInt32();
+            NewEvent.ItemOrMoney = fields[4].GetUInt32();
+            NewEvent.ItemStackCount = fields[5].GetUInt8();
+            NewEvent.DestTabId = fields[6].GetUInt8();
+            NewEvent.TimeStamp = fields[7].GetUInt64();
+
+            if (TabId >= GUILD_BANK_MAX_TABS)
+            {
+                sLog->outError("Guild::LoadGuildBankEventLogFromDB: Invalid tabid '%u' for guild bank log entry (guild: '%s', LogGuid: %u), skipped.", TabId, GetName().c_str(), NewEvent.LogGuid);
+                continue;
+            }
 
-        if (NewEvent.isMoneyEvent() && m_GuildBankEventLog_Money.size() >= GUILD_BANK_MAX_LOGS ||
-            m_GuildBankEventLog_Item[TabId].size() >= GUILD_BANK_MAX_LOGS)
-            continue;
+            if (NewEvent.isMoneyEvent() && m_GuildBankEventLog_Money.size() >= GUILD_BANK_MAX_LOGS ||
+                m_GuildBankEventLog_Item[TabId].size() >= GUILD_BANK_MAX_LOGS)
+                continue;
 
-        if (NewEvent.isMoneyEvent())
-            m_GuildBankEventLog_Money.push_front(NewEvent);
-        else
-            m_GuildBankEventLog_Item[TabId].push_front(NewEvent);
-    }while (result->NextRow());
+            if (NewEvent.isMoneyEvent())
+                m_GuildBankEventLog_Money.push_front(NewEvent);
+            else
+                m_GuildBankEventLog_Item[TabId].push_front(NewEvent);
+        }while (result->NextRow());
+    }
 
     // Check lists size in case to many event entries in db for a tab or for money
     // This cases can happen only if a crash occured somewhere and table has too many log entries
@@ -1590,6 +1756,10 @@ void Guild::LoadGuildBankEventLogFromDB()
                 m_Id, m_GuildBankEventLog_Item[i].front().LogGuid);
         }
     }
+
+    m_GuildBankEventLog_Money.splice(m_GuildBankEventLog_Money.end(), loggedMoney);
+    for (uint8 i = 0; i < GUILD_BANK_MAX_TABS; ++i)
+        m_GuildBankEventLog_Item[i].splice(m_GuildBankEventLog_Item[i].end(), loggedItem[i]);
 }
 
 void Guild::UnloadGuildBankEventLog()
@@ -1605,6 +1775,12 @@ void Guild::DisplayGuildBankLogs(WorldSession *session, uint8 TabId)
     if (TabId > GUILD_BANK_MAX_TABS)
         return;
 
+    if (!m_bankloaded)
+    {
+        AddPendingRequest(session, GUILD_REQUEST_BANK_LOGS, TabId);
+        return;
+    }
+
     if (TabId == GUILD_BANK_MAX_TABS)
     {
         // Here we display money logs
@@ -1976,6 +2152,12 @@ void Guild::SendGuildBankTabText(WorldSession *session, uint8 TabId)
     if (TabId > GUILD_BANK_MAX_TABS)
         return;
 
+    if (!m_bankloaded && session)
+    {
+        AddPendingRequest(session, GUILD_REQUEST_BANK_TAB_TEXT, TabId);
+        return;
+    }
+
     GuildBankTab const *tab = GetBankTab(TabId);
     if (!tab)
         return;
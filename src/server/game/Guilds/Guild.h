@@ -27,6 +27,8 @@
 #include "Item.h"
 
 class Item;
+class SqlQueryHolder;
+class GuildLoadQueryHolder;
 
 #define GUILD_RANKS_MIN_COUNT   5
 #define GUILD_RANKS_MAX_COUNT   10
@@ -182,6 +184,41 @@ struct GuildEventlogEntry
     uint64 TimeStamp;
 };
 
+// bank and event log are fetched in one query holder when first needed
+enum GuildLoadQueryIndex
+{
+    GUILD_LOAD_QUERY_BANK_TABS          = 0,
+    GUILD_LOAD_QUERY_BANK_ITEMS         = 1,
+    GUILD_LOAD_QUERY_BANK_EVENTLOG      = 2,
+    GUILD_LOAD_QUERY_EVENTLOG           = 3,
+    MAX_GUILD_LOAD_QUERY
+};
+
+// client requests answered once the pending load is done
+enum GuildPendingRequestType
+{
+    GUILD_REQUEST_BANK_TABS_INFO        = 0,
+    GUILD_REQUEST_BANK_CONTENT          = 1,
+    GUILD_REQUEST_BANK_LOGS             = 2,
+    GUILD_REQUEST_BANK_TAB_TEXT         = 3,
+    GUILD_REQUEST_EVENTLOG              = 4,
+};
+
+struct GuildPendingRequest
+{
+    GuildPendingRequest(uint32 _accountId, GuildPendingRequestType _type, uint8 _tabId)
+        : accountId(_accountId), type(_type), tabId(_tabId) {}
+
+    bool operator==(GuildPendingRequest const& other) const
+    {
+        return accountId == other.accountId && type == other.type && tabId == other.tabId;
+    }
+
+    uint32 accountId;
+    GuildPendingRequestType type;
+    uint8 tabId;
+};
+
 enum GuildEmblem
 {
     ERR_GUILDEMBLEM_SUCCESS               = 0,
@@ -364,7 +401,7 @@ class Guild
 
         void UpdateLogoutTime(uint64 guid);
         // Guild eventlog
-        void   LoadGuildEventLogFromDB();
+        void   LoadGuildEventLogFromDB(QueryResult_AutoPtr result);
         void   UnloadGuildEventlog();
         void   DisplayGuildEventlog(WorldSession *session);
         void   LogGuildEvent(uint8 EventType, uint32 PlayerGuid1, uint32 PlayerGuid2, uint8 NewRank);
@@ -395,8 +432,11 @@ class Guild
         bool   IsMemberHaveRights(uint32 LowGuid, uint8 TabId, uint32 rights) const;
         bool   CanMemberViewTab(uint32 LowGuid, uint8 TabId) const;
         // Load/unload
-        void   LoadGuildBankFromDB();
+        void   LoadGuildBankFromDB(QueryResult_AutoPtr tabsResult, QueryResult_AutoPtr itemsResult);
         void   UnloadGuildBank();
+        bool   IsBankLoaded() const { return m_bankloaded; }
+        void   LoadBankAndEventLogAsync();
+        void   HandleLoadResult(GuildLoadQueryHolder* holder);
         void   IncOnlineMemberCount() { ++m_onlinemembers; }
         // Money deposit/withdraw
         void   SendMoneyInfo(WorldSession *session, uint32 LowGuid);
@@ -414,7 +454,7 @@ class Guild
         // rights per day
         bool   LoadBankRightsFromDB(QueryResult_AutoPtr guildBankTabRightsResult);
         // logs
-        void   LoadGuildBankEventLogFromDB();
+        void   LoadGuildBankEventLogFromDB(QueryResult_AutoPtr result);
         void   UnloadGuildBankEventLog();
         void   DisplayGuildBankLogs(WorldSession *session, uint8 TabId);
         void   LogBankEvent(uint8 LogEntry, uint8 TabId, uint32 PlayerGuidLow, uint32 ItemOrMoney, uint8 ItemStackCount=0, uint8 DestTabId=0);
@@ -466,8 +506,17 @@ class Guild
 
         uint32 LogMaxGuid;
         uint32 GuildEventlogMaxGuid;
+
+        // async load of bank and event log, see LoadBankAndEventLogAsync()
+        typedef std::vector<GuildPendingRequest> PendingRequestList;
+        PendingRequestList m_pendingRequests;
+        bool m_dataLoading;
+        uint32 m_loadEventLogGuid;                          // log entries below these guids were written before the load query
+        uint32 m_loadBankLogGuid;
     private:
         void UpdateAccountsNumber();
+        void AddPendingRequest(WorldSession *session, GuildPendingRequestType type, uint8 TabId = 0);
+        void SendPendingRequests();
         // internal common parts for CanStore/StoreItem functions
         void AppendDisplayGuildBankSlot(WorldPacket& data, GuildBankTab const *tab, int32 slot);
         uint8 _CanStoreItem_InSpecificSlot(uint8 tab, uint8 slot, GuildItemPosCountVec& dest, uint32& count, bool swap, Item *pSrcItem) const;
@@ -50,11 +50,13 @@ class LoginQueryHolder : public SqlQueryHolder
     private:
         uint32 m_accountId;
         uint64 m_guid;
+        uint32 m_loginTime;                                 // getMSTime() of CMSG_PLAYER_LOGIN
     public:
-        LoginQueryHolder(uint32 accountId, uint64 guid)
-            : m_accountId(accountId), m_guid(guid) { }
+        LoginQueryHolder(uint32 accountId, uint64 guid, uint32 loginTime)
+            : m_accountId(accountId), m_guid(guid), m_loginTime(loginTime) { }
         uint64 GetGuid() const { return m_guid; }
         uint32 GetAccountId() const { return m_accountId; }
+        uint32 GetLoginTime() const { return m_loginTime; }
         bool Initialize();
 };
 
@@ -447,6 +449,7 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket & recv_data)
     }
 
     m_playerLoading = true;
+    uint32 loginTime = getMSTime();
     uint64 playerGuid = 0;
 
     sLog->outDebug("WORLD: Recvd Player Logon Message");
@@ -456,7 +459,7 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket & recv_data)
     if (!CharacterDatabase.PQuery("SELECT 1 FROM characters WHERE guid='%d' AND account='%d'", GUID_LOPART(playerGuid), GetAccountId()))
         KickPlayer();
 
-    LoginQueryHolder *holder = new LoginQueryHolder(GetAccountId(), playerGuid);
+    LoginQueryHolder *holder = new LoginQueryHolder(GetAccountId(), playerGuid, loginTime);
     if (!holder->Initialize())
     {
         delete holder;                                      // delete all unprocessed queries
@@ -499,6 +502,8 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder * holder)
     data << pCurrChar->GetOrientation();
     SendPacket(&data);
 
+    sWorld->RecordLoginTime(getMSTimeDiff(holder->GetLoginTime(), getMSTime()));
+
     data.Initialize(SMSG_ACCOUNT_DATA_TIMES, 128);
     for (int i = 0; i < 32; i++)
         data << uint32(0);
@@ -1071,6 +1071,10 @@ void WorldSession::HandleGuildBankDepositItem(WorldPacket & recv_data)
     if (!pGuild)
         return;
 
+    // bank content still loading, the client resends after the tabs arrive
+    if (!pGuild->IsBankLoaded())
+        return;
+
     Player *pl = GetPlayer();
 
     // player->bank or bank->bank check if tab is correct to prevent crash
@@ -1529,6 +1533,9 @@ void WorldSession::HandleGuildBankBuyTab(WorldPacket & recv_data)
     if (!pGuild)
         return;
 
+    if (!pGuild->IsBankLoaded())
+        return;
+
     uint32 TabCost = sObjectMgr->GetGuildBankTabPrice(TabId) * GOLD;
     if (!TabCost)
         return;
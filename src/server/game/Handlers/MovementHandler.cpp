@@ -327,9 +327,9 @@ void WorldSession::HandleMovementOpcodes(WorldPacket & recv_data)
     data << mover->GetPackGUID();
     data.append(recv_data.contents(), recv_data.size());
     if (mover->isCharmed() && mover->GetCharmer())
-        mover->GetCharmer()->SendMessageToSet(&data, false);
+        mover->GetCharmer()->SendMovementMessageToSet(&data, opcode == MSG_MOVE_HEARTBEAT);
     else
-        mover->SendMessageToSet(&data, false);
+        mover->SendMovementMessageToSet(&data, opcode == MSG_MOVE_HEARTBEAT);
 
     mover->m_movementInfo = movementInfo;
     mover->SetPosition(movementInfo.GetPos()->GetPositionX(), movementInfo.GetPos()->GetPositionY(), movementInfo.GetPos()->GetPositionZ(), movementInfo.GetPos()->GetOrientation());
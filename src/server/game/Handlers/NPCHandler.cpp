@@ -269,6 +269,9 @@ void WorldSession::HandleGossipHelloOpcode(WorldPacket & recv_data)
     //if (GetPlayer()->hasUnitState(UNIT_STAT_DIED))
     //    GetPlayer()->RemoveSpellsCausingAura(SPELL_AURA_FEIGN_DEATH);
 
+    // gossip scripts may start timers or movement
+    unit->WakeUp();
+
     if (unit->isArmorer() || unit->isCivilian() || unit->isQuestGiver() || unit->isServiceProvider())
     {
         unit->StopMoving();
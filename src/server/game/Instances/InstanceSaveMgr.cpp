@@ -39,9 +39,15 @@
 #include "World.h"
 #include "Group.h"
 #include "InstanceScript.h"
+#include "SqlOperations.h"
+
+// ids per IN list / rows per INSERT for the set based instance cleanup
+#define INSTANCE_CLEANUP_BATCH 1000
 
 InstanceSaveManager::~InstanceSaveManager()
 {
+    WaitOnlineCleanup();
+
     // it is undefined whether this or objectmgr will be unloaded first
     // so we must be prepared for both cases
     lock_instLists = true;
@@ -212,33 +218,70 @@ bool InstanceSave::UnloadIfEmpty()
         return true;
 }
 
-void InstanceSaveManager::_DelHelper(DatabaseType &db, const char *fields, const char *table, const char *queryTail, ...)
+void InstanceSaveManager::_DelHelper(DatabaseType &db, const char *table, const char *queryTail, ...)
 {
-    Tokens fieldTokens = StrSplit(fields, ", ");
-    ASSERT(fieldTokens.size() != 0);
-
     va_list ap;
     char szQueryTail [MAX_QUERY_LEN];
     va_start(ap, queryTail);
     vsnprintf(szQueryTail, MAX_QUERY_LEN, queryTail, ap);
     va_end(ap);
 
-    QueryResult_AutoPtr result = db.PQuery("SELECT %s FROM %s %s", fields, table, szQueryTail);
+    // one multi-table DELETE instead of a SELECT and a DELETE per found row
+    db.DirectPExecute("DELETE %s FROM %s %s", table, table, szQueryTail);
+}
+
+// Restricts a cleanup statement to instance ids nobody can be using right now.
+// At startup nothing is loaded yet, online runs skip every id the world thread
+// knew about when the run was started and everything created after it
+std::string InstanceSaveManager::_CleanupFilter(const char *column, InstanceCleanupSnapshot const* snapshot)
+{
+    if (!snapshot)
+        return "";
+
+    std::ostringstream ss;
+    ss << " AND " << column << " <= " << snapshot->maxInstanceId;
+    if (!snapshot->liveIds.empty())
+    {
+        ss << " AND " << column << " NOT IN (";
+        for (std::set<uint32>::const_iterator itr = snapshot->liveIds.begin(); itr != snapshot->liveIds.end(); ++itr)
+            ss << (itr != snapshot->liveIds.begin() ? "," : "") << *itr;
+        ss << ")";
+    }
+    return ss.str();
+}
+
+// Deletes the rows of a world table that reference instances missing from the character `instance` table.
+// The two tables can live on different servers, so the orphans are sent back as batched IN lists.
+uint32 InstanceSaveManager::_DeleteOrphanRespawns(const char *table, std::set<uint32> const& instanceSet, InstanceCleanupSnapshot const* snapshot)
+{
+    std::vector<uint32> orphans;
+    QueryResult_AutoPtr result = WorldDatabase.PQuery("SELECT DISTINCT(instance) FROM %s WHERE instance <> 0%s", table, _CleanupFilter("instance", snapshot).c_str());
     if (result)
     {
         do
         {
-            Field *fields = result->Fetch();
-            std::ostringstream ss;
-            for (size_t i = 0; i < fieldTokens.size(); i++)
-            {
-                std::string fieldValue = fields[i].GetCppString();
-                db.EscapeString(fieldValue);
-                ss << (i != 0 ? " AND " : "") << fieldTokens[i] << " = '" << fieldValue << "'";
-            }
-            db.DirectPExecute("DELETE FROM %s WHERE %s", table, ss.str().c_str());
-        } while (result->NextRow());
+            uint32 instance = result->Fetch()[0].GetUInt32();
+            if (instanceSet.find(instance) == instanceSet.end())
+                orphans.push_back(instance);
+        }
+        while (result->NextRow());
     }
+
+    if (orphans.empty())
+        return 0;
+
+    WorldDatabase.BeginTransaction();
+    for (size_t i = 0; i < orphans.size(); i += INSTANCE_CLEANUP_BATCH)
+    {
+        std::ostringstream ss;
+        for (size_t j = i; j < orphans.size() && j < i + INSTANCE_CLEANUP_BATCH; ++j)
+            ss << (j != i ? "," : "") << orphans[j];
+        WorldDatabase.PExecute("DELETE FROM %s WHERE instance IN (%s)", table, ss.str().c_str());
+    }
+    // the startup run is followed by the respawn time loading
+    _CommitTransaction(WorldDatabase, !snapshot);
+
+    return orphans.size();
 }
 
 void InstanceSaveManager::CleanupInstances()
@@ -246,16 +289,29 @@ void InstanceSaveManager::CleanupInstances()
     // load reset times and clean expired instances
     sInstanceSaveMgr->LoadResetTimes();
 
+    _CleanupInstanceReferences(NULL);
+}
+
+void InstanceSaveManager::_CleanupInstanceReferences(InstanceCleanupSnapshot const* snapshot)
+{
+    uint32 oldMSTime = getMSTime();
+
     // clean character/group - instance binds with invalid group/characters
-    _DelHelper(CharacterDatabase, "character_instance.guid, instance", "character_instance", "LEFT JOIN characters ON character_instance.guid = characters.guid WHERE characters.guid IS NULL");
-    _DelHelper(CharacterDatabase, "group_instance.leaderGuid, instance", "group_instance", "LEFT JOIN characters ON group_instance.leaderGuid = characters.guid LEFT JOIN groups ON group_instance.leaderGuid = groups.leaderGuid WHERE characters.guid IS NULL OR groups.leaderGuid IS NULL");
+    // deleted characters and groups can not come back, no filter needed
+    sLog->outString("Instance cleanup: removing binds of deleted characters and groups...");
+    _DelHelper(CharacterDatabase, "character_instance", "LEFT JOIN characters ON character_instance.guid = characters.guid WHERE characters.guid IS NULL");
+    _DelHelper(CharacterDatabase, "group_instance", "LEFT JOIN characters ON group_instance.leaderGuid = characters.guid LEFT JOIN groups ON group_instance.leaderGuid = groups.leaderGuid WHERE characters.guid IS NULL OR groups.leaderGuid IS NULL");
 
     // clean instances that do not have any players or groups bound to them
-    _DelHelper(CharacterDatabase, "id, map, difficulty", "instance", "LEFT JOIN character_instance ON character_instance.instance = id LEFT JOIN group_instance ON group_instance.instance = id WHERE character_instance.instance IS NULL AND group_instance.instance IS NULL");
+    sLog->outString("Instance cleanup: removing unbound instances...");
+    _DelHelper(CharacterDatabase, "instance", "LEFT JOIN character_instance ON character_instance.instance = id LEFT JOIN group_instance ON group_instance.instance = id WHERE character_instance.instance IS NULL AND group_instance.instance IS NULL%s", _CleanupFilter("id", snapshot).c_str());
 
     // clean invalid instance references in other tables
-    _DelHelper(CharacterDatabase, "character_instance.guid, instance", "character_instance", "LEFT JOIN instance ON character_instance.instance = instance.id WHERE instance.id IS NULL");
-    _DelHelper(CharacterDatabase, "group_instance.leaderGuid, instance", "group_instance", "LEFT JOIN instance ON group_instance.instance = instance.id WHERE instance.id IS NULL");
+    sLog->outString("Instance cleanup: removing references to missing instances...");
+    _DelHelper(CharacterDatabase, "character_instance", "LEFT JOIN instance ON character_instance.instance = instance.id WHERE instance.id IS NULL%s", _CleanupFilter("character_instance.instance", snapshot).c_str());
+    _DelHelper(CharacterDatabase, "group_instance", "LEFT JOIN instance ON group_instance.instance = instance.id WHERE instance.id IS NULL%s", _CleanupFilter("group_instance.instance", snapshot).c_str());
+    CharacterDatabase.DirectPExecute("UPDATE characters LEFT JOIN instance ON characters.instance_id = instance.id SET characters.instance_id = 0 WHERE characters.instance_id <> 0 AND instance.id IS NULL%s", _CleanupFilter("characters.instance_id", snapshot).c_str());
+    CharacterDatabase.DirectPExecute("UPDATE corpse LEFT JOIN instance ON corpse.instance = instance.id SET corpse.instance = 0 WHERE corpse.instance <> 0 AND instance.id IS NULL%s", _CleanupFilter("corpse.instance", snapshot).c_str());
 
     // creature_respawn and gameobject_respawn are in another database
     // first, obtain total instance set
@@ -271,66 +327,61 @@ void InstanceSaveManager::CleanupInstances()
         while (result->NextRow());
     }
 
-    // creature_respawn
-    result = WorldDatabase.Query("SELECT DISTINCT(instance) FROM creature_respawn WHERE instance <> 0");
-    if (result)
-    {
-        do
-        {
-            Field *fields = result->Fetch();
-            if (InstanceSet.find(fields[0].GetUInt32()) == InstanceSet.end())
-                WorldDatabase.DirectPExecute("DELETE FROM creature_respawn WHERE instance = '%u'", fields[0].GetUInt32());
-        }
-        while (result->NextRow());
-    }
+    sLog->outString("Instance cleanup: removing respawn times of missing instances...");
+    uint32 creatureOrphans = _DeleteOrphanRespawns("creature_respawn", InstanceSet, snapshot);
+    uint32 gameobjectOrphans = _DeleteOrphanRespawns("gameobject_respawn", InstanceSet, snapshot);
 
-    // gameobject_respawn
-    result = WorldDatabase.Query("SELECT DISTINCT(instance) FROM gameobject_respawn WHERE instance <> 0");
-    if (result)
-    {
-        do
-        {
-            Field *fields = result->Fetch();
-            if (InstanceSet.find(fields[0].GetUInt32()) == InstanceSet.end())
-                WorldDatabase.DirectPExecute("DELETE FROM gameobject_respawn WHERE instance = '%u'", fields[0].GetUInt32());
-        }
-        while (result->NextRow());
-    }
+    sLog->outString();
+    sLog->outString(">> Initialized %u instances, cleared respawn times of %u + %u missing instances in %u ms", (uint32)InstanceSet.size(), creatureOrphans, gameobjectOrphans, GetMSTimeDiffToNow(oldMSTime));
+}
 
-    // characters
-    result = CharacterDatabase.Query("SELECT DISTINCT(instance_id) FROM characters WHERE instance_id <> 0");
-    if (result)
+// Moves every value of table.column found in instance_pack.old_id to the matching new_id.
+// Done in two passes through a free id range so that the (guid, instance) style
+// keys never see two rows with the same id, whatever order MySQL updates them in.
+void InstanceSaveManager::_RemapInstanceColumn(DatabaseType &db, const char *table, const char *column, uint32 offset)
+{
+    db.PExecute("UPDATE %s JOIN instance_pack ON %s.%s = instance_pack.old_id SET %s.%s = instance_pack.new_id + %u",
+        table, table, column, table, column, offset);
+    db.PExecute("UPDATE %s SET %s = %s - %u WHERE %s >= %u", table, column, column, offset, column, offset);
+}
+
+void InstanceSaveManager::_FillInstancePackTable(DatabaseType &db, std::vector<std::pair<uint32, uint32> > const& remap)
+{
+    db.Execute("DROP TEMPORARY TABLE IF EXISTS instance_pack");
+    db.Execute("CREATE TEMPORARY TABLE instance_pack (old_id INT UNSIGNED NOT NULL PRIMARY KEY, new_id INT UNSIGNED NOT NULL)");
+
+    for (size_t i = 0; i < remap.size(); i += INSTANCE_CLEANUP_BATCH)
     {
-        do
-        {
-            Field *fields = result->Fetch();
-            if (InstanceSet.find(fields[0].GetUInt32()) == InstanceSet.end())
-                CharacterDatabase.DirectPExecute("UPDATE characters SET instance_id = '0' WHERE instance_id = '%u'", fields[0].GetUInt32());
-        }
-        while (result->NextRow());
+        std::ostringstream ss;
+        ss << "INSERT INTO instance_pack (old_id, new_id) VALUES ";
+        for (size_t j = i; j < remap.size() && j < i + INSTANCE_CLEANUP_BATCH; ++j)
+            ss << (j != i ? "," : "") << "(" << remap[j].first << "," << remap[j].second << ")";
+        db.Execute(ss.str().c_str());
     }
+}
 
-    // corpse
-    result = CharacterDatabase.Query("SELECT DISTINCT(instance) FROM corpse WHERE instance <> 0");
-    if (result)
+// Commits the transaction this thread opened with BeginTransaction. With wait it is run
+// before returning, on this thread, for the startup steps whose tables are read right after;
+// otherwise it goes to the delay thread like every other queued transaction.
+void InstanceSaveManager::_CommitTransaction(DatabaseType &db, bool wait)
+{
+    if (wait)
     {
-        do
+        if (SqlTransaction* trans = db.DetachTransaction())
         {
-            Field *fields = result->Fetch();
-            if (InstanceSet.find(fields[0].GetUInt32()) == InstanceSet.end())
-                CharacterDatabase.DirectPExecute("UPDATE corpse SET instance = '0' WHERE instance = '%u'", fields[0].GetUInt32());
+            trans->Execute(&db);
+            delete trans;
+            return;
         }
-        while (result->NextRow());
     }
 
-    sLog->outString();
-    sLog->outString(">> Initialized %u instances", (uint32)InstanceSet.size());
+    db.CommitTransaction();
 }
 
 void InstanceSaveManager::PackInstances()
 {
     // this routine renumbers player instance associations in such a way so they start from 1 and go up
-    // TODO: this can be done a LOT more efficiently
+    uint32 oldMSTime = getMSTime();
 
     // obtain set of all associations
     std::set<uint32> InstanceSet;
@@ -349,27 +400,98 @@ void InstanceSaveManager::PackInstances()
         while (result->NextRow());
     }
 
+    std::vector<std::pair<uint32, uint32> > remap;
+
     uint32 InstanceNumber = 1;
     // we do assume std::set is sorted properly on integer value
     for (std::set<uint32>::iterator i = InstanceSet.begin(); i != InstanceSet.end(); ++i)
     {
         if (*i != InstanceNumber)
-        {
-            // remap instance id
-            WorldDatabase.PExecute("UPDATE creature_respawn SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            WorldDatabase.PExecute("UPDATE gameobject_respawn SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE characters SET instance_id = '%u' WHERE instance_id = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE corpse SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE character_instance SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE instance SET id = '%u' WHERE id = '%u'", InstanceNumber, *i);
-            CharacterDatabase.PExecute("UPDATE group_instance SET instance = '%u' WHERE instance = '%u'", InstanceNumber, *i);
-        }
+            remap.push_back(std::make_pair(*i, InstanceNumber));
 
         ++InstanceNumber;
     }
 
+    if (!remap.empty())
+    {
+        // ids above the highest current one are free for the intermediate pass
+        uint32 offset = *InstanceSet.rbegin() + 1;
+
+        sLog->outString("Packing instances: renumbering %u instances...", uint32(remap.size()));
+
+        // remapped synchronously, creature and gameobject respawn times are loaded right after
+        CharacterDatabase.BeginTransaction();
+        _FillInstancePackTable(CharacterDatabase, remap);
+        _RemapInstanceColumn(CharacterDatabase, "characters", "instance_id", offset);
+        _RemapInstanceColumn(CharacterDatabase, "corpse", "instance", offset);
+        _RemapInstanceColumn(CharacterDatabase, "character_instance", "instance", offset);
+        _RemapInstanceColumn(CharacterDatabase, "group_instance", "instance", offset);
+        _RemapInstanceColumn(CharacterDatabase, "instance", "id", offset);
+        CharacterDatabase.Execute("DROP TEMPORARY TABLE instance_pack");
+        _CommitTransaction(CharacterDatabase, true);
+
+        WorldDatabase.BeginTransaction();
+        _FillInstancePackTable(WorldDatabase, remap);
+        _RemapInstanceColumn(WorldDatabase, "creature_respawn", "instance", offset);
+        _RemapInstanceColumn(WorldDatabase, "gameobject_respawn", "instance", offset);
+        WorldDatabase.Execute("DROP TEMPORARY TABLE instance_pack");
+        _CommitTransaction(WorldDatabase, true);
+    }
+
     sLog->outString();
-    sLog->outString(">> Instance numbers remapped, next instance id is %u", InstanceNumber);
+    sLog->outString(">> Instance numbers remapped, next instance id is %u (%u renumbered in %u ms)", InstanceNumber, uint32(remap.size()), GetMSTimeDiffToNow(oldMSTime));
+}
+
+class InstanceCleanupRunnable : public ACE_Based::Runnable
+{
+    public:
+        InstanceCleanupRunnable(InstanceSaveManager::InstanceCleanupSnapshot* snapshot) : m_snapshot(snapshot) {}
+        ~InstanceCleanupRunnable() { delete m_snapshot; }
+
+        void run()
+        {
+            CharacterDatabase.ThreadStart();
+            WorldDatabase.ThreadStart();
+
+            sLog->outString("Instance cleanup: online run started (instances up to %u, %u in use skipped)", m_snapshot->maxInstanceId, uint32(m_snapshot->liveIds.size()));
+            sInstanceSaveMgr->_CleanupInstanceReferences(m_snapshot);
+            sInstanceSaveMgr->m_onlineCleanupRunning = false;
+
+            WorldDatabase.ThreadEnd();
+            CharacterDatabase.ThreadEnd();
+        }
+
+    private:
+        InstanceSaveManager::InstanceCleanupSnapshot* m_snapshot;
+};
+
+bool InstanceSaveManager::StartOnlineCleanup()
+{
+    if (m_onlineCleanupRunning)
+        return false;
+
+    // the previous run has finished, release its thread
+    WaitOnlineCleanup();
+    m_onlineCleanupRunning = true;
+
+    // taken on the world thread, the background thread only reads its copy
+    InstanceCleanupSnapshot* snapshot = new InstanceCleanupSnapshot();
+    snapshot->maxInstanceId = sMapMgr->GetMaxInstanceId();
+    for (InstanceSaveHashMap::const_iterator itr = m_instanceSaveById.begin(); itr != m_instanceSaveById.end(); ++itr)
+        snapshot->liveIds.insert(itr->first);
+
+    m_cleanupThread = new ACE_Based::Thread(new InstanceCleanupRunnable(snapshot));
+    return true;
+}
+
+void InstanceSaveManager::WaitOnlineCleanup()
+{
+    if (!m_cleanupThread)
+        return;
+
+    m_cleanupThread->wait();
+    delete m_cleanupThread;
+    m_cleanupThread = NULL;
 }
 
 void InstanceSaveManager::LoadResetTimes()
@@ -452,7 +574,7 @@ void InstanceSaveManager::LoadResetTimes()
 
     // clean expired instances, references to them will be deleted in CleanupInstances
     // must be done before calculating new reset times
-    _DelHelper(CharacterDatabase, "id, map, difficulty", "instance", "LEFT JOIN instance_reset ON mapid = map WHERE (instance.resettime < '"UI64FMTD"' AND instance.resettime > '0') OR (NOT instance_reset.resettime IS NULL AND instance_reset.resettime < '"UI64FMTD"')", (uint64)now, (uint64)now);
+    _DelHelper(CharacterDatabase, "instance", "LEFT JOIN instance_reset ON mapid = map WHERE (instance.resettime < '"UI64FMTD"' AND instance.resettime > '0') OR (NOT instance_reset.resettime IS NULL AND instance_reset.resettime < '"UI64FMTD"')", (uint64)now, (uint64)now);
 
     // calculate new global reset times for expired instances and those that have never been reset yet
     // add the global reset times to the priority queue
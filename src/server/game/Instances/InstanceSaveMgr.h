@@ -29,6 +29,7 @@
 #include <ace/Thread_Mutex.h>
 #include <list>
 #include <map>
+#include <set>
 
 struct InstanceTemplate;
 struct MapEntry;
@@ -117,8 +118,9 @@ class InstanceSaveManager
 {
     friend class ACE_Singleton<InstanceSaveManager, ACE_Null_Mutex>;
     friend class InstanceSave;
+    friend class InstanceCleanupRunnable;
 public:
-    InstanceSaveManager() : lock_instLists(false) {};
+    InstanceSaveManager() : lock_instLists(false), m_onlineCleanupRunning(false), m_cleanupThread(NULL) {};
     ~InstanceSaveManager();
 
         typedef std::map<uint32 /*InstanceId*/, InstanceSave*> InstanceSaveMap;
@@ -138,8 +140,22 @@ public:
         typedef std::multimap<time_t /*resetTime*/, InstResetEvent> ResetTimeQueue;
         typedef std::vector<time_t /*resetTime*/> ResetTimeVector;
 
+        /* instance ids an online cleanup run must leave alone */
+        struct InstanceCleanupSnapshot
+        {
+            InstanceCleanupSnapshot() : maxInstanceId(0) {}
+            uint32 maxInstanceId;
+            std::set<uint32> liveIds;
+        };
+
         void CleanupInstances();
         void PackInstances();
+        /* runs the reference cleanup of CleanupInstances on a background thread,
+           packing needs a server without loaded instances and stays startup only */
+        bool StartOnlineCleanup();
+        bool IsOnlineCleanupRunning() const { return m_onlineCleanupRunning; }
+        // joins the thread of the last online cleanup, at shutdown before the DB threads stop
+        void WaitOnlineCleanup();
 
         void LoadResetTimes();
         time_t GetResetTimeFor(uint32 mapid) { return m_resetTimeByMapId[mapid]; }
@@ -162,7 +178,13 @@ public:
         void _ResetOrWarnAll(uint32 mapid, bool warn, uint32 timeleft);
         void _ResetInstance(uint32 mapid, uint32 instanceId);
         void _ResetSave(InstanceSaveHashMap::iterator &itr);
-        void _DelHelper(DatabaseType &db, const char *fields, const char *table, const char *queryTail, ...);
+        void _DelHelper(DatabaseType &db, const char *table, const char *queryTail, ...);
+        void _CleanupInstanceReferences(InstanceCleanupSnapshot const* snapshot);
+        std::string _CleanupFilter(const char *column, InstanceCleanupSnapshot const* snapshot);
+        uint32 _DeleteOrphanRespawns(const char *table, std::set<uint32> const& instanceSet, InstanceCleanupSnapshot const* snapshot);
+        void _FillInstancePackTable(DatabaseType &db, std::vector<std::pair<uint32, uint32> > const& remap);
+        void _RemapInstanceColumn(DatabaseType &db, const char *table, const char *column, uint32 offset);
+        void _CommitTransaction(DatabaseType &db, bool wait);
         // used during global instance resets
         bool lock_instLists;
         // fast lookup by instance id
@@ -170,6 +192,8 @@ public:
         // fast lookup for reset times
         ResetTimeVector m_resetTimeByMapId;
         ResetTimeQueue m_resetTimeQueue;
+        volatile bool m_onlineCleanupRunning;
+        ACE_Based::Thread* m_cleanupThread;
 };
 
 #define sInstanceSaveMgr ACE_Singleton<InstanceSaveManager, ACE_Thread_Mutex>::instance()
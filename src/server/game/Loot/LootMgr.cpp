@@ -21,11 +21,15 @@
 #include "LootMgr.h"
 #include "Log.h"
 #include "ObjectMgr.h"
+#include "ObjectAccessor.h"
+#include "Group.h"
 
 #include "World.h"
 #include "Util.h"
 #include "SharedDefines.h"
 
+#include <ace/Atomic_Op.h>
+
 static Rates const qualityToRate[MAX_ITEM_QUALITY] = {
     RATE_DROP_ITEM_POOR,                                    // ITEM_QUALITY_POOR
     RATE_DROP_ITEM_NORMAL,                                  // ITEM_QUALITY_NORMAL
@@ -55,6 +59,7 @@ class LootTemplate::LootGroup                               // A set of loot def
         bool HasQuestDrop() const;                          // True if group includes at least 1 quest drop entry
         bool HasQuestDropForPlayer(Player const * player) const;
                                                             // The same for active quests of the player
+        void CollectQuestDrops(std::set<uint32>& items) const;
         void Process(Loot& loot) const;                     // Rolls an item from the group (if any) and adds the item to the loot
         float RawTotalChance() const;                       // Overall chance for the group (without equal chanced items)
         float TotalChance() const;                          // Overall chance for the group
@@ -75,6 +80,7 @@ void LootStore::Clear()
     for (LootTemplateMap::const_iterator itr=m_LootTemplates.begin(); itr != m_LootTemplates.end(); ++itr)
         delete itr->second;
     m_LootTemplates.clear();
+    m_questDrops.clear();
 }
 
 // Checks validity of the loot store
@@ -182,6 +188,25 @@ bool LootStore::HaveQuestLootForPlayer(uint32 loot_id, Player* player) const
     return false;
 }
 
+std::set<uint32> const* LootStore::GetQuestDrops(uint32 loot_id) const
+{
+    QuestDropMap::const_iterator itr = m_questDrops.find(loot_id);
+    return itr != m_questDrops.end() ? &itr->second : NULL;
+}
+
+void LootStore::CacheQuestDrops()
+{
+    m_questDrops.clear();
+
+    for (LootTemplateMap::const_iterator tab = m_LootTemplates.begin(); tab != m_LootTemplates.end(); ++tab)
+    {
+        std::set<uint32> items;
+        tab->second->CollectQuestDrops(items);
+        if (!items.empty())
+            m_questDrops[tab->first].swap(items);
+    }
+}
+
 LootTemplate const* LootStore::GetLootFor(uint32 loot_id) const
 {
     LootTemplateMap::const_iterator tab = m_LootTemplates.find(loot_id);
@@ -331,6 +356,77 @@ bool LootItem::AllowedForPlayer(Player const * player) const
     return true;
 }
 
+//
+// --------- LootSnapshot ---------
+//
+
+// corpses die, get looted and despawn on all map threads
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_lootSnapshotsTaken;
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_lootSnapshotsGenerated;
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_lootSnapshotsDiscarded;
+
+void LootSnapshot::Take(uint32 loot_id, LootStore const& store, Player* recipient)
+{
+    Release();
+
+    taken = true;
+    seed = uint32(rand32());
+    ++s_lootSnapshotsTaken;
+
+    if (!recipient)
+        return;
+
+    std::set<uint32> const* questDrops = store.GetQuestDrops(loot_id);
+
+    std::vector<Player*> looters;
+    if (Group* group = recipient->GetGroup())
+    {
+        for (GroupReference *itr = group->GetFirstMember(); itr != NULL; itr = itr->next())
+            if (Player* pl = itr->getSource())
+                looters.push_back(pl);
+    }
+    else
+        looters.push_back(recipient);
+
+    for (std::vector<Player*>::const_iterator itr = looters.begin(); itr != looters.end(); ++itr)
+    {
+        std::set<uint32>& needed = members[(*itr)->GetGUIDLow()];
+        if (!questDrops)
+            continue;
+
+        for (std::set<uint32>::const_iterator item = questDrops->begin(); item != questDrops->end(); ++item)
+            if ((*itr)->HasQuestForItem(*item))
+                needed.insert(*item);
+    }
+}
+
+void LootSnapshot::SetGenerated()
+{
+    if (taken && !generated)
+    {
+        generated = true;
+        ++s_lootSnapshotsGenerated;
+    }
+}
+
+void LootSnapshot::Release()
+{
+    if (taken && !generated)
+        ++s_lootSnapshotsDiscarded;
+
+    members.clear();
+    seed = 0;
+    taken = false;
+    generated = false;
+}
+
+void GetDeferredLootStats(DeferredLootStats& stats)
+{
+    stats.taken = uint32(s_lootSnapshotsTaken.value());
+    stats.generated = uint32(s_lootSnapshotsGenerated.value());
+    stats.discarded = uint32(s_lootSnapshotsDiscarded.value());
+}
+
 //
 // --------- Loot ---------
 //
@@ -360,7 +456,7 @@ void Loot::AddItem(LootStoreItem const & item)
 }
 
 // Calls processor of corresponding LootTemplate (which handles everything including references)
-void Loot::FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner)
+void Loot::FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner, LootSnapshot const* snapshot)
 {
     LootTemplate const* tab = store.GetLootFor(loot_id);
 
@@ -373,20 +469,35 @@ void Loot::FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner)
     items.reserve(MAX_NR_LOOT_ITEMS);
     quest_items.reserve(MAX_NR_QUEST_ITEMS);
 
+    m_snapshot = snapshot;
+
     tab->Process(*this, store);                             // Processing is done there, callback via Loot::AddItem()
 
     // Setting access rights fow group-looting case
-    if (!loot_owner)
-        return;
-    Group * pGroup=loot_owner->GetGroup();
-    if (!pGroup)
-        return;
-    for (GroupReference *itr = pGroup->GetFirstMember(); itr != NULL; itr = itr->next())
+    std::vector<Player*> members;
+    if (snapshot)
+    {
+        // the group at the death, members that went offline since get their lists if they loot
+        for (LootSnapshot::MemberQuestDrops::const_iterator itr = snapshot->members.begin(); itr != snapshot->members.end(); ++itr)
+            if (Player* pl = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER)))
+                members.push_back(pl);
+    }
+    else
+    {
+        if (!loot_owner)
+            return;
+        Group * pGroup=loot_owner->GetGroup();
+        if (!pGroup)
+            return;
+        for (GroupReference *itr = pGroup->GetFirstMember(); itr != NULL; itr = itr->next())
+            if (Player* pl = itr->getSource())
+                members.push_back(pl);
+    }
+
+    for (std::vector<Player*>::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
         //fill the quest item map for every player in the recipient's group
-        Player* pl = itr->getSource();
-        if (!pl)
-            continue;
+        Player* pl = *itr;
         uint32 plguid = pl->GetGUIDLow();
         QuestItemMap::iterator qmapitr = PlayerQuestItems.find(plguid);
         if (qmapitr == PlayerQuestItems.end())
@@ -406,6 +517,19 @@ void Loot::FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner)
     }
 }
 
+// Quest drops of a player in the snapshot follow the quest state at the death
+bool Loot::AllowedForPlayer(LootItem const& item, Player const* player) const
+{
+    if (m_snapshot && item.needs_quest)
+    {
+        LootSnapshot::MemberQuestDrops::const_iterator itr = m_snapshot->members.find(player->GetGUIDLow());
+        if (itr != m_snapshot->members.end())
+            return sObjectMgr->IsPlayerMeetToCondition(player, item.conditionId) && itr->second.find(item.itemid) != itr->second.end();
+    }
+
+    return item.AllowedForPlayer(player);
+}
+
 QuestItemList* Loot::FillFFALoot(Player* player)
 {
     QuestItemList *ql = new QuestItemList();
@@ -437,7 +561,7 @@ QuestItemList* Loot::FillQuestLoot(Player* player)
     for (uint8 i = 0; i < quest_items.size(); i++)
     {
         LootItem &item = quest_items[i];
-        if (!item.is_looted && item.AllowedForPlayer(player))
+        if (!item.is_looted && AllowedForPlayer(item, player))
         {
             ql->push_back(QuestItem(i));
 
@@ -812,6 +936,16 @@ bool LootTemplate::LootGroup::HasQuestDropForPlayer(Player const * player) const
     return false;
 }
 
+void LootTemplate::LootGroup::CollectQuestDrops(std::set<uint32>& items) const
+{
+    for (LootStoreItemList::const_iterator i=ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+        if (i->needs_quest)
+            items.insert(i->itemid);
+    for (LootStoreItemList::const_iterator i=EqualChanced.begin(); i != EqualChanced.end(); ++i)
+        if (i->needs_quest)
+            items.insert(i->itemid);
+}
+
 // Rolls an item from the group (if any takes its chance) and adds the item to the loot
 void LootTemplate::LootGroup::Process(Loot& loot) const
 {
@@ -1001,6 +1135,30 @@ bool LootTemplate::HasQuestDropForPlayer(LootTemplateMap const& store, Player co
     return false;
 }
 
+void LootTemplate::CollectQuestDrops(std::set<uint32>& items, uint8 groupId) const
+{
+    if (groupId)                                            // Group reference
+    {
+        if (groupId <= Groups.size())
+            Groups[groupId-1].CollectQuestDrops(items);
+        return;
+    }
+
+    for (LootStoreItemList::const_iterator i = Entries.begin(); i != Entries.end(); ++i)
+    {
+        if (i->mincountOrRef < 0)                           // References, resolved the way Process() does
+        {
+            if (LootTemplate const* Referenced = LootTemplates_Reference.GetLootFor(-i->mincountOrRef))
+                Referenced->CollectQuestDrops(items, i->group);
+        }
+        else if (i->needs_quest)
+            items.insert(i->itemid);
+    }
+
+    for (LootGroups::const_iterator i = Groups.begin(); i != Groups.end(); ++i)
+        i->CollectQuestDrops(items);
+}
+
 // Checks integrity of the template
 void LootTemplate::Verify(LootStore const& lootstore, uint32 id) const
 {
@@ -1052,6 +1210,9 @@ void LoadLootTemplates_Creature()
 
     // output error for any still listed (not referenced from appropriate table) ids
     LootTemplates_Creature.ReportUnusedIds(ids_set);
+
+    // for the loot snapshots taken at each death
+    LootTemplates_Creature.CacheQuestDrops();
 }
 
 void LoadLootTemplates_Disenchant()
@@ -1239,5 +1400,8 @@ void LoadLootTemplates_Reference()
 
     // output error for any still listed ids (not referenced from any loot table)
     LootTemplates_Reference.ReportUnusedIds(ids_set);
+
+    // the quest drops of the creature templates include the referenced ones
+    LootTemplates_Creature.CacheQuestDrops();
 }
 
@@ -26,6 +26,7 @@
 #include "LinkedReference/RefManager.h"
 
 #include <map>
+#include <set>
 #include <vector>
 
 #define MAX_NR_LOOT_ITEMS 16
@@ -135,6 +136,10 @@ class LootStore
         bool HaveLootFor(uint32 loot_id) const { return m_LootTemplates.find(loot_id) != m_LootTemplates.end(); }
         bool HaveQuestLootFor(uint32 loot_id) const;
         bool HaveQuestLootForPlayer(uint32 loot_id, Player* player) const;
+        // item ids of all quest drops the template can produce, NULL when it has none
+        std::set<uint32> const* GetQuestDrops(uint32 loot_id) const;
+        // collects them per template, again whenever the referenced templates change
+        void CacheQuestDrops();
 
         LootTemplate const* GetLootFor(uint32 loot_id) const;
 
@@ -144,7 +149,10 @@ class LootStore
         void LoadLootTable();
         void Clear();
     private:
+        typedef UNORDERED_MAP<uint32, std::set<uint32> > QuestDropMap;
+
         LootTemplateMap m_LootTemplates;
+        QuestDropMap m_questDrops;
         char const* m_name;
         char const* m_entryName;
 };
@@ -164,6 +172,8 @@ class LootTemplate
         bool HasQuestDrop(LootTemplateMap const& store, uint8 GroupId = 0) const;
         // True if template includes at least 1 quest drop for an active quest of the player
         bool HasQuestDropForPlayer(LootTemplateMap const& store, Player const * player, uint8 GroupId = 0) const;
+        // Adds the item ids of all quest drops of the template, references included
+        void CollectQuestDrops(std::set<uint32>& items, uint8 GroupId = 0) const;
 
         // Checks integrity of the template
         void Verify(LootStore const& store, uint32 Id) const;
@@ -201,6 +211,41 @@ class LootValidatorRefManager : public RefManager<Loot, LootValidatorRef>
 
 //=====================================================
 
+// What the body loot of a creature depends on, taken when it dies. The loot itself is only
+// generated by the first loot request, most killed trash is never opened, and replays the
+// rolls from the seed and the quest drops from the quest state at the death.
+struct LootSnapshot
+{
+    // guid low of the recipient or of each member of its group at the death, and the quest drops
+    // of the loot template each of them had a quest for
+    typedef std::map<uint32, std::set<uint32> > MemberQuestDrops;
+
+    LootSnapshot() : seed(0), taken(false), generated(false) {}
+    ~LootSnapshot() { Release(); }
+
+    void Take(uint32 loot_id, LootStore const& store, Player* recipient);
+    // the loot was generated from it
+    void SetGenerated();
+    // the corpse is gone, counts the snapshot as discarded unless its loot was generated
+    void Release();
+
+    MemberQuestDrops members;
+    uint32 seed;
+    bool taken;
+    bool generated;
+};
+
+struct DeferredLootStats
+{
+    uint32 taken;
+    uint32 generated;
+    uint32 discarded;
+};
+
+void GetDeferredLootStats(DeferredLootStats& stats);
+
+//=====================================================
+
 struct Loot
 {
     QuestItemMap const& GetPlayerQuestItems() const { return PlayerQuestItems; }
@@ -216,7 +261,7 @@ struct Loot
     uint32 gold;
     uint8 unlootedCount;
 
-    Loot(uint32 _gold = 0) : gold(_gold), unlootedCount(0) {}
+    Loot(uint32 _gold = 0) : gold(_gold), unlootedCount(0), m_snapshot(NULL) {}
     ~Loot() { clear(); }
 
     // if loot becomes invalid this reference is used to inform the listener
@@ -244,6 +289,7 @@ struct Loot
         quest_items.clear();
         gold = 0;
         unlootedCount = 0;
+        m_snapshot = NULL;
         i_LootValidatorRefManager.clearReferences();
     }
 
@@ -257,7 +303,8 @@ struct Loot
     void RemoveLooter(uint64 GUID) { PlayersLooting.erase(GUID); }
 
     void generateMoneyLoot(uint32 minAmount, uint32 maxAmount);
-    void FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner);
+    // with a snapshot the group and quest state of the snapshot are used instead of the current ones
+    void FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner, LootSnapshot const* snapshot = NULL);
 
     // Inserts the item into the loot (called by LootTemplate processors)
     void AddItem(LootStoreItem const & item);
@@ -266,6 +313,8 @@ struct Loot
     uint32 GetMaxSlotInLootFor(Player* player) const;
 
     private:
+        bool AllowedForPlayer(LootItem const& item, Player const* player) const;
+
         std::set<uint64> PlayersLooting;
         QuestItemMap PlayerQuestItems;
         QuestItemMap PlayerFFAItems;
@@ -273,6 +322,8 @@ struct Loot
 
         // All rolls are registered here. They need to know, when the loot is not valid anymore
         LootValidatorRefManager i_LootValidatorRefManager;
+
+        LootSnapshot const* m_snapshot;
 };
 
 struct LootView
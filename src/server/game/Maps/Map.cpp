@@ -31,6 +31,11 @@
 #include "ObjectAccessor.h"
 #include "MapManager.h"
 #include "ObjectMgr.h"
+#include "WalkMap.h"
+#include "PathPlanner.h"
+#include "TickProfiler.h"
+#include "Util.h"
+#include "Timer.h"
 
 #define DEFAULT_GRID_EXPIRY     300
 #define MAX_GRID_LOAD_TIME      50
@@ -53,6 +58,9 @@ Map::~Map()
 
     if (!m_scriptSchedule.empty())
         sWorld->DecreaseScheduledScriptCount(m_scriptSchedule.size());
+
+    delete m_randomStream;
+    delete m_pathPlanner;
 }
 
 bool Map::ExistMap(uint32 mapid, int gx, int gy)
@@ -159,6 +167,17 @@ void Map::LoadMap(int gx, int gy, bool reload)
         sLog->outError("Error loading map file: \n %s\n", tmp);
     }
     delete [] tmp;
+
+    if (!sWorld->getConfig(CONFIG_PATHFINDING_ENABLE))
+        return;
+
+    // walk file name, the tile simply has no walkability layer without it
+    len = sWorld->GetDataPath().length()+strlen("walkmaps/%03u%02u%02u.walk")+1;
+    tmp = new char[len];
+    snprintf(tmp, len, (char *)(sWorld->GetDataPath()+"walkmaps/%03u%02u%02u.walk").c_str(), GetId(), gx, gy);
+    if (GridMaps[gx][gy]->loadWalkData(tmp))
+        sLog->outDetail("Loaded walk map %s", tmp);
+    delete [] tmp;
 }
 
 void Map::LoadMapAndVMap(int gx, int gy)
@@ -188,8 +207,9 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode, Map* _par
 i_mapEntry (sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode), i_InstanceId(InstanceId),
 m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
 m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
+m_awakeObjects(0), m_dormantObjects(0), m_randomStream(NULL), m_pathPlanner(NULL),
 m_activeNonPlayersIter(m_activeNonPlayers.end()), i_gridExpiry(expiry),
-i_scriptLock(false)
+i_scriptLock(false), m_scriptClock(0), m_scriptOrder(0)
 {
     m_parentMap = (_parent ? _parent : this);
 
@@ -205,6 +225,12 @@ i_scriptLock(false)
 
     //lets initialize visibility distance for map
     Map::InitVisibilityDistance();
+
+    m_pathPlanner = new PathPlanner(*this);
+
+    // same seed, map and instance id give the same sequence of rolls on every run
+    if (uint32 seed = sWorld->getConfig(CONFIG_RANDOM_MAP_SEED))
+        m_randomStream = new RandomStream(seed ^ (id * 0x9E3779B9) ^ (InstanceId * 0x85EBCA6B));
 }
 
 void Map::InitVisibilityDistance()
@@ -212,6 +238,16 @@ void Map::InitVisibilityDistance()
     //init visibility for continents
     m_VisibleDistance = sWorld->GetMaxVisibleDistanceOnContinents();
     m_VisibilityNotifyPeriod = World::GetVisibilityNotifyPeriodOnContinents();
+    SetMovementTiers(sWorld->getConfig(CONFIG_MOVEMENT_TIER_NEAR_CONTINENTS), sWorld->getConfig(CONFIG_MOVEMENT_TIER_MID_CONTINENTS));
+}
+
+void Map::SetMovementTiers(uint32 nearDist, uint32 midDist)
+{
+    if (midDist < nearDist)
+        midDist = nearDist;
+
+    m_MovementTierDistSq[MOVEMENT_TIER_NEAR] = float(nearDist) * float(nearDist);
+    m_MovementTierDistSq[MOVEMENT_TIER_MID] = float(midDist) * float(midDist);
 }
 
 // Template specialization of utility methods
@@ -317,7 +353,12 @@ Map::EnsureGridCreated(const GridPair &p)
             int gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
 
             if (!GridMaps[gx][gy])
+            {
+                uint32 startTime = getMSTime();
                 LoadMapAndVMap(gx, gy);
+                ++m_gridLoadStats.terrainLoads;
+                m_gridLoadStats.terrainTime += getMSTimeDiff(startTime, getMSTime());
+            }
         }
     }
 }
@@ -357,23 +398,131 @@ bool Map::EnsureGridLoaded(const Cell &cell)
         sLog->outDebug("Loading grid[%u, %u] for map %u instance %u", cell.GridX(), cell.GridY(), GetId(), i_InstanceId);
 
         setGridObjectDataLoaded(true, cell.GridX(), cell.GridY());
+        ++m_gridLoadStats.grids;
 
+        uint32 startTime = getMSTime();
+        uint32 cells = 0;
         ObjectGridLoader loader(*grid, this, cell);
-        loader.LoadN();
+
+        // instance scripts expect all their creatures at once
+        if (!sWorld->getConfig(CONFIG_GRID_LOAD_TICK_BUDGET) || Instanceable())
+        {
+            loader.LoadN();
+            cells = MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS;
+        }
+        else
+        {
+            // the cells around the trigger now, the others ring by ring outwards over the next ticks
+            uint32 nearCells = sWorld->getConfig(CONFIG_GRID_LOAD_NEAR_CELLS);
+            for (uint32 ring = 0; ring < MAX_NUMBER_OF_CELLS; ++ring)
+            {
+                for (uint32 x = 0; x < MAX_NUMBER_OF_CELLS; ++x)
+                {
+                    for (uint32 y = 0; y < MAX_NUMBER_OF_CELLS; ++y)
+                    {
+                        if (std::max(abs(int32(x) - int32(cell.CellX())), abs(int32(y) - int32(cell.CellY()))) != int32(ring))
+                            continue;
+
+                        if (ring <= nearCells)
+                        {
+                            loader.LoadCell(x, y);
+                            ++cells;
+                            continue;
+                        }
+
+                        PendingCellLoad load;
+                        load.gridX = cell.GridX();
+                        load.gridY = cell.GridY();
+                        load.cellX = x;
+                        load.cellY = y;
+                        m_pendingCellLoads.push_back(load);
+                    }
+                }
+            }
+        }
+
+        m_gridLoadStats.nearCells += cells;
+        m_gridLoadStats.nearObjects += loader.GetLoadedObjectCount();
+        m_gridLoadStats.nearTime += getMSTimeDiff(startTime, getMSTime());
 
         // Add resurrectable corpses to world object list in grid
         sObjectAccessor->AddCorpsesToGrid(GridPair(cell.GridX(), cell.GridY()), (*grid)(cell.CellX(), cell.CellY()), this);
         return true;
     }
 
+    // a deferred cell is needed before its turn
+    if (!grid->isCellObjectDataLoaded(cell.CellX(), cell.CellY()))
+    {
+        uint32 startTime = getMSTime();
+        ObjectGridLoader loader(*grid, this, cell);
+        loader.LoadCell(cell.CellX(), cell.CellY());
+
+        ++m_gridLoadStats.forcedCells;
+        m_gridLoadStats.forcedObjects += loader.GetLoadedObjectCount();
+        m_gridLoadStats.forcedTime += getMSTimeDiff(startTime, getMSTime());
+    }
+
     return false;
 }
 
+void Map::LoadPendingCells()
+{
+    if (m_pendingCellLoads.empty())
+        return;
+
+    uint32 budget = sWorld->getConfig(CONFIG_GRID_LOAD_TICK_BUDGET);
+    uint32 startTime = getMSTime();
+    uint32 elapsed = 0;
+
+    // one cell at least, so a budget shorter than a cell still gets through the queue
+    do
+    {
+        PendingCellLoad load = m_pendingCellLoads.front();
+        m_pendingCellLoads.pop_front();
+
+        NGridType *grid = getNGrid(load.gridX, load.gridY);
+        ASSERT(grid != NULL);
+
+        Cell cell(CellPair(load.gridX * MAX_NUMBER_OF_CELLS + load.cellX, load.gridY * MAX_NUMBER_OF_CELLS + load.cellY));
+        ObjectGridLoader loader(*grid, this, cell);
+        if (!loader.LoadCell(load.cellX, load.cellY))
+            continue;                                       // visited in the meantime
+
+        ++m_gridLoadStats.deferredCells;
+        m_gridLoadStats.deferredObjects += loader.GetLoadedObjectCount();
+        elapsed = getMSTimeDiff(startTime, getMSTime());
+
+        if (grid->isAllCellObjectDataLoaded())
+            sLog->outDebug("Loading grid[%u, %u] for map %u instance %u finished", load.gridX, load.gridY, GetId(), i_InstanceId);
+    }
+    while (!m_pendingCellLoads.empty() && (!budget || elapsed < budget));
+
+    elapsed = getMSTimeDiff(startTime, getMSTime());
+    m_gridLoadStats.deferredTime += elapsed;
+    if (elapsed > m_gridLoadStats.deferredMaxTick)
+        m_gridLoadStats.deferredMaxTick = elapsed;
+}
+
 void Map::LoadGrid(float x, float y)
 {
     CellPair pair = Trinity::ComputeCellPair(x, y);
     Cell cell(pair);
     EnsureGridLoaded(cell);
+
+    // callers look for objects anywhere in the grid right after
+    NGridType *grid = getNGrid(cell.GridX(), cell.GridY());
+    if (grid->isAllCellObjectDataLoaded())
+        return;
+
+    uint32 startTime = getMSTime();
+    ObjectGridLoader loader(*grid, this, cell);
+    for (uint32 cx = 0; cx < MAX_NUMBER_OF_CELLS; ++cx)
+        for (uint32 cy = 0; cy < MAX_NUMBER_OF_CELLS; ++cy)
+            if (loader.LoadCell(cx, cy))
+                ++m_gridLoadStats.forcedCells;
+
+    m_gridLoadStats.forcedObjects += loader.GetLoadedObjectCount();
+    m_gridLoadStats.forcedTime += getMSTimeDiff(startTime, getMSTime());
 }
 
 bool Map::Add(Player* player)
@@ -541,12 +690,21 @@ bool Map::loaded(const GridPair &p) const
 
 void Map::Update(const uint32 &t_diff)
 {
+    // objects of the cells nobody has looked at yet
+    {
+        TickProfileScope profile(PROFILE_MAP_CELL_LOADS, GetId(), GetInstanceId());
+        LoadPendingCells();
+    }
+
     // update players at tick
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
-        Player* plr = m_mapRefIter->getSource();
-        if (plr && plr->IsInWorld())
-            plr->Update(t_diff);
+        TickProfileScope profile(PROFILE_MAP_PLAYERS, GetId(), GetInstanceId());
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        {
+            Player* plr = m_mapRefIter->getSource();
+            if (plr && plr->IsInWorld())
+                plr->Update(t_diff);
+        }
     }
 
     // update active cells around players and active objects
@@ -560,42 +718,45 @@ void Map::Update(const uint32 &t_diff)
 
     // the player iterator is stored in the map object
     // to make sure calls to Map::Remove don't invalidate it
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
-        Player* plr = m_mapRefIter->getSource();
+        TickProfileScope profile(PROFILE_MAP_CELLS, GetId(), GetInstanceId());
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        {
+            Player* plr = m_mapRefIter->getSource();
 
-        if (!plr->IsInWorld())
-            continue;
+            if (!plr->IsInWorld())
+                continue;
 
-        CellPair standing_cell(Trinity::ComputeCellPair(plr->GetPositionX(), plr->GetPositionY()));
+            CellPair standing_cell(Trinity::ComputeCellPair(plr->GetPositionX(), plr->GetPositionY()));
 
-        // Check for correctness of standing_cell, it also avoids problems with update_cell
-        if (standing_cell.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || standing_cell.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
-            continue;
+            // Check for correctness of standing_cell, it also avoids problems with update_cell
+            if (standing_cell.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || standing_cell.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
+                continue;
 
-        // the overloaded operators handle range checking
-        // so ther's no need for range checking inside the loop
-        CellPair begin_cell(standing_cell), end_cell(standing_cell);
-        //lets update mobs/objects in ALL visible cells around player!
-        CellArea area = Cell::CalculateCellArea(*plr, GetVisibilityDistance());
-        area.ResizeBorders(begin_cell, end_cell);
+            // the overloaded operators handle range checking
+            // so ther's no need for range checking inside the loop
+            CellPair begin_cell(standing_cell), end_cell(standing_cell);
+            //lets update mobs/objects in ALL visible cells around player!
+            CellArea area = Cell::CalculateCellArea(*plr, GetVisibilityDistance());
+            area.ResizeBorders(begin_cell, end_cell);
 
-        for (uint32 x = begin_cell.x_coord; x <= end_cell.x_coord; ++x)
-        {
-            for (uint32 y = begin_cell.y_coord; y <= end_cell.y_coord; ++y)
+            for (uint32 x = begin_cell.x_coord; x <= end_cell.x_coord; ++x)
             {
-                // marked cells are those that have been visited
-                // don't visit the same cell twice
-                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                if (!isCellMarked(cell_id))
+                for (uint32 y = begin_cell.y_coord; y <= end_cell.y_coord; ++y)
                 {
-                    markCell(cell_id);
-                    CellPair pair(x, y);
-                    Cell cell(pair);
-                    cell.data.Part.reserved = CENTER_DISTRICT;
-                    //cell.SetNoCreate();
-                    cell.Visit(pair, grid_object_update,  *this);
-                    cell.Visit(pair, world_object_update, *this);
+                    // marked cells are those that have been visited
+                    // don't visit the same cell twice
+                    uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+                    if (!isCellMarked(cell_id))
+                    {
+                        markCell(cell_id);
+                        CellPair pair(x, y);
+                        Cell cell(pair);
+                        cell.data.Part.reserved = CENTER_DISTRICT;
+                        //cell.SetNoCreate();
+                        cell.Visit(pair, grid_object_update,  *this);
+                        cell.Visit(pair, world_object_update, *this);
+                    }
                 }
             }
         }
@@ -604,6 +765,8 @@ void Map::Update(const uint32 &t_diff)
     // non-player active objects
     if (!m_activeNonPlayers.empty())
     {
+        TickProfileScope profile(PROFILE_MAP_ACTIVE_OBJECTS, GetId(), GetInstanceId());
+
         for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
         {
             // skip not in world
@@ -650,18 +813,29 @@ void Map::Update(const uint32 &t_diff)
         }
     }
 
+    m_awakeObjects = updater.i_awake;
+    m_dormantObjects = updater.i_dormant;
+
     // Process necessary scripts
+    m_scriptClock += t_diff;
     if (!m_scriptSchedule.empty())
     {
+        TickProfileScope profile(PROFILE_MAP_SCRIPTS, GetId(), GetInstanceId());
         i_scriptLock = true;
         ScriptsProcess();
         i_scriptLock = false;
     }
 
-    MoveAllCreaturesInMoveList();
+    {
+        TickProfileScope profile(PROFILE_MAP_MOVE_LIST, GetId(), GetInstanceId());
+        MoveAllCreaturesInMoveList();
+    }
 
     if (!m_mapRefManager.isEmpty() || !m_activeNonPlayers.empty())
+    {
+        TickProfileScope profile(PROFILE_MAP_RELOCATION, GetId(), GetInstanceId());
         ProcessRelocationNotifies(t_diff);
+    }
 }
 
 struct ResetNotifier
@@ -1033,6 +1207,14 @@ bool Map::UnloadGrid(const uint32 &x, const uint32 &y, bool unloadAll)
 
         sLog->outDebug("Unloading grid[%u, %u] for map %u", x, y, GetId());
 
+        for (PendingCellLoads::iterator itr = m_pendingCellLoads.begin(); itr != m_pendingCellLoads.end();)
+        {
+            if (itr->gridX == x && itr->gridY == y)
+                itr = m_pendingCellLoads.erase(itr);
+            else
+                ++itr;
+        }
+
         ObjectGridUnloader unloader(*grid);
 
         if (!unloadAll)
@@ -1138,6 +1320,7 @@ GridMap::GridMap()
     m_liquidLevel = INVALID_HEIGHT;
     m_liquid_type = NULL;
     m_liquid_map  = NULL;
+    m_walkMap = NULL;
 }
 
 GridMap::~GridMap()
@@ -1200,14 +1383,28 @@ void GridMap::unloadData()
     delete[] m_V8;
     delete[] m_liquid_type;
     delete[] m_liquid_map;
+    delete m_walkMap;
     m_area_map = NULL;
     m_V9 = NULL;
     m_V8 = NULL;
     m_liquid_type = NULL;
     m_liquid_map  = NULL;
+    m_walkMap = NULL;
     m_gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
+bool GridMap::loadWalkData(char const* filename)
+{
+    delete m_walkMap;
+    m_walkMap = new WalkMap();
+    if (m_walkMap->loadData(filename))
+        return true;
+
+    delete m_walkMap;
+    m_walkMap = NULL;
+    return false;
+}
+
 bool GridMap::loadAreaData(FILE *in, uint32 offset, uint32 /*size*/)
 {
     map_areaHeader header;
@@ -1641,38 +1838,23 @@ inline GridMap *Map::GetGrid(float x, float y)
     return GridMaps[gx][gy];
 }
 
-float Map::GetHeight(float x, float y, float z, bool pUseVmaps, float maxSearchDist) const
+float Map::GetMapHeight(float x, float y, float z) const
 {
     // find raw .map surface under Z coordinates
-    float mapHeight;
     if (GridMap *gmap = const_cast<Map*>(this)->GetGrid(x, y))
     {
         float _mapheight = gmap->getHeight(x, y);
 
         // look from a bit higher pos to find the floor, ignore under surface case
         if (z + 2.0f > _mapheight)
-            mapHeight = _mapheight;
-        else
-            mapHeight = VMAP_INVALID_HEIGHT_VALUE;
+            return _mapheight;
     }
-    else
-        mapHeight = VMAP_INVALID_HEIGHT_VALUE;
 
-    float vmapHeight;
-    if (pUseVmaps)
-    {
-        VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
-        if (vmgr->isHeightCalcEnabled())
-        {
-            // look from a bit higher pos to find the floor
-            vmapHeight = vmgr->getHeight(GetId(), x, y, z + 2.0f, maxSearchDist);
-        }
-        else
-            vmapHeight = VMAP_INVALID_HEIGHT_VALUE;
-    }
-    else
-        vmapHeight = VMAP_INVALID_HEIGHT_VALUE;
+    return VMAP_INVALID_HEIGHT_VALUE;
+}
 
+float Map::SelectHeight(float z, float mapHeight, float vmapHeight, bool pUseVmaps)
+{
     // mapHeight set for any above raw ground Z or <= INVALID_HEIGHT
     // vmapheight set for any under Z value or <= INVALID_HEIGHT
 
@@ -1703,6 +1885,132 @@ float Map::GetHeight(float x, float y, float z, bool pUseVmaps, float maxSearchD
     }
 }
 
+float Map::GetHeight(float x, float y, float z, bool pUseVmaps, float maxSearchDist) const
+{
+    float mapHeight = GetMapHeight(x, y, z);
+
+    float vmapHeight;
+    if (pUseVmaps)
+    {
+        VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+        if (vmgr->isHeightCalcEnabled())
+        {
+            // look from a bit higher pos to find the floor
+            vmapHeight = vmgr->getHeight(GetId(), x, y, z + 2.0f, maxSearchDist);
+        }
+        else
+            vmapHeight = VMAP_INVALID_HEIGHT_VALUE;
+    }
+    else
+        vmapHeight = VMAP_INVALID_HEIGHT_VALUE;
+
+    return SelectHeight(z, mapHeight, vmapHeight, pUseVmaps);
+}
+
+void Map::GetHeights(float const* x, float const* y, float const* z, float* heights, uint32 count, bool pUseVmaps, float maxSearchDist) const
+{
+    VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+    if (!pUseVmaps || !vmgr->isHeightCalcEnabled())
+    {
+        for (uint32 i = 0; i < count; ++i)
+            heights[i] = SelectHeight(z[i], GetMapHeight(x[i], y[i], z[i]), VMAP_INVALID_HEIGHT_VALUE, pUseVmaps);
+        return;
+    }
+
+    std::vector<VMAP::HeightQuery> queries(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        queries[i].x = x[i];
+        queries[i].y = y[i];
+        queries[i].z = z[i] + 2.0f;                         // look from a bit higher pos to find the floor
+        queries[i].maxSearchDist = maxSearchDist;
+    }
+
+    if (count)
+        vmgr->getHeight(GetId(), &queries[0], count);
+
+    for (uint32 i = 0; i < count; ++i)
+        heights[i] = SelectHeight(z[i], GetMapHeight(x[i], y[i], z[i]), queries[i].height, pUseVmaps);
+}
+
+void Map::BenchmarkVMapQueries(float x, float y, float z, float radius, uint32 count, VMapBenchResult& result) const
+{
+    std::vector<VMAP::LineOfSightQuery> segments(count);
+    std::vector<float> px(count), py(count), pz(count);
+    {
+        RandomStream stream(count);
+        RandomStreamSelector selector(&stream);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            VMAP::LineOfSightQuery& segment = segments[i];
+            float angle = float(rand_norm()) * 2.0f * M_PI;
+            float dist = float(rand_norm()) * radius;
+            segment.x1 = x + dist * cos(angle);
+            segment.y1 = y + dist * sin(angle);
+            segment.z1 = z + 2.0f + float(rand_norm()) * 10.0f;
+            angle = float(rand_norm()) * 2.0f * M_PI;
+            dist = float(rand_norm()) * radius;
+            segment.x2 = x + dist * cos(angle);
+            segment.y2 = y + dist * sin(angle);
+            segment.z2 = z + 2.0f + float(rand_norm()) * 10.0f;
+
+            angle = float(rand_norm()) * 2.0f * M_PI;
+            dist = float(rand_norm()) * radius;
+            px[i] = x + dist * cos(angle);
+            py[i] = y + dist * sin(angle);
+            pz[i] = z + float(rand_norm()) * 20.0f - 10.0f;
+        }
+    }
+
+    VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+    std::vector<bool> visible(count);
+
+    uint32 start = getMSTime();
+    for (uint32 i = 0; i < count; ++i)
+    {
+        VMAP::LineOfSightQuery const& segment = segments[i];
+        visible[i] = vmgr->isInLineOfSight(GetId(), segment.x1, segment.y1, segment.z1, segment.x2, segment.y2, segment.z2);
+    }
+    result.losScalarTime = getMSTimeDiff(start, getMSTime());
+
+    start = getMSTime();
+    if (count)
+        vmgr->isInLineOfSight(GetId(), &segments[0], count);
+    result.losBatchTime = getMSTimeDiff(start, getMSTime());
+
+    result.losVisible = 0;
+    result.losMismatches = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (visible[i])
+            ++result.losVisible;
+        if (visible[i] != segments[i].result)
+            ++result.losMismatches;
+    }
+
+    std::vector<float> heights(count), batchHeights(count);
+
+    start = getMSTime();
+    for (uint32 i = 0; i < count; ++i)
+        heights[i] = GetHeight(px[i], py[i], pz[i]);
+    result.heightScalarTime = getMSTimeDiff(start, getMSTime());
+
+    start = getMSTime();
+    if (count)
+        GetHeights(&px[0], &py[0], &pz[0], &batchHeights[0], count);
+    result.heightBatchTime = getMSTimeDiff(start, getMSTime());
+
+    result.heightFound = 0;
+    result.heightMismatches = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (heights[i] > INVALID_HEIGHT)
+            ++result.heightFound;
+        if (heights[i] != batchHeights[i])
+            ++result.heightMismatches;
+    }
+}
+
 inline bool IsOutdoorWMO(uint32 mogpFlags, uint32 mapId)
 {
     // if this flag is set we are outdoors and can mount up
@@ -2276,6 +2584,7 @@ void InstanceMap::InitVisibilityDistance()
     //init visibility distance for instances
     m_VisibleDistance = sWorld->GetMaxVisibleDistanceInInstances();
     m_VisibilityNotifyPeriod = World::GetVisibilityNotifyPeriodInInstances();
+    SetMovementTiers(sWorld->getConfig(CONFIG_MOVEMENT_TIER_NEAR_INSTANCES), sWorld->getConfig(CONFIG_MOVEMENT_TIER_MID_INSTANCES));
 }
 
 /*
@@ -2603,6 +2912,7 @@ void BattleGroundMap::InitVisibilityDistance()
     //init visibility distance for BG/Arenas
     m_VisibleDistance = sWorld->GetMaxVisibleDistanceInBGArenas();
     m_VisibilityNotifyPeriod = World::GetVisibilityNotifyPeriodInBGArenas();
+    SetMovementTiers(sWorld->getConfig(CONFIG_MOVEMENT_TIER_NEAR_BGARENAS), sWorld->getConfig(CONFIG_MOVEMENT_TIER_MID_BGARENAS));
 }
 
 bool BattleGroundMap::CanEnter(Player * player)
@@ -2654,22 +2964,73 @@ void BattleGroundMap::RemoveAllPlayers()
                     plr->TeleportTo(plr->GetBattleGroundEntryPoint());
 }
 
+void Map::AddToObjectIndex(WorldObject* obj)
+{
+    m_objectIndex[obj->GetGUID()] = obj;
+}
+
+void Map::RemoveFromObjectIndex(WorldObject* obj)
+{
+    m_objectIndex.erase(obj->GetGUID());
+}
+
+Player*
+Map::GetPlayer(uint64 guid)
+{
+    WorldObject* obj = GetWorldObject(guid);
+    return obj && obj->GetTypeId() == TYPEID_PLAYER ? (Player*)obj : NULL;
+}
+
+Unit*
+Map::GetUnit(uint64 guid)
+{
+    WorldObject* obj = GetWorldObject(guid);
+    return obj && (obj->GetTypeId() == TYPEID_UNIT || obj->GetTypeId() == TYPEID_PLAYER) ? (Unit*)obj : NULL;
+}
+
+// pets are kept apart from other creatures in the global registry, keep that split
 Creature*
 Map::GetCreature(uint64 guid)
 {
-    return ObjectAccessor::GetObjectInMap(guid, this, (Creature*)NULL);
+    if (IS_PET_GUID(guid))
+        return NULL;
+    WorldObject* obj = GetWorldObject(guid);
+    return obj && obj->GetTypeId() == TYPEID_UNIT ? (Creature*)obj : NULL;
+}
+
+Pet*
+Map::GetPet(uint64 guid)
+{
+    if (!IS_PET_GUID(guid))
+        return NULL;
+    WorldObject* obj = GetWorldObject(guid);
+    return obj && obj->GetTypeId() == TYPEID_UNIT ? (Pet*)obj : NULL;
+}
+
+Creature*
+Map::GetCreatureOrPet(uint64 guid)
+{
+    if (IS_PET_GUID(guid))
+        return GetPet(guid);
+
+    if (IS_CREATURE_GUID(guid))
+        return GetCreature(guid);
+
+    return NULL;
 }
 
 GameObject*
 Map::GetGameObject(uint64 guid)
 {
-    return ObjectAccessor::GetObjectInMap(guid, this, (GameObject*)NULL);
+    WorldObject* obj = GetWorldObject(guid);
+    return obj && obj->GetTypeId() == TYPEID_GAMEOBJECT ? (GameObject*)obj : NULL;
 }
 
 DynamicObject*
 Map::GetDynamicObject(uint64 guid)
 {
-    return ObjectAccessor::GetObjectInMap(guid, this, (DynamicObject*)NULL);
+    WorldObject* obj = GetWorldObject(guid);
+    return obj && obj->GetTypeId() == TYPEID_DYNAMICOBJECT ? (DynamicObject*)obj : NULL;
 }
 
 void Map::UpdateIteratorBack(Player* player)
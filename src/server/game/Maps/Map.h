@@ -34,6 +34,7 @@
 #include <ace/RW_Thread_Mutex.h>
 #include <ace/Thread_Mutex.h>
 #include <bitset>
+#include <deque>
 #include <list>
 
 class Unit;
@@ -45,21 +46,91 @@ class Object;
 class WorldObject;
 class TempSummon;
 class Player;
+class Pet;
 class CreatureFormation;
 class CreatureGroup;
 struct ScriptInfo;
 struct ScriptAction;
 struct Position;
 class BattleGround;
+class RandomStream;
+class WalkMap;
+class PathPlanner;
+
+// Distance tiers of movement broadcasts, see Unit::SendMovementMessageToSet
+enum MovementTier
+{
+    MOVEMENT_TIER_NEAR  = 0,                                // every movement packet
+    MOVEMENT_TIER_MID   = 1,                                // heartbeats every Visibility.MovementTier.Interval.Mid
+    MOVEMENT_TIER_FAR   = 2,                                // heartbeats every Visibility.MovementTier.Interval.Far
+    MAX_MOVEMENT_TIERS  = 3
+};
+
+struct MovementBroadcastStats
+{
+    MovementBroadcastStats() : sentPackets(0), sentBytes(0), suppressedPackets(0), suppressedBytes(0) {}
+
+    uint64 sentPackets;
+    uint64 sentBytes;
+    uint64 suppressedPackets;
+    uint64 suppressedBytes;
+};
+
+// work and time (ms) of the grid loading stages, see Map::EnsureGridLoaded
+struct GridLoadStats
+{
+    GridLoadStats() : terrainLoads(0), terrainTime(0), grids(0), nearCells(0), nearObjects(0), nearTime(0),
+        deferredCells(0), deferredObjects(0), deferredTime(0), deferredMaxTick(0), forcedCells(0), forcedObjects(0), forcedTime(0) {}
+
+    uint32 terrainLoads;                                    // map and vmap tiles
+    uint32 terrainTime;
+    uint32 grids;                                           // grids that started loading their objects
+    uint32 nearCells;                                       // cells around the trigger, loaded at once
+    uint32 nearObjects;
+    uint32 nearTime;
+    uint32 deferredCells;                                   // the other cells, loaded under the tick budget
+    uint32 deferredObjects;
+    uint32 deferredTime;
+    uint32 deferredMaxTick;
+    uint32 forcedCells;                                     // deferred cells visited or asked for before their turn
+    uint32 forcedObjects;
+    uint32 forcedTime;
+};
+
+// single against batched vmap queries, see Map::BenchmarkVMapQueries
+struct VMapBenchResult
+{
+    uint32 losScalarTime;                                   // ms, one isInLineOfSight call per segment
+    uint32 losBatchTime;                                    // ms, all segments in one batch
+    uint32 losVisible;
+    uint32 losMismatches;                                   // segments the two paths disagree on
+    uint32 heightScalarTime;                                // ms, one GetHeight call per point
+    uint32 heightBatchTime;                                 // ms, one GetHeights call
+    uint32 heightFound;
+    uint32 heightMismatches;
+};
 
 struct ScriptAction
 {
+    uint64 time;                                            // Map script clock (ms) to run at
+    uint32 order;                                           // scheduling order, keeps steps due at the same time in sequence
     uint64 sourceGUID;
     uint64 targetGUID;
     uint64 ownerGUID;                                       // owner of source if source is item
     ScriptInfo const* script;                               // pointer to static script data
 };
 
+// heap order of the script schedule: the earliest action on top
+struct ScriptActionLater
+{
+    bool operator()(ScriptAction const& a, ScriptAction const& b) const
+    {
+        if (a.time != b.time)
+            return a.time > b.time;
+        return int32(a.order - b.order) > 0;
+    }
+};
+
 //******************************************
 // Map file format defines
 //******************************************
@@ -172,6 +243,8 @@ class GridMap
     float   m_liquidLevel;
     uint8  *m_liquid_type;
     float  *m_liquid_map;
+    // Walkability layer, if built for this tile
+    WalkMap *m_walkMap;
 
     bool  loadAreaData(FILE *in, uint32 offset, uint32 size);
     bool  loadHeightData(FILE *in, uint32 offset, uint32 size);
@@ -189,6 +262,7 @@ public:
     GridMap();
     ~GridMap();
     bool  loadData(char *filaname);
+    bool  loadWalkData(char const* filename);
     void  unloadData();
 
     uint16 getArea(float x, float y);
@@ -196,6 +270,7 @@ public:
     float  getLiquidLevel(float x, float y);
     uint8  getTerrainType(float x, float y);
     ZLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, LiquidData *data = 0);
+    WalkMap const* getWalkMap() const { return m_walkMap; }
 };
 
 struct CreatureMover
@@ -283,6 +358,41 @@ class Map : public GridRefManager<NGridType>
         //function for setting up visibility distance for maps on per-type/per-Id basis
         virtual void InitVisibilityDistance();
 
+        MovementTier GetMovementTier(float distSq) const
+        {
+            if (distSq <= m_MovementTierDistSq[MOVEMENT_TIER_NEAR])
+                return MOVEMENT_TIER_NEAR;
+            return distSq <= m_MovementTierDistSq[MOVEMENT_TIER_MID] ? MOVEMENT_TIER_MID : MOVEMENT_TIER_FAR;
+        }
+        bool HasMovementTiers() const { return m_MovementTierDistSq[MOVEMENT_TIER_NEAR] > 0.0f; }
+        void AddMovementBroadcastStats(uint32 sent, uint32 suppressed, uint32 size)
+        {
+            m_movementStats.sentPackets += sent;
+            m_movementStats.sentBytes += uint64(sent) * size;
+            m_movementStats.suppressedPackets += suppressed;
+            m_movementStats.suppressedBytes += uint64(suppressed) * size;
+        }
+        MovementBroadcastStats const& GetMovementBroadcastStats() const { return m_movementStats; }
+
+        // objects updated and skipped as dormant by the last Update()
+        uint32 GetAwakeObjectCount() const { return m_awakeObjects; }
+        uint32 GetDormantObjectCount() const { return m_dormantObjects; }
+
+        // own random sequence selected while the map updates, NULL unless MapRandomSeed is set
+        RandomStream* GetRandomStream() const { return m_randomStream; }
+
+        // walkability layer of a loaded tile, never loads the grid
+        WalkMap const* GetWalkMap(int gx, int gy) const
+        {
+            if (gx < 0 || gy < 0 || gx >= MAX_NUMBER_OF_GRIDS || gy >= MAX_NUMBER_OF_GRIDS || !GridMaps[gx][gy])
+                return NULL;
+            return GridMaps[gx][gy]->getWalkMap();
+        }
+        PathPlanner& GetPathPlanner() { return *m_pathPlanner; }
+
+        GridLoadStats const& GetGridLoadStats() const { return m_gridLoadStats; }
+        uint32 GetPendingCellLoadCount() const { return m_pendingCellLoads.size(); }
+
         void PlayerRelocation(Player *, float x, float y, float z, float orientation);
         void CreatureRelocation(Creature* creature, float x, float y, float z, float ang);
 
@@ -294,10 +404,13 @@ class Map : public GridRefManager<NGridType>
             return !getNGrid(p.x_coord, p.y_coord) || getNGrid(p.x_coord, p.y_coord)->GetGridState() == GRID_STATE_REMOVAL;
         }
 
+        // the cell at x, y has its objects; a cell still waiting in the deferred loads
+        // spawns what was added to its grid data by itself
         bool IsLoaded(float x, float y) const
         {
-            GridPair p = Trinity::ComputeGridPair(x, y);
-            return loaded(p);
+            Cell cell(Trinity::ComputeCellPair(x, y));
+            return loaded(GridPair(cell.GridX(), cell.GridY())) &&
+                getNGrid(cell.GridX(), cell.GridY())->isCellObjectDataLoaded(cell.CellX(), cell.CellY());
         }
 
         bool GetUnloadLock(const GridPair &p) const { return getNGrid(p.x_coord, p.y_coord)->getUnloadLock(); }
@@ -325,6 +438,11 @@ class Map : public GridRefManager<NGridType>
         // some calls like isInWater should not use vmaps due to processor power
         // can return INVALID_HEIGHT if under z+2 z coord not found height
         float GetHeight(float x, float y, float z, bool pCheckVMap=true, float maxSearchDist=DEFAULT_HEIGHT_SEARCH) const;
+        // GetHeight for several points, the vmap rays are traced as one batch
+        void GetHeights(float const* x, float const* y, float const* z, float* heights, uint32 count, bool pCheckVMap=true, float maxSearchDist=DEFAULT_HEIGHT_SEARCH) const;
+        // count random segments and points within radius of x, y, z, the same ones for the same count,
+        // each queried one by one and then as one batch
+        void BenchmarkVMapQueries(float x, float y, float z, float radius, uint32 count, VMapBenchResult& result) const;
 
         ZLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, LiquidData *data = 0) const;
 
@@ -423,14 +541,33 @@ class Map : public GridRefManager<NGridType>
         void UpdateIteratorBack(Player* player);
 
         TempSummon *SummonCreature(uint32 entry, const Position &pos, SummonPropertiesEntry const *properties = NULL, uint32 duration = 0, Unit *summoner = NULL, SpellEntry const* spellInfo = NULL);
+
+        // objects in world on this map by guid, lookups from inside the map
+        // update are served here instead of the global ObjectAccessor
+        void AddToObjectIndex(WorldObject* obj);
+        void RemoveFromObjectIndex(WorldObject* obj);
+        WorldObject* GetWorldObject(uint64 guid) const
+        {
+            ObjectIndexType::const_iterator itr = m_objectIndex.find(guid);
+            return itr != m_objectIndex.end() ? itr->second : NULL;
+        }
+        Player* GetPlayer(uint64 guid);
+        Unit* GetUnit(uint64 guid);
         Creature* GetCreature(uint64 guid);
+        Pet* GetPet(uint64 guid);
+        Creature* GetCreatureOrPet(uint64 guid);
         GameObject* GetGameObject(uint64 guid);
         DynamicObject* GetDynamicObject(uint64 guid);
     private:
+        typedef UNORDERED_MAP<uint64, WorldObject*> ObjectIndexType;
+        ObjectIndexType m_objectIndex;
+
         void LoadMapAndVMap(int gx, int gy);
         void LoadVMap(int gx, int gy);
         void LoadMap(int gx, int gy, bool reload = false);
         GridMap *GetGrid(float x, float y);
+        float GetMapHeight(float x, float y, float z) const;
+        static float SelectHeight(float z, float mapHeight, float vmapHeight, bool pUseVmaps);
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
@@ -448,6 +585,7 @@ class Map : public GridRefManager<NGridType>
         void EnsureGridCreated(const GridPair &);
         bool EnsureGridLoaded(Cell const&);
         void EnsureGridLoadedAtEnter(Cell const&, Player* player = NULL);
+        void LoadPendingCells();
 
         void buildNGridLinkage(NGridType* pNGridType) { pNGridType->link(this); }
 
@@ -484,6 +622,17 @@ class Map : public GridRefManager<NGridType>
 
         int32 m_VisibilityNotifyPeriod;
 
+        // upper bound of the near and mid tier, squared; near 0 disables the tiers
+        void SetMovementTiers(uint32 nearDist, uint32 midDist);
+        float m_MovementTierDistSq[MOVEMENT_TIER_FAR];
+        MovementBroadcastStats m_movementStats;
+
+        uint32 m_awakeObjects;
+        uint32 m_dormantObjects;
+
+        RandomStream* m_randomStream;
+        PathPlanner* m_pathPlanner;
+
         typedef std::set<WorldObject*> ActiveNonPlayers;
         ActiveNonPlayers m_activeNonPlayers;
         ActiveNonPlayers::iterator m_activeNonPlayersIter;
@@ -497,6 +646,9 @@ class Map : public GridRefManager<NGridType>
         WorldObject* _GetScriptWorldObject(Object* obj, bool isSource, const ScriptInfo* scriptInfo) const;
         void _ScriptProcessDoor(Object* source, Object* target, const ScriptInfo* scriptInfo) const;
         GameObject* _FindGameObject(WorldObject* pWorldObject, uint32 guid) const;
+        void _ScheduleScript(ScriptInfo const* script, uint32 delay, uint64 sourceGUID, uint64 targetGUID, uint64 ownerGUID);
+        Object* _GetScriptObject(uint64 guid, uint64 ownerGUID);
+        void _ScriptsProcessStep(ScriptAction const& step);
 
         time_t i_gridExpiry;
 
@@ -516,7 +668,23 @@ class Map : public GridRefManager<NGridType>
         std::set<WorldObject *> i_objectsToRemove;
         std::map<WorldObject*, bool> i_objectsToSwitch;
         std::set<WorldObject*> i_worldObjects;
-        std::multimap<time_t, ScriptAction> m_scriptSchedule;
+        // pending script actions as a binary heap on ScriptActionLater; due actions are moved
+        // to m_scriptBatch together, both vectors keep their storage between runs
+        typedef std::vector<ScriptAction> ScriptSchedule;
+        ScriptSchedule m_scriptSchedule;
+        ScriptSchedule m_scriptBatch;
+        uint64 m_scriptClock;                               // ms, advanced by Update
+        uint32 m_scriptOrder;
+
+        // cells of loaded grids still waiting for their objects, nearest to the trigger first
+        struct PendingCellLoad
+        {
+            uint8 gridX, gridY;
+            uint8 cellX, cellY;
+        };
+        typedef std::deque<PendingCellLoad> PendingCellLoads;
+        PendingCellLoads m_pendingCellLoads;
+        GridLoadStats m_gridLoadStats;
 
         // Type specific code for add/remove to/from grid
         template<class T>
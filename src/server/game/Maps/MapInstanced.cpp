@@ -60,6 +60,7 @@ void MapInstanced::Update(const uint32& t)
         else
         {
             // update only here, because it may schedule some bad things before delete
+            RandomStreamSelector selector(i->second->GetRandomStream());
             i->second->Update(t);
             ++i;
         }
@@ -69,7 +70,10 @@ void MapInstanced::Update(const uint32& t)
 void MapInstanced::DelayedUpdate(const uint32 diff)
 {
     for (InstancedMaps::iterator i = m_InstancedMaps.begin(); i != m_InstancedMaps.end(); ++i)
+    {
+        RandomStreamSelector selector(i->second->GetRandomStream());
         i->second->DelayedUpdate(diff);
+    }
 
     Map::DelayedUpdate(diff); // this may be removed
 }
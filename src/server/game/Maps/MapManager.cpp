@@ -32,6 +32,7 @@
 #include "CellImpl.h"
 #include "Corpse.h"
 #include "ObjectMgr.h"
+#include "TickProfiler.h"
 
 extern GridState* si_GridStates[];                          // debugging code, should be deleted some day
 
@@ -238,21 +239,33 @@ void MapManager::Update(time_t diff)
     if (!i_timer.Passed())
         return;
 
+    TickProfileScope profile(PROFILE_MAP_MANAGER);
+
     MapMapType::iterator iter = i_maps.begin();
     for (; iter != i_maps.end(); ++iter)
     {
         if (m_updater.activated())
             m_updater.schedule_update(*iter->second, i_timer.GetCurrent());
         else
+        {
+            RandomStreamSelector selector(iter->second->GetRandomStream());
+            TickProfileScope mapProfile(PROFILE_MAP_UPDATE, iter->second->GetId(), iter->second->GetInstanceId());
             iter->second->Update(i_timer.GetCurrent());
+        }
     }
     if (m_updater.activated())
         m_updater.wait();
 
     for (iter = i_maps.begin(); iter != i_maps.end(); ++iter)
+    {
+        RandomStreamSelector selector(iter->second->GetRandomStream());
+        TickProfileScope mapProfile(PROFILE_MAP_DELAYED_UPDATE, iter->second->GetId(), iter->second->GetInstanceId());
         iter->second->DelayedUpdate(uint32(i_timer.GetCurrent()));
+    }
 
     sObjectAccessor->Update(i_timer.GetCurrent());
+
+    TickProfileScope transportProfile(PROFILE_TRANSPORTS);
     for (TransportSet::iterator iter = m_Transports.begin(); iter != m_Transports.end(); ++iter)
         (*iter)->Update(i_timer.GetCurrent());
 
@@ -125,6 +125,7 @@ class MapManager
 
         bool CanPlayerEnter(uint32 mapid, Player* player);
         uint32 GenerateInstanceId() { return ++i_MaxInstanceId; }
+        uint32 GetMaxInstanceId() const { return i_MaxInstanceId; }
         void InitMaxInstanceId();
         void InitializeVisibilityDistanceInfo();
 
@@ -22,6 +22,7 @@
 #include "DelayExecutor.h"
 #include "Map.h"
 #include "DatabaseEnv.h"
+#include "TickProfiler.h"
 
 #include <ace/Guard_T.h>
 #include <ace/Method_Request.h>
@@ -66,7 +67,11 @@ class MapUpdateRequest : public ACE_Method_Request
 
     call (void)
     {
-        m_map.Update (m_diff);
+        {
+            RandomStreamSelector selector(m_map.GetRandomStream());
+            TickProfileScope profile(PROFILE_MAP_UPDATE, m_map.GetId(), m_map.GetInstanceId());
+            m_map.Update (m_diff);
+        }
         m_updater.update_finished ();
         return 0;
     }
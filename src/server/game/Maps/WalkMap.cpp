@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WalkMap.h"
+#include "Log.h"
+
+#include <cstdio>
+
+int8 const WalkDirectionX[WALK_DIRECTIONS] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+int8 const WalkDirectionY[WALK_DIRECTIONS] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+
+WalkMap::WalkMap() : m_heights(NULL), m_links(NULL), m_minHeight(0.0f), m_heightStep(0.0f)
+{
+}
+
+WalkMap::~WalkMap()
+{
+    unloadData();
+}
+
+bool WalkMap::loadData(char const* filename)
+{
+    unloadData();
+
+    FILE* in = fopen(filename, "rb");
+    if (!in)
+        return false;
+
+    walk_fileheader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        header.walkMagic != uint32(WALK_MAGIC) || header.versionMagic != uint32(WALK_VERSION_MAGIC))
+    {
+        sLog->outError("Walk file '%s' is missing its header or from an older version. Please recreate using the walkmap_assembler.", filename);
+        fclose(in);
+        return false;
+    }
+
+    m_minHeight = header.minHeight;
+    m_heightStep = header.heightStep;
+    m_heights = new uint16[WALK_RESOLUTION * WALK_RESOLUTION];
+    m_links = new uint8[WALK_RESOLUTION * WALK_RESOLUTION];
+
+    if (fread(m_heights, sizeof(uint16), WALK_RESOLUTION * WALK_RESOLUTION, in) != WALK_RESOLUTION * WALK_RESOLUTION ||
+        fread(m_links, sizeof(uint8), WALK_RESOLUTION * WALK_RESOLUTION, in) != WALK_RESOLUTION * WALK_RESOLUTION)
+    {
+        sLog->outError("Walk file '%s' is truncated.", filename);
+        fclose(in);
+        unloadData();
+        return false;
+    }
+
+    fclose(in);
+    return true;
+}
+
+void WalkMap::unloadData()
+{
+    delete[] m_heights;
+    delete[] m_links;
+    m_heights = NULL;
+    m_links = NULL;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_WALKMAP_H
+#define TRINITY_WALKMAP_H
+
+#include "Define.h"
+
+//******************************************
+// Walk file format defines, written by walkmap_assembler
+//******************************************
+#define WALK_MAGIC            'KLAW'
+#define WALK_VERSION_MAGIC    '1.0w'
+
+// nodes per tile side, one node per .map V8 cell
+#define WALK_RESOLUTION       128
+#define WALK_DIRECTIONS       8
+
+struct walk_fileheader
+{
+    uint32 walkMagic;
+    uint32 versionMagic;
+    float  minHeight;
+    float  heightStep;                                      // node height = minHeight + uint16 value * heightStep
+};
+
+// node offsets of the link bits, bit i of a node links it to the node at (x + WalkDirectionX[i], y + WalkDirectionY[i])
+extern int8 const WalkDirectionX[WALK_DIRECTIONS];
+extern int8 const WalkDirectionY[WALK_DIRECTIONS];
+
+// link bit index of the neighbour at (dx, dy), both in -1..1 and not both 0
+inline uint32 GetWalkDirection(int32 dx, int32 dy)
+{
+    static uint32 const directions[3][3] = { { 5, 4, 3 }, { 6, 0, 2 }, { 7, 0, 1 } };
+    return directions[dx + 1][dy + 1];
+}
+
+/*
+ * Walkability layer of one map tile: WALK_RESOLUTION x WALK_RESOLUTION nodes
+ * at the centres of the .map height cells, each with its ground height and a
+ * bit per neighbour it can be walked to. A node without links is not walkable.
+ * Built offline from the .map heights and the vmap tiles, loaded next to the
+ * tile's GridMap.
+ */
+class WalkMap
+{
+    public:
+        WalkMap();
+        ~WalkMap();
+
+        bool loadData(char const* filename);
+        void unloadData();
+
+        uint8 getLinks(uint32 x, uint32 y) const { return m_links[x * WALK_RESOLUTION + y]; }
+        float getHeight(uint32 x, uint32 y) const { return m_minHeight + m_heights[x * WALK_RESOLUTION + y] * m_heightStep; }
+
+    private:
+        uint16* m_heights;
+        uint8*  m_links;
+        float   m_minHeight;
+        float   m_heightStep;
+};
+
+#endif
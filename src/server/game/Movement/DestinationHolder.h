@@ -35,12 +35,13 @@ class DestinationHolder
     TimeTrackerSmall i_tracker;
     uint32 i_totalTravelTime;
     uint32 i_timeElapsed;
+    uint32 i_relocationTime;                                // i_timeElapsed at which micro movement writes the position back next
     bool i_destSet;
     float i_fromX, i_fromY, i_fromZ;
     float i_destX, i_destY, i_destZ;
 
     public:
-        DestinationHolder() : i_tracker(TRAVELLER_UPDATE_INTERVAL), i_totalTravelTime(0), i_timeElapsed(0),
+        DestinationHolder() : i_tracker(TRAVELLER_UPDATE_INTERVAL), i_totalTravelTime(0), i_timeElapsed(0), i_relocationTime(0),
             i_destSet(false), i_fromX(0), i_fromY(0), i_fromZ(0), i_destX(0), i_destY(0), i_destZ(0) {}
 
         uint32 SetDestination(TRAVELLER &traveller, float dest_x, float dest_y, float dest_z, bool sendMove = true);
@@ -54,6 +55,8 @@ class DestinationHolder
         float GetDestinationDiff(float x, float y, float z) const;
         bool HasArrived(void) const { return (i_totalTravelTime == 0 || i_timeElapsed >= i_totalTravelTime); }
         bool UpdateTraveller(TRAVELLER &traveller, uint32 diff, bool micro_movement=false);
+        // micro movement only: moves the traveller to its position on the path right now
+        void SyncTraveller(TRAVELLER &traveller);
         uint32 StartTravel(TRAVELLER &traveller, bool sendMove = true);
         void GetLocationNow(const Map * map, float &x, float &y, float &z, bool is3D = false) const;
         void GetLocationNowNoMicroMovement(float &x, float &y, float &z) const; // For use without micro movement
@@ -61,6 +64,7 @@ class DestinationHolder
 
     private:
         void _findOffSetPoint(float x1, float y1, float x2, float y2, float offset, float &x, float &y);
+        void _setRelocationTime();
 };
 #endif
 
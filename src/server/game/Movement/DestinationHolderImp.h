@@ -22,6 +22,8 @@
 #define TRINITY_DESTINATIONHOLDERIMP_H
 
 #include "MapManager.h"
+#include "World.h"
+#include "GridDefines.h"
 #include "DestinationHolder.h"
 
 #include <cmath>
@@ -86,6 +88,7 @@ DestinationHolder<TRAVELLER>::StartTravel(TRAVELLER &traveller, bool sendMove)
 
     i_totalTravelTime = traveller.GetTotalTrevelTimeTo(i_destX, i_destY, i_destZ);
     i_timeElapsed = 0;
+    _setRelocationTime();
     if (sendMove)
         traveller.MoveTo(i_destX, i_destY, i_destZ, i_totalTravelTime);
     return i_totalTravelTime;
@@ -114,6 +117,11 @@ DestinationHolder<TRAVELLER>::UpdateTraveller(TRAVELLER &traveller, uint32 diff,
         if (!traveller.GetTraveller().hasUnitState(UNIT_STAT_MOVING | UNIT_STAT_IN_FLIGHT))
             return true;
 
+        // the client runs the segment on its own, the server position is only written back
+        // when the path leaves the current cell, at the checkpoint or at the destination
+        if (!HasArrived() && i_timeElapsed < i_relocationTime)
+            return true;
+
         if (traveller.GetTraveller().hasUnitState(UNIT_STAT_IN_FLIGHT))
             GetLocationNow(traveller.GetTraveller().GetBaseMap() , x, y, z, true);                  // Should reposition Object with right Coord, so I can bypass some Grid Relocation
         else
@@ -132,6 +140,7 @@ DestinationHolder<TRAVELLER>::UpdateTraveller(TRAVELLER &traveller, uint32 diff,
         i_fromX = x;                            // and change origine
         i_fromY = y;                            // then I take into account only micro movement
         i_fromZ = z;
+        _setRelocationTime();
     }
 
     if (traveller.GetTraveller().GetPositionX() != x || traveller.GetTraveller().GetPositionY() != y)
@@ -143,6 +152,52 @@ DestinationHolder<TRAVELLER>::UpdateTraveller(TRAVELLER &traveller, uint32 diff,
     return true;
 }
 
+template<typename TRAVELLER>
+void
+DestinationHolder<TRAVELLER>::SyncTraveller(TRAVELLER &traveller)
+{
+    if (!i_destSet)
+        return;
+
+    i_relocationTime = 0;
+    i_tracker.Reset(0);
+    UpdateTraveller(traveller, 0, true);
+}
+
+// fraction of the way from a to b at which the first cell border is crossed, above 1 if none is;
+// cell borders lie on the multiples of SIZE_OF_GRID_CELL, see Trinity::ComputeCellPair
+inline float CellBorderFraction(float a, float b)
+{
+    float border;
+    if (b > a)
+        border = (floor(a / SIZE_OF_GRID_CELL) + 1.0f) * SIZE_OF_GRID_CELL;
+    else if (b < a)
+        border = (ceil(a / SIZE_OF_GRID_CELL) - 1.0f) * SIZE_OF_GRID_CELL;
+    else
+        return 2.0f;
+
+    return (border - a) / (b - a);
+}
+
+template<typename TRAVELLER>
+void
+DestinationHolder<TRAVELLER>::_setRelocationTime()
+{
+    // 0 writes the position back on every update
+    uint32 checkpoint = sWorld->getConfig(CONFIG_MOVEMENT_CHECKPOINT);
+    if (!checkpoint)
+    {
+        i_relocationTime = 0;
+        return;
+    }
+
+    float fraction = std::min(CellBorderFraction(i_fromX, i_destX), CellBorderFraction(i_fromY, i_destY));
+    if (fraction >= 1.0f)
+        i_relocationTime = std::min(checkpoint, i_totalTravelTime);
+    else                                                    // 1 ms into the next cell
+        i_relocationTime = std::min(checkpoint, uint32(fraction * i_totalTravelTime) + 1);
+}
+
 template<typename TRAVELLER>
 void
 DestinationHolder<TRAVELLER>::GetLocationNow(const Map * map, float &x, float &y, float &z, bool is3D) const
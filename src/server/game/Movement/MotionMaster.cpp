@@ -460,6 +460,11 @@ MotionMaster::MoveDistract(uint32 timer)
 
 void MotionMaster::Mutate(MovementGenerator *m, MovementSlot slot)
 {
+    i_owner->WakeUp();
+
+    // the new generator starts from where the unit is now
+    SyncPosition();
+
     if (MovementGenerator *curr = Impl[slot])
     {
         Impl[slot] = NULL; // in case a new one is generated in this slot during directdelete
@@ -569,6 +574,13 @@ void MotionMaster::DelayedDelete(_Ty curr)
     m_expList->push_back(curr);
 }
 
+void MotionMaster::SyncPosition()
+{
+    // no top while Mutate finalizes the generator it replaces
+    if (!empty() && top())
+        top()->SyncPosition(*i_owner);
+}
+
 bool MotionMaster::GetDestination(float &x, float &y, float &z)
 {
     if (empty())
@@ -170,6 +170,8 @@ class MotionMaster //: private std::stack<MovementGenerator *>
         void propagateSpeedChange();
 
         bool GetDestination(float &x, float &y, float &z);
+        // writes a lazily kept position of the owner back, see DestinationHolder::UpdateTraveller
+        void SyncPosition();
     private:
         void Mutate(MovementGenerator *m, MovementSlot slot);                  // use Move* functions instead
 
@@ -27,6 +27,7 @@
 #include "Dynamic/FactoryHolder.h"
 #include "Common.h"
 #include "MotionMaster.h"
+#include "ObjectPool.h"
 
 #include <ace/Singleton.h>
 
@@ -37,6 +38,8 @@ class MovementGenerator
     public:
         virtual ~MovementGenerator();
 
+        DECLARE_POOLED_OBJECT(OBJECT_POOL_MOVEMENT)
+
         virtual void Initialize(Unit &) = 0;
         virtual void Finalize(Unit &) = 0;
 
@@ -49,6 +52,9 @@ class MovementGenerator
         virtual void unitSpeedChanged() { }
 
         virtual bool GetDestination(float& /*x*/, float& /*y*/, float& /*z*/) const { return false; }
+
+        // generators that write the position back lazily bring it up to date
+        virtual void SyncPosition(Unit &) {}
 };
 
 template<class T, class D>
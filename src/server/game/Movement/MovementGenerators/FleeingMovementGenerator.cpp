@@ -46,8 +46,28 @@ FleeingMovementGenerator<T>::_setTargetLocation(T &owner)
         return;
 
     owner.addUnitState(UNIT_STAT_FLEEING | UNIT_STAT_ROAMING);
+
+    i_pathIndex = 0;
+    if (owner.GetMap()->GetPathPlanner().BuildPath(owner, x, y, z, i_path))
+        _setNextPathPoint(owner);
+    else
+    {
+        Traveller<T> traveller(owner);
+        i_destinationHolder.SetDestination(traveller, x, y, z);
+    }
+}
+
+template<class T>
+bool
+FleeingMovementGenerator<T>::_setNextPathPoint(T &owner)
+{
+    if (i_pathIndex >= i_path.size())
+        return false;
+
     Traveller<T> traveller(owner);
-    i_destinationHolder.SetDestination(traveller, x, y, z);
+    PathPoint const& point = i_path[i_pathIndex++];
+    i_destinationHolder.SetDestination(traveller, point.x, point.y, point.z);
+    return true;
 }
 
 template<>
@@ -387,6 +407,9 @@ FleeingMovementGenerator<T>::Update(T &owner, const uint32 & time_diff)
     if (i_destinationHolder.UpdateTraveller(traveller, time_diff))
     {
         i_destinationHolder.ResetUpdate(50);
+        if (i_destinationHolder.HasArrived() && _setNextPathPoint(owner))
+            return true;
+
         if (i_nextCheckTime.Passed() && i_destinationHolder.HasArrived())
         {
             _setTargetLocation(owner);
@@ -404,6 +427,8 @@ template bool FleeingMovementGenerator<Player>::_getPoint(Player &, float &, flo
 template bool FleeingMovementGenerator<Creature>::_getPoint(Creature &, float &, float &, float &);
 template void FleeingMovementGenerator<Player>::_setTargetLocation(Player &);
 template void FleeingMovementGenerator<Creature>::_setTargetLocation(Creature &);
+template bool FleeingMovementGenerator<Player>::_setNextPathPoint(Player &);
+template bool FleeingMovementGenerator<Creature>::_setNextPathPoint(Creature &);
 template void FleeingMovementGenerator<Player>::Finalize(Player &);
 template void FleeingMovementGenerator<Creature>::Finalize(Creature &);
 template void FleeingMovementGenerator<Player>::Reset(Player &);
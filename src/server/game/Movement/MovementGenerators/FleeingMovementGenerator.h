@@ -25,13 +25,14 @@
 #include "DestinationHolder.h"
 #include "Traveller.h"
 #include "MapManager.h"
+#include "PathPlanner.h"
 
 template<class T>
 class FleeingMovementGenerator
 : public MovementGeneratorMedium< T, FleeingMovementGenerator<T> >
 {
     public:
-        FleeingMovementGenerator(uint64 fright) : i_frightGUID(fright), i_nextCheckTime(0) {}
+        FleeingMovementGenerator(uint64 fright) : i_frightGUID(fright), i_nextCheckTime(0), i_pathIndex(0) {}
 
         void Initialize(T &);
         void Finalize(T &);
@@ -43,6 +44,7 @@ class FleeingMovementGenerator
 
     private:
         void _setTargetLocation(T &owner);
+        bool _setNextPathPoint(T &owner);
         bool _getPoint(T &owner, float &x, float &y, float &z);
         bool _setMoveData(T &owner);
         void _Init(T &);
@@ -61,6 +63,8 @@ class FleeingMovementGenerator
         uint64 i_frightGUID;
 
         DestinationHolder< Traveller<T> > i_destinationHolder;
+        PathPointList i_path;
+        uint32 i_pathIndex;
 };
 
 class TimedFleeingMovementGenerator
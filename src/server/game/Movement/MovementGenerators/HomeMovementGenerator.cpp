@@ -51,11 +51,37 @@ HomeMovementGenerator<Creature>::_setTargetLocation(Creature & owner)
     float x, y, z;
     owner.GetHomePosition(x, y, z, ori);
 
+    // evading around obstacles walks the path point by point, each with its own travel time
+    i_pathIndex = 0;
+    if (owner.GetMap()->GetPathPlanner().BuildPath(owner, x, y, z, i_path))
+        _setNextPathPoint(owner);
+    else
+    {
+        CreatureTraveller traveller(owner);
+        uint32 travel_time = i_destinationHolder.SetDestination(traveller, x, y, z);
+        modifyTravelTime(travel_time);
+    }
+    owner.clearUnitState(UNIT_STAT_ALL_STATE);
+}
+
+bool
+HomeMovementGenerator<Creature>::_setNextPathPoint(Creature & owner)
+{
+    if (i_pathIndex >= i_path.size())
+        return false;
+
     CreatureTraveller traveller(owner);
 
-    uint32 travel_time = i_destinationHolder.SetDestination(traveller, x, y, z);
-    modifyTravelTime(travel_time);
-    owner.clearUnitState(UNIT_STAT_ALL_STATE);
+    // the travel time of the last leg ran out, the creature is at its end
+    if (i_pathIndex)
+    {
+        PathPoint const& reached = i_path[i_pathIndex - 1];
+        traveller.Relocation(reached.x, reached.y, reached.z);
+    }
+
+    PathPoint const& point = i_path[i_pathIndex++];
+    modifyTravelTime(i_destinationHolder.SetDestination(traveller, point.x, point.y, point.z));
+    return true;
 }
 
 bool
@@ -64,6 +90,9 @@ HomeMovementGenerator<Creature>::Update(Creature &owner, const uint32& time_diff
     CreatureTraveller traveller(owner);
     i_destinationHolder.UpdateTraveller(traveller, time_diff);
 
+    if (time_diff > i_travel_timer && _setNextPathPoint(owner))
+        return true;
+
     if (time_diff > i_travel_timer)
     {
         owner.AddUnitMovementFlag(MOVEFLAG_WALK_MODE);
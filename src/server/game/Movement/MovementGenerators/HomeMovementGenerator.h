@@ -24,6 +24,7 @@
 #include "MovementGenerator.h"
 #include "DestinationHolder.h"
 #include "Traveller.h"
+#include "PathPlanner.h"
 
 class Creature;
 
@@ -36,7 +37,7 @@ class HomeMovementGenerator<Creature>
 {
     public:
 
-        HomeMovementGenerator() {}
+        HomeMovementGenerator() : i_pathIndex(0) {}
         ~HomeMovementGenerator() {}
 
         void Initialize(Creature &);
@@ -49,7 +50,10 @@ class HomeMovementGenerator<Creature>
         bool GetDestination(float& x, float& y, float& z) const { i_destinationHolder.GetDestination(x, y, z); return true; }
     private:
         void _setTargetLocation(Creature &);
+        bool _setNextPathPoint(Creature &);
         DestinationHolder< Traveller<Creature> > i_destinationHolder;
+        PathPointList i_path;
+        uint32 i_pathIndex;
 
         float ori;
         uint32 i_travel_timer;
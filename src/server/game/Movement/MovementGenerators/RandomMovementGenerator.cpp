@@ -156,6 +156,7 @@ bool RandomMovementGenerator<Creature>::Update(Creature &creature, const uint32
 {
     if (creature.hasUnitState(UNIT_STAT_ROOT | UNIT_STAT_STUNNED | UNIT_STAT_DISTRACTED))
     {
+        SyncPosition(creature);
         i_nextMoveTime.Update(i_nextMoveTime.GetExpiry());  // Expire the timer
         creature.clearUnitState(UNIT_STAT_ROAMING);
         return true;
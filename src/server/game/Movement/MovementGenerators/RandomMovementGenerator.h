@@ -39,6 +39,11 @@ class RandomMovementGenerator
         void Reset(T &);
         bool Update(T &, const uint32 &);
         bool GetDestination(float &x, float &y, float &z) const;
+        void SyncPosition(Unit &u)
+        {
+            Traveller<T> traveller(*((T*)&u));
+            i_destinationHolder.SyncTraveller(traveller);
+        }
         void UpdateMapPosition(uint32 mapid, float &x , float &y, float &z)
         {
             i_destinationHolder.GetLocationNow(mapid, x, y, z);
@@ -78,6 +78,7 @@ bool TargetedMovementGenerator<T>::_setTargetLocation(T &owner)
 
             if (stop)
             {
+                i_path.clear();
                 owner.GetPosition(x, y, z);
                 i_destinationHolder.SetDestination(traveller, x, y, z);
                 i_destinationHolder.StartTravel(traveller, false);
@@ -117,13 +118,31 @@ bool TargetedMovementGenerator<T>::_setTargetLocation(T &owner)
         if (i_destinationHolder.HasDestination() && i_destinationHolder.GetDestinationDiff(x, y, z) < bothObjectSize)
             return;
     */
-    i_destinationHolder.SetDestination(traveller, x, y, z);
+    // around obstacles the way there is walked point by point
+    i_pathIndex = 0;
+    if (owner.GetMap()->GetPathPlanner().BuildPath(owner, x, y, z, i_path))
+        _setNextPathPoint(owner);
+    else
+        i_destinationHolder.SetDestination(traveller, x, y, z);
+
     owner.addUnitState(UNIT_STAT_CHASE);
     if (owner.GetTypeId() == TYPEID_UNIT && (&owner)->ToCreature()->canFly())
         owner.AddUnitMovementFlag(MOVEFLAG_FLYING2);
     return true;
 }
 
+template<class T>
+bool TargetedMovementGenerator<T>::_setNextPathPoint(T &owner)
+{
+    if (i_pathIndex >= i_path.size())
+        return false;
+
+    Traveller<T> traveller(owner);
+    PathPoint const& point = i_path[i_pathIndex++];
+    i_destinationHolder.SetDestination(traveller, point.x, point.y, point.z);
+    return true;
+}
+
 template<class T>
 void TargetedMovementGenerator<T>::Initialize(T &owner)
 {
@@ -187,6 +206,9 @@ bool TargetedMovementGenerator<T>::Update(T &owner, const uint32 & time_diff)
 
     if (i_destinationHolder.UpdateTraveller(traveller, time_diff))
     {
+        if (i_destinationHolder.HasArrived())
+            _setNextPathPoint(owner);
+
         // put targeted movement generators on a higher priority
         //if (owner.GetObjectSize())
         //i_destinationHolder.ResetUpdate(50);
@@ -213,7 +235,7 @@ bool TargetedMovementGenerator<T>::Update(T &owner, const uint32 & time_diff)
     }
 
     // Implemented for PetAI to handle resetting flags when pet owner reached
-    if (i_destinationHolder.HasArrived())
+    if (i_destinationHolder.HasArrived() && i_pathIndex >= i_path.size())
         MovementInform(owner);
 
     return true;
@@ -241,6 +263,8 @@ template TargetedMovementGenerator<Player>::TargetedMovementGenerator(Unit &targ
 template TargetedMovementGenerator<Creature>::TargetedMovementGenerator(Unit &target, float offset, float angle);
 template bool TargetedMovementGenerator<Player>::_setTargetLocation(Player &);
 template bool TargetedMovementGenerator<Creature>::_setTargetLocation(Creature &);
+template bool TargetedMovementGenerator<Player>::_setNextPathPoint(Player &);
+template bool TargetedMovementGenerator<Creature>::_setNextPathPoint(Creature &);
 template void TargetedMovementGenerator<Player>::Initialize(Player &);
 template void TargetedMovementGenerator<Creature>::Initialize(Creature &);
 template void TargetedMovementGenerator<Player>::Finalize(Player &);
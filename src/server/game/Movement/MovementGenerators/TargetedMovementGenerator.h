@@ -25,6 +25,7 @@
 #include "DestinationHolder.h"
 #include "Traveller.h"
 #include "FollowerReference.h"
+#include "PathPlanner.h"
 
 class TargetedMovementGeneratorBase
 {
@@ -42,9 +43,9 @@ class TargetedMovementGenerator
     public:
 
         TargetedMovementGenerator(Unit &target)
-            : TargetedMovementGeneratorBase(target), i_offset(0), i_angle(0), i_recalculateTravel(false) {}
+            : TargetedMovementGeneratorBase(target), i_offset(0), i_angle(0), i_recalculateTravel(false), i_pathIndex(0) {}
         TargetedMovementGenerator(Unit &target, float offset, float angle)
-            : TargetedMovementGeneratorBase(target), i_offset(offset), i_angle(angle), i_recalculateTravel(false) {}
+            : TargetedMovementGeneratorBase(target), i_offset(offset), i_angle(angle), i_recalculateTravel(false), i_pathIndex(0) {}
         ~TargetedMovementGenerator() {}
 
         void Initialize(T &);
@@ -68,12 +69,15 @@ class TargetedMovementGenerator
     private:
 
         bool _setTargetLocation(T &);
+        bool _setNextPathPoint(T &);
 
         float i_offset;
         float i_angle;
         DestinationHolder< Traveller<T> > i_destinationHolder;
         bool i_recalculateTravel;
         float i_targetX, i_targetY, i_targetZ;
+        PathPointList i_path;                               // points around obstacles to the destination, if any
+        uint32 i_pathIndex;                                 // next point of i_path
 };
 #endif
 
@@ -78,6 +78,11 @@ class WaypointMovementGenerator
         void Reset(T &unit);
         bool Update(T &, const uint32 &);
         bool GetDestination(float &x, float &y, float &z) const;
+        void SyncPosition(Unit &u)
+        {
+            Traveller<T> traveller(*((T*)&u));
+            this->i_destinationHolder.SyncTraveller(traveller);
+        }
         MovementGeneratorType GetMovementGeneratorType() { return WAYPOINT_MOTION_TYPE; }
 
     private:
@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PathPlanner.h"
+#include "WalkMap.h"
+#include "Map.h"
+#include "Creature.h"
+#include "World.h"
+#include "Util.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+#define WALK_NODE_SIZE          (SIZE_OF_GRIDS / WALK_RESOLUTION)
+#define WALK_NODE_DIAGONAL      (WALK_NODE_SIZE * 1.4142136f)
+#define WALK_NODES_PER_MAP      (MAX_NUMBER_OF_GRIDS * WALK_RESOLUTION)
+
+namespace
+{
+    struct OpenNode
+    {
+        OpenNode(float _f, uint32 _node) : f(_f), node(_node) {}
+
+        // lowest estimate on top of the priority_queue
+        bool operator<(OpenNode const& other) const { return f > other.f; }
+
+        float f;
+        uint32 node;
+    };
+
+    inline float NodeCoord(uint32 n)
+    {
+        return (CENTER_GRID_ID - (n + 0.5f) / WALK_RESOLUTION) * SIZE_OF_GRIDS;
+    }
+
+    // octile distance, never more than the walked one
+    inline float EstimateDistance(uint32 from, uint32 to)
+    {
+        int32 dx = abs(int32(from >> 16) - int32(to >> 16));
+        int32 dy = abs(int32(from & 0xFFFF) - int32(to & 0xFFFF));
+        if (dx < dy)
+            std::swap(dx, dy);
+        return (dx - dy) * WALK_NODE_SIZE + dy * WALK_NODE_DIAGONAL;
+    }
+}
+
+PathPlanner::PathPlanner(Map const& map) : m_map(map)
+{
+}
+
+bool PathPlanner::BuildPath(Unit const& unit, float x, float y, float z, PathPointList& path)
+{
+    path.clear();
+
+    if (!sWorld->getConfig(CONFIG_PATHFINDING_ENABLE))
+        return false;
+
+    // the walk layer only knows the ground
+    if (unit.HasUnitMovementFlag(MOVEFLAG_FLYING2 | MOVEFLAG_LEVITATING | MOVEFLAG_SWIMMING))
+        return false;
+
+    if (Creature const* creature = unit.ToCreature())
+        if (creature->canFly())
+            return false;
+
+    return FindPath(unit.GetPositionX(), unit.GetPositionY(), x, y, z, path);
+}
+
+bool PathPlanner::FindPath(float startX, float startY, float endX, float endY, float endZ, PathPointList& path, bool useCache)
+{
+    ++m_stats.requests;
+    path.clear();
+
+    NodeId start, end;
+    if (!_getNode(startX, startY, start) || !_getNode(endX, endY, end))
+    {
+        ++m_stats.noData;
+        return false;
+    }
+
+    if (start == end || _isStraightWalkable(start, end))
+    {
+        ++m_stats.straight;
+        return false;
+    }
+
+    uint64 key = (uint64(start) << 32) | end;
+    NodeList const* nodes = NULL;
+    if (useCache)
+    {
+        PathCache::iterator itr = m_cache.find(key);
+        if (itr != m_cache.end())
+        {
+            // a tile on the way may have been unloaded since
+            if (_isLoaded(itr->second.nodes))
+            {
+                ++m_stats.cacheHits;
+                m_cacheOrder.splice(m_cacheOrder.begin(), m_cacheOrder, itr->second.order);
+                nodes = &itr->second.nodes;
+            }
+            else
+            {
+                m_cacheOrder.erase(itr->second.order);
+                m_cache.erase(itr);
+            }
+        }
+    }
+
+    NodeList found;
+    if (!nodes)
+    {
+        if (_search(start, end, found))
+            _smooth(found);
+        else
+        {
+            ++m_stats.failed;
+            found.clear();
+        }
+
+        if (useCache)
+            _addToCache(key, found);
+        nodes = &found;
+    }
+
+    if (nodes->empty())
+        return false;
+
+    // the first node is where the unit already is, the last one is replaced by the exact destination
+    path.reserve(nodes->size() - 1);
+    for (size_t i = 1; i + 1 < nodes->size(); ++i)
+    {
+        NodeId node = (*nodes)[i];
+        path.push_back(PathPoint(NodeCoord(node >> 16), NodeCoord(node & 0xFFFF), _getHeight(node)));
+    }
+    path.push_back(PathPoint(endX, endY, endZ));
+    return true;
+}
+
+void PathPlanner::ClearCache()
+{
+    m_cache.clear();
+    m_cacheOrder.clear();
+}
+
+void PathPlanner::Benchmark(float x, float y, float radius, uint32 count, PathBenchResult& result)
+{
+    std::vector<PathPoint> pairs;
+    pairs.reserve(count * 2);
+    {
+        RandomStream stream(count);
+        RandomStreamSelector selector(&stream);
+        for (uint32 i = 0; i < count * 2; ++i)
+        {
+            float angle = float(rand_norm()) * 2.0f * M_PI;
+            float dist = float(rand_norm()) * radius;
+            pairs.push_back(PathPoint(x + dist * cos(angle), y + dist * sin(angle), 0.0f));
+        }
+    }
+
+    PathPlannerStats saved = m_stats;
+    m_stats = PathPlannerStats();
+
+    PathPointList path;
+    result.paths = 0;
+
+    uint32 start = getMSTime();
+    for (uint32 i = 0; i < count; ++i)
+    {
+        PathPoint const& from = pairs[i * 2];
+        PathPoint const& to = pairs[i * 2 + 1];
+        if (FindPath(from.x, from.y, to.x, to.y, to.z, path, false))
+            ++result.paths;
+    }
+    result.searchTime = getMSTimeDiff(start, getMSTime());
+
+    result.straight = m_stats.straight;
+    result.noData = m_stats.noData;
+    result.failed = m_stats.failed;
+    result.expandedNodes = m_stats.expandedNodes;
+
+    m_stats = saved;
+
+    // fill the cache of a planner of our own, then time the lookups alone; more pairs
+    // than the cache holds would time evictions and searches instead
+    PathPlanner cached(m_map);
+    result.cachedPairs = std::min(count, sWorld->getConfig(CONFIG_PATHFINDING_CACHE_SIZE));
+    for (uint32 i = 0; i < result.cachedPairs; ++i)
+        cached.FindPath(pairs[i * 2].x, pairs[i * 2].y, pairs[i * 2 + 1].x, pairs[i * 2 + 1].y, 0.0f, path);
+
+    start = getMSTime();
+    for (uint32 i = 0; i < result.cachedPairs; ++i)
+        cached.FindPath(pairs[i * 2].x, pairs[i * 2].y, pairs[i * 2 + 1].x, pairs[i * 2 + 1].y, 0.0f, path);
+    result.cachedTime = getMSTimeDiff(start, getMSTime());
+}
+
+bool PathPlanner::_getNode(float x, float y, NodeId& node) const
+{
+    if (!Trinity::IsValidMapCoord(x, y))
+        return false;
+
+    int32 nx = int32((CENTER_GRID_ID - x / SIZE_OF_GRIDS) * WALK_RESOLUTION);
+    int32 ny = int32((CENTER_GRID_ID - y / SIZE_OF_GRIDS) * WALK_RESOLUTION);
+    if (nx < 0 || ny < 0 || nx >= WALK_NODES_PER_MAP || ny >= WALK_NODES_PER_MAP)
+        return false;
+
+    node = (NodeId(nx) << 16) | NodeId(ny);
+    if (_getLinks(node))
+        return true;
+
+    // standing on the edge of a blocked node, take a walkable neighbour
+    for (uint32 i = 0; i < WALK_DIRECTIONS; ++i)
+    {
+        int32 x2 = nx + WalkDirectionX[i];
+        int32 y2 = ny + WalkDirectionY[i];
+        if (x2 < 0 || y2 < 0 || x2 >= WALK_NODES_PER_MAP || y2 >= WALK_NODES_PER_MAP)
+            continue;
+
+        node = (NodeId(x2) << 16) | NodeId(y2);
+        if (_getLinks(node))
+            return true;
+    }
+    return false;
+}
+
+uint8 PathPlanner::_getLinks(NodeId node) const
+{
+    uint32 nx = node >> 16;
+    uint32 ny = node & 0xFFFF;
+    if (WalkMap const* walkMap = m_map.GetWalkMap(nx / WALK_RESOLUTION, ny / WALK_RESOLUTION))
+        return walkMap->getLinks(nx % WALK_RESOLUTION, ny % WALK_RESOLUTION);
+    return 0;
+}
+
+float PathPlanner::_getHeight(NodeId node) const
+{
+    uint32 nx = node >> 16;
+    uint32 ny = node & 0xFFFF;
+    if (WalkMap const* walkMap = m_map.GetWalkMap(nx / WALK_RESOLUTION, ny / WALK_RESOLUTION))
+        return walkMap->getHeight(nx % WALK_RESOLUTION, ny % WALK_RESOLUTION);
+    return INVALID_HEIGHT;
+}
+
+bool PathPlanner::_isStraightWalkable(NodeId from, NodeId to) const
+{
+    int32 x0 = from >> 16, y0 = from & 0xFFFF;
+    int32 dx = int32(to >> 16) - x0, dy = int32(to & 0xFFFF) - y0;
+    int32 steps = std::max(abs(dx), abs(dy));
+
+    // nodes along the line, each step to one of the 8 neighbours must be linked
+    NodeId cur = from;
+    int32 curX = x0, curY = y0;
+    for (int32 i = 1; i <= steps; ++i)
+    {
+        int32 nextX = x0 + int32(floor(float(dx * i) / steps + 0.5f));
+        int32 nextY = y0 + int32(floor(float(dy * i) / steps + 0.5f));
+        if (!(_getLinks(cur) & (1 << GetWalkDirection(nextX - curX, nextY - curY))))
+            return false;
+
+        curX = nextX;
+        curY = nextY;
+        cur = (NodeId(curX) << 16) | NodeId(curY);
+    }
+    return true;
+}
+
+bool PathPlanner::_isLoaded(NodeList const& nodes) const
+{
+    for (NodeList::const_iterator itr = nodes.begin(); itr != nodes.end(); ++itr)
+        if (!_getLinks(*itr))
+            return false;
+    return true;
+}
+
+bool PathPlanner::_search(NodeId start, NodeId end, NodeList& nodes)
+{
+    ++m_stats.searches;
+
+    uint32 maxNodes = sWorld->getConfig(CONFIG_PATHFINDING_MAX_NODES);
+    uint32 expanded = 0;
+    bool found = false;
+
+    m_searchNodes.clear();
+    m_searchNodes[start].parent = start;
+
+    std::priority_queue<OpenNode> open;
+    open.push(OpenNode(EstimateDistance(start, end), start));
+
+    while (!open.empty())
+    {
+        NodeId node = open.top().node;
+        open.pop();
+
+        SearchNode& current = m_searchNodes[node];
+        if (current.closed)
+            continue;
+
+        if (node == end)
+        {
+            found = true;
+            break;
+        }
+
+        if (expanded++ >= maxNodes)
+            break;
+
+        current.closed = true;
+        float g = current.g;
+        float height = _getHeight(node);
+        uint8 links = _getLinks(node);
+        int32 x = node >> 16, y = node & 0xFFFF;
+
+        for (uint32 i = 0; i < WALK_DIRECTIONS; ++i)
+        {
+            if (!(links & (1 << i)))
+                continue;
+
+            int32 x2 = x + WalkDirectionX[i];
+            int32 y2 = y + WalkDirectionY[i];
+            if (x2 < 0 || y2 < 0 || x2 >= WALK_NODES_PER_MAP || y2 >= WALK_NODES_PER_MAP)
+                continue;
+
+            // linked into a tile that is not loaded here
+            NodeId next = (NodeId(x2) << 16) | NodeId(y2);
+            if (!_getLinks(next))
+                continue;
+
+            float step = (i & 1) ? WALK_NODE_DIAGONAL : WALK_NODE_SIZE;
+            float dz = _getHeight(next) - height;
+            float nextG = g + sqrt(step * step + dz * dz);
+
+            std::pair<SearchNodeMap::iterator, bool> inserted = m_searchNodes.insert(SearchNodeMap::value_type(next, SearchNode()));
+            SearchNode& searchNode = inserted.first->second;
+            if (!inserted.second && (searchNode.closed || searchNode.g <= nextG))
+                continue;
+
+            searchNode.g = nextG;
+            searchNode.parent = node;
+            open.push(OpenNode(nextG + EstimateDistance(next, end), next));
+        }
+    }
+
+    m_stats.expandedNodes += expanded;
+
+    nodes.clear();
+    if (!found)
+        return false;
+
+    for (NodeId node = end; node != start; node = m_searchNodes[node].parent)
+        nodes.push_back(node);
+    nodes.push_back(start);
+    std::reverse(nodes.begin(), nodes.end());
+    return true;
+}
+
+void PathPlanner::_smooth(NodeList& nodes) const
+{
+    if (nodes.size() < 3)
+        return;
+
+    // keep the last node still walkable in a straight line from the previous kept one
+    NodeList corners;
+    corners.push_back(nodes.front());
+    size_t anchor = 0;
+    for (size_t i = 2; i < nodes.size(); ++i)
+    {
+        if (!_isStraightWalkable(nodes[anchor], nodes[i]))
+        {
+            anchor = i - 1;
+            corners.push_back(nodes[anchor]);
+        }
+    }
+    corners.push_back(nodes.back());
+    nodes.swap(corners);
+}
+
+void PathPlanner::_addToCache(uint64 key, NodeList const& nodes)
+{
+    uint32 maxSize = sWorld->getConfig(CONFIG_PATHFINDING_CACHE_SIZE);
+    if (!maxSize)
+        return;
+
+    while (m_cache.size() >= maxSize)
+    {
+        m_cache.erase(m_cacheOrder.back());
+        m_cacheOrder.pop_back();
+    }
+
+    m_cacheOrder.push_front(key);
+    CachedPath& cached = m_cache[key];
+    cached.nodes = nodes;
+    cached.order = m_cacheOrder.begin();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_PATHPLANNER_H
+#define TRINITY_PATHPLANNER_H
+
+#include "Define.h"
+#include "UnorderedMap.h"
+
+#include <list>
+#include <vector>
+
+class Map;
+class Unit;
+
+struct PathPoint
+{
+    PathPoint() : x(0), y(0), z(0) {}
+    PathPoint(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+
+    float x, y, z;
+};
+
+typedef std::vector<PathPoint> PathPointList;
+
+struct PathPlannerStats
+{
+    PathPlannerStats() : requests(0), straight(0), noData(0), cacheHits(0), searches(0), failed(0), expandedNodes(0) {}
+
+    uint32 requests;
+    uint32 straight;                                        // destination walkable in a straight line
+    uint32 noData;                                          // start or destination outside of the walk layer
+    uint32 cacheHits;
+    uint32 searches;
+    uint32 failed;                                          // no path within Pathfinding.MaxSearchNodes
+    uint64 expandedNodes;
+};
+
+struct PathBenchResult
+{
+    uint32 paths;                                           // pairs walked around obstacles
+    uint32 straight;
+    uint32 noData;
+    uint32 failed;
+    uint64 expandedNodes;
+    uint32 searchTime;                                      // ms, every pair searched
+    uint32 cachedPairs;                                     // the first pairs, as many as the cache holds
+    uint32 cachedTime;                                      // ms, those pairs answered by the cache
+};
+
+/*
+ * A* over the walk layers of the loaded tiles of one map. Paths are searched
+ * between walk nodes (about 4 yards apart), shortened to the corners where the
+ * straight line between them is walkable and kept in a bounded per-map cache
+ * keyed by start and end node, so the units of a pack chasing the same target
+ * share one search. Each map owns its planner and only uses it from its own
+ * update, no locking needed.
+ */
+class PathPlanner
+{
+    public:
+        explicit PathPlanner(Map const& map);
+
+        // path of unit from its position to x, y, z, ending at x, y, z itself; false when the
+        // unit moves there in a straight line (flying or swimming, no walk layer, no path or none needed)
+        bool BuildPath(Unit const& unit, float x, float y, float z, PathPointList& path);
+        // same for any start point, useCache false always searches and leaves the cache untouched
+        bool FindPath(float startX, float startY, float endX, float endY, float endZ, PathPointList& path, bool useCache = true);
+
+        PathPlannerStats const& GetStats() const { return m_stats; }
+        void ResetStats() { m_stats = PathPlannerStats(); }
+        uint32 GetCacheSize() const { return m_cache.size(); }
+        void ClearCache();
+
+        // count random pairs within radius of x, y, the same ones for the same count;
+        // the cache and the stats are left as they were
+        void Benchmark(float x, float y, float radius, uint32 count, PathBenchResult& result);
+
+    private:
+        // node x << 16 | node y, counted over the whole map like the cell ids
+        typedef uint32 NodeId;
+        typedef std::vector<NodeId> NodeList;
+
+        bool _getNode(float x, float y, NodeId& node) const;
+        uint8 _getLinks(NodeId node) const;
+        float _getHeight(NodeId node) const;
+        bool _isStraightWalkable(NodeId from, NodeId to) const;
+        bool _isLoaded(NodeList const& nodes) const;
+        bool _search(NodeId start, NodeId end, NodeList& nodes);
+        void _smooth(NodeList& nodes) const;
+        void _addToCache(uint64 key, NodeList const& nodes);
+
+        struct SearchNode
+        {
+            SearchNode() : g(0.0f), parent(0), closed(false) {}
+
+            float g;
+            NodeId parent;
+            bool closed;
+        };
+        typedef UNORDERED_MAP<NodeId, SearchNode> SearchNodeMap;
+
+        typedef std::list<uint64> CacheOrder;
+        struct CachedPath
+        {
+            NodeList nodes;                                 // empty when there is no path
+            CacheOrder::iterator order;
+        };
+        typedef UNORDERED_MAP<uint64, CachedPath> PathCache;
+
+        Map const& m_map;
+        SearchNodeMap m_searchNodes;
+        PathCache m_cache;
+        CacheOrder m_cacheOrder;                            // most recently used first
+        PathPlannerStats m_stats;
+};
+
+#endif
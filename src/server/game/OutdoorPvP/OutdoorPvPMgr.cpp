@@ -27,6 +27,7 @@
 #include "OutdoorPvPEP.h"
 #include "ObjectMgr.h"
 #include "Player.h"
+#include "TickProfiler.h"
 
 OutdoorPvPMgr::OutdoorPvPMgr()
 {
@@ -168,6 +169,8 @@ OutdoorPvP * OutdoorPvPMgr::GetOutdoorPvPToZoneId(uint32 zoneid)
 
 void OutdoorPvPMgr::Update(uint32 diff)
 {
+    TickProfileScope profile(PROFILE_OUTDOORPVP_MGR);
+
     m_UpdateTimer += diff;
     if (m_UpdateTimer > OUTDOORPVP_OBJECTIVE_UPDATE_INTERVAL)
     {
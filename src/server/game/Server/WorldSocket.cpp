@@ -46,6 +46,8 @@
 #include "Log.h"
 #include "DBCStores.h"
 #include "WorldLog.h"
+#include "Object.h"
+#include "GridDefines.h"
 
 #if defined(__GNUC__)
 #pragma pack(1)
@@ -82,9 +84,17 @@ m_OutBufferSize(65536),
 m_OutActive(false),
 m_Seed(static_cast<uint32> (rand32())),
 m_OverSpeedPings(0),
-m_LastPingTime(ACE_Time_Value::zero)
+m_LastPingTime(ACE_Time_Value::zero),
+m_DroppedPackets(0),
+m_DroppedPacketsTime(0)
 {
     reference_counting_policy().value (ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
+
+    for (uint8 i = 0; i < MAX_RATE_CLASSES; ++i)
+    {
+        m_RateTokens[i] = 0;
+        m_RateRefillTime[i] = 0;
+    }
 }
 
 WorldSocket::~WorldSocket (void)
@@ -614,6 +624,10 @@ int WorldSocket::ProcessIncoming (WorldPacket* new_pct)
 
                 if (m_Session != NULL)
                 {
+                    // Drop malformed and flooding packets here instead of on the world thread
+                    if (sWorld->getConfig (CONFIG_NETWORK_PREPARSE) && !PreParsePacket (*new_pct))
+                        return DropPacket (opcode);
+
                     // Our Idle timer will reset on any non PING opcodes.
                     // Catches people idling on the login screen and any lingering ingame connections.
                     m_Session->ResetTimeOutTime();
@@ -950,6 +964,112 @@ int WorldSocket::HandlePing (WorldPacket& recvPacket)
     return SendPacket (packet);
 }
 
+bool WorldSocket::PreParsePacket (WorldPacket& pct)
+{
+    const uint16 opcode = pct.GetOpcode();
+
+    if (opcode >= NUM_MSG_TYPES)
+        return true;
+
+    // opcodes without a fixed layout are left to their handlers
+    if (opcodeTable[opcode].handler == &WorldSession::HandleMovementOpcodes)
+    {
+        MovementInfo movementInfo;
+
+        try
+        {
+            pct >> movementInfo;
+        }
+        catch (ByteBufferException &)
+        {
+            return false;
+        }
+
+        pct.rpos(0);
+
+        // same check as HandleMovementOpcodes(), which ignores such packets anyway
+        if (!Trinity::IsValidMapCoord(movementInfo.GetPos()->GetPositionX(), movementInfo.GetPos()->GetPositionY(),
+            movementInfo.GetPos()->GetPositionZ(), movementInfo.GetPos()->GetOrientation()))
+            return false;
+
+        return ConsumeRateToken (RATE_CLASS_MOVEMENT, sWorld->getConfig (CONFIG_NETWORK_RATE_LIMIT_MOVEMENT));
+    }
+
+    switch (opcode)
+    {
+        case CMSG_CAST_SPELL:
+            // spell id and cast count, the targets are read by the handler
+            if (pct.size() < 4 + 1)
+                return false;
+
+            // DBC stores are read only once the world is running
+            if (!sSpellStore.LookupEntry (pct.read<uint32> (0)))
+                return false;
+
+            return ConsumeRateToken (RATE_CLASS_SPELL, sWorld->getConfig (CONFIG_NETWORK_RATE_LIMIT_SPELL));
+        case CMSG_TIME_SYNC_RESP:
+            // counter and client ticks
+            return pct.size() >= 4 + 4;
+        default:
+            return true;
+    }
+}
+
+bool WorldSocket::ConsumeRateToken (uint8 rateClass, uint32 rate)
+{
+    if (!rate)
+        return true;
+
+    // one second worth of packets may arrive at once
+    const uint32 capacity = rate * 1000;
+    const uint32 now = getMSTime();
+
+    if (!m_RateRefillTime[rateClass])
+        m_RateTokens[rateClass] = capacity;
+    else
+    {
+        uint32 diff = std::min<uint32> (getMSTimeDiff (m_RateRefillTime[rateClass], now), 1000);
+        m_RateTokens[rateClass] = std::min<uint32> (m_RateTokens[rateClass] + diff * rate, capacity);
+    }
+
+    m_RateRefillTime[rateClass] = now;
+
+    if (m_RateTokens[rateClass] < 1000)
+        return false;
+
+    m_RateTokens[rateClass] -= 1000;
+    return true;
+}
+
+int WorldSocket::DropPacket (uint16 opcode)
+{
+    sLog->outDebug ("WorldSocket::DropPacket: dropped %s (0x%.4X) from %s, accountid=%u",
+                    LookupOpcodeName (opcode), opcode, GetRemoteAddress().c_str(), m_Session->GetAccountId());
+
+    const uint32 now = getMSTime();
+
+    if (getMSTimeDiff (m_DroppedPacketsTime, now) >= MINUTE * IN_MILLISECONDS)
+    {
+        m_DroppedPacketsTime = now;
+        m_DroppedPackets = 0;
+    }
+
+    ++m_DroppedPackets;
+
+    uint32 max_count = sWorld->getConfig (CONFIG_NETWORK_MAX_DROPPED_PACKETS);
+
+    if (max_count && m_DroppedPackets > max_count && m_Session->GetSecurity() == SEC_PLAYER)
+    {
+        sLog->outError ("WorldSocket::DropPacket: Player kicked for sending %u malformed or flooding "
+                        "packets within one minute, address = %s, accountid=%u",
+                        m_DroppedPackets, GetRemoteAddress().c_str(), m_Session->GetAccountId());
+
+        return -1;
+    }
+
+    return 0;
+}
+
 int WorldSocket::iSendPacket (const WorldPacket& pct)
 {
     if (m_OutBuffer->space () < pct.size () + sizeof (ServerPktHeader))
@@ -165,6 +165,19 @@ class WorldSocket : protected WorldHandler
         // Called by ProcessIncoming() on CMSG_PING.
         int HandlePing (WorldPacket& recvPacket);
 
+        // Called by ProcessIncoming() with Network.PreParse enabled, checks the
+        // layout of hot opcodes and applies the per session rate limits.
+        // return false if the packet has to be dropped
+        bool PreParsePacket (WorldPacket& pct);
+
+        // Take one packet from the rate limit bucket of the given class,
+        // return false if the bucket is empty
+        bool ConsumeRateToken (uint8 rateClass, uint32 rate);
+
+        // Count a dropped packet, return -1 if the session has to be kicked.
+        // Need to be called with m_SessionLock lock held
+        int DropPacket (uint16 opcode);
+
         // Try to write WorldPacket to m_OutBuffer , return -1 if no space
         // Need to be called with m_OutBufferLock lock held
         int iSendPacket (const WorldPacket& pct);
@@ -182,6 +195,21 @@ class WorldSocket : protected WorldHandler
         // Keep track of over-speed pings , to prevent ping flood.
         uint32 m_OverSpeedPings;
 
+        // Token buckets of Network.PreParse rate limits, in 1/1000 packets
+        enum RateClass
+        {
+            RATE_CLASS_MOVEMENT,
+            RATE_CLASS_SPELL,
+            MAX_RATE_CLASSES
+        };
+
+        uint32 m_RateTokens[MAX_RATE_CLASSES];
+        uint32 m_RateRefillTime[MAX_RATE_CLASSES];
+
+        // Packets dropped by PreParsePacket() in the current minute
+        uint32 m_DroppedPackets;
+        uint32 m_DroppedPacketsTime;
+
         // Address of the remote peer
         std::string m_Address;
 
@@ -1692,7 +1692,7 @@ void Aura::TriggerSpell()
                     // Prismatic Shield
                     case 40879:
                     {
-                        switch (rand()%6)
+                        switch (urand(0, 5))
                         {
                         case 0: trigger_spell_id = 40880; break;
                         case 1: trigger_spell_id = 40882; break;
@@ -1720,7 +1720,7 @@ void Aura::TriggerSpell()
 //                    // Dementia
                     case 41404:
                     {
-                        if (rand()%2)
+                        if (urand(0, 1))
                             trigger_spell_id = 41406;
                         else
                             trigger_spell_id = 41409;
@@ -380,6 +380,8 @@ Spell::~Spell()
 
 void Spell::FillTargetMap()
 {
+    m_areaTargetCache.Clear();
+
     for (uint32 i = 0; i < 3; ++i)
     {
         // not call for empty effect.
@@ -584,6 +586,9 @@ void Spell::FillTargetMap()
             m_delayMoment = (uint64) floor(dist / m_spellInfo->speed * 1000.0f);
         }
     }
+
+    // do not keep unit pointers beyond this update
+    m_areaTargetCache.Clear();
 }
 
 void Spell::prepareDataForTriggerSystem()
@@ -1302,19 +1307,6 @@ struct ChainHealingOrder : public std::binary_function<const Unit*, const Unit*,
     }
 };
 
-// Helper for targets nearest to the spell target
-// The spell target is always first unless there is a target at _completely_ the same position (unbelievable case)
-struct TargetDistanceOrder : public std::binary_function<const Unit, const Unit, bool>
-{
-    const Unit* MainTarget;
-    TargetDistanceOrder(const Unit* Target) : MainTarget(Target) {};
-    // functor for operator ">"
-    bool operator()(const Unit* _Left, const Unit* _Right) const
-    {
-        return (MainTarget->GetDistance(_Left) < MainTarget->GetDistance(_Right));
-    }
-};
-
 void Spell::SearchChainTarget(std::list<Unit*> &TagUnitMap, float max_range, uint32 num, SpellTargets TargetType)
 {
     Unit *cur = m_targets.getUnitTarget();
@@ -1337,47 +1329,94 @@ void Spell::SearchChainTarget(std::list<Unit*> &TagUnitMap, float max_range, uin
         SearchAreaTarget(tempUnitMap, max_range, PUSH_CHAIN, TargetType);
     tempUnitMap.remove(cur);
 
+    std::vector<Unit*> candidates(tempUnitMap.begin(), tempUnitMap.end());
+    std::vector<std::pair<float, size_t> > inJumpRange;
+
     while (num)
     {
         TagUnitMap.push_back(cur);
         --num;
 
-        if (tempUnitMap.empty())
+        if (candidates.empty())
             break;
 
-        std::list<Unit*>::iterator next;
+        size_t next = 0;
 
         if (TargetType == SPELL_TARGETS_CHAINHEAL)
         {
-            next = tempUnitMap.begin();
-            while (cur->GetDistance(*next) > CHAIN_SPELL_JUMP_RADIUS
-                || !cur->IsWithinLOSInMap(*next))
+            while (cur->GetDistance(candidates[next]) > CHAIN_SPELL_JUMP_RADIUS
+                || !cur->IsWithinLOSInMap(candidates[next]))
             {
                 ++next;
-                if (next == tempUnitMap.end())
+                if (next == candidates.size())
                     return;
             }
         }
         else
         {
-            tempUnitMap.sort(TargetDistanceOrder(cur));
-            next = tempUnitMap.begin();
+            // order only what is in jump range, each distance computed once
+            inJumpRange.clear();
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                float dist = cur->GetDistance(candidates[i]);
+                if (dist <= CHAIN_SPELL_JUMP_RADIUS)
+                    inJumpRange.push_back(std::make_pair(dist, i));
+            }
+            std::sort(inJumpRange.begin(), inJumpRange.end());
 
-            if (cur->GetDistance(*next) > CHAIN_SPELL_JUMP_RADIUS)
-                break;
-            while (m_spellInfo->DmgClass == SPELL_DAMAGE_CLASS_MELEE
-                && !m_caster->isInFrontInMap(*next, max_range)
-                || !m_caster->canSeeOrDetect(*next, false)
-                || !cur->IsWithinLOSInMap(*next))
+            std::vector<std::pair<float, size_t> >::const_iterator itr = inJumpRange.begin();
+            for (; itr != inJumpRange.end(); ++itr)
             {
-                ++next;
-                if (next == tempUnitMap.end() || cur->GetDistance(*next) > CHAIN_SPELL_JUMP_RADIUS)
-                    return;
+                Unit* target = candidates[itr->second];
+                if ((m_spellInfo->DmgClass != SPELL_DAMAGE_CLASS_MELEE || m_caster->isInFrontInMap(target, max_range))
+                    && m_caster->canSeeOrDetect(target, false)
+                    && cur->IsWithinLOSInMap(target))
+                    break;
             }
+
+            if (itr == inJumpRange.end())
+                return;
+
+            next = itr->second;
         }
 
-        cur = *next;
-        tempUnitMap.erase(next);
+        cur = candidates[next];
+        candidates.erase(candidates.begin() + next);
+    }
+}
+
+bool Spell::IsValidAreaTarget(Unit* target, SpellTargets TargetType, uint32 entry, Position const* pos) const
+{
+    switch (TargetType)
+    {
+        case SPELL_TARGETS_ALLY:
+            return target->isAttackableByAOE() && m_caster->IsFriendlyTo(target);
+        case SPELL_TARGETS_ENEMY:
+        {
+            if (target->GetTypeId() == TYPEID_UNIT && target->ToCreature()->isTotem())
+                return false;
+
+            if (m_caster->GetCreatureType() == CREATURE_TYPE_TOTEM)
+            {
+                if (!target->isAttackableByAOE(pos->GetPositionX(), pos->GetPositionY(), pos->GetPositionZ(), true))
+                    return false;
+            }
+            else
+            {
+                if (!target->isAttackableByAOE())
+                    return false;
+            }
+
+            Unit* check = m_caster->GetCharmerOrOwnerOrSelf();
+
+            if (check->IsControlledByPlayer())
+                return !check->IsFriendlyTo(target);
+            return check->IsHostileTo(target);
+        }
+        case SPELL_TARGETS_ENTRY:
+            return target->GetEntry() == entry;
+        default:
+            return false;
     }
 }
 
@@ -1410,12 +1449,136 @@ void Spell::SearchAreaTarget(std::list<Unit*> &TagUnitMap, float radius, const u
             break;
     }
 
-    Trinity::SpellNotifierCreatureAndPlayer notifier(*this, TagUnitMap, radius, type, TargetType, pos, entry);
-    if ((m_spellInfo->AttributesEx3 & SPELL_ATTR_EX3_PLAYERS_ONLY)
-        || TargetType == SPELL_TARGETS_ENTRY && !entry)
-        m_caster->GetMap()->VisitWorld(pos->m_positionX, pos->m_positionY, radius, notifier);
-    else
-        m_caster->GetMap()->VisitAll(pos->m_positionX, pos->m_positionY, radius, notifier);
+    // effects and target types searching around the same center share one grid
+    // visit, only the filter below differs between them
+    SpellAreaTargetCache &cache = m_areaTargetCache;
+    if (!cache.Covers(pos, radius))
+    {
+        cache.Reset(pos, radius);
+        Trinity::SpellTargetCandidateCollector collector(cache);
+        m_caster->GetMap()->VisitAll(pos->m_positionX, pos->m_positionY, radius, collector);
+
+        size_t count = cache.units.size();
+        cache.distSq.resize(count);
+        if (count)
+        {
+            // flat arrays without branches, left to the compiler to vectorize
+            float const* x = &cache.posX[0];
+            float const* y = &cache.posY[0];
+            float const* z = &cache.posZ[0];
+            float* d = &cache.distSq[0];
+            for (size_t i = 0; i < count; ++i)
+            {
+                float dx = x[i] - cache.centerX;
+                float dy = y[i] - cache.centerY;
+                float dz = z[i] - cache.centerZ;
+                d[i] = dx*dx + dy*dy + dz*dz;
+            }
+        }
+    }
+
+    // former VisitWorld() searches only see units of the world containers
+    bool worldOnly = (m_spellInfo->AttributesEx3 & SPELL_ATTR_EX3_PLAYERS_ONLY)
+        || TargetType == SPELL_TARGETS_ENTRY && !entry;
+    // caster centered source searches check distance from caster to target (because of model collision)
+    bool casterDist = TargetType != SPELL_TARGETS_ENTRY && type == PUSH_SRC_CENTER;
+    float radiusSq = radius * radius;
+
+    for (size_t i = 0; i < cache.units.size(); ++i)
+    {
+        Unit* target = cache.units[i];
+
+        if (worldOnly && !target->m_isWorldObject)
+            continue;
+
+        switch (type)
+        {
+            case PUSH_IN_FRONT:
+            case PUSH_IN_BACK:
+            case PUSH_IN_LINE:
+                break;
+            default:
+                if (!casterDist && cache.distSq[i] >= radiusSq)
+                    continue;
+                break;
+        }
+
+        if (!IsValidAreaTarget(target, TargetType, entry, pos))
+            continue;
+
+        switch (type)
+        {
+            case PUSH_IN_FRONT:
+                if (m_caster->isInFrontInMap(target, radius, M_PI/3))
+                    TagUnitMap.push_back(target);
+                break;
+            case PUSH_IN_BACK:
+                if (m_caster->isInBackInMap(target, radius, M_PI/3))
+                    TagUnitMap.push_back(target);
+                break;
+            case PUSH_IN_LINE:
+                if (m_caster->HasInLine(target, radius, m_caster->GetObjectSize()))
+                    TagUnitMap.push_back(target);
+                break;
+            default:
+                if (!casterDist || m_caster->IsWithinDistInMap(target, radius))
+                    TagUnitMap.push_back(target);
+                break;
+        }
+    }
+
+    if (!m_IsTriggeredSpell)
+        PrepareTargetsLOS(TagUnitMap);
+}
+
+// trace the line of sight checks CheckTarget will do for these targets as one vmap batch
+void Spell::PrepareTargetsLOS(std::list<Unit*> const& targets)
+{
+    std::map<Unit const*, bool> &los = m_areaTargetCache.losToCaster;
+    std::vector<Unit const*> units;
+    std::vector<VMAP::LineOfSightQuery> queries;
+
+    float x, y, z;
+    m_caster->GetPosition(x, y, z);
+    for (std::list<Unit*>::const_iterator itr = targets.begin(); itr != targets.end(); ++itr)
+    {
+        Unit const* target = *itr;
+        if (target == m_caster || los.find(target) != los.end())
+            continue;
+
+        if (!target->IsInMap(m_caster))
+        {
+            los[target] = false;
+            continue;
+        }
+
+        // same segment as WorldObject::IsWithinLOS, from the target to the caster
+        VMAP::LineOfSightQuery query;
+        target->GetPosition(query.x1, query.y1, query.z1);
+        query.z1 += 2.0f;
+        query.x2 = x;
+        query.y2 = y;
+        query.z2 = z + 2.0f;
+        queries.push_back(query);
+        units.push_back(target);
+    }
+
+    if (queries.size() < 2)
+        return;
+
+    VMAP::IVMapManager* vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
+    vMapManager->isInLineOfSight(m_caster->GetMapId(), &queries[0], queries.size());
+    for (size_t i = 0; i < queries.size(); ++i)
+        los[units[i]] = queries[i].result;
+}
+
+bool Spell::IsWithinLOSOfCaster(Unit const* target) const
+{
+    std::map<Unit const*, bool>::const_iterator itr = m_areaTargetCache.losToCaster.find(target);
+    if (itr != m_areaTargetCache.losToCaster.end())
+        return itr->second;
+
+    return target->IsWithinLOSInMap(m_caster);
 }
 
 WorldObject* Spell::SearchNearbyTarget(float range, SpellTargets TargetType)
@@ -5210,7 +5373,7 @@ bool Spell::CheckTarget(Unit* target, uint32 eff)
             // all ok by some way or another, skip normal check
             break;
         default:                                            // normal case
-            if (target != m_caster && !target->IsWithinLOSInMap(m_caster))
+            if (target != m_caster && !IsWithinLOSOfCaster(target))
                 return false;
             break;
     }
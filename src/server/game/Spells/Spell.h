@@ -90,11 +90,6 @@ enum SpellNotifyPushType
 
 bool IsQuestTameSpell(uint32 spellId);
 
-namespace Trinity
-{
-    struct SpellNotifierCreatureAndPlayer;
-}
-
 class SpellCastTargets;
 
 struct SpellCastTargetsReader
@@ -241,9 +236,48 @@ enum SpellTargets
     SPELL_TARGETS_CHAINHEAL,
 };
 
+// Living units around one center, gathered by a single grid visit and shared by
+// all area searches of a cast that use the same center and a radius not larger
+struct SpellAreaTargetCache
+{
+    SpellAreaTargetCache() : centerX(0.0f), centerY(0.0f), centerZ(0.0f), radius(-1.0f) {}
+
+    bool Covers(Position const* pos, float r) const
+    {
+        return r <= radius && pos->m_positionX == centerX && pos->m_positionY == centerY && pos->m_positionZ == centerZ;
+    }
+    void Reset(Position const* pos, float r)
+    {
+        units.clear();
+        posX.clear();
+        posY.clear();
+        posZ.clear();
+        distSq.clear();
+        centerX = pos->m_positionX;
+        centerY = pos->m_positionY;
+        centerZ = pos->m_positionZ;
+        radius = r;
+    }
+    void Clear()
+    {
+        radius = -1.0f;
+        units.clear();
+        posX.clear();
+        posY.clear();
+        posZ.clear();
+        distSq.clear();
+        losToCaster.clear();
+    }
+
+    float centerX, centerY, centerZ, radius;
+    std::vector<Unit*> units;
+    std::vector<float> posX, posY, posZ;                    // positions at gathering time, one entry per unit
+    std::vector<float> distSq;                              // squared distance to the center, filled after gathering
+    std::map<Unit const*, bool> losToCaster;                // line of sight of found targets, traced in one batch, kept across centers
+};
+
 class Spell
 {
-    friend struct Trinity::SpellNotifierCreatureAndPlayer;
     friend void Unit::SetCurrentCastedSpell(Spell * pSpell);
     public:
 
@@ -392,6 +426,8 @@ class Spell
         Unit* SelectMagnetTarget();
         void HandleHitTriggerAura();
         bool CheckTarget(Unit* target, uint32 eff);
+        void PrepareTargetsLOS(std::list<Unit*> const& targets);
+        bool IsWithinLOSOfCaster(Unit const* target) const;
 
         void CheckSrc() { if (!m_targets.HasSrc()) m_targets.setSrc(m_caster); }
         void CheckDst() { if (!m_targets.HasDst()) m_targets.setDst(m_caster); }
@@ -576,6 +612,7 @@ class Spell
         bool IsAliveUnitPresentInTargetList();
         void SearchAreaTarget(std::list<Unit*> &unitList, float radius, const uint32 type, SpellTargets TargetType, uint32 entry = 0);
         void SearchChainTarget(std::list<Unit*> &unitList, float radius, uint32 unMaxTargets, SpellTargets TargetType);
+        bool IsValidAreaTarget(Unit* target, SpellTargets TargetType, uint32 entry, Position const* pos) const;
         WorldObject* SearchNearbyTarget(float range, SpellTargets TargetType);
         bool IsValidSingleTargetEffect(Unit const* target, Targets type) const;
         bool IsValidSingleTargetSpell(Unit const* target) const;
@@ -611,111 +648,29 @@ class Spell
 
         uint32 m_customAttr;
         bool m_skipCheck;
+
+        SpellAreaTargetCache m_areaTargetCache;             // valid during FillTargetMap only
 };
 
 namespace Trinity
 {
-    struct SpellNotifierCreatureAndPlayer
+    struct SpellTargetCandidateCollector
     {
-        std::list<Unit*> *i_data;
-        Spell &i_spell;
-        const uint32& i_push_type;
-        float i_radius, i_radiusSq;
-        SpellTargets i_TargetType;
-        Unit* i_caster;
-        uint32 i_entry;
-        const Position * const i_pos;
-
-        SpellNotifierCreatureAndPlayer(Spell &spell, std::list<Unit*> &data, float radius, const uint32 &type,
-            SpellTargets TargetType = SPELL_TARGETS_ENEMY, const Position *pos = NULL, uint32 entry = 0)
-            : i_data(&data), i_spell(spell), i_push_type(type), i_radius(radius), i_radiusSq(radius*radius)
-            , i_TargetType(TargetType), i_pos(pos), i_entry(entry)
-        {
-            i_caster = spell.GetCaster();
-        }
+        SpellAreaTargetCache &i_cache;
+
+        explicit SpellTargetCandidateCollector(SpellAreaTargetCache &cache) : i_cache(cache) {}
 
         template<class T> inline void Visit(GridRefManager<T>  &m)
         {
-            assert(i_data);
-
-            if (!i_caster)
-                return;
-
             for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
             {
                 if (!itr->getSource()->isAlive() || (itr->getSource()->GetTypeId() == TYPEID_PLAYER && ((Player*)itr->getSource())->isInFlight()))
                     continue;
 
-                switch (i_TargetType)
-                {
-                    case SPELL_TARGETS_ALLY:
-                        if (!itr->getSource()->isAttackableByAOE() || !i_caster->IsFriendlyTo(itr->getSource()))
-                            continue;
-                        break;
-                    case SPELL_TARGETS_ENEMY:
-                    {
-                        if (itr->getSource()->GetTypeId() == TYPEID_UNIT && ((Creature*)itr->getSource())->isTotem())
-                            continue;
-
-                        if (i_caster->GetCreatureType() == CREATURE_TYPE_TOTEM)
-                        {
-                            if (!itr->getSource()->isAttackableByAOE(i_pos->GetPositionX(), i_pos->GetPositionY(), i_pos->GetPositionZ(), true))
-                                continue;
-                        }
-                        else
-                        {
-                            if (!itr->getSource()->isAttackableByAOE())
-                                continue;
-                        }
-
-                        Unit* check = i_caster->GetCharmerOrOwnerOrSelf();
-
-                        if (check->IsControlledByPlayer())
-                        {
-                            if (check->IsFriendlyTo(itr->getSource()))
-                                continue;
-                        }
-                        else
-                        {
-                            if (!check->IsHostileTo(itr->getSource()))
-                                continue;
-                        }
-                    }break;
-                    case SPELL_TARGETS_ENTRY:
-                    {
-                        if (itr->getSource()->GetEntry() != i_entry)
-                            continue;
-                    }break;
-                    default: continue;
-                }
-
-                switch (i_push_type)
-                {
-                    case PUSH_IN_FRONT:
-                        if (i_caster->isInFrontInMap((Unit*)(itr->getSource()), i_radius, M_PI/3))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_IN_BACK:
-                        if (i_caster->isInBackInMap((Unit*)(itr->getSource()), i_radius, M_PI/3))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_IN_LINE:
-                        if (i_caster->HasInLine((Unit*)(itr->getSource()), i_radius, i_caster->GetObjectSize()))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    default:
-                        if (i_TargetType != SPELL_TARGETS_ENTRY && i_push_type == PUSH_SRC_CENTER && i_caster) // if caster then check distance from caster to target (because of model collision)
-                        {
-                            if (i_caster->IsWithinDistInMap(itr->getSource(), i_radius))
-                                i_data->push_back(itr->getSource());
-                        }
-                        else
-                        {
-                            if ((itr->getSource()->GetExactDistSq(i_pos) < i_radiusSq))
-                                i_data->push_back(itr->getSource());
-                        }
-                        break;
-                }
+                i_cache.units.push_back(itr->getSource());
+                i_cache.posX.push_back(itr->getSource()->GetPositionX());
+                i_cache.posY.push_back(itr->getSource()->GetPositionY());
+                i_cache.posZ.push_back(itr->getSource()->GetPositionZ());
             }
         }
 
@@ -727,9 +682,9 @@ namespace Trinity
     };
 
     #ifndef WIN32
-    template<> inline void SpellNotifierCreatureAndPlayer::Visit(CorpseMapType&) {}
-    template<> inline void SpellNotifierCreatureAndPlayer::Visit(GameObjectMapType&) {}
-    template<> inline void SpellNotifierCreatureAndPlayer::Visit(DynamicObjectMapType&) {}
+    template<> inline void SpellTargetCandidateCollector::Visit(CorpseMapType&) {}
+    template<> inline void SpellTargetCandidateCollector::Visit(GameObjectMapType&) {}
+    template<> inline void SpellTargetCandidateCollector::Visit(DynamicObjectMapType&) {}
     #endif
 }
 
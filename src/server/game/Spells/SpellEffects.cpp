@@ -4973,7 +4973,7 @@ void Spell::EffectScriptEffect(uint32 effIndex)
                         return;
 
                     uint32 spellId = 0;
-                    switch (rand() % 4)
+                    switch (urand(0, 3))
                     {
                         case 0: spellId = 46740; break;
                         case 1: spellId = 46739; break;
@@ -2931,3 +2931,161 @@ DiminishingReturnsType GetDiminishingReturnsGroupType(DiminishingGroup group)
     return DRTYPE_NONE;
 }
 
+
+void SpellMgr::LoadSpellInfoStore()
+{
+    uint32 rows = GetSpellStore()->GetNumRows();
+    SpellInfoStore store(rows);
+    uint32 count = 0;
+
+    for (uint32 i = 0; i < rows; ++i)
+    {
+        SpellEntry const* spellEntry = GetSpellStore()->LookupEntry(i);
+        if (!spellEntry)
+            continue;
+
+        SpellInfo& info = store[i];
+        info.Id = spellEntry->Id;
+        info.Attributes = spellEntry->Attributes;
+        info.AttributesEx = spellEntry->AttributesEx;
+        info.AttributesEx2 = spellEntry->AttributesEx2;
+        info.AttributesEx3 = spellEntry->AttributesEx3;
+        info.AttributesEx4 = spellEntry->AttributesEx4;
+        info.AttributesEx5 = spellEntry->AttributesEx5;
+        info.CustomAttr = GetSpellCustomAttr(i);
+        info.SchoolMask = spellEntry->SchoolMask;
+        info.DmgClass = spellEntry->DmgClass;
+        info.PreventionType = spellEntry->PreventionType;
+        info.SpellFamilyName = spellEntry->SpellFamilyName;
+        info.SpellFamilyFlags = spellEntry->SpellFamilyFlags;
+        info.ProcFlags = spellEntry->procFlags;
+        info.ProcChance = spellEntry->procChance;
+        info.ProcCharges = spellEntry->procCharges;
+        info.EquippedItemClass = spellEntry->EquippedItemClass;
+        info.EquippedItemSubClassMask = spellEntry->EquippedItemSubClassMask;
+        info.MinRange = GetSpellMinRange(spellEntry);
+        info.MaxRange = GetSpellMaxRange(spellEntry);
+
+        for (uint8 j = 0; j < MAX_SPELL_EFFECTS; ++j)
+        {
+            info.Effect[j] = spellEntry->Effect[j];
+            info.EffectApplyAuraName[j] = spellEntry->EffectApplyAuraName[j];
+            info.EffectImplicitTargetA[j] = spellEntry->EffectImplicitTargetA[j];
+            info.EffectImplicitTargetB[j] = spellEntry->EffectImplicitTargetB[j];
+            info.EffectRadiusHostile[j] = GetSpellRadius(spellEntry, j, false);
+            info.EffectRadiusFriend[j] = GetSpellRadius(spellEntry, j, true);
+        }
+
+        info.ProcEvent = GetSpellProcEvent(i);
+        info.Entry = spellEntry;
+        ++count;
+    }
+
+    mSpellInfoStore.swap(store);
+
+    sLog->outString();
+    sLog->outString(">> Built %u spell infos (%u bytes each, %u bytes per SpellEntry)", count, uint32(sizeof(SpellInfo)), uint32(sizeof(SpellEntry)));
+}
+
+// The checks a damage or aura hit runs on its spell: school, attributes, custom
+// attributes, proc data, range and the effect auras and radii
+static inline uint32 CombatChecks(SpellEntry const* spellEntry, SpellMgr const* mgr)
+{
+    uint32 acc = GetSpellSchoolMask(spellEntry) + spellEntry->DmgClass;
+    if (spellEntry->Attributes & SPELL_ATTR_IMPOSSIBLE_DODGE_PARRY_BLOCK)
+        acc += 1;
+    if (spellEntry->AttributesEx2 & SPELL_ATTR_EX2_CANT_CRIT)
+        acc += 2;
+    if (spellEntry->AttributesEx3 & SPELL_ATTR_EX3_NO_INITIAL_AGGRO)
+        acc += 4;
+    if (mgr->GetSpellCustomAttr(spellEntry->Id) & SPELL_ATTR_CU_DIRECT_DAMAGE)
+        acc += 8;
+
+    SpellProcEventEntry const* procEvent = mgr->GetSpellProcEvent(spellEntry->Id);
+    acc += procEvent && procEvent->procFlags ? procEvent->procFlags : spellEntry->procFlags;
+    acc += uint32(GetSpellMaxRange(sSpellRangeStore.LookupEntry(spellEntry->rangeIndex)));
+
+    for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+        if (spellEntry->Effect[i])
+            acc += spellEntry->EffectApplyAuraName[i] + uint32(GetSpellRadiusForHostile(sSpellRadiusStore.LookupEntry(spellEntry->EffectRadiusIndex[i])));
+
+    return acc;
+}
+
+static inline uint32 CombatChecks(SpellInfo const* info)
+{
+    uint32 acc = info->SchoolMask + info->DmgClass;
+    if (info->Attributes & SPELL_ATTR_IMPOSSIBLE_DODGE_PARRY_BLOCK)
+        acc += 1;
+    if (info->AttributesEx2 & SPELL_ATTR_EX2_CANT_CRIT)
+        acc += 2;
+    if (info->AttributesEx3 & SPELL_ATTR_EX3_NO_INITIAL_AGGRO)
+        acc += 4;
+    if (info->CustomAttr & SPELL_ATTR_CU_DIRECT_DAMAGE)
+        acc += 8;
+
+    acc += info->ProcEvent && info->ProcEvent->procFlags ? info->ProcEvent->procFlags : info->ProcFlags;
+    acc += uint32(info->MaxRange);
+
+    for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+        if (info->Effect[i])
+            acc += info->EffectApplyAuraName[i] + uint32(info->EffectRadiusHostile[i]);
+
+    return acc;
+}
+
+void SpellMgr::BenchmarkSpellInfo(uint32 events, SpellInfoBenchResult& result) const
+{
+    // a raid's worth of damage, heal and aura spells, the same ones on every run
+    RandomStream stream(events);
+    RandomStreamSelector selector(&stream);
+
+    std::vector<uint32> candidates;
+    for (uint32 i = 0; i < mSpellInfoStore.size(); ++i)
+    {
+        SpellInfo const& info = mSpellInfoStore[i];
+        if (!info.Entry || (info.Attributes & SPELL_ATTR_PASSIVE))
+            continue;
+
+        for (uint8 j = 0; j < MAX_SPELL_EFFECTS; ++j)
+        {
+            if (info.Effect[j] == SPELL_EFFECT_SCHOOL_DAMAGE || info.Effect[j] == SPELL_EFFECT_HEAL ||
+                info.Effect[j] == SPELL_EFFECT_WEAPON_DAMAGE || info.Effect[j] == SPELL_EFFECT_APPLY_AURA)
+            {
+                candidates.push_back(i);
+                break;
+            }
+        }
+    }
+
+    result.spells = 0;
+    result.entryTime = 0;
+    result.infoTime = 0;
+    result.match = true;
+    if (candidates.empty())
+        return;
+
+    std::vector<uint32> spells;
+    uint32 spellCount = std::min<uint32>(candidates.size(), 1500);
+    for (uint32 i = 0; i < spellCount; ++i)
+        spells.push_back(candidates[urand(0, candidates.size() - 1)]);
+    result.spells = spellCount;
+
+    // the log: a few spells (rotations) dominate, the rest shows up now and then
+    std::vector<uint32> log(events);
+    for (uint32 i = 0; i < events; ++i)
+        log[i] = spells[roll_chance_i(70) ? urand(0, spellCount / 20) : urand(0, spellCount - 1)];
+
+    uint32 entrySum = 0, infoSum = 0;
+    uint32 start = getMSTime();
+    for (uint32 i = 0; i < events; ++i)
+        entrySum += CombatChecks(sSpellStore.LookupEntry(log[i]), this);
+    result.entryTime = getMSTimeDiff(start, getMSTime());
+
+    start = getMSTime();
+    for (uint32 i = 0; i < events; ++i)
+        infoSum += CombatChecks(GetSpellInfo(log[i]));
+    result.infoTime = getMSTimeDiff(start, getMSTime());
+
+    result.match = entrySum == infoSum;
+}
@@ -793,6 +793,57 @@ inline bool IsProfessionSkill(uint32 skill)
 
 typedef std::vector<uint32> SpellCustomAttribute;
 
+// The fields of a SpellEntry that combat checks read on every hit, packed together
+// with the DBC indexes (range, radius) and the SpellMgr tables (custom attributes,
+// proc event) already resolved. Built by SpellMgr::LoadSpellInfoStore once the
+// spell tables are loaded; everything else stays in the entry (Entry).
+struct SpellInfo
+{
+    uint32 Id;
+    uint32 Attributes;
+    uint32 AttributesEx;
+    uint32 AttributesEx2;
+    uint32 AttributesEx3;
+    uint32 AttributesEx4;
+    uint32 AttributesEx5;
+    uint32 CustomAttr;                                      // SPELL_ATTR_CU_*
+    uint32 SchoolMask;
+    uint32 DmgClass;
+    uint32 PreventionType;
+    uint32 SpellFamilyName;
+    uint64 SpellFamilyFlags;
+    uint32 ProcFlags;
+    uint32 ProcChance;
+    uint32 ProcCharges;
+    int32 EquippedItemClass;
+    int32 EquippedItemSubClassMask;
+    float MinRange;
+    float MaxRange;
+    uint32 Effect[MAX_SPELL_EFFECTS];
+    uint32 EffectApplyAuraName[MAX_SPELL_EFFECTS];
+    uint32 EffectImplicitTargetA[MAX_SPELL_EFFECTS];
+    uint32 EffectImplicitTargetB[MAX_SPELL_EFFECTS];
+    float EffectRadiusHostile[MAX_SPELL_EFFECTS];
+    float EffectRadiusFriend[MAX_SPELL_EFFECTS];
+    SpellProcEventEntry const* ProcEvent;                   // spell_proc_event row or NULL
+    SpellEntry const* Entry;                                // cold data
+
+    float GetEffectRadius(uint32 effIndex, bool positive) const
+    {
+        return positive ? EffectRadiusFriend[effIndex] : EffectRadiusHostile[effIndex];
+    }
+};
+
+typedef std::vector<SpellInfo> SpellInfoStore;
+
+struct SpellInfoBenchResult
+{
+    uint32 spells;                                          // distinct spells in the replayed log
+    uint32 entryTime;                                       // ms, checks through SpellEntry and the lookup tables
+    uint32 infoTime;                                        // ms, same checks through SpellInfo
+    bool match;                                             // both passes computed the same result
+};
+
 typedef std::map<int32, std::vector<int32> > SpellLinkedMap;
 
 class SpellMgr
@@ -1046,6 +1097,17 @@ class SpellMgr
                 return 0;*/
         }
 
+        // NULL for ids without a Spell.dbc row; only valid until the next LoadSpellInfoStore
+        SpellInfo const* GetSpellInfo(uint32 spellId) const
+        {
+            if (spellId >= mSpellInfoStore.size() || !mSpellInfoStore[spellId].Entry)
+                return NULL;
+            return &mSpellInfoStore[spellId];
+        }
+
+        // replays a synthetic raid combat log through both layers
+        void BenchmarkSpellInfo(uint32 events, SpellInfoBenchResult& result) const;
+
         const std::vector<int32> *GetSpellLinked(int32 spell_id) const
         {
             SpellLinkedMap::const_iterator itr = mSpellLinkedMap.find(spell_id);
@@ -1075,6 +1137,8 @@ class SpellMgr
         void LoadSpellCustomAttr();
         void LoadSpellLinked();
         void LoadSpellEnchantProcData();
+        // must be after everything that changes spell data, custom attributes or proc events
+        void LoadSpellInfoStore();
 
     private:
         SpellScriptTarget  mSpellScriptTarget;
@@ -1092,6 +1156,7 @@ class SpellMgr
         SpellCustomAttribute  mSpellCustomAttr;
         SpellLinkedMap      mSpellLinkedMap;
         SpellEnchantProcEventMap     mSpellEnchantProcEventMap;
+        SpellInfoStore      mSpellInfoStore;
 };
 
 #define sSpellMgr ACE_Singleton<SpellMgr, ACE_Null_Mutex>::instance()
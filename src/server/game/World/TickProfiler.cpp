@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.h"
+#include "TickProfiler.h"
+
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
+#include <ace/TSS_T.h>
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+
+static char const* const zoneNames[MAX_PROFILE_ZONES] =
+{
+    "World::Update",
+    "UpdateSessions",
+    "MapManager::Update",
+    "Map::Update",
+    "LoadPendingCells",
+    "Player::Update",
+    "player cells",
+    "active object cells",
+    "ScriptsProcess",
+    "MoveAllCreaturesInMoveList",
+    "ProcessRelocationNotifies",
+    "DelayedUpdate",
+    "ObjectAccessor::Update",
+    "Transport::Update",
+    "UpdatePlayerSaves",
+    "BattlegroundMgr::Update",
+    "OutdoorPvPMgr::Update",
+    "UpdateResultQueue",
+    "ProcessCliCommands"
+};
+
+// the buffers themselves belong to the profiler, they outlive their threads for the dumps
+struct TickProfileSlot
+{
+    TickProfileSlot() : buffer(NULL) {}
+    TickProfiler::ThreadBuffer* buffer;
+};
+
+static ACE_TSS<TickProfileSlot> threadSlots;
+
+static uint32 Percentile(std::vector<uint32> const& sorted, uint32 pct)
+{
+    return sorted[std::min<size_t>(sorted.size() - 1, sorted.size() * pct / 100)];
+}
+
+TickProfiler::TickProfiler() : m_enabled(false), m_bufferSize(16384), m_startTime(ACE_OS::gettimeofday())
+{
+}
+
+TickProfiler::~TickProfiler()
+{
+    for (std::vector<ThreadBuffer*>::iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+        delete *itr;
+}
+
+char const* TickProfiler::GetZoneName(TickProfileZone zone)
+{
+    return zone < MAX_PROFILE_ZONES ? zoneNames[zone] : "<unknown>";
+}
+
+TickProfiler::ThreadBuffer* TickProfiler::GetThreadBuffer()
+{
+    TickProfileSlot* slot = threadSlots.ts_object();
+    if (!slot)
+        return NULL;
+
+    if (!slot->buffer)
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+        slot->buffer = new ThreadBuffer(m_threads.size(), m_bufferSize);
+        m_threads.push_back(slot->buffer);
+    }
+
+    return slot->buffer;
+}
+
+uint64 TickProfiler::GetTime() const
+{
+    ACE_UINT64 time;
+    (ACE_OS::gettimeofday() - m_startTime).to_usec(time);
+    return time;
+}
+
+void TickProfiler::GetEvents(ThreadBuffer const* buffer, std::vector<TickProfileEvent const*>& events) const
+{
+    uint32 size = buffer->events.size();
+    if (buffer->written > size)
+    {
+        for (uint32 i = buffer->next; i < size; ++i)
+            events.push_back(&buffer->events[i]);
+    }
+
+    for (uint32 i = 0; i < buffer->next; ++i)
+        events.push_back(&buffer->events[i]);
+}
+
+void TickProfiler::GetZoneStats(TickProfileZoneStats stats[MAX_PROFILE_ZONES], uint64& window)
+{
+    std::vector<uint32> durations[MAX_PROFILE_ZONES];
+    uint64 now = GetTime();
+    uint64 oldest = now;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    for (std::vector<ThreadBuffer*>::const_iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+    {
+        std::vector<TickProfileEvent const*> events;
+        GetEvents(*itr, events);
+        for (std::vector<TickProfileEvent const*>::const_iterator event = events.begin(); event != events.end(); ++event)
+        {
+            durations[(*event)->zone].push_back((*event)->duration);
+            oldest = std::min(oldest, (*event)->start);
+        }
+    }
+
+    window = now - oldest;
+    for (uint8 i = 0; i < MAX_PROFILE_ZONES; ++i)
+    {
+        stats[i] = TickProfileZoneStats();
+        if (durations[i].empty())
+            continue;
+
+        std::sort(durations[i].begin(), durations[i].end());
+        stats[i].count = durations[i].size();
+        for (std::vector<uint32>::const_iterator itr = durations[i].begin(); itr != durations[i].end(); ++itr)
+            stats[i].total += *itr;
+        stats[i].p50 = Percentile(durations[i], 50);
+        stats[i].p95 = Percentile(durations[i], 95);
+        stats[i].p99 = Percentile(durations[i], 99);
+        stats[i].max = durations[i].back();
+    }
+}
+
+struct TickProfileMapStatsOrder
+{
+    bool operator()(TickProfileMapStats const& a, TickProfileMapStats const& b) const { return a.total > b.total; }
+};
+
+void TickProfiler::GetMapStats(std::vector<TickProfileMapStats>& stats)
+{
+    typedef std::map<std::pair<uint32, uint32>, std::vector<uint32> > MapDurations;
+    MapDurations durations;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        for (std::vector<ThreadBuffer*>::const_iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+        {
+            std::vector<TickProfileEvent const*> events;
+            GetEvents(*itr, events);
+            for (std::vector<TickProfileEvent const*>::const_iterator event = events.begin(); event != events.end(); ++event)
+                if ((*event)->zone == PROFILE_MAP_UPDATE)
+                    durations[std::make_pair((*event)->mapId, (*event)->instanceId)].push_back((*event)->duration);
+        }
+    }
+
+    stats.clear();
+    for (MapDurations::iterator itr = durations.begin(); itr != durations.end(); ++itr)
+    {
+        std::sort(itr->second.begin(), itr->second.end());
+
+        TickProfileMapStats map;
+        map.mapId = itr->first.first;
+        map.instanceId = itr->first.second;
+        map.count = itr->second.size();
+        map.total = 0;
+        for (std::vector<uint32>::const_iterator duration = itr->second.begin(); duration != itr->second.end(); ++duration)
+            map.total += *duration;
+        map.p95 = Percentile(itr->second, 95);
+        map.max = itr->second.back();
+        stats.push_back(map);
+    }
+
+    std::sort(stats.begin(), stats.end(), TickProfileMapStatsOrder());
+}
+
+bool TickProfiler::DumpChromeTrace(char const* fileName, uint32& count)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+
+    FILE* file = fopen(fileName, "w");
+    if (!file)
+        return false;
+
+    count = 0;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (std::vector<ThreadBuffer*>::const_iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+    {
+        ThreadBuffer const* buffer = *itr;
+        if (buffer->world)
+            fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"world\"}}", itr == m_threads.begin() ? "" : ",", buffer->index);
+        else
+            fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"map updater %u\"}}", itr == m_threads.begin() ? "" : ",", buffer->index, buffer->index);
+
+        std::vector<TickProfileEvent const*> events;
+        GetEvents(buffer, events);
+        for (std::vector<TickProfileEvent const*>::const_iterator event = events.begin(); event != events.end(); ++event, ++count)
+        {
+            TickProfileEvent const* e = *event;
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":" UI64FMTD ",\"dur\":%u",
+                zoneNames[e->zone], e->mapId != TICK_PROFILE_NO_MAP ? "map" : "world", buffer->index, e->start, e->duration);
+            if (e->mapId != TICK_PROFILE_NO_MAP)
+                fprintf(file, ",\"args\":{\"map\":%u,\"instance\":%u}", e->mapId, e->instanceId);
+            fprintf(file, "}");
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return true;
+}
+
+void TickProfiler::Reset()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    for (std::vector<ThreadBuffer*>::iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+    {
+        (*itr)->next = 0;
+        (*itr)->written = 0;
+    }
+}
+
+void TickProfileScope::Begin(TickProfileZone zone, uint32 mapId, uint32 instanceId)
+{
+    m_buffer = sTickProfiler->GetThreadBuffer();
+    if (!m_buffer)
+        return;
+
+    m_start = sTickProfiler->GetTime();
+    m_mapId = mapId;
+    m_instanceId = instanceId;
+    m_zone = zone;
+    ++m_buffer->depth;
+}
+
+void TickProfileScope::End()
+{
+    uint64 end = sTickProfiler->GetTime();
+    --m_buffer->depth;
+
+    TickProfileEvent& event = m_buffer->events[m_buffer->next];
+    event.start = m_start;
+    event.duration = uint32(end - m_start);
+    event.mapId = m_mapId;
+    event.instanceId = m_instanceId;
+    event.zone = m_zone;
+    event.depth = m_buffer->depth;
+
+    if (m_zone == PROFILE_WORLD_UPDATE)
+        m_buffer->world = true;
+    if (++m_buffer->next == m_buffer->events.size())
+        m_buffer->next = 0;
+    ++m_buffer->written;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITY_TICKPROFILER_H
+#define TRINITY_TICKPROFILER_H
+
+#include "Define.h"
+
+#include <ace/Null_Mutex.h>
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Time_Value.h>
+#include <vector>
+
+enum TickProfileZone
+{
+    PROFILE_WORLD_UPDATE,
+    PROFILE_WORLD_SESSIONS,
+    PROFILE_MAP_MANAGER,
+    PROFILE_MAP_UPDATE,                                     // one map, from its update thread
+    PROFILE_MAP_CELL_LOADS,
+    PROFILE_MAP_PLAYERS,
+    PROFILE_MAP_CELLS,                                      // cells around the players
+    PROFILE_MAP_ACTIVE_OBJECTS,                             // cells around the non player active objects
+    PROFILE_MAP_SCRIPTS,
+    PROFILE_MAP_MOVE_LIST,
+    PROFILE_MAP_RELOCATION,
+    PROFILE_MAP_DELAYED_UPDATE,
+    PROFILE_OBJECT_ACCESSOR,
+    PROFILE_TRANSPORTS,
+    PROFILE_PLAYER_SAVES,
+    PROFILE_BATTLEGROUND_MGR,
+    PROFILE_OUTDOORPVP_MGR,
+    PROFILE_DB_CALLBACKS,
+    PROFILE_CLI_COMMANDS,
+    MAX_PROFILE_ZONES
+};
+
+#define TICK_PROFILE_NO_MAP 0xFFFFFFFF
+
+struct TickProfileEvent
+{
+    uint64 start;                                           // us since the profiler was created
+    uint32 duration;                                        // us
+    uint32 mapId;                                           // TICK_PROFILE_NO_MAP outside of map zones
+    uint32 instanceId;
+    uint8 zone;
+    uint8 depth;                                            // zones open around it on the same thread
+};
+
+struct TickProfileZoneStats
+{
+    TickProfileZoneStats() : count(0), total(0), p50(0), p95(0), p99(0), max(0) {}
+
+    uint32 count;
+    uint64 total;                                           // us
+    uint32 p50, p95, p99, max;                              // us
+};
+
+struct TickProfileMapStats
+{
+    uint32 mapId;
+    uint32 instanceId;
+    uint32 count;
+    uint64 total;                                           // us in Map::Update
+    uint32 p95, max;                                        // us
+};
+
+/*
+ * Scoped zones around the phases of the world and map updates. Every thread
+ * writes the zones it closes into its own ring buffer of TickProfiler.BufferSize
+ * events, so recording takes no lock; the percentiles and the trace dump are
+ * built from what the rings hold, the last few hundred ticks. They are read
+ * by commands on the world thread, while no map is updating.
+ */
+class TickProfiler
+{
+    friend class ACE_Singleton<TickProfiler, ACE_Null_Mutex>;
+    friend class TickProfileScope;
+
+    TickProfiler();
+    ~TickProfiler();
+
+    public:
+        // one ring per thread, allocated by the first zone the thread records
+        struct ThreadBuffer
+        {
+            explicit ThreadBuffer(uint32 _index, uint32 size) : index(_index), events(size), next(0), written(0), depth(0), world(false) {}
+
+            uint32 index;
+            std::vector<TickProfileEvent> events;
+            uint32 next;
+            uint64 written;
+            uint8 depth;
+            bool world;                                     // recorded World::Update
+        };
+
+        bool IsEnabled() const { return m_enabled; }
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        // events per thread, for the threads recording their first zone from now on
+        void SetBufferSize(uint32 size) { m_bufferSize = size ? size : 1; }
+
+        void GetZoneStats(TickProfileZoneStats stats[MAX_PROFILE_ZONES], uint64& window);
+        // maps with the most time in Map::Update first
+        void GetMapStats(std::vector<TickProfileMapStats>& stats);
+        // Chrome trace event format, loaded by chrome://tracing and Perfetto
+        bool DumpChromeTrace(char const* fileName, uint32& events);
+        void Reset();
+
+        static char const* GetZoneName(TickProfileZone zone);
+
+    private:
+        ThreadBuffer* GetThreadBuffer();
+        uint64 GetTime() const;
+        // the events of buffer from the oldest to the newest
+        void GetEvents(ThreadBuffer const* buffer, std::vector<TickProfileEvent const*>& events) const;
+
+        volatile bool m_enabled;
+        uint32 m_bufferSize;
+        ACE_Time_Value m_startTime;
+
+        ACE_Thread_Mutex m_lock;                            // thread registration
+        std::vector<ThreadBuffer*> m_threads;
+};
+
+#define sTickProfiler ACE_Singleton<TickProfiler, ACE_Null_Mutex>::instance()
+
+class TickProfileScope
+{
+    public:
+        explicit TickProfileScope(TickProfileZone zone, uint32 mapId = TICK_PROFILE_NO_MAP, uint32 instanceId = 0) : m_buffer(NULL)
+        {
+            if (sTickProfiler->IsEnabled())
+                Begin(zone, mapId, instanceId);
+        }
+
+        ~TickProfileScope()
+        {
+            if (m_buffer)
+                End();
+        }
+
+    private:
+        void Begin(TickProfileZone zone, uint32 mapId, uint32 instanceId);
+        void End();
+
+        TickProfiler::ThreadBuffer* m_buffer;
+        uint64 m_start;
+        uint32 m_mapId;
+        uint32 m_instanceId;
+        uint8 m_zone;
+};
+
+#endif
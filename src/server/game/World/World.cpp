@@ -59,6 +59,9 @@
 #include "CreatureEventAIMgr.h"
 #include "ScriptMgr.h"
 #include "WardenDataStorage.h"
+#include "PlayerSaveScheduler.h"
+#include "ObjectPool.h"
+#include "TickProfiler.h"
 
 volatile bool World::m_stopEvent = false;
 uint8 World::m_ExitCode = SHUTDOWN_EXIT_CODE;
@@ -98,6 +101,9 @@ World::World()
     m_availableDbcLocaleMask = 0;
 
     m_updateTimeSum = 0;
+    m_loginTimeSum = 0;
+    m_loginTimeMax = 0;
+    m_loginTimeCount = 0;
     m_updateTimeCount = 0;
 }
 
@@ -541,7 +547,17 @@ void World::LoadConfigSettings(bool reload)
     }
     m_configs[CONFIG_ADDON_CHANNEL] = ConfigMgr::GetBoolDefault("AddonChannel", true);
     m_configs[CONFIG_GRID_UNLOAD] = ConfigMgr::GetBoolDefault("GridUnload", true);
+    m_configs[CONFIG_GRID_LOAD_TICK_BUDGET] = ConfigMgr::GetIntDefault("GridLoad.TickBudget", 5);
+    m_configs[CONFIG_GRID_LOAD_NEAR_CELLS] = ConfigMgr::GetIntDefault("GridLoad.NearCells", 2);
+    m_configs[CONFIG_DORMANT_OBJECTS] = ConfigMgr::GetBoolDefault("DormantObjects", true);
+    m_configs[CONFIG_DORMANT_IDLE_CREATURE_TIME] = ConfigMgr::GetIntDefault("DormantObjects.IdleCreatureTime", 2);
+    m_configs[CONFIG_MOVEMENT_CHECKPOINT] = ConfigMgr::GetIntDefault("MovementCheckpoint", 1000);
+    m_configs[CONFIG_RANDOM_MAP_SEED] = ConfigMgr::GetIntDefault("MapRandomSeed", 0);
+    m_configs[CONFIG_OBJECT_POOL_MAX_FREE] = ConfigMgr::GetIntDefault("ObjectPool.MaxFreeBlocks", 2048);
+    sObjectPoolMgr->SetMaxFreeBlocks(m_configs[CONFIG_OBJECT_POOL_MAX_FREE]);
     m_configs[CONFIG_INTERVAL_SAVE] = ConfigMgr::GetIntDefault("PlayerSaveInterval", 900000);
+    m_configs[CONFIG_PLAYER_SAVE_MAX_PER_TICK] = ConfigMgr::GetIntDefault("PlayerSave.MaxPerTick", 10);
+    m_configs[CONFIG_PLAYER_SAVE_THREADS] = ConfigMgr::GetIntDefault("PlayerSave.Threads", 1);
     m_configs[CONFIG_INTERVAL_DISCONNECT_TOLERANCE] = ConfigMgr::GetIntDefault("DisconnectToleranceInterval", 0);
 
     m_configs[CONFIG_INTERVAL_GRIDCLEAN] = ConfigMgr::GetIntDefault("GridCleanUpDelay", 300000);
@@ -769,6 +785,9 @@ void World::LoadConfigSettings(bool reload)
 
     m_configs[CONFIG_EXTERNAL_MAIL] = ConfigMgr::GetIntDefault("ExternalMail", 0);
     m_configs[CONFIG_EXTERNAL_MAIL_INTERVAL] = ConfigMgr::GetIntDefault("ExternalMailInterval", 1);
+    m_configs[CONFIG_EXPIRED_MAIL_BATCH_SIZE] = ConfigMgr::GetIntDefault("ExpiredMailBatchSize", 500);
+    if (m_configs[CONFIG_EXPIRED_MAIL_BATCH_SIZE] < 1)
+        m_configs[CONFIG_EXPIRED_MAIL_BATCH_SIZE] = 1;
 
     m_configs[CONFIG_UPTIME_UPDATE] = ConfigMgr::GetIntDefault("UpdateUptimeInterval", 10);
     if (int32(m_configs[CONFIG_UPTIME_UPDATE]) <= 0)
@@ -843,6 +862,11 @@ void World::LoadConfigSettings(bool reload)
         m_configs[CONFIG_MAX_OVERSPEED_PINGS] = 2;
     }
 
+    m_configs[CONFIG_NETWORK_PREPARSE] = ConfigMgr::GetBoolDefault("Network.PreParse", false);
+    m_configs[CONFIG_NETWORK_RATE_LIMIT_MOVEMENT] = ConfigMgr::GetIntDefault("Network.RateLimit.Movement", 100);
+    m_configs[CONFIG_NETWORK_RATE_LIMIT_SPELL] = ConfigMgr::GetIntDefault("Network.RateLimit.Spell", 30);
+    m_configs[CONFIG_NETWORK_MAX_DROPPED_PACKETS] = ConfigMgr::GetIntDefault("Network.MaxDroppedPackets", 0);
+
     m_configs[CONFIG_SAVE_RESPAWN_TIME_IMMEDIATELY] = ConfigMgr::GetBoolDefault("SaveRespawnTimeImmediately", true);
     m_configs[CONFIG_WEATHER] = ConfigMgr::GetBoolDefault("ActivateWeather", true);
 
@@ -1007,6 +1031,15 @@ void World::LoadConfigSettings(bool reload)
     m_visibility_notify_periodInInstances = ConfigMgr::GetIntDefault("Visibility.Notify.Period.InInstances",  DEFAULT_VISIBILITY_NOTIFY_PERIOD);
     m_visibility_notify_periodInBGArenas = ConfigMgr::GetIntDefault("Visibility.Notify.Period.InBGArenas",   DEFAULT_VISIBILITY_NOTIFY_PERIOD);
 
+    m_configs[CONFIG_MOVEMENT_TIER_NEAR_CONTINENTS] = ConfigMgr::GetIntDefault("Visibility.MovementTier.Near.Continents", 40);
+    m_configs[CONFIG_MOVEMENT_TIER_NEAR_INSTANCES]  = ConfigMgr::GetIntDefault("Visibility.MovementTier.Near.Instances",  0);
+    m_configs[CONFIG_MOVEMENT_TIER_NEAR_BGARENAS]   = ConfigMgr::GetIntDefault("Visibility.MovementTier.Near.BGArenas",   60);
+    m_configs[CONFIG_MOVEMENT_TIER_MID_CONTINENTS]  = ConfigMgr::GetIntDefault("Visibility.MovementTier.Mid.Continents",  70);
+    m_configs[CONFIG_MOVEMENT_TIER_MID_INSTANCES]   = ConfigMgr::GetIntDefault("Visibility.MovementTier.Mid.Instances",   0);
+    m_configs[CONFIG_MOVEMENT_TIER_MID_BGARENAS]    = ConfigMgr::GetIntDefault("Visibility.MovementTier.Mid.BGArenas",    120);
+    m_configs[CONFIG_MOVEMENT_TIER_MID_INTERVAL]    = ConfigMgr::GetIntDefault("Visibility.MovementTier.Interval.Mid",    500);
+    m_configs[CONFIG_MOVEMENT_TIER_FAR_INTERVAL]    = ConfigMgr::GetIntDefault("Visibility.MovementTier.Interval.Far",    1500);
+
     // Read the "Data" directory from the config file
     std::string dataPath = ConfigMgr::GetStringDefault("DataDir", "./");
     if (dataPath.at(dataPath.length()-1) != '/' && dataPath.at(dataPath.length()-1) != '\\')
@@ -1041,6 +1074,9 @@ void World::LoadConfigSettings(bool reload)
     m_configs[CONFIG_VMAP_INDOOR_CHECK] = enableIndoor;
     m_configs[CONFIG_PET_LOS] = enablePetLOS;
     m_configs[CONFIG_VMAP_TOTEM] = ConfigMgr::GetBoolDefault("vmap.totem", false);
+    m_configs[CONFIG_PATHFINDING_ENABLE] = ConfigMgr::GetBoolDefault("Pathfinding.Enable", true);
+    m_configs[CONFIG_PATHFINDING_MAX_NODES] = ConfigMgr::GetIntDefault("Pathfinding.MaxSearchNodes", 2048);
+    m_configs[CONFIG_PATHFINDING_CACHE_SIZE] = ConfigMgr::GetIntDefault("Pathfinding.CacheSize", 256);
     m_configs[CONFIG_MAX_WHO] = ConfigMgr::GetIntDefault("MaxWhoListReturns", 49);
 
     m_configs[CONFIG_BG_START_MUSIC] = ConfigMgr::GetBoolDefault("MusicInBattleground", false);
@@ -1061,6 +1097,10 @@ void World::LoadConfigSettings(bool reload)
     m_configs[CONFIG_SHOW_KICK_IN_WORLD] = ConfigMgr::GetBoolDefault("ShowKickInWorld", false);
     m_configs[CONFIG_INTERVAL_LOG_UPDATE] = ConfigMgr::GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_configs[CONFIG_MIN_LOG_UPDATE] = ConfigMgr::GetIntDefault("MinRecordUpdateTimeDiff", 100);
+    m_configs[CONFIG_TICK_PROFILER] = ConfigMgr::GetBoolDefault("TickProfiler.Enable", false);
+    m_configs[CONFIG_TICK_PROFILER_BUFFER] = ConfigMgr::GetIntDefault("TickProfiler.BufferSize", 16384);
+    sTickProfiler->SetEnabled(m_configs[CONFIG_TICK_PROFILER]);
+    sTickProfiler->SetBufferSize(m_configs[CONFIG_TICK_PROFILER_BUFFER]);
     m_configs[CONFIG_NUMTHREADS] = ConfigMgr::GetIntDefault("MapUpdate.Threads", 1);
     m_configs[CONFIG_DUEL_MOD] = ConfigMgr::GetBoolDefault("DuelMod.Enable", false);
     m_configs[CONFIG_DUEL_CD_RESET] = ConfigMgr::GetBoolDefault("DuelMod.Cooldowns", false);
@@ -1306,6 +1346,9 @@ void World::SetInitialWorldSettings()
     sLog->outString("Loading linked spells...");
     sSpellMgr->LoadSpellLinked();
 
+    sLog->outString("Building spell infos...");
+    sSpellMgr->LoadSpellInfoStore();                          // must be after all spell data loading
+
     sLog->outString("Loading Player Create Data...");
     sObjectMgr->LoadPlayerInfo();
 
@@ -1397,7 +1440,7 @@ void World::SetInitialWorldSettings()
     sTicketMgr->LoadGMSurveys();
 
     // Handle outdated emails (delete/return)
-    sLog->outString("Returning old mails...");
+    sLog->outString("Starting expired mail processing...");
     sObjectMgr->ReturnOrDeleteOldMails(false);
 
     sLog->outString("Loading Autobroadcasts...");
@@ -1480,6 +1523,9 @@ void World::SetInitialWorldSettings()
     sLog->outString("Starting Map System");
     sMapMgr->Initialize();
 
+    sLog->outString("Starting player save workers");
+    sPlayerSaveScheduler->Initialize(m_configs[CONFIG_PLAYER_SAVE_THREADS]);
+
     sLog->outString("Starting Game Event system...");
     uint32 nextGameEvent = sGameEventMgr->Initialize();
     m_timers[WUPDATE_EVENTS].SetInterval(nextGameEvent);    //depend on next event
@@ -1628,9 +1674,18 @@ void World::LoadAutobroadcasts()
     sLog->outString( ">> Loaded %u autobroadcasts definitions", count);
 }
 
+void World::RecordLoginTime(uint32 diff)
+{
+    m_loginTimeSum += diff;
+    m_loginTimeMax = std::max(m_loginTimeMax, diff);
+    ++m_loginTimeCount;
+}
+
 // Update the World !
 void World::Update(time_t diff)
 {
+    TickProfileScope profile(PROFILE_WORLD_UPDATE);
+
     m_updateTime = uint32(diff);
     if (m_configs[CONFIG_INTERVAL_LOG_UPDATE])
     {
@@ -1639,6 +1694,21 @@ void World::Update(time_t diff)
             sLog->outBasic("Update time diff: %u. Players online: %u.", m_updateTimeSum / m_updateTimeCount, GetActiveSessionCount());
             m_updateTimeSum = m_updateTime;
             m_updateTimeCount = 1;
+
+            if (m_loginTimeCount)
+            {
+                sLog->outBasic("Login time: avg %u ms, max %u ms over %u logins.", GetLoginTimeAvg(), m_loginTimeMax, m_loginTimeCount);
+                m_loginTimeSum = 0;
+                m_loginTimeMax = 0;
+                m_loginTimeCount = 0;
+            }
+
+            if (uint32 saves = sPlayerSaveScheduler->GetSaveCount())
+            {
+                sLog->outBasic("Player saves: %u, avg %u ms, max %u ms from request to built row, queue depth max %u.",
+                    saves, sPlayerSaveScheduler->GetLatencyAvg(), sPlayerSaveScheduler->GetLatencyMax(), sPlayerSaveScheduler->GetMaxQueueSize());
+                sPlayerSaveScheduler->ResetStats();
+            }
         }
         else
         {
@@ -1746,6 +1816,10 @@ void World::Update(time_t diff)
     // Update objects when the timer has passed (maps, transport, creatures, ...)
     sMapMgr->Update(diff);                // As interval = 0
 
+    // autosaves due, while no map is updating
+    sPlayerSaveScheduler->Update();
+    RecordTimeDiff("UpdatePlayerSaves");
+
     if (m_configs[CONFIG_AUTOBROADCAST_ENABLED])
     {
        if (m_timers[WUPDATE_AUTOBROADCAST].Passed())
@@ -2232,6 +2306,8 @@ void World::SendServerMessage(ServerMessageType type, const char *text, Player*
 
 void World::UpdateSessions(time_t diff)
 {
+    TickProfileScope profile(PROFILE_WORLD_SESSIONS);
+
     // Add new sessions
     WorldSession* sess;
     while (addSessQueue.next(sess))
@@ -2260,6 +2336,8 @@ void World::UpdateSessions(time_t diff)
 // This handles the issued and queued CLI commands
 void World::ProcessCliCommands()
 {
+    TickProfileScope profile(PROFILE_CLI_COMMANDS);
+
     CliCommandHolder::Print* zprint = NULL;
     void* callbackArg = NULL;
     CliCommandHolder* command;
@@ -2286,7 +2364,7 @@ void World::SendAutoBroadcast()
     std::string msg;
 
     std::list<std::string>::const_iterator itr = m_Autobroadcasts.begin();
-    std::advance(itr, rand() % m_Autobroadcasts.size());
+    std::advance(itr, urand(0, m_Autobroadcasts.size() - 1));
     msg = *itr;
 
     uint32 abcenter = ConfigMgr::GetIntDefault("AutoBroadcast.Center", 0);
@@ -2321,6 +2399,7 @@ void World::InitResultQueue()
 
 void World::UpdateResultQueue()
 {
+    TickProfileScope profile(PROFILE_DB_CALLBACKS);
     m_resultQueue->Update();
 }
 
@@ -147,6 +147,7 @@ enum WorldConfigs
     CONFIG_MAIL_DELIVERY_DELAY,
     CONFIG_EXTERNAL_MAIL,
     CONFIG_EXTERNAL_MAIL_INTERVAL,
+    CONFIG_EXPIRED_MAIL_BATCH_SIZE,
     CONFIG_UPTIME_UPDATE,
     CONFIG_SKILL_CHANCE_ORANGE,
     CONFIG_SKILL_CHANCE_YELLOW,
@@ -160,6 +161,19 @@ enum WorldConfigs
     CONFIG_SKILL_GAIN_GATHERING,
     CONFIG_SKILL_GAIN_WEAPON,
     CONFIG_MAX_OVERSPEED_PINGS,
+    CONFIG_NETWORK_PREPARSE,
+    CONFIG_NETWORK_RATE_LIMIT_MOVEMENT,
+    CONFIG_NETWORK_RATE_LIMIT_SPELL,
+    CONFIG_NETWORK_MAX_DROPPED_PACKETS,
+    CONFIG_DORMANT_OBJECTS,
+    CONFIG_DORMANT_IDLE_CREATURE_TIME,
+    CONFIG_MOVEMENT_CHECKPOINT,
+    CONFIG_RANDOM_MAP_SEED,
+    CONFIG_OBJECT_POOL_MAX_FREE,
+    CONFIG_PLAYER_SAVE_MAX_PER_TICK,
+    CONFIG_PLAYER_SAVE_THREADS,
+    CONFIG_GRID_LOAD_TICK_BUDGET,
+    CONFIG_GRID_LOAD_NEAR_CELLS,
     CONFIG_SAVE_RESPAWN_TIME_IMMEDIATELY,
     CONFIG_ALWAYS_MAX_SKILL_FOR_LEVEL,
     CONFIG_WEATHER,
@@ -230,9 +244,14 @@ enum WorldConfigs
     CONFIG_SHOW_KICK_IN_WORLD,
     CONFIG_INTERVAL_LOG_UPDATE,
     CONFIG_MIN_LOG_UPDATE,
+    CONFIG_TICK_PROFILER,
+    CONFIG_TICK_PROFILER_BUFFER,
     CONFIG_ENABLE_SINFO_LOGIN,
     CONFIG_PET_LOS,
     CONFIG_VMAP_TOTEM,
+    CONFIG_PATHFINDING_ENABLE,
+    CONFIG_PATHFINDING_MAX_NODES,
+    CONFIG_PATHFINDING_CACHE_SIZE,
     CONFIG_NUMTHREADS,
     CONFIG_CHATLOG_CHANNEL,
     CONFIG_CHATLOG_WHISPER,
@@ -259,6 +278,14 @@ enum WorldConfigs
     CONFIG_WARDEN_NUM_CHECKS,
     CONFIG_WARDEN_CLIENT_CHECK_HOLDOFF,
     CONFIG_WARDEN_CLIENT_RESPONSE_DELAY,
+    CONFIG_MOVEMENT_TIER_NEAR_CONTINENTS,
+    CONFIG_MOVEMENT_TIER_NEAR_INSTANCES,
+    CONFIG_MOVEMENT_TIER_NEAR_BGARENAS,
+    CONFIG_MOVEMENT_TIER_MID_CONTINENTS,
+    CONFIG_MOVEMENT_TIER_MID_INSTANCES,
+    CONFIG_MOVEMENT_TIER_MID_BGARENAS,
+    CONFIG_MOVEMENT_TIER_MID_INTERVAL,
+    CONFIG_MOVEMENT_TIER_FAR_INTERVAL,
     CONFIG_VALUE_COUNT
 };
 
@@ -502,6 +529,11 @@ class World
         // Update time
         uint32 GetUpdateTime() const { return m_updateTime; }
         void SetRecordDiffInterval(int32 t) { if (t >= 0) m_configs[CONFIG_INTERVAL_LOG_UPDATE] = (uint32)t; }
+        // CMSG_PLAYER_LOGIN to SMSG_LOGIN_VERIFY_WORLD, logged and reset together with the update time diff
+        void RecordLoginTime(uint32 diff);
+        uint32 GetLoginCount() const { return m_loginTimeCount; }
+        uint32 GetLoginTimeAvg() const { return m_loginTimeCount ? m_loginTimeSum / m_loginTimeCount : 0; }
+        uint32 GetLoginTimeMax() const { return m_loginTimeMax; }
 
         // Get the maximum skill level a player can reach
         uint16 GetConfigMaxSkillValue() const
@@ -634,6 +666,7 @@ class World
         uint32 mail_timer_expires;
         uint32 m_updateTime, m_updateTimeSum;
         uint32 m_updateTimeCount;
+        uint32 m_loginTimeSum, m_loginTimeMax, m_loginTimeCount;
         uint32 m_currentTime;
 
         typedef UNORDERED_MAP<uint32, Weather*> WeatherMap;
@@ -312,6 +312,73 @@ QueryResult_AutoPtr Database::Query(const char* sql)
     return QueryResult_AutoPtr(queryResult);
 }
 
+void Database::QueryMulti(std::vector<char const*> const& queries, std::vector<QueryResult_AutoPtr>& results)
+{
+    results.assign(queries.size(), QueryResult_AutoPtr(NULL));
+
+    std::string sql;
+    std::vector<size_t> slots;                              // result index of each batched statement
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        if (!queries[i])
+            continue;
+        if (!sql.empty())
+            sql += ';';
+        sql += queries[i];
+        slots.push_back(i);
+    }
+
+    size_t done = 0;
+    if (mMysql && slots.size() > 1)
+    {
+        // guarded block for thread-safe mySQL request, multi statements are only allowed for this batch
+        ACE_Guard<ACE_Thread_Mutex> query_connection_guard(mMutex);
+        if (!mysql_set_server_option(mMysql, MYSQL_OPTION_MULTI_STATEMENTS_ON))
+        {
+            if (mysql_real_query(mMysql, sql.c_str(), sql.size()))
+            {
+                sLog->outErrorDb("SQL: %s", queries[slots[0]]);
+                sLog->outErrorDb("query ERROR: %s", mysql_error(mMysql));
+                done = 1;
+            }
+            else
+            {
+                for (;;)
+                {
+                    if (MYSQL_RES* result = mysql_store_result(mMysql))
+                    {
+                        uint64 rowCount = mysql_affected_rows(mMysql);
+                        if (rowCount)
+                        {
+                            QueryResult* queryResult = new QueryResult(result, mysql_fetch_fields(result), rowCount, mysql_field_count(mMysql));
+                            queryResult->NextRow();
+                            results[slots[done]] = QueryResult_AutoPtr(queryResult);
+                        }
+                        else
+                            mysql_free_result(result);
+                    }
+                    ++done;
+
+                    int status = mysql_next_result(mMysql);
+                    if (status < 0)                         // no more results
+                        break;
+                    if (status > 0)                         // the server stops at the first failing statement
+                    {
+                        sLog->outErrorDb("SQL: %s", queries[slots[done]]);
+                        sLog->outErrorDb("query ERROR: %s", mysql_error(mMysql));
+                        ++done;
+                        break;
+                    }
+                }
+            }
+            mysql_set_server_option(mMysql, MYSQL_OPTION_MULTI_STATEMENTS_OFF);
+        }
+    }
+
+    for (; done < slots.size(); ++done)
+        results[slots[done]] = Query(queries[slots[done]]);
+}
+
 QueryResult_AutoPtr Database::PQuery(const char* format, ...)
 {
     if (!format)
@@ -598,6 +665,38 @@ bool Database::CommitTransaction()
     return _res;
 }
 
+SqlTransaction* Database::DetachTransaction()
+{
+    if (!mMysql || !m_threadBody)
+        return NULL;
+
+    SqlTransaction* trans = NULL;
+
+    nMutex.acquire();
+    TransactionQueues::iterator i = m_tranQueues.find(ACE_Based::Thread::current());
+    if (i != m_tranQueues.end())
+    {
+        trans = i->second;
+        m_tranQueues.erase(i);
+    }
+    nMutex.release();
+    return trans;
+}
+
+bool Database::CommitTransaction(SqlTransaction* trans)
+{
+    if (!trans)
+        return false;
+
+    if (!mMysql || !m_threadBody)
+    {
+        delete trans;
+        return false;
+    }
+
+    return m_threadBody->Delay(trans);
+}
+
 bool Database::RollbackTransaction()
 {
     if (!mMysql)
@@ -63,6 +63,9 @@ class Database
 
         QueryResult_AutoPtr Query(const char* sql);
         QueryResult_AutoPtr PQuery(const char* format,...) ATTR_PRINTF(2, 3);
+        // all statements in one round trip, results in statement order, NULL entries are skipped;
+        // statements after a failing one are run one by one
+        void QueryMulti(std::vector<char const*> const& queries, std::vector<QueryResult_AutoPtr>& results);
         QueryNamedResult* QueryNamed(const char* sql);
         QueryNamedResult* PQueryNamed(const char* format,...) ATTR_PRINTF(2, 3);
 
@@ -120,6 +123,11 @@ class Database
         bool BeginTransaction();
         bool CommitTransaction();
         bool RollbackTransaction();
+        // takes the open transaction of the calling thread out so that it can be finished and committed
+        // from another thread; NULL when there is none or statements are not queued (no delay thread)
+        SqlTransaction* DetachTransaction();
+        // queues a detached transaction, may be called from any thread
+        bool CommitTransaction(SqlTransaction* trans);
 
         operator bool () const { return mMysql != NULL; }
         unsigned long EscapeString(char* to, const char* from, unsigned long length);
@@ -197,12 +197,16 @@ void SqlQueryHolderEx::Execute(Database *db)
     // we can do this, we are friends
     std::vector<SqlQueryHolder::SqlResultPair> &queries = m_holder->m_queries;
 
+    // execute all queries in the holder in one round trip and pass the results
+    std::vector<char const*> sqls(queries.size());
     for (size_t i = 0; i < queries.size(); i++)
-    {
-        // execute all queries in the holder and pass the results
-        char const *sql = queries[i].first;
-        if (sql) m_holder->SetResult(i, db->Query(sql));
-    }
+        sqls[i] = queries[i].first;
+
+    std::vector<QueryResult_AutoPtr> results;
+    db->QueryMulti(sqls, results);
+
+    for (size_t i = 0; i < queries.size(); i++)
+        if (sqls[i]) m_holder->SetResult(i, results[i]);
 
     // sync with the caller thread
     m_queue->add(m_callback);
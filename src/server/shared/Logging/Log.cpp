@@ -22,21 +22,26 @@
 #include "Log.h"
 #include "Config.h"
 #include "Util.h"
+#include "LogWorker.h"
 
 #include <stdarg.h>
 #include <stdio.h>
 
 Log::Log() :
+    m_worker(NULL), m_workerThread(NULL),
     raLogfile(NULL), logfile(NULL), gmLogfile(NULL), charLogfile(NULL),
-    dberLogfile(NULL), chatLogfile(NULL), m_gmlog_per_account(false),
-    m_enableLogDBLater(false), m_enableLogDB(false), m_colored(false),
-    arenaLogFile(NULL), sqlLogFile(NULL), sqlDevLogFile(NULL), wardenLogFile(NULL)
+    dberLogfile(NULL), chatLogfile(NULL), arenaLogFile(NULL), sqlLogFile(NULL),
+    sqlDevLogFile(NULL), wardenLogFile(NULL), m_gmlog_per_account(false),
+    m_enableLogDBLater(false), m_enableLogDB(false), m_colored(false)
 {
     Initialize();
 }
 
 Log::~Log()
 {
+    // database connections are gone at this point, only the files are drained
+    StopWorker(false);
+
     if ( logfile != NULL )
         fclose(logfile);
     logfile = NULL;
@@ -127,6 +132,12 @@ void Log::Initialize()
 
     m_logsTimestamp = "_" + GetTimestampStr();
 
+    /// Writer thread for files and DB
+    if (ConfigMgr::GetBoolDefault("Log.Async.Enable", true))
+        StartWorker(ConfigMgr::GetIntDefault("Log.Async.FlushInterval", 100), ConfigMgr::GetIntDefault("Log.Async.BatchSize", 100));
+    else
+        StopWorker(true);
+
     /// Open specific log files
     logfile = openLogFile("LogFile","LogTimestamp","w");
     InitColors(ConfigMgr::GetStringDefault("LogColors", ""));
@@ -198,6 +209,36 @@ void Log::Initialize()
     }
 }
 
+void Log::StartWorker(uint32 flushInterval, uint32 batchSize)
+{
+    if (m_worker)
+        return;
+
+    m_worker = new LogWorker(flushInterval, batchSize);
+    m_workerThread = new ACE_Based::Thread(m_worker);      // deletes m_worker
+}
+
+void Log::StopWorker(bool writeDB)
+{
+    if (!m_worker)
+        return;
+
+    // log calls made from here on are written in place
+    LogWorker* worker = m_worker;
+    m_worker = NULL;
+
+    worker->Stop(writeDB);
+    m_workerThread->wait();
+    delete m_workerThread;
+    m_workerThread = NULL;
+}
+
+void Log::Flush()
+{
+    if (m_worker)
+        m_worker->Flush();
+}
+
 FILE* Log::openLogFile(char const* configFileName,char const* configTimeStampFlag, char const* mode)
 {
     std::string logfn=ConfigMgr::GetStringDefault(configFileName, "");
@@ -367,76 +408,95 @@ std::string Log::GetTimestampStr()
     return std::string(buf);
 }
 
+void Log::outConsole(bool stdout_stream, bool colored, ColorTypes color, const char * text, bool newline)
+{
+    FILE* stream = stdout_stream ? stdout : stderr;
+
+    if (colored)
+        SetColor(stdout_stream, color);
+
+    utf8printf(stream, "%s", text);
+
+    if (colored)
+        ResetColor(stdout_stream);
+
+    if (newline)
+        fprintf(stream, "\n");
+
+    fflush(stream);
+}
+
+void Log::outFile(FILE* file, bool timestamp, const char * prefix, const char * text, bool newline)
+{
+    if (!file)
+        return;
+
+    if (m_worker)
+    {
+        m_worker->Enqueue(new LogMessage(file, timestamp, prefix, text, newline));
+        return;
+    }
+
+    if (timestamp)
+        outTimestamp(file);
+    if (prefix)
+        fputs(prefix, file);
+    fputs(text, file);
+
+    if (newline)
+    {
+        fputs("\n", file);
+        fflush(file);
+    }
+}
+
 void Log::outDB(LogTypes type, const char * str)
 {
-    if (!str || type >= MAX_LOG_TYPES)
+    if (!str || !*str || type >= MAX_LOG_TYPES)
          return;
 
-    std::string new_str(str);
-    if (new_str.empty())
+    if (m_worker)
+    {
+        m_worker->Enqueue(new LogMessage(realm, uint8(type), str));
         return;
+    }
+
+    std::string new_str(str);
     LoginDatabase.EscapeString(new_str);
 
     LoginDatabase.PExecute("INSERT INTO logs (time, realm, type, string) "
         "VALUES (" UI64FMTD ", %u, %u, '%s');", uint64(time(0)), realm, type, new_str.c_str());
 }
 
+// formats the variadic arguments once, the result is shared by console, file and DB output
+#define FORMAT_LOG_MESSAGE(buf, format) \
+    char buf[MAX_QUERY_LEN]; \
+    { \
+        va_list ap; \
+        va_start(ap, format); \
+        vsnprintf(buf, MAX_QUERY_LEN, format, ap); \
+        va_end(ap); \
+    }
+
 void Log::outString(const char * str, ...)
 {
     if (!str)
         return;
 
-    if (m_enableLogDB)
-    {
-        // we don't want empty strings in the DB
-        std::string s(str);
-        if (s.empty() || s == " ")
-            return;
-
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_STRING, nnew_str);
-        va_end(ap2);
-    }
-
-    if (m_colored)
-        SetColor(true,m_colors[LOGL_NORMAL]);
-
-    va_list ap;
+    FORMAT_LOG_MESSAGE(buf, str);
 
-    va_start(ap, str);
-    vutf8printf(stdout, str, &ap);
-    va_end(ap);
+    // we don't want empty strings in the DB
+    if (m_enableLogDB && *buf && strcmp(buf, " ") != 0)
+        outDB(LOG_TYPE_STRING, buf);
 
-    if (m_colored)
-        ResetColor(true);
-
-    printf("\n");
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n");
-        va_end(ap);
-
-        fflush(logfile);
-    }
-    fflush(stdout);
+    outConsole(true, m_colored, m_colors[LOGL_NORMAL], buf, true);
+    outFile(logfile, true, NULL, buf);
 }
 
 void Log::outString()
 {
-    printf("\n");
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "\n");
-        fflush(logfile);
-    }
-    fflush(stdout);
+    outConsole(true, false, WHITE, "", true);
+    outFile(logfile, true, NULL, "");
 }
 
 void Log::outCrash(const char * err, ...)
@@ -444,42 +504,20 @@ void Log::outCrash(const char * err, ...)
     if (!err)
         return;
 
-    if (m_enableLogDB)
-    {
-        va_list ap2;
-        va_start(ap2, err);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, err, ap2);
-        outDB(LOG_TYPE_CRASH, nnew_str);
-        va_end(ap2);
-    }
-
-    if (m_colored)
-        SetColor(false,LRED);
-
-    va_list ap;
+    FORMAT_LOG_MESSAGE(buf, err);
 
-    va_start(ap, err);
-    vutf8printf(stderr, err, &ap);
-    va_end(ap);
+    if (m_enableLogDB)
+        outDB(LOG_TYPE_CRASH, buf);
 
-    if (m_colored)
-        ResetColor(false);
+    outConsole(false, m_colored, LRED, buf, true);
 
-    fprintf(stderr, "\n");
+    // bypass the writer thread, the process may not live long enough to drain it
     if (logfile)
     {
         outTimestamp(logfile);
-        fprintf(logfile, "CRASH ALERT: ");
-
-        va_start(ap, err);
-        vfprintf(logfile, err, ap);
-        va_end(ap);
-
-        fprintf(logfile, "\n");
+        fprintf(logfile, "CRASH ALERT: %s\n", buf);
         fflush(logfile);
     }
-    fflush(stderr);
 }
 
 void Log::outError(const char * err, ...)
@@ -487,59 +525,23 @@ void Log::outError(const char * err, ...)
     if (!err)
         return;
 
-    if (m_enableLogDB)
-    {
-        va_list ap2;
-        va_start(ap2, err);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, err, ap2);
-        outDB(LOG_TYPE_ERROR, nnew_str);
-        va_end(ap2);
-    }
-
-    if (m_colored)
-        SetColor(false,LRED);
-
-    va_list ap;
-
-    va_start(ap, err);
-    vutf8printf(stderr, err, &ap);
-    va_end(ap);
+    FORMAT_LOG_MESSAGE(buf, err);
 
-    if (m_colored)
-        ResetColor(false);
-
-    fprintf( stderr, "\n");
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR: ");
-
-        va_start(ap, err);
-        vfprintf(logfile, err, ap);
-        va_end(ap);
+    if (m_enableLogDB)
+        outDB(LOG_TYPE_ERROR, buf);
 
-        fprintf(logfile, "\n");
-        fflush(logfile);
-    }
-    fflush(stderr);
+    outConsole(false, m_colored, LRED, buf, true);
+    outFile(logfile, true, "ERROR: ", buf);
 }
 
 void Log::outArena(const char * str, ...)
 {
-    if (!str)
+    if (!str || !arenaLogFile)
         return;
 
-    if (arenaLogFile)
-    {
-        va_list ap;
-        outTimestamp(arenaLogFile);
-        va_start(ap, str);
-        vfprintf(arenaLogFile, str, ap);
-        fprintf(arenaLogFile, "\n");
-        va_end(ap);
-        fflush(arenaLogFile);
-    }
+    FORMAT_LOG_MESSAGE(buf, str);
+
+    outFile(arenaLogFile, true, NULL, buf);
 }
 
 void Log::outSQLDriver(const char* str, ...)
@@ -547,27 +549,10 @@ void Log::outSQLDriver(const char* str, ...)
     if (!str)
         return;
 
-    va_list ap;
-    va_start(ap, str);
-    vutf8printf(stdout, str, &ap);
-    va_end(ap);
-
-    printf("\n");
+    FORMAT_LOG_MESSAGE(buf, str);
 
-    if (sqlLogFile)
-    {
-        outTimestamp(sqlLogFile);
-
-        va_list apSQL;
-        va_start(apSQL, str);
-        vfprintf(sqlLogFile, str, apSQL);
-        va_end(apSQL);
-
-        fprintf(sqlLogFile, "\n");
-        fflush(sqlLogFile);
-    }
-
-    fflush(stdout);
+    outConsole(true, false, WHITE, buf, true);
+    outFile(sqlLogFile, true, NULL, buf);
 }
 
 void Log::outErrorDb(const char * err, ...)
@@ -575,44 +560,11 @@ void Log::outErrorDb(const char * err, ...)
     if (!err)
         return;
 
-    if (m_colored)
-        SetColor(false,LRED);
-
-    va_list ap;
-
-    va_start(ap, err);
-    vutf8printf(stderr, err, &ap);
-    va_end(ap);
-
-    if (m_colored)
-        ResetColor(false);
-
-    fprintf( stderr, "\n" );
-
-    if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR: " );
-
-        va_start(ap, err);
-        vfprintf(logfile, err, ap);
-        va_end(ap);
-
-        fprintf(logfile, "\n" );
-        fflush(logfile);
-    }
+    FORMAT_LOG_MESSAGE(buf, err);
 
-    if (dberLogfile)
-    {
-        outTimestamp(dberLogfile);
-        va_start(ap, err);
-        vfprintf(dberLogfile, err, ap);
-        va_end(ap);
-
-        fprintf(dberLogfile, "\n" );
-        fflush(dberLogfile);
-    }
-    fflush(stderr);
+    outConsole(false, m_colored, LRED, buf, true);
+    outFile(logfile, true, "ERROR: ", buf);
+    outFile(dberLogfile, true, NULL, buf);
 }
 
 void Log::outSQLDev(const char* str, ...)
@@ -620,25 +572,10 @@ void Log::outSQLDev(const char* str, ...)
     if (!str)
         return;
 
-    va_list ap;
-    va_start(ap, str);
-    vutf8printf(stdout, str, &ap);
-    va_end(ap);
+    FORMAT_LOG_MESSAGE(buf, str);
 
-    printf("\n");
-
-    if (sqlDevLogFile)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        vfprintf(sqlDevLogFile, str, ap2);
-        va_end(ap2);
-
-        fprintf(sqlDevLogFile, "\n");
-        fflush(sqlDevLogFile);
-    }
-
-    fflush(stdout);
+    outConsole(true, false, WHITE, buf, true);
+    outFile(sqlDevLogFile, false, NULL, buf);
 }
 
 void Log::outBasic(const char * str, ...)
@@ -646,43 +583,21 @@ void Log::outBasic(const char * str, ...)
     if (!str)
         return;
 
-    if (m_enableLogDB && m_dbLogLevel > LOGL_NORMAL)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_BASIC, nnew_str);
-        va_end(ap2);
-    }
-
-    if (m_logLevel > LOGL_NORMAL)
-    {
-        if (m_colored)
-            SetColor(true,m_colors[LOGL_BASIC]);
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
+    bool toDB = m_enableLogDB && m_dbLogLevel > LOGL_NORMAL;
+    bool toConsole = m_logLevel > LOGL_NORMAL;
+    if (!toDB && !toConsole)
+        return;
 
-        if (m_colored)
-            ResetColor(true);
+    FORMAT_LOG_MESSAGE(buf, str);
 
-        printf("\n");
+    if (toDB)
+        outDB(LOG_TYPE_BASIC, buf);
 
-        if (logfile)
-        {
-            outTimestamp(logfile);
-            va_list ap;
-            va_start(ap, str);
-            vfprintf(logfile, str, ap);
-            fprintf(logfile, "\n" );
-            va_end(ap);
-            fflush(logfile);
-        }
+    if (toConsole)
+    {
+        outConsole(true, m_colored, m_colors[LOGL_BASIC], buf, true);
+        outFile(logfile, true, NULL, buf);
     }
-    fflush(stdout);
 }
 
 void Log::outDetail(const char * str, ...)
@@ -690,45 +605,21 @@ void Log::outDetail(const char * str, ...)
     if (!str)
         return;
 
-    if (m_enableLogDB && m_dbLogLevel > LOGL_BASIC)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_DETAIL, nnew_str);
-        va_end(ap2);
-    }
-
-    if (m_logLevel > LOGL_BASIC)
-    {
-        if (m_colored)
-            SetColor(true,m_colors[LOGL_DETAIL]);
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
+    bool toDB = m_enableLogDB && m_dbLogLevel > LOGL_BASIC;
+    bool toConsole = m_logLevel > LOGL_BASIC;
+    if (!toDB && !toConsole)
+        return;
 
-        if (m_colored)
-            ResetColor(true);
+    FORMAT_LOG_MESSAGE(buf, str);
 
-        printf("\n");
+    if (toDB)
+        outDB(LOG_TYPE_DETAIL, buf);
 
-        if (logfile)
-        {
-            outTimestamp(logfile);
-            va_list ap;
-            va_start(ap, str);
-            vfprintf(logfile, str, ap);
-            va_end(ap);
-
-            fprintf(logfile, "\n");
-            fflush(logfile);
-        }
+    if (toConsole)
+    {
+        outConsole(true, m_colored, m_colors[LOGL_DETAIL], buf, true);
+        outFile(logfile, true, NULL, buf);
     }
-
-    fflush(stdout);
 }
 
 void Log::outStaticDebug(const char * str, ...)
@@ -736,69 +627,32 @@ void Log::outStaticDebug(const char * str, ...)
     if (!str)
         return;
 
-    if (m_enableLogDB && m_dbLogLevel > LOGL_DETAIL)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_DEBUG, nnew_str);
-        va_end(ap2);
-    }
-
-    if ( m_logLevel > LOGL_DETAIL )
-    {
-        if (m_colored)
-            SetColor(true, m_colors[LOGL_DEBUG]);
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
+    bool toDB = m_enableLogDB && m_dbLogLevel > LOGL_DETAIL;
+    bool toConsole = m_logLevel > LOGL_DETAIL;
+    if (!toDB && !toConsole)
+        return;
 
-        if (m_colored)
-            ResetColor(true);
+    FORMAT_LOG_MESSAGE(buf, str);
 
-        printf( "\n" );
+    if (toDB)
+        outDB(LOG_TYPE_DEBUG, buf);
 
-        if (logfile)
-        {
-            outTimestamp(logfile);
-            va_list ap2;
-            va_start(ap2, str);
-            vfprintf(logfile, str, ap2);
-            va_end(ap2);
-
-            fprintf(logfile, "\n" );
-            fflush(logfile);
-        }
+    if (toConsole)
+    {
+        outConsole(true, m_colored, m_colors[LOGL_DEBUG], buf, true);
+        outFile(logfile, true, NULL, buf);
     }
-    fflush(stdout);
 }
 
 void Log::outDebugInLine(const char * str, ...)
 {
-    if (!str)
+    if (!str || m_logLevel <= LOGL_DETAIL)
         return;
 
-    if (m_logLevel > LOGL_DETAIL)
-    {
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
+    FORMAT_LOG_MESSAGE(buf, str);
 
-        //if (m_colored)
-        //    ResetColor(true);
-
-        if (logfile)
-        {
-            va_list ap;
-            va_start(ap, str);
-            vfprintf(logfile, str, ap);
-            va_end(ap);
-        }
-    }
+    outConsole(true, false, WHITE, buf, false);
+    outFile(logfile, false, NULL, buf, false);
 }
 
 void Log::outDebug(const char * str, ...)
@@ -806,44 +660,21 @@ void Log::outDebug(const char * str, ...)
     if (!str)
         return;
 
-    if (m_enableLogDB && m_dbLogLevel > LOGL_DETAIL)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_DEBUG, nnew_str);
-        va_end(ap2);
-    }
-
-    if ( m_logLevel > LOGL_DETAIL )
-    {
-        if (m_colored)
-            SetColor(true,m_colors[LOGL_DEBUG]);
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
+    bool toDB = m_enableLogDB && m_dbLogLevel > LOGL_DETAIL;
+    bool toConsole = m_logLevel > LOGL_DETAIL;
+    if (!toDB && !toConsole)
+        return;
 
-        if (m_colored)
-            ResetColor(true);
+    FORMAT_LOG_MESSAGE(buf, str);
 
-        printf( "\n" );
+    if (toDB)
+        outDB(LOG_TYPE_DEBUG, buf);
 
-        if (logfile)
-        {
-            outTimestamp(logfile);
-            va_list ap;
-            va_start(ap, str);
-            vfprintf(logfile, str, ap);
-            va_end(ap);
-
-            fprintf(logfile, "\n" );
-            fflush(logfile);
-        }
+    if (toConsole)
+    {
+        outConsole(true, m_colored, m_colors[LOGL_DEBUG], buf, true);
+        outFile(logfile, true, NULL, buf);
     }
-    fflush(stdout);
 }
 
 void Log::outStringInLine(const char * str, ...)
@@ -851,18 +682,10 @@ void Log::outStringInLine(const char * str, ...)
     if (!str)
         return;
 
-    va_list ap;
+    FORMAT_LOG_MESSAGE(buf, str);
 
-    va_start(ap, str);
-    vutf8printf(stdout, str, &ap);
-    va_end(ap);
-
-    if (logfile)
-    {
-        va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        va_end(ap);
-    }
+    outConsole(true, false, WHITE, buf, false);
+    outFile(logfile, false, NULL, buf, false);
 }
 
 void Log::outCommand(uint32 account, const char * str, ...)
@@ -870,69 +693,30 @@ void Log::outCommand(uint32 account, const char * str, ...)
     if (!str)
         return;
 
+    FORMAT_LOG_MESSAGE(buf, str);
+
     // TODO: support accountid
     if (m_enableLogDB && m_dbGM)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_GM, nnew_str);
-        va_end(ap2);
-    }
+        outDB(LOG_TYPE_GM, buf);
 
     if (m_logLevel > LOGL_NORMAL)
     {
-        if (m_colored)
-            SetColor(true,m_colors[LOGL_BASIC]);
-
-        va_list ap;
-        va_start(ap, str);
-        vutf8printf(stdout, str, &ap);
-        va_end(ap);
-
-        if (m_colored)
-            ResetColor(true);
-
-        printf("\n");
-
-        if (logfile)
-        {
-            outTimestamp(logfile);
-            va_list ap;
-            va_start(ap, str);
-            vfprintf(logfile, str, ap);
-            fprintf(logfile, "\n" );
-            va_end(ap);
-            fflush(logfile);
-        }
+        outConsole(true, m_colored, m_colors[LOGL_BASIC], buf, true);
+        outFile(logfile, true, NULL, buf);
     }
 
     if (m_gmlog_per_account)
     {
+        // GM commands are rare enough to open and close the per account file in place
         if (FILE* per_file = openGmlogPerAccount (account))
         {
             outTimestamp(per_file);
-            va_list ap;
-            va_start(ap, str);
-            vfprintf(per_file, str, ap);
-            fprintf(per_file, "\n" );
-            va_end(ap);
+            fprintf(per_file, "%s\n", buf);
             fclose(per_file);
         }
     }
-    else if (gmLogfile)
-    {
-        outTimestamp(gmLogfile);
-        va_list ap;
-        va_start(ap, str);
-        vfprintf(gmLogfile, str, ap);
-        fprintf(gmLogfile, "\n" );
-        va_end(ap);
-        fflush(gmLogfile);
-    }
-
-    fflush(stdout);
+    else
+        outFile(gmLogfile, true, NULL, buf);
 }
 
 void Log::outChar(const char * str, ...)
@@ -940,48 +724,41 @@ void Log::outChar(const char * str, ...)
     if (!str)
         return;
 
-    if (m_enableLogDB && m_dbChar)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_CHAR, nnew_str);
-        va_end(ap2);
-    }
+    bool toDB = m_enableLogDB && m_dbChar;
+    if (!toDB && !charLogfile)
+        return;
 
-    if (charLogfile)
-    {
-        outTimestamp(charLogfile);
-        va_list ap;
-        va_start(ap, str);
-        vfprintf(charLogfile, str, ap);
-        fprintf(charLogfile, "\n" );
-        va_end(ap);
-        fflush(charLogfile);
-    }
+    FORMAT_LOG_MESSAGE(buf, str);
+
+    if (toDB)
+        outDB(LOG_TYPE_CHAR, buf);
+
+    outFile(charLogfile, true, NULL, buf);
 }
 
 void Log::outCharDump(const char * str, uint32 account_id, uint32 guid, const char * name)
 {
-    FILE *file = NULL;
     if (m_charLog_Dump_Separate)
     {
         char fileName[29]; // Max length: name(12) + guid(11) + _.log (5) + \0
         snprintf(fileName, 29, "%d_%s.log", guid, name);
         std::string sFileName(m_dumpsDir);
         sFileName.append(fileName);
-        file = fopen((m_logsDir + sFileName).c_str(), "w");
+        if (FILE* file = fopen((m_logsDir + sFileName).c_str(), "w"))
+        {
+            fprintf(file, "== START DUMP == (account: %u guid: %u name: %s )\n%s\n== END DUMP ==\n",
+                account_id, guid, name, str);
+            fclose(file);
+        }
     }
-    else
-        file = charLogfile;
-    if (file)
+    else if (charLogfile)
     {
-        fprintf(file, "== START DUMP == (account: %u guid: %u name: %s )\n%s\n== END DUMP ==\n",
-            account_id, guid, name, str);
-        fflush(file);
-        if (m_charLog_Dump_Separate)
-            fclose(file);
+        char header[128];
+        snprintf(header, 128, "== START DUMP == (account: %u guid: %u name: %s )\n", account_id, guid, name);
+        std::string dump(header);
+        dump.append(str);
+        dump.append("\n== END DUMP ==");
+        outFile(charLogfile, false, NULL, dump.c_str());
     }
 }
 
@@ -990,26 +767,16 @@ void Log::outRemote(const char * str, ...)
     if (!str)
         return;
 
-    if (m_enableLogDB && m_dbRA)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_RA, nnew_str);
-        va_end(ap2);
-    }
+    bool toDB = m_enableLogDB && m_dbRA;
+    if (!toDB && !raLogfile)
+        return;
 
-    if (raLogfile)
-    {
-        outTimestamp(raLogfile);
-        va_list ap;
-        va_start(ap, str);
-        vfprintf(raLogfile, str, ap);
-        fprintf(raLogfile, "\n" );
-        va_end(ap);
-        fflush(raLogfile);
-    }
+    FORMAT_LOG_MESSAGE(buf, str);
+
+    if (toDB)
+        outDB(LOG_TYPE_RA, buf);
+
+    outFile(raLogfile, true, NULL, buf);
 }
 
 void Log::outChat(const char * str, ...)
@@ -1017,41 +784,24 @@ void Log::outChat(const char * str, ...)
     if (!str)
         return;
 
-    if (m_enableLogDB && m_dbChat)
-    {
-        va_list ap2;
-        va_start(ap2, str);
-        char nnew_str[MAX_QUERY_LEN];
-        vsnprintf(nnew_str, MAX_QUERY_LEN, str, ap2);
-        outDB(LOG_TYPE_CHAT, nnew_str);
-        va_end(ap2);
-    }
+    bool toDB = m_enableLogDB && m_dbChat;
+    if (!toDB && !chatLogfile)
+        return;
 
-    if (chatLogfile)
-    {
-        outTimestamp(chatLogfile);
-        va_list ap;
-        va_start(ap, str);
-        vfprintf(chatLogfile, str, ap);
-        fprintf(chatLogfile, "\n" );
-        fflush(chatLogfile);
-        va_end(ap);
-    }
+    FORMAT_LOG_MESSAGE(buf, str);
+
+    if (toDB)
+        outDB(LOG_TYPE_CHAT, buf);
+
+    outFile(chatLogfile, true, NULL, buf);
 }
 
 void Log::outWarden(const char * str, ...)
 {
-    if (!str)
+    if (!str || !wardenLogFile)
         return;
 
-    if (wardenLogFile)
-    {
-        outTimestamp(wardenLogFile);
-        va_list ap;
-        va_start(ap, str);
-        vfprintf(wardenLogFile, str, ap);
-        fprintf(wardenLogFile, "\n" );
-        fflush(wardenLogFile);
-        va_end(ap);
-    }
+    FORMAT_LOG_MESSAGE(buf, str);
+
+    outFile(wardenLogFile, true, NULL, buf);
 }
@@ -25,6 +25,7 @@
 #include "DatabaseEnv.h"
 
 class Config;
+class LogWorker;
 
 enum LogFilters
 {
@@ -123,6 +124,9 @@ class Log
         void SetSQLDriverQueryLogging(bool newStatus) { m_sqlDriverQueryLogging = newStatus; }
         void SetRealmID(uint32 id) { realm = id; }
 
+        // wait until the writer thread has written everything logged so far
+        void Flush();
+
         uint32 getLogFilter() const { return m_logFilter; }
         bool IsOutDebug() const { return m_logLevel > 2 || (m_logFileLevel > 2 && logfile); }
         bool IsOutCharDump() const { return m_charLog_Dump; }
@@ -132,10 +136,21 @@ class Log
         void SetLogDB(bool enable) { m_enableLogDB = enable; }
         void SetLogDBLater(bool value) { m_enableLogDBLater = value; }
         bool GetSQLDriverQueryLogging() const { return m_sqlDriverQueryLogging; }
+        std::string const& GetLogsDir() const { return m_logsDir; }
     private:
         FILE* openLogFile(char const* configFileName,char const* configTimeStampFlag, char const* mode);
         FILE* openGmlogPerAccount(uint32 account);
 
+        void outConsole(bool stdout_stream, bool colored, ColorTypes color, const char * text, bool newline);
+        void outFile(FILE* file, bool timestamp, const char * prefix, const char * text, bool newline = true);
+
+        void StartWorker(uint32 flushInterval, uint32 batchSize);
+        void StopWorker(bool writeDB);
+
+        // file and DB output is handed to this thread when Log.Async.Enable is set
+        LogWorker* m_worker;
+        ACE_Based::Thread* m_workerThread;
+
         FILE* raLogfile;
         FILE* logfile;
         FILE* gmLogfile;
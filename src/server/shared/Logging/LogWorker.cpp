@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LogWorker.h"
+#include "DatabaseEnv.h"
+
+#include <ace/OS_NS_sys_time.h>
+#include <ace/OS_NS_time.h>
+
+LogWorker::LogWorker(uint32 flushInterval, uint32 batchSize) :
+    m_wakeup(m_mutex), m_written(m_mutex), m_enqueued(0), m_done(0),
+    m_running(true), m_writeDB(true), m_mysqlThreadInit(false),
+    m_flushInterval(flushInterval ? flushInterval : 1), m_batchSize(batchSize ? batchSize : 1)
+{
+}
+
+LogWorker::~LogWorker()
+{
+    for (MessageQueue::iterator itr = m_queue.begin(); itr != m_queue.end(); ++itr)
+        delete *itr;
+}
+
+void LogWorker::Enqueue(LogMessage* msg)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    m_queue.push_back(msg);
+    ++m_enqueued;
+
+    // the writer wakes up on its own every m_flushInterval, only hurry it when a batch is full
+    if (m_queue.size() >= m_batchSize)
+        m_wakeup.signal();
+}
+
+void LogWorker::Flush()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    uint64 target = m_enqueued;
+    while (m_done < target && m_running)
+    {
+        m_wakeup.signal();
+        m_written.wait();
+    }
+}
+
+void LogWorker::Stop(bool writeDB)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    m_writeDB = writeDB;
+    m_running = false;
+    m_wakeup.signal();
+    m_written.broadcast();
+}
+
+void LogWorker::run()
+{
+    MessageQueue batch;
+
+    for (;;)
+    {
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+            if (m_queue.empty() && m_running)
+            {
+                ACE_Time_Value until = ACE_OS::gettimeofday() + ACE_Time_Value(0, m_flushInterval * 1000);
+                m_wakeup.wait(&until);
+            }
+
+            if (m_queue.empty() && !m_running)
+                break;
+
+            batch.swap(m_queue);
+        }
+
+        Write(batch);
+
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+            m_done += batch.size();
+            m_written.broadcast();
+        }
+
+        for (MessageQueue::iterator itr = batch.begin(); itr != batch.end(); ++itr)
+            delete *itr;
+        batch.clear();
+    }
+
+    if (m_mysqlThreadInit)
+        mysql_thread_end();
+}
+
+void LogWorker::Write(MessageQueue& batch)
+{
+    std::vector<FILE*> dirty;
+    MessageQueue rows;
+
+    for (MessageQueue::const_iterator itr = batch.begin(); itr != batch.end(); ++itr)
+    {
+        LogMessage* msg = *itr;
+        if (!msg->file)
+        {
+            rows.push_back(msg);
+            continue;
+        }
+
+        if (msg->timestamp)
+        {
+            tm aTm;
+            ACE_OS::localtime_r(&msg->time, &aTm);
+            fprintf(msg->file, "%-4d-%02d-%02d %02d:%02d:%02d ", aTm.tm_year + 1900, aTm.tm_mon + 1, aTm.tm_mday, aTm.tm_hour, aTm.tm_min, aTm.tm_sec);
+        }
+        fputs(msg->text.c_str(), msg->file);
+
+        if (std::find(dirty.begin(), dirty.end(), msg->file) == dirty.end())
+            dirty.push_back(msg->file);
+    }
+
+    // one flush per file and batch instead of one per line
+    for (std::vector<FILE*>::const_iterator itr = dirty.begin(); itr != dirty.end(); ++itr)
+        fflush(*itr);
+
+    if (!rows.empty() && m_writeDB)
+        WriteDB(rows);
+}
+
+void LogWorker::WriteDB(MessageQueue const& rows)
+{
+    if (!m_mysqlThreadInit)
+    {
+        mysql_thread_init();
+        m_mysqlThreadInit = true;
+    }
+
+    static char const* header = "INSERT INTO logs (time, realm, type, string) VALUES ";
+
+    std::string query;
+    uint32 count = 0;
+    char buf[64];
+
+    for (MessageQueue::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        std::string str = (*itr)->text;
+        LoginDatabase.EscapeString(str);
+
+        // multi-row insert, split on batch size and on the query buffer limit
+        if (count && (count >= m_batchSize || query.size() + str.size() + 64 >= MAX_QUERY_LEN))
+        {
+            LoginDatabase.Execute(query.c_str());
+            count = 0;
+        }
+
+        if (!count)
+            query = header;
+        else
+            query += ',';
+
+        snprintf(buf, 64, "(" UI64FMTD ", %u, %u, '", uint64((*itr)->time), (*itr)->realm, uint32((*itr)->dbType));
+        query += buf;
+        query += str;
+        query += "')";
+        ++count;
+    }
+
+    if (count)
+        LoginDatabase.Execute(query.c_str());
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRINITYCORE_LOGWORKER_H
+#define TRINITYCORE_LOGWORKER_H
+
+#include "Common.h"
+#include "Threading.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <vector>
+
+// One already formatted line, either for a log file or for the `logs` table
+struct LogMessage
+{
+    // file line; prefix is written between the timestamp and the text
+    LogMessage(FILE* _file, bool _timestamp, char const* _prefix, char const* _text, bool _newline)
+        : time(::time(NULL)), file(_file), timestamp(_timestamp), realm(0), dbType(0)
+    {
+        if (_prefix)
+            text = _prefix;
+        text += _text;
+        if (_newline)
+            text += '\n';
+    }
+
+    // `logs` table row
+    LogMessage(uint32 _realm, uint8 _dbType, char const* _text)
+        : time(::time(NULL)), file(NULL), timestamp(false), realm(_realm), dbType(_dbType), text(_text) {}
+
+    time_t time;
+    FILE* file;                                             // NULL for `logs` table rows
+    bool timestamp;
+    uint32 realm;
+    uint8 dbType;
+    std::string text;
+};
+
+// Writer thread of the logging system: producers only format and queue,
+// all file writes and `logs` inserts are done here in batches
+class LogWorker : public ACE_Based::Runnable
+{
+    typedef std::vector<LogMessage*> MessageQueue;
+
+    public:
+        LogWorker(uint32 flushInterval, uint32 batchSize);
+        ~LogWorker();
+
+        void Enqueue(LogMessage* msg);
+
+        // block until everything queued before the call has been written
+        void Flush();
+
+        // write what is still queued and leave run(); `logs` rows are dropped
+        // when writeDB is false (database connections already closed)
+        void Stop(bool writeDB);
+
+        virtual void run();
+
+    private:
+        void Write(MessageQueue& batch);
+        void WriteDB(MessageQueue const& rows);
+
+        ACE_Thread_Mutex m_mutex;
+        ACE_Condition_Thread_Mutex m_wakeup;                // producers -> writer
+        ACE_Condition_Thread_Mutex m_written;               // writer -> Flush()
+        MessageQueue m_queue;
+
+        uint64 m_enqueued;
+        uint64 m_done;
+        volatile bool m_running;
+        volatile bool m_writeDB;
+        bool m_mysqlThreadInit;
+
+        uint32 m_flushInterval;                             // ms between writer wake ups
+        uint32 m_batchSize;                                 // queued lines that wake the writer early, rows per INSERT
+};
+
+#endif
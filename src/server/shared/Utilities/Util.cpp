@@ -21,37 +21,173 @@
 #include "Util.h"
 
 #include "utf8.h"
-//#include "SFMT.h"
+#ifdef USE_SFMT_FOR_RNG
+#include "SFMT.h"
+#endif
 #include "MersenneTwister.h"
+#include "Timer.h"
+#include <new>
 #include <ace/TSS_T.h>
 #include <ace/INET_Addr.h>
 
-typedef ACE_TSS<MTRand> MTRandTSS;
-static MTRandTSS mtRand;
+#if COMPILER == COMPILER_MICROSOFT
+#  define RAND_THREAD_LOCAL __declspec(thread)
+#else
+#  define RAND_THREAD_LOCAL __thread
+#endif
+
+// Generator behind irand/urand/rand32/rand_norm/rand_chance. With USE_SFMT the
+// SSE2 SFMT generator refills its whole state block at once and every call after
+// that is a plain array read; otherwise the classic Mersenne Twister is used.
+class RandomEngine
+{
+    public:
+        RandomEngine()
+        {
+#ifdef USE_SFMT_FOR_RNG
+            // SFMTRand seeds itself from time(0), which would give every thread the same stream
+            m_rand.RandomInit(int(MTRand().randInt()));
+#endif
+        }
+        explicit RandomEngine(uint32 seed) { Seed(seed); }
+
+#ifdef USE_SFMT_FOR_RNG
+        void Seed(uint32 seed) { m_rand.RandomInit(int(seed)); }
+        uint32 Rand32() { return m_rand.BRandom(); }
+        // 0..range inclusive
+        uint32 Range(uint32 range) { return range == 0xFFFFFFFF ? m_rand.BRandom() : m_rand.URandom(0, range); }
+        double Norm() { return m_rand.Random(); }
+
+        // the state is made of __m128i, keep it 16 byte aligned on the heap as well
+        void* operator new(size_t size) { return _mm_malloc(size, 16); }
+        void operator delete(void* ptr) { _mm_free(ptr); }
+        // ACE_TSS allocates through ACE_NEW_RETURN, the nothrow form
+        void* operator new(size_t size, std::nothrow_t const&) throw() { return _mm_malloc(size, 16); }
+        void operator delete(void* ptr, std::nothrow_t const&) throw() { _mm_free(ptr); }
+#else
+        void Seed(uint32 seed) { m_rand.seed(seed); }
+        uint32 Rand32() { return m_rand.randInt(); }
+        uint32 Range(uint32 range) { return m_rand.randInt(range); }
+        double Norm() { return m_rand.randExc(); }
+#endif
+
+    private:
+#ifdef USE_SFMT_FOR_RNG
+        SFMTRand m_rand;
+#else
+        MTRand m_rand;
+#endif
+};
+
+typedef ACE_TSS<RandomEngine> RandomEngineTSS;
+static RandomEngineTSS randomEngines;
+
+// ACE_TSS owns the per-thread engines, the raw pointer caches the lookup so the
+// common path is a single thread local read
+static RAND_THREAD_LOCAL RandomEngine* currentEngine = NULL;
+static RAND_THREAD_LOCAL RandomStream* currentStream = NULL;
+
+static inline RandomEngine* GetThreadEngine()
+{
+    static RAND_THREAD_LOCAL RandomEngine* threadEngine = NULL;
+    if (!threadEngine)
+        threadEngine = randomEngines.ts_object();
+    return threadEngine;
+}
+
+static inline RandomEngine* GetEngine()
+{
+    if (!currentEngine)
+        currentEngine = GetThreadEngine();
+    return currentEngine;
+}
 
 int32 irand (int32 min, int32 max)
 {
-    return int32 (mtRand->randInt (max - min)) + min;
+    return int32 (GetEngine()->Range(max - min)) + min;
 }
 
 uint32 urand (uint32 min, uint32 max)
 {
-    return mtRand->randInt (max - min) + min;
+    return GetEngine()->Range(max - min) + min;
 }
 
 int32 rand32 ()
 {
-    return mtRand->randInt ();
+    return GetEngine()->Rand32();
 }
 
 double rand_norm(void)
 {
-    return mtRand->randExc ();
+    return GetEngine()->Norm();
 }
 
 double rand_chance (void)
 {
-    return mtRand->randExc (100.0);
+    return GetEngine()->Norm() * 100.0;
+}
+
+RandomStream::RandomStream(uint32 seed) : m_engine(new RandomEngine(seed)), m_seed(seed)
+{
+}
+
+RandomStream::~RandomStream()
+{
+    if (currentStream == this)
+        SelectRandomStream(NULL);
+    delete m_engine;
+}
+
+void RandomStream::Reseed(uint32 seed)
+{
+    m_seed = seed;
+    m_engine->Seed(seed);
+}
+
+void SelectRandomStream(RandomStream* stream)
+{
+    currentStream = stream;
+    currentEngine = stream ? stream->m_engine : GetThreadEngine();
+}
+
+RandomStream* GetSelectedRandomStream()
+{
+    return currentStream;
+}
+
+void BenchmarkRandom(uint32 count, RandomBenchResult& result)
+{
+    volatile uint32 sink = 0;
+    uint32 start;
+
+    // the previous implementation: one ACE_TSS lookup per call
+    {
+        ACE_TSS<MTRand> oldRand;
+        start = getMSTime();
+        for (uint32 i = 0; i < count; ++i)
+            sink += oldRand->randInt(99);
+        result.mtRandTime = getMSTimeDiff(start, getMSTime());
+    }
+
+    start = getMSTime();
+    for (uint32 i = 0; i < count; ++i)
+        sink += urand(0, 99);
+    result.urandTime = getMSTimeDiff(start, getMSTime());
+
+    {
+        RandomEngine engine(count);
+        start = getMSTime();
+        for (uint32 i = 0; i < count; ++i)
+            sink += engine.Range(99);
+        result.engineTime = getMSTimeDiff(start, getMSTime());
+    }
+
+#ifdef USE_SFMT_FOR_RNG
+    result.engineName = "SFMT";
+#else
+    result.engineName = "MTRand";
+#endif
+    (void)sink;
 }
 
 Tokens StrSplit(const std::string &src, const std::string &sep)
@@ -62,6 +62,59 @@ inline uint32 secsToTimeBitFields(time_t secs)
  * With an FPU, there is usually no difference in performance between float and double. */
  double rand_chance(void);
 
+class RandomEngine;
+
+/* A self contained random sequence. While selected on a thread, irand/urand/rand32/rand_norm/
+ * rand_chance draw from it instead of the thread's own generator, so the same seed replays the
+ * same rolls. Maps own one each when MapRandomSeed is set. */
+class RandomStream
+{
+    friend void SelectRandomStream(RandomStream* stream);
+
+    public:
+        explicit RandomStream(uint32 seed);
+        ~RandomStream();
+
+        void Reseed(uint32 seed);
+        uint32 GetSeed() const { return m_seed; }
+
+    private:
+        RandomStream(RandomStream const&);
+        RandomStream& operator=(RandomStream const&);
+
+        RandomEngine* m_engine;
+        uint32 m_seed;
+};
+
+/* Route the random functions of the calling thread to the given stream, NULL restores the thread's own generator. */
+void SelectRandomStream(RandomStream* stream);
+RandomStream* GetSelectedRandomStream();
+
+/* Selects a stream for the lifetime of the object and restores the previous one afterwards. */
+class RandomStreamSelector
+{
+    public:
+        explicit RandomStreamSelector(RandomStream* stream) : m_previous(GetSelectedRandomStream())
+        {
+            SelectRandomStream(stream);
+        }
+        ~RandomStreamSelector() { SelectRandomStream(m_previous); }
+
+    private:
+        RandomStream* m_previous;
+};
+
+struct RandomBenchResult
+{
+    uint32 mtRandTime;                                      // ms, ACE_TSS<MTRand> lookup on every call (old path)
+    uint32 urandTime;                                       // ms, urand() through the cached thread engine
+    uint32 engineTime;                                      // ms, the engine called directly
+    char const* engineName;
+};
+
+/* Draw count numbers in 0..99 through each path and time them. */
+void BenchmarkRandom(uint32 count, RandomBenchResult& result);
+
 /* Return true if a random roll fits in the specified chance (range 0-100). */
 inline bool roll_chance_f(float chance)
 {
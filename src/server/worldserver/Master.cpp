@@ -294,6 +294,9 @@ int Master::Run()
     ///- Clean database before leaving
     clearOnlineAccounts();
 
+    // Hand queued log lines to the DB before the delay threads go away
+    sLog->Flush();
+
     // Wait for delay threads to end
     CharacterDatabase.HaltDelayThread();
     WorldDatabase.HaltDelayThread();
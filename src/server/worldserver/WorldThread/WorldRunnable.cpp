@@ -30,6 +30,9 @@
 #include "BattlegroundMgr.h"
 #include "MapManager.h"
 #include "Timer.h"
+#include "PlayerSaveScheduler.h"
+#include "InstanceSaveMgr.h"
+#include "ObjectMgr.h"
 #include "WorldRunnable.h"
 
 #define WORLD_SLEEP_CONST 50
@@ -97,6 +100,11 @@ void WorldRunnable::run()
 
     sMapMgr->UnloadAll();                     // unload all grids (including locked in memory)
 
+    sInstanceSaveMgr->WaitOnlineCleanup();    // its statements go through the DB threads as well
+    sObjectMgr->WaitOldMails();               // the expired mail job stops after its current batch
+
+    sPlayerSaveScheduler->Stop();             // hand the last queued saves to the DB
+
     // End the database thread
     WorldDatabase.ThreadEnd();                                  // free mySQL thread resources
     //sObjectMgr->UnloadAll();             // unload 'i_player2corpse' storage and remove from world
@@ -20,23 +20,59 @@
 
 #include <string>
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <ace/OS_NS_unistd.h>
 
 #include "TileAssembler.h"
 
+void printUsage(char const* prog)
+{
+    std::cout << "usage: " << prog << " <raw data dir> <vmap dest dir> [options]" << std::endl;
+    std::cout << "    --threads <n>  number of worker threads, default: number of processors" << std::endl;
+    std::cout << "    --sah          build the trees with the surface area heuristic" << std::endl;
+    std::cout << "    --compare      also build every tree with the other method and print the traversal cost of both" << std::endl;
+}
+
 int main(int argc, char* argv[])
 {
-    if (argc != 3)
+    if (argc < 3)
     {
-        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir>" << std::endl;
+        printUsage(argv[0]);
         return 1;
     }
 
     std::string src = argv[1];
     std::string dest = argv[2];
 
+    long threads = ACE_OS::num_processors();
+    BIHBuildMethod method = BIH_BUILD_MIDPOINT;
+    bool compare = false;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--sah") == 0)
+            method = BIH_BUILD_SAH;
+        else if (strcmp(argv[i], "--compare") == 0)
+            compare = true;
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (threads < 1)
+        threads = 1;
+
     std::cout << "using " << src << " as source directory and writing output to " << dest << std::endl;
 
     VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest);
+    ta->setThreads(uint32(threads));
+    ta->setBuildMethod(method);
+    ta->setCompareBuilders(compare);
 
     if (!ta->convertWorld2())
     {
@@ -49,4 +85,3 @@ int main(int argc, char* argv[])
     std::cout << "Ok, all done" << std::endl;
     return 0;
 }
-
@@ -0,0 +1,487 @@
+/*
+ * Copyright (C) 2010-2012 Project SkyFire <http://www.projectskyfire.org/>
+ * Copyright (C) 2010-2012 Oregon <http://www.oregoncore.com/>
+ * Copyright (C) 2008-2012 TrinityCore <http://www.trinitycore.org/>
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Builds the walk maps (DataDir/walkmaps/MMMXXYY.walk) the worldserver plans
+ * creature paths on. One node per .map height cell: its ground height from the
+ * .map heights, raised onto the vmap surface (roads, floors, bridges) where one
+ * lies within a step above the terrain, and a link to each neighbour that is
+ * not too steep to walk to and, with vmaps, not blocked by a model in between.
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ace/Dirent.h>
+#include <ace/OS_NS_sys_stat.h>
+
+#include "Define.h"
+#include "VMapManager2.h"
+
+//******************************************
+// Map and walk file format defines, see Map.h and WalkMap.h of the worldserver
+//******************************************
+#define MAP_MAGIC             'SPAM'
+#define MAP_VERSION_MAGIC     '5.0w'
+#define MAP_HEIGHT_MAGIC      'TGHM'
+
+#define MAP_HEIGHT_NO_HEIGHT  0x0001
+#define MAP_HEIGHT_AS_INT16   0x0002
+#define MAP_HEIGHT_AS_INT8    0x0004
+
+#define WALK_MAGIC            'KLAW'
+#define WALK_VERSION_MAGIC    '1.0w'
+
+#define MAX_NUMBER_OF_GRIDS   64
+#define SIZE_OF_GRIDS         533.33333f
+#define WALK_RESOLUTION       128
+#define WALK_DIRECTIONS       8
+#define WALK_NODE_SIZE        (SIZE_OF_GRIDS / WALK_RESOLUTION)
+
+// vmap surfaces up to this far above the terrain are walked on, also the height of the line of sight checks
+#define WALK_STEP_HEIGHT      2.0f
+
+struct map_fileheader
+{
+    uint32 mapMagic;
+    uint32 versionMagic;
+    uint32 areaMapOffset;
+    uint32 areaMapSize;
+    uint32 heightMapOffset;
+    uint32 heightMapSize;
+    uint32 liquidMapOffset;
+    uint32 liquidMapSize;
+};
+
+struct map_heightHeader
+{
+    uint32 fourcc;
+    uint32 flags;
+    float  gridHeight;
+    float  gridMaxHeight;
+};
+
+struct walk_fileheader
+{
+    uint32 walkMagic;
+    uint32 versionMagic;
+    float  minHeight;
+    float  heightStep;
+};
+
+static int8 const WalkDirectionX[WALK_DIRECTIONS] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+static int8 const WalkDirectionY[WALK_DIRECTIONS] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+
+struct TileNodes
+{
+    float height[WALK_RESOLUTION * WALK_RESOLUTION];
+    bool walkable[WALK_RESOLUTION * WALK_RESOLUTION];
+};
+
+typedef std::map<uint32 /*gx << 8 | gy*/, TileNodes*> TileMap;
+
+std::string dataDir;
+bool useVMaps = true;
+float maxSlope = 0.0f;                                      // tangent of the steepest walkable slope
+VMAP::VMapManager2* vmapManager = NULL;
+
+void printUsage(char const* prog)
+{
+    std::cout << "usage: " << prog << " <data dir> [options]" << std::endl;
+    std::cout << "    reads <data dir>/maps and <data dir>/vmaps, writes <data dir>/walkmaps" << std::endl;
+    std::cout << "    --map <id>     only build this map" << std::endl;
+    std::cout << "    --novmap       terrain only, no model heights and line of sight" << std::endl;
+    std::cout << "    --slope <deg>  steepest walkable slope, default: 50" << std::endl;
+}
+
+inline float nodeCoord(uint32 tile, uint32 node)
+{
+    return (MAX_NUMBER_OF_GRIDS / 2 - tile - (node + 0.5f) / WALK_RESOLUTION) * SIZE_OF_GRIDS;
+}
+
+template<class T>
+bool readHeights(FILE* in, std::vector<float>& v9, std::vector<float>& v8, float base, float multiplier)
+{
+    std::vector<T> raw9(129 * 129), raw8(128 * 128);
+    if (fread(&raw9[0], sizeof(T), raw9.size(), in) != raw9.size() || fread(&raw8[0], sizeof(T), raw8.size(), in) != raw8.size())
+        return false;
+
+    for (size_t i = 0; i < raw9.size(); ++i)
+        v9[i] = raw9[i] * multiplier + base;
+    for (size_t i = 0; i < raw8.size(); ++i)
+        v8[i] = raw8[i] * multiplier + base;
+    return true;
+}
+
+// node heights and walkable slopes of one tile from its .map heights
+bool loadTerrain(uint32 mapId, uint32 gx, uint32 gy, TileNodes& nodes)
+{
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%smaps/%03u%02u%02u.map", dataDir.c_str(), mapId, gx, gy);
+
+    FILE* in = fopen(filename, "rb");
+    if (!in)
+        return false;
+
+    map_fileheader header;
+    map_heightHeader heightHeader;
+    if (fread(&header, sizeof(header), 1, in) != 1 || header.mapMagic != uint32(MAP_MAGIC) || header.versionMagic != uint32(MAP_VERSION_MAGIC) ||
+        !header.heightMapOffset || fseek(in, header.heightMapOffset, SEEK_SET) != 0 ||
+        fread(&heightHeader, sizeof(heightHeader), 1, in) != 1 || heightHeader.fourcc != uint32(MAP_HEIGHT_MAGIC))
+    {
+        std::cout << "skipping " << filename << ": no height data or from an incompatible client version" << std::endl;
+        fclose(in);
+        return false;
+    }
+
+    std::vector<float> v9(129 * 129, heightHeader.gridHeight), v8(128 * 128, heightHeader.gridHeight);
+    // flat tiles keep gridHeight everywhere
+    bool ok = true;
+    if (!(heightHeader.flags & MAP_HEIGHT_NO_HEIGHT))
+    {
+        if (heightHeader.flags & MAP_HEIGHT_AS_INT16)
+            ok = readHeights<uint16>(in, v9, v8, heightHeader.gridHeight, (heightHeader.gridMaxHeight - heightHeader.gridHeight) / 65535);
+        else if (heightHeader.flags & MAP_HEIGHT_AS_INT8)
+            ok = readHeights<uint8>(in, v9, v8, heightHeader.gridHeight, (heightHeader.gridMaxHeight - heightHeader.gridHeight) / 255);
+        else
+            ok = fread(&v9[0], sizeof(float), v9.size(), in) == v9.size() && fread(&v8[0], sizeof(float), v8.size(), in) == v8.size();
+    }
+    fclose(in);
+
+    if (!ok)
+    {
+        std::cout << "skipping " << filename << ": truncated height data" << std::endl;
+        return false;
+    }
+
+    // the centre height is the V8 value, the corners are V9 values half a diagonal away
+    float halfDiagonal = WALK_NODE_SIZE * 0.7071068f;
+    for (uint32 x = 0; x < WALK_RESOLUTION; ++x)
+    {
+        for (uint32 y = 0; y < WALK_RESOLUTION; ++y)
+        {
+            float h = v8[x * 128 + y];
+            float corners[4] = { v9[x * 129 + y], v9[(x + 1) * 129 + y], v9[x * 129 + y + 1], v9[(x + 1) * 129 + y + 1] };
+
+            bool walkable = true;
+            for (uint32 i = 0; i < 4; ++i)
+                if (fabs(corners[i] - h) > halfDiagonal * maxSlope)
+                    walkable = false;
+
+            nodes.height[x * WALK_RESOLUTION + y] = h;
+            nodes.walkable[x * WALK_RESOLUTION + y] = walkable;
+        }
+    }
+    return true;
+}
+
+// raise the nodes onto model surfaces right above the terrain
+void applyModelHeights(uint32 mapId, uint32 gx, uint32 gy, TileNodes& nodes)
+{
+    std::vector<VMAP::HeightQuery> queries(WALK_RESOLUTION);
+    for (uint32 x = 0; x < WALK_RESOLUTION; ++x)
+    {
+        for (uint32 y = 0; y < WALK_RESOLUTION; ++y)
+        {
+            VMAP::HeightQuery& query = queries[y];
+            query.x = nodeCoord(gx, x);
+            query.y = nodeCoord(gy, y);
+            query.z = nodes.height[x * WALK_RESOLUTION + y] + WALK_STEP_HEIGHT;
+            query.maxSearchDist = WALK_STEP_HEIGHT + 0.5f;
+        }
+
+        vmapManager->getHeight(mapId, &queries[0], WALK_RESOLUTION);
+
+        for (uint32 y = 0; y < WALK_RESOLUTION; ++y)
+        {
+            float& h = nodes.height[x * WALK_RESOLUTION + y];
+            if (queries[y].height > VMAP_INVALID_HEIGHT && queries[y].height > h)
+            {
+                h = queries[y].height;
+                // standing on a model, its surface decides and not the terrain below
+                nodes.walkable[x * WALK_RESOLUTION + y] = true;
+            }
+        }
+    }
+}
+
+TileNodes const* findNode(TileMap const& tiles, int32 nx, int32 ny, uint32& index)
+{
+    if (nx < 0 || ny < 0 || nx >= MAX_NUMBER_OF_GRIDS * WALK_RESOLUTION || ny >= MAX_NUMBER_OF_GRIDS * WALK_RESOLUTION)
+        return NULL;
+
+    TileMap::const_iterator itr = tiles.find((uint32(nx / WALK_RESOLUTION) << 8) | uint32(ny / WALK_RESOLUTION));
+    if (itr == tiles.end())
+        return NULL;
+
+    index = (nx % WALK_RESOLUTION) * WALK_RESOLUTION + ny % WALK_RESOLUTION;
+    return itr->second;
+}
+
+bool writeTile(uint32 mapId, uint32 gx, uint32 gy, TileMap const& tiles, uint32& walkableNodes)
+{
+    TileNodes const& nodes = *tiles.find((gx << 8) | gy)->second;
+
+    std::vector<uint8> links(WALK_RESOLUTION * WALK_RESOLUTION, 0);
+    std::vector<VMAP::LineOfSightQuery> queries;
+    std::vector<uint32> queryLinks;
+
+    for (uint32 x = 0; x < WALK_RESOLUTION; ++x)
+    {
+        queries.clear();
+        queryLinks.clear();
+
+        for (uint32 y = 0; y < WALK_RESOLUTION; ++y)
+        {
+            uint32 index = x * WALK_RESOLUTION + y;
+            if (!nodes.walkable[index])
+                continue;
+
+            for (uint32 dir = 0; dir < WALK_DIRECTIONS; ++dir)
+            {
+                int32 nx = int32(gx * WALK_RESOLUTION + x) + WalkDirectionX[dir];
+                int32 ny = int32(gy * WALK_RESOLUTION + y) + WalkDirectionY[dir];
+                uint32 otherIndex;
+                TileNodes const* other = findNode(tiles, nx, ny, otherIndex);
+                if (!other || !other->walkable[otherIndex])
+                    continue;
+
+                float step = (dir & 1) ? WALK_NODE_SIZE * 1.4142136f : WALK_NODE_SIZE;
+                if (fabs(other->height[otherIndex] - nodes.height[index]) > step * maxSlope)
+                    continue;
+
+                if (!useVMaps)
+                {
+                    links[index] |= 1 << dir;
+                    continue;
+                }
+
+                VMAP::LineOfSightQuery query;
+                query.x1 = nodeCoord(gx, x);
+                query.y1 = nodeCoord(gy, y);
+                query.z1 = nodes.height[index] + WALK_STEP_HEIGHT;
+                query.x2 = nodeCoord(nx / WALK_RESOLUTION, nx % WALK_RESOLUTION);
+                query.y2 = nodeCoord(ny / WALK_RESOLUTION, ny % WALK_RESOLUTION);
+                query.z2 = other->height[otherIndex] + WALK_STEP_HEIGHT;
+                queries.push_back(query);
+                queryLinks.push_back(index << 3 | dir);
+            }
+        }
+
+        if (queries.empty())
+            continue;
+
+        vmapManager->isInLineOfSight(mapId, &queries[0], queries.size());
+        for (size_t i = 0; i < queries.size(); ++i)
+            if (queries[i].result)
+                links[queryLinks[i] >> 3] |= 1 << (queryLinks[i] & 7);
+    }
+
+    walk_fileheader header;
+    header.walkMagic = WALK_MAGIC;
+    header.versionMagic = WALK_VERSION_MAGIC;
+
+    float minHeight = nodes.height[0], maxHeight = nodes.height[0];
+    for (uint32 i = 0; i < WALK_RESOLUTION * WALK_RESOLUTION; ++i)
+    {
+        minHeight = std::min(minHeight, nodes.height[i]);
+        maxHeight = std::max(maxHeight, nodes.height[i]);
+    }
+    header.minHeight = minHeight;
+    header.heightStep = (maxHeight - minHeight) / 65535;
+
+    std::vector<uint16> heights(WALK_RESOLUTION * WALK_RESOLUTION, 0);
+    walkableNodes = 0;
+    for (uint32 i = 0; i < WALK_RESOLUTION * WALK_RESOLUTION; ++i)
+    {
+        if (header.heightStep > 0.0f)
+            heights[i] = uint16((nodes.height[i] - minHeight) / header.heightStep + 0.5f);
+        if (links[i])
+            ++walkableNodes;
+    }
+
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%swalkmaps/%03u%02u%02u.walk", dataDir.c_str(), mapId, gx, gy);
+    FILE* out = fopen(filename, "wb");
+    if (!out)
+    {
+        std::cout << "can't create " << filename << std::endl;
+        return false;
+    }
+
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(&heights[0], sizeof(uint16), heights.size(), out);
+    fwrite(&links[0], sizeof(uint8), links.size(), out);
+    fclose(out);
+    return true;
+}
+
+bool buildMap(uint32 mapId, std::set<uint32> const& tileIds)
+{
+    std::string vmapDir = dataDir + "vmaps";
+    TileMap tiles;
+
+    // heights of every tile first, the links of the border nodes need the neighbour tiles
+    for (std::set<uint32>::const_iterator itr = tileIds.begin(); itr != tileIds.end(); ++itr)
+    {
+        uint32 gx = *itr >> 8, gy = *itr & 0xFF;
+        TileNodes* nodes = new TileNodes;
+        if (!loadTerrain(mapId, gx, gy, *nodes))
+        {
+            delete nodes;
+            continue;
+        }
+
+        if (useVMaps && vmapManager->loadMap(vmapDir.c_str(), mapId, gx, gy) == VMAP::VMAP_LOAD_RESULT_OK)
+        {
+            applyModelHeights(mapId, gx, gy, *nodes);
+            vmapManager->unloadMap(mapId, gx, gy);
+        }
+        tiles[*itr] = nodes;
+    }
+
+    bool ok = true;
+    for (TileMap::const_iterator itr = tiles.begin(); itr != tiles.end(); ++itr)
+    {
+        uint32 gx = itr->first >> 8, gy = itr->first & 0xFF;
+
+        // the models of the neighbours reach over the shared border
+        std::vector<uint32> loaded;
+        if (useVMaps)
+        {
+            for (int32 x = int32(gx) - 1; x <= int32(gx) + 1; ++x)
+                for (int32 y = int32(gy) - 1; y <= int32(gy) + 1; ++y)
+                    if (x >= 0 && y >= 0 && x < MAX_NUMBER_OF_GRIDS && y < MAX_NUMBER_OF_GRIDS &&
+                        vmapManager->loadMap(vmapDir.c_str(), mapId, x, y) == VMAP::VMAP_LOAD_RESULT_OK)
+                        loaded.push_back((uint32(x) << 8) | uint32(y));
+        }
+
+        uint32 walkableNodes = 0;
+        if (!writeTile(mapId, gx, gy, tiles, walkableNodes))
+            ok = false;
+        else
+            printf("map %03u tile [%02u,%02u]: %u walkable nodes\n", mapId, gx, gy, walkableNodes);
+
+        for (std::vector<uint32>::const_iterator tile = loaded.begin(); tile != loaded.end(); ++tile)
+            vmapManager->unloadMap(mapId, *tile >> 8, *tile & 0xFF);
+    }
+
+    for (TileMap::iterator itr = tiles.begin(); itr != tiles.end(); ++itr)
+        delete itr->second;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    dataDir = argv[1];
+    if (dataDir[dataDir.length() - 1] != '/' && dataDir[dataDir.length() - 1] != '\\')
+        dataDir.append("/");
+
+    int32 onlyMap = -1;
+    float slope = 50.0f;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--map") == 0 && i + 1 < argc)
+            onlyMap = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--novmap") == 0)
+            useVMaps = false;
+        else if (strcmp(argv[i], "--slope") == 0 && i + 1 < argc)
+            slope = float(atof(argv[++i]));
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (slope <= 0.0f || slope >= 90.0f)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    maxSlope = tan(slope * float(M_PI) / 180.0f);
+
+    // MMMXXYY.map
+    std::map<uint32, std::set<uint32> > maps;
+    ACE_Dirent dir;
+    if (dir.open((dataDir + "maps").c_str()) == -1)
+    {
+        std::cout << "can't open " << dataDir << "maps" << std::endl;
+        return 1;
+    }
+
+    for (ACE_DIRENT* entry = dir.read(); entry; entry = dir.read())
+    {
+        uint32 mapId, gx, gy;
+        if (strlen(entry->d_name) != 11 || strcmp(entry->d_name + 7, ".map") != 0 ||
+            sscanf(entry->d_name, "%3u%2u%2u", &mapId, &gx, &gy) != 3 || gx >= MAX_NUMBER_OF_GRIDS || gy >= MAX_NUMBER_OF_GRIDS)
+            continue;
+
+        if (onlyMap < 0 || uint32(onlyMap) == mapId)
+            maps[mapId].insert((gx << 8) | gy);
+    }
+    dir.close();
+
+    if (maps.empty())
+    {
+        std::cout << "no map files found in " << dataDir << "maps" << std::endl;
+        return 1;
+    }
+
+    ACE_OS::mkdir((dataDir + "walkmaps").c_str());
+
+    if (useVMaps)
+    {
+        vmapManager = new VMAP::VMapManager2();
+        vmapManager->setEnableLineOfSightCalc(true);
+        vmapManager->setEnableHeightCalc(true);
+    }
+
+    std::cout << "building walk maps of " << maps.size() << " maps " << (useVMaps ? "with" : "without") << " vmaps, max slope " << slope << std::endl;
+
+    bool ok = true;
+    for (std::map<uint32, std::set<uint32> >::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+        if (!buildMap(itr->first, itr->second))
+            ok = false;
+
+    delete vmapManager;
+
+    if (!ok)
+    {
+        std::cout << "exit with errors" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Ok, all done" << std::endl;
+    return 0;
+}